@@ -0,0 +1,185 @@
+// Interleaved versus planar sample storage, using SDRplay-sized packets.
+//
+// Each run feeds API-style xi/xq packets into the buffer the way the stream
+// callback does (interleaving first for SampleBuffer, storing as-is for
+// PlanarBuffer), then runs a kernel over the stored samples in place.
+#include "planar_buffer.h"
+#include "sample_buffer.h"
+#include "sample_convert.h"
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+
+const size_t FIR_TAPS = 32;
+
+// Kernels over interleaved storage
+struct InterleavedKernels {
+    static int64_t power(const std::complex<short>* s, size_t n) {
+        int64_t sum = 0;
+        for (size_t k = 0; k < n; ++k) {
+            int32_t re = s[k].real();
+            int32_t im = s[k].imag();
+            sum += re * re + im * im;
+        }
+        return sum;
+    }
+
+    // Real FIR over I, one output per input sample with a full history
+    static int64_t fir(const std::complex<short>* s, size_t n, const short* taps) {
+        int64_t sum = 0;
+        for (size_t k = 0; k + FIR_TAPS <= n; ++k) {
+            int32_t acc = 0;
+            for (size_t t = 0; t < FIR_TAPS; ++t) {
+                acc += s[k + t].real() * taps[t];
+            }
+            sum += acc;
+        }
+        return sum;
+    }
+};
+
+// The same kernels over planar storage
+struct PlanarKernels {
+    static int64_t power(const short* xi, const short* xq, size_t n) {
+        int64_t sum = 0;
+        for (size_t k = 0; k < n; ++k) {
+            int32_t re = xi[k];
+            int32_t im = xq[k];
+            sum += re * re + im * im;
+        }
+        return sum;
+    }
+
+    static int64_t fir(const short* xi, size_t n, const short* taps) {
+        int64_t sum = 0;
+        for (size_t k = 0; k + FIR_TAPS <= n; ++k) {
+            int32_t acc = 0;
+            for (size_t t = 0; t < FIR_TAPS; ++t) {
+                acc += xi[k + t] * taps[t];
+            }
+            sum += acc;
+        }
+        return sum;
+    }
+};
+
+enum class Kernel { None, Power, Fir };
+
+const char* kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Power: return "power";
+        case Kernel::Fir: return "fir32";
+        default: return "store";
+    }
+}
+
+struct Packets {
+    std::vector<short> xi;
+    std::vector<short> xq;
+    std::vector<short> taps;
+
+    explicit Packets(size_t packetSize) : xi(packetSize), xq(packetSize), taps(FIR_TAPS) {
+        for (size_t k = 0; k < packetSize; ++k) {
+            xi[k] = static_cast<short>((k * 37) & 0x3fff);
+            xq[k] = static_cast<short>(-static_cast<int>((k * 11) & 0x3fff));
+        }
+        for (size_t t = 0; t < FIR_TAPS; ++t) {
+            taps[t] = static_cast<short>(t + 1);
+        }
+    }
+};
+
+volatile int64_t sink;  // Keeps the kernels from being optimised away
+
+double runInterleaved(const Packets& packets, Kernel kernel, size_t readSize, size_t totalSamples) {
+    const size_t packetSize = packets.xi.size();
+    SampleBuffer buffer(262144);
+    std::vector<std::complex<short>> scratch(packetSize);
+    int64_t result = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < totalSamples; sent += packetSize) {
+        interleaveIQ(packets.xi.data(), packets.xq.data(), scratch.data(), packetSize);
+        buffer.write(scratch.data(), packetSize);
+
+        while (buffer.available() >= readSize) {
+            SampleSpans spans = buffer.peek(readSize);
+            for (const SampleSpan& span : { spans.first, spans.second }) {
+                if (kernel == Kernel::Power) {
+                    result += InterleavedKernels::power(span.data, span.size);
+                } else if (kernel == Kernel::Fir) {
+                    result += InterleavedKernels::fir(span.data, span.size, packets.taps.data());
+                }
+            }
+            buffer.consume(spans.size());
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    sink = result;
+    return static_cast<double>(totalSamples) / elapsed.count() / 1e6;
+}
+
+double runPlanar(const Packets& packets, Kernel kernel, size_t readSize, size_t totalSamples) {
+    const size_t packetSize = packets.xi.size();
+    PlanarBuffer buffer(262144);
+    int64_t result = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < totalSamples; sent += packetSize) {
+        buffer.write(packets.xi.data(), packets.xq.data(), packetSize);
+
+        while (buffer.available() >= readSize) {
+            PlanarSpans spans = buffer.peek(readSize);
+            for (const PlanarSpan& span : { spans.first, spans.second }) {
+                if (kernel == Kernel::Power) {
+                    result += PlanarKernels::power(span.i, span.q, span.size);
+                } else if (kernel == Kernel::Fir) {
+                    result += PlanarKernels::fir(span.i, span.size, packets.taps.data());
+                }
+            }
+            buffer.consume(spans.size());
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    sink = result;
+    return static_cast<double>(totalSamples) / elapsed.count() / 1e6;
+}
+
+} // namespace
+
+int main() {
+    const size_t totalSamples = 64 * 1024 * 1024;
+    const size_t readSize = 16384;
+    const size_t packetSizes[] = {252, 1344};
+    const Kernel kernels[] = {Kernel::None, Kernel::Power, Kernel::Fir};
+
+    std::cout << std::left << std::setw(10) << "packet"
+              << std::setw(10) << "kernel"
+              << std::setw(18) << "interleaved MS/s"
+              << std::setw(14) << "planar MS/s"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (size_t packetSize : packetSizes) {
+        Packets packets(packetSize);
+        for (Kernel kernel : kernels) {
+            double interleaved = runInterleaved(packets, kernel, readSize, totalSamples);
+            double planar = runPlanar(packets, kernel, readSize, totalSamples);
+
+            std::cout << std::left << std::setw(10) << packetSize
+                      << std::setw(10) << kernelName(kernel)
+                      << std::setw(18) << std::fixed << std::setprecision(1) << interleaved
+                      << std::setw(14) << planar
+                      << std::setprecision(2) << planar / interleaved << "x" << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Throughput comparison of the lock-free SampleBuffer against the previous
+// mutex-guarded implementation, using SDRplay-sized packets.
+#include "sample_buffer.h"
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+
+// The SampleBuffer implementation prior to the SPSC ring, kept as a baseline
+class LegacySampleBuffer {
+public:
+    explicit LegacySampleBuffer(size_t size) : buffer(size), readPos(0), writePos(0) {}
+
+    bool write(const std::complex<short>* data, size_t count) {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        size_t bufferSize = buffer.size();
+        size_t available = (readPos <= writePos)
+            ? bufferSize - (writePos - readPos)
+            : readPos - writePos;
+        if (count >= available) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            buffer[writePos] = data[i];
+            writePos = (writePos + 1) % bufferSize;
+        }
+        dataAvailable.notify_all();
+        return true;
+    }
+
+    size_t read(std::complex<short>* dest, size_t maxCount) {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        size_t bufferSize = buffer.size();
+        size_t count = (readPos <= writePos)
+            ? writePos - readPos
+            : bufferSize - readPos + writePos;
+        count = std::min(count, maxCount);
+        for (size_t i = 0; i < count; ++i) {
+            dest[i] = buffer[readPos];
+            readPos = (readPos + 1) % bufferSize;
+        }
+        return count;
+    }
+
+    bool waitForSamples(size_t count, unsigned int timeoutMs) {
+        std::unique_lock<std::mutex> lock(bufferMutex);
+        return dataAvailable.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, count]() {
+            size_t available = (readPos <= writePos)
+                ? writePos - readPos
+                : buffer.size() - readPos + writePos;
+            return available >= count;
+        });
+    }
+
+private:
+    std::vector<std::complex<short>> buffer;
+    size_t readPos;
+    size_t writePos;
+    std::mutex bufferMutex;
+    std::condition_variable dataAvailable;
+};
+
+// The legacy buffer rejects whole packets, so the producer retries; the SPSC
+// ring blocks on the API side instead, which delivers every sample exactly once
+void configureBackPressure(LegacySampleBuffer&) {}
+
+void configureBackPressure(SampleBuffer& buffer) {
+    buffer.setOverflowPolicy(OverflowPolicy::BlockWithTimeout, 1000);
+}
+
+struct Result {
+    double msps;
+    size_t producerStalls;
+};
+
+template <typename Buffer>
+Result runTransfer(size_t capacity, size_t packetSize, size_t readSize, size_t totalSamples) {
+    Buffer buffer(capacity);
+    configureBackPressure(buffer);
+    std::vector<std::complex<short>> packet(packetSize, std::complex<short>(1, -1));
+    size_t stalls = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&]() {
+        size_t sent = 0;
+        while (sent < totalSamples) {
+            size_t n = std::min(packetSize, totalSamples - sent);
+            while (!buffer.write(packet.data(), n)) {
+                ++stalls;
+                std::this_thread::yield();
+            }
+            sent += n;
+        }
+    });
+
+    std::vector<std::complex<short>> out(readSize);
+    size_t received = 0;
+    while (received < totalSamples) {
+        buffer.waitForSamples(1, 10);
+        received += buffer.read(out.data(), out.size());
+    }
+    producer.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return Result{static_cast<double>(totalSamples) / elapsed.count() / 1e6, stalls};
+}
+
+} // namespace
+
+int main() {
+    const size_t totalSamples = 64 * 1024 * 1024;
+    const size_t capacity = 262144;
+    const size_t readSize = 16384;
+    const size_t packetSizes[] = {252, 1008, 1344, 4096};
+
+    std::cout << std::left << std::setw(10) << "packet"
+              << std::setw(16) << "legacy MS/s"
+              << std::setw(16) << "spsc MS/s"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (size_t packetSize : packetSizes) {
+        Result legacy = runTransfer<LegacySampleBuffer>(capacity, packetSize, readSize, totalSamples);
+        Result spsc = runTransfer<SampleBuffer>(capacity, packetSize, readSize, totalSamples);
+
+        std::cout << std::left << std::setw(10) << packetSize
+                  << std::setw(16) << std::fixed << std::setprecision(1) << legacy.msps
+                  << std::setw(16) << spsc.msps
+                  << std::setprecision(2) << spsc.msps / legacy.msps << "x" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Wakeup latency and consumer CPU cost of each wait strategy.
+//
+// A producer writes one SDRplay-sized packet at a fixed interval and stamps
+// the time just before each write. The consumer waits for the packet and
+// records how long after the write it woke up. Busy polling wakes fastest
+// but burns a core; blocking is cheapest but slowest and most jittery.
+#include "latency_histogram.h"
+#include "sample_buffer.h"
+#include "wait_strategy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <time.h>
+#endif
+
+using namespace sdrplay;
+
+namespace {
+
+const size_t PACKET_SIZE = 1344;
+const size_t PACKETS = 5000;
+const auto PACKET_INTERVAL = std::chrono::microseconds(250);
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// CPU time of the calling thread, or -1 where unavailable
+double threadCpuSeconds() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+    return -1.0;
+#endif
+}
+
+struct Result {
+    double cpuPercent;
+};
+
+Result run(WaitStrategy strategy, unsigned int spinUs, LatencyHistogram& histogram) {
+    SampleBuffer buffer(65536);
+    buffer.setWaitStrategy(strategy, spinUs);
+    std::atomic<uint64_t> writeNs(0);
+    std::atomic<bool> done(false);
+
+    std::thread producer([&]() {
+        std::vector<std::complex<short>> packet(PACKET_SIZE, std::complex<short>(1, -1));
+        auto next = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < PACKETS; ++i) {
+            next += PACKET_INTERVAL;
+            std::this_thread::sleep_until(next);
+            writeNs.store(nowNs(), std::memory_order_relaxed);
+            buffer.write(packet.data(), packet.size());
+        }
+        done = true;
+    });
+
+    std::vector<std::complex<short>> dest(PACKET_SIZE);
+    double cpuStart = threadCpuSeconds();
+    auto wallStart = std::chrono::steady_clock::now();
+    size_t received = 0;
+    while (received < PACKETS) {
+        if (!buffer.waitForSamples(PACKET_SIZE, 100)) {
+            if (done) {
+                break;
+            }
+            continue;
+        }
+        histogram.record(nowNs() - writeNs.load(std::memory_order_relaxed));
+        buffer.read(dest.data(), dest.size());
+        ++received;
+    }
+    double cpu = threadCpuSeconds() - cpuStart;
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+    producer.join();
+
+    Result result;
+    result.cpuPercent = cpuStart < 0 ? -1.0 : 100.0 * cpu / wall.count();
+    return result;
+}
+
+void printBars(const LatencyHistogram& histogram) {
+    // Regroup the fine buckets by power of two for a compact picture
+    const size_t width = 50;
+    std::vector<uint64_t> octaves(64, 0);
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        uint64_t n = histogram.bucketCount(i);
+        if (n > 0) {
+            uint64_t low = std::max<uint64_t>(1, LatencyHistogram::bucketLowerBound(i));
+            size_t octave = 0;
+            while ((low >> (octave + 1)) != 0) {
+                ++octave;
+            }
+            octaves[octave] += n;
+        }
+    }
+    uint64_t peak = *std::max_element(octaves.begin(), octaves.end());
+    for (size_t octave = 0; octave < octaves.size(); ++octave) {
+        if (octaves[octave] == 0) {
+            continue;
+        }
+        double lowUs = static_cast<double>(uint64_t(1) << octave) / 1000.0;
+        size_t bar = static_cast<size_t>(width * octaves[octave] / peak);
+        std::cout << "    >= " << std::right << std::setw(9) << std::fixed << std::setprecision(2)
+                  << lowUs << " us  " << std::left << std::setw(width + 2)
+                  << std::string(std::max<size_t>(bar, 1), '#') << octaves[octave] << std::endl;
+    }
+}
+
+} // namespace
+
+int main() {
+    struct Config {
+        WaitStrategy strategy;
+        unsigned int spinUs;
+    };
+    const Config configs[] = {
+        {WaitStrategy::Block, 0},
+        {WaitStrategy::SpinThenBlock, 20},
+        {WaitStrategy::SpinThenBlock, 300},
+        {WaitStrategy::BusyPoll, 0},
+    };
+
+    std::cout << "Wakeup latency, " << PACKET_SIZE << "-sample packets every "
+              << PACKET_INTERVAL.count() << " us" << std::endl << std::endl;
+    std::cout << std::left << std::setw(22) << "strategy"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us"
+              << std::setw(10) << "max us" << "consumer CPU" << std::endl;
+
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms;
+    for (const Config& config : configs) {
+        std::string name = waitStrategyName(config.strategy);
+        if (config.strategy == WaitStrategy::SpinThenBlock) {
+            name += " " + std::to_string(config.spinUs) + "us";
+        }
+        std::unique_ptr<LatencyHistogram> histogram(new LatencyHistogram());
+        Result result = run(config.strategy, config.spinUs, *histogram);
+
+        std::cout << std::left << std::setw(22) << name << std::fixed << std::setprecision(1);
+        for (double p : {50.0, 90.0, 99.0, 99.9}) {
+            std::cout << std::setw(10) << histogram->percentile(p) / 1000.0;
+        }
+        std::cout << std::setw(10) << histogram->max() / 1000.0;
+        if (result.cpuPercent < 0) {
+            std::cout << "n/a" << std::endl;
+        } else {
+            std::cout << result.cpuPercent << "%" << std::endl;
+        }
+        names.push_back(name);
+        histograms.push_back(std::move(histogram));
+    }
+
+    for (size_t i = 0; i < histograms.size(); ++i) {
+        std::cout << std::endl << names[i] << std::endl;
+        printBars(*histograms[i]);
+    }
+    return 0;
+}
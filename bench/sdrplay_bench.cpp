@@ -0,0 +1,493 @@
+// Microbenchmark suite for the streaming hot path.
+//
+// Each benchmark runs over a grid of packet sizes (and buffer capacities
+// where they matter) and reports one row per combination: the cost per
+// packet, the sample rate that cost sustains and, for wakeup latency, the
+// percentiles. Tables are for reading; JSON and CSV are for comparing
+// builds over time.
+//
+//   sdrplay_bench [--format table|json|csv] [--output FILE]
+//                 [--filter NAME] [--quick]
+#include "callback_wrapper.h"
+#include "latency_histogram.h"
+#include "sample_buffer.h"
+#include "sample_convert.h"
+#include "wait_strategy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+
+const size_t PACKET_SIZES[] = {256, 1008, 1344, 4096, 16384};
+const size_t CAPACITIES[] = {65536, 262144, 1048576};
+const SimdLevel SIMD_LEVELS[] = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON};
+
+struct Options {
+    std::string format{"table"};
+    std::string output;
+    std::string filter;
+    bool quick{false};
+};
+
+// One measured combination; fields that were not measured are negative
+struct Row {
+    std::string bench;
+    std::string variant;
+    size_t packet;
+    size_t capacity;
+    uint64_t packets;
+    double nsPerPacket;
+    double msps;
+    double p50Ns;
+    double p99Ns;
+    double p999Ns;
+
+    Row(const std::string& bench, const std::string& variant, size_t packet, size_t capacity)
+        : bench(bench), variant(variant), packet(packet), capacity(capacity), packets(0),
+          nsPerPacket(-1.0), msps(-1.0), p50Ns(-1.0), p99Ns(-1.0), p999Ns(-1.0) {}
+};
+
+class Suite {
+public:
+    explicit Suite(const Options& options) : options(options) {}
+
+    bool enabled(const std::string& bench) const {
+        return options.filter.empty() || bench.find(options.filter) != std::string::npos;
+    }
+
+    // Time step() in batches until the time budget is spent, after a warm-up
+    template <typename Step>
+    void measure(Row row, Step step) {
+        const double budget = options.quick ? 0.02 : 0.2;
+        const int batch = 64;
+        for (int i = 0; i < batch; ++i) {
+            step();
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed(0);
+        uint64_t packets = 0;
+        do {
+            for (int i = 0; i < batch; ++i) {
+                step();
+            }
+            packets += batch;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed.count() < budget);
+
+        row.packets = packets;
+        row.nsPerPacket = elapsed.count() * 1e9 / static_cast<double>(packets);
+        row.msps = static_cast<double>(row.packet) * 1e3 / row.nsPerPacket;
+        add(row);
+    }
+
+    void add(const Row& row) {
+        rows.push_back(row);
+        if (options.format == "table") {
+            printRow(std::cout, row);
+        }
+    }
+
+    bool quick() const { return options.quick; }
+    const std::vector<Row>& results() const { return rows; }
+
+    static void printHeader(std::ostream& out) {
+        out << std::left << std::setw(20) << "bench" << std::setw(22) << "variant"
+            << std::right << std::setw(8) << "packet" << std::setw(10) << "capacity"
+            << std::setw(12) << "ns/packet" << std::setw(10) << "MS/s"
+            << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us"
+            << std::endl;
+    }
+
+private:
+    static void printRow(std::ostream& out, const Row& row) {
+        out << std::left << std::setw(20) << row.bench << std::setw(22) << row.variant
+            << std::right << std::setw(8) << row.packet << std::setw(10);
+        if (row.capacity) {
+            out << row.capacity;
+        } else {
+            out << "-";
+        }
+        out << std::fixed << std::setprecision(1);
+        printField(out, 12, row.nsPerPacket, 1.0);
+        printField(out, 10, row.msps, 1.0);
+        printField(out, 10, row.p50Ns, 1e-3);
+        printField(out, 10, row.p99Ns, 1e-3);
+        printField(out, 10, row.p999Ns, 1e-3);
+        out << std::endl;
+    }
+
+    static void printField(std::ostream& out, int width, double value, double scale) {
+        if (value < 0) {
+            out << std::setw(width) << "-";
+        } else {
+            out << std::setw(width) << value * scale;
+        }
+    }
+
+    Options options;
+    std::vector<Row> rows;
+};
+
+std::vector<short> testComponent(size_t count, int seed) {
+    std::vector<short> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<short>((i * 2654435761u + seed) >> 16);
+    }
+    return values;
+}
+
+void benchBuffer(Suite& suite) {
+    if (!suite.enabled("buffer_write_read")) {
+        return;
+    }
+    for (size_t capacity : CAPACITIES) {
+        for (size_t packet : PACKET_SIZES) {
+            SampleBuffer buffer(capacity);
+            std::vector<std::complex<short>> in(packet, std::complex<short>(1, -1)), out(packet);
+            suite.measure(Row("buffer_write_read", "spsc", packet, capacity), [&]() {
+                buffer.write(in.data(), packet);
+                buffer.read(out.data(), packet);
+            });
+        }
+    }
+}
+
+void benchInterleave(Suite& suite) {
+    if (!suite.enabled("interleave")) {
+        return;
+    }
+    for (SimdLevel level : SIMD_LEVELS) {
+        if (!isSimdLevelSupported(level)) {
+            continue;
+        }
+        for (size_t packet : PACKET_SIZES) {
+            std::vector<short> xi = testComponent(packet, 1), xq = testComponent(packet, 2);
+            std::vector<std::complex<short>> dest(packet);
+            suite.measure(Row("interleave", simdLevelName(level), packet, 0), [&]() {
+                interleaveIQ(level, xi.data(), xq.data(), dest.data(), packet);
+            });
+        }
+    }
+}
+
+// The whole API-thread path: interleave, ring write and tagging
+void benchStreamCallback(Suite& suite) {
+    if (!suite.enabled("stream_callback")) {
+        return;
+    }
+    for (size_t capacity : CAPACITIES) {
+        for (size_t packet : PACKET_SIZES) {
+            CallbackWrapper wrapper(capacity);
+            wrapper.prepareStream(packet);
+            std::vector<short> xi = testComponent(packet, 1), xq = testComponent(packet, 2);
+            sdrplay_api_StreamCbParamsT params = {};
+            params.numSamples = static_cast<unsigned int>(packet);
+            unsigned int reset = 1;
+            suite.measure(Row("stream_callback", "buffer only", packet, capacity), [&]() {
+                CallbackWrapper::streamCallback(xi.data(), xq.data(), &params, params.numSamples,
+                                                reset, wrapper.getContext());
+                params.firstSampleNum += params.numSamples;
+                reset = 0;
+                wrapper.consumeSamples(packet);
+            });
+        }
+    }
+}
+
+// API-thread cost of delivering to a sample callback, inline or via the dispatcher
+void benchCallbackDispatch(Suite& suite) {
+    if (!suite.enabled("callback_dispatch")) {
+        return;
+    }
+    struct Variant {
+        const char* name;
+        CallbackMode mode;
+        SampleFormat format;
+    };
+    const Variant variants[] = {
+        {"inline cs16", CallbackMode::Inline, SampleFormat::CS16},
+        {"inline cf32", CallbackMode::Inline, SampleFormat::CF32},
+        {"dispatcher cs16", CallbackMode::Dispatcher, SampleFormat::CS16},
+    };
+    for (const Variant& variant : variants) {
+        for (size_t packet : PACKET_SIZES) {
+            std::atomic<uint64_t> delivered(0);
+            CallbackWrapper wrapper(262144);
+            if (variant.format == SampleFormat::CF32) {
+                wrapper.setSampleCallback([&delivered](const std::complex<float>*, size_t count) {
+                    delivered.fetch_add(count, std::memory_order_relaxed);
+                });
+            } else {
+                wrapper.setSampleCallback([&delivered](const std::complex<short>*, size_t count) {
+                    delivered.fetch_add(count, std::memory_order_relaxed);
+                });
+            }
+            wrapper.setSampleFormat(variant.format);
+            wrapper.prepareStream(packet);
+            wrapper.setCallbackMode(variant.mode);
+
+            std::vector<short> xi = testComponent(packet, 1), xq = testComponent(packet, 2);
+            sdrplay_api_StreamCbParamsT params = {};
+            params.numSamples = static_cast<unsigned int>(packet);
+            unsigned int reset = 1;
+            suite.measure(Row("callback_dispatch", variant.name, packet, 262144), [&]() {
+                CallbackWrapper::streamCallback(xi.data(), xq.data(), &params, params.numSamples,
+                                                reset, wrapper.getContext());
+                params.firstSampleNum += params.numSamples;
+                reset = 0;
+                wrapper.consumeSamples(packet);
+            });
+            wrapper.setCallbackMode(CallbackMode::Inline);
+        }
+    }
+}
+
+void benchConvert(Suite& suite) {
+    if (!suite.enabled("format_convert")) {
+        return;
+    }
+    for (SimdLevel level : SIMD_LEVELS) {
+        if (!isSimdLevelSupported(level)) {
+            continue;
+        }
+        for (size_t packet : PACKET_SIZES) {
+            std::vector<std::complex<short>> src(packet);
+            std::vector<short> xi = testComponent(packet, 1), xq = testComponent(packet, 2);
+            interleaveIQ(xi.data(), xq.data(), src.data(), packet);
+            std::vector<std::complex<float>> cf32(packet);
+            std::vector<int8_t> cs8(2 * packet);
+            std::vector<uint8_t> cu8(2 * packet);
+            std::string name = simdLevelName(level);
+
+            suite.measure(Row("format_convert", "cf32 " + name, packet, 0), [&]() {
+                convertToCF32(level, src.data(), cf32.data(), packet);
+            });
+            suite.measure(Row("format_convert", "cs8 " + name, packet, 0), [&]() {
+                convertToCS8(level, src.data(), cs8.data(), packet);
+            });
+            suite.measure(Row("format_convert", "cu8 " + name, packet, 0), [&]() {
+                convertToCU8(level, src.data(), cu8.data(), packet);
+            });
+        }
+    }
+}
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Time from a packet being written to waitForSamples() returning in another thread
+void benchWakeup(Suite& suite) {
+    if (!suite.enabled("wait_wakeup")) {
+        return;
+    }
+    struct Variant {
+        WaitStrategy strategy;
+        unsigned int spinUs;
+    };
+    const Variant variants[] = {
+        {WaitStrategy::Block, 0},
+        {WaitStrategy::SpinThenBlock, 50},
+        {WaitStrategy::BusyPoll, 0},
+    };
+    const size_t packets = suite.quick() ? 200 : 2000;
+    const auto interval = std::chrono::microseconds(250);
+
+    for (const Variant& variant : variants) {
+        for (size_t packet : {size_t(1008), size_t(16384)}) {
+            SampleBuffer buffer(65536);
+            buffer.setWaitStrategy(variant.strategy, variant.spinUs);
+            std::atomic<uint64_t> writeNs(0);
+            std::atomic<bool> done(false);
+
+            std::thread producer([&]() {
+                std::vector<std::complex<short>> in(packet, std::complex<short>(1, -1));
+                auto next = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < packets; ++i) {
+                    next += interval;
+                    std::this_thread::sleep_until(next);
+                    writeNs.store(nowNs(), std::memory_order_relaxed);
+                    buffer.write(in.data(), in.size());
+                }
+                done = true;
+            });
+
+            LatencyHistogram histogram;
+            std::vector<std::complex<short>> out(packet);
+            size_t received = 0;
+            while (received < packets) {
+                if (!buffer.waitForSamples(packet, 100)) {
+                    if (done) {
+                        break;
+                    }
+                    continue;
+                }
+                histogram.record(nowNs() - writeNs.load(std::memory_order_relaxed));
+                buffer.read(out.data(), out.size());
+                ++received;
+            }
+            producer.join();
+
+            std::string name = waitStrategyName(variant.strategy);
+            if (variant.strategy == WaitStrategy::SpinThenBlock) {
+                name += " " + std::to_string(variant.spinUs) + "us";
+            }
+            Row row("wait_wakeup", name, packet, 65536);
+            row.packets = histogram.count();
+            row.p50Ns = static_cast<double>(histogram.percentile(50.0));
+            row.p99Ns = static_cast<double>(histogram.percentile(99.0));
+            row.p999Ns = static_cast<double>(histogram.percentile(99.9));
+            suite.add(row);
+        }
+    }
+}
+
+std::string timestamp() {
+    std::time_t now = std::time(nullptr);
+    char text[32];
+    std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return text;
+}
+
+std::string compilerName() {
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+std::string jsonNumber(double value) {
+    if (value < 0) {
+        return "null";
+    }
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2) << value;
+    return text.str();
+}
+
+void writeJson(std::ostream& out, const std::vector<Row>& rows, const Options& options) {
+#if defined(NDEBUG)
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+    out << "{\n"
+        << "  \"timestamp\": \"" << timestamp() << "\",\n"
+        << "  \"compiler\": \"" << compilerName() << "\",\n"
+        << "  \"build\": \"" << build << "\",\n"
+        << "  \"simd\": \"" << simdLevelName(detectSimdLevel()) << "\",\n"
+        << "  \"quick\": " << (options.quick ? "true" : "false") << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Row& row = rows[i];
+        out << "    {\"bench\": \"" << row.bench << "\", \"variant\": \"" << row.variant
+            << "\", \"packet\": " << row.packet << ", \"capacity\": " << row.capacity
+            << ", \"packets\": " << row.packets
+            << ", \"ns_per_packet\": " << jsonNumber(row.nsPerPacket)
+            << ", \"msps\": " << jsonNumber(row.msps)
+            << ", \"p50_ns\": " << jsonNumber(row.p50Ns)
+            << ", \"p99_ns\": " << jsonNumber(row.p99Ns)
+            << ", \"p999_ns\": " << jsonNumber(row.p999Ns) << "}"
+            << (i + 1 < rows.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void writeCsv(std::ostream& out, const std::vector<Row>& rows) {
+    out << "bench,variant,packet,capacity,packets,ns_per_packet,msps,p50_ns,p99_ns,p999_ns\n";
+    for (const Row& row : rows) {
+        out << row.bench << "," << row.variant << "," << row.packet << "," << row.capacity << ","
+            << row.packets << std::fixed << std::setprecision(2);
+        for (double value : {row.nsPerPacket, row.msps, row.p50Ns, row.p99Ns, row.p999Ns}) {
+            out << ",";
+            if (value >= 0) {
+                out << value;
+            }
+        }
+        out << "\n";
+    }
+}
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--format table|json|csv] [--output FILE] [--filter NAME] [--quick]" << std::endl
+              << "Benchmarks: buffer_write_read, interleave, stream_callback, callback_dispatch,"
+              << " format_convert, wait_wakeup" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            options.format = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.format != "table" && options.format != "json" && options.format != "csv") {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (options.format == "table") {
+        std::cout << "Kernels: " << simdLevelName(detectSimdLevel()) << std::endl << std::endl;
+        Suite::printHeader(std::cout);
+    }
+
+    Suite suite(options);
+    benchBuffer(suite);
+    benchInterleave(suite);
+    benchStreamCallback(suite);
+    benchCallbackDispatch(suite);
+    benchConvert(suite);
+    benchWakeup(suite);
+
+    if (options.format == "table") {
+        return 0;
+    }
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) {
+            std::cerr << "Cannot write " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+    if (options.format == "json") {
+        writeJson(out, suite.results(), options);
+    } else {
+        writeCsv(out, suite.results());
+    }
+    return 0;
+}
@@ -0,0 +1,473 @@
+// End-to-end throughput and latency from the API callback to a consumer.
+//
+// Drives Device through the simulated API at a sweep of sample rates. A
+// consumer thread waits for each packet and reads it; the latency of a
+// packet is the time from its stream tag's arrival stamp to readSamples()
+// returning the packet's last sample. Each rate reports latency
+// percentiles, the CPU the wrapper spends per MSPS (stream callbacks plus
+// the consumer, excluding the simulator and any simulated DSP load) and
+// whether samples were dropped. A final unpaced run streams as fast as the
+// simulator can to show the ceiling.
+//
+// Gate options make the exit status non-zero when a limit is missed, so a
+// release pipeline can run:
+//
+//   sdrplay_e2e_bench --format json --output e2e.json
+//                     --max-p99-us 500 --min-sustained-msps 10
+#include "sdrplay_simulator.h"
+#include "sdrplay_wrapper.h"
+#include "device_registry.h"
+#include "device_impl/rsp1a_control.h"
+#include "latency_histogram.h"
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <time.h>
+#endif
+
+using namespace sdrplay;
+
+namespace {
+
+// Highest rate the simulated device accepts
+const double MAX_RATE_MSPS = 10.66;
+
+struct Options {
+    std::vector<double> ratesMsps{2.0, 4.0, 6.0, 8.0, 10.0, MAX_RATE_MSPS};
+    double seconds{2.0};
+    bool unpaced{true};
+    size_t bufferSize{262144};
+    unsigned int packetSamples{1008};
+    WaitStrategy waitStrategy{WaitStrategy::Block};
+    double dspNsPerSample{0.0};
+    std::string format{"table"};
+    std::string output;
+
+    // Gates; negative = not checked
+    double maxP99Us{-1.0};
+    double maxP999Us{-1.0};
+    double minSustainedMsps{-1.0};
+};
+
+// Results of streaming at one rate
+struct RunResult {
+    std::string mode;         // "paced" or "unpaced"
+    double requestedMsps;     // Rate asked of the device; 0 for unpaced
+    double deliveredMsps;     // Samples produced by the simulator per second
+    double consumedMsps;      // Samples read by the consumer per second
+    uint64_t packets;         // Packets whose latency was recorded
+    double p50Us;
+    double p99Us;
+    double p999Us;
+    double maxUs;
+    double cpuPercent;        // Wrapper CPU as a percentage of one core
+    double cpuPercentPerMsps;
+    uint64_t droppedSamples;  // Samples the buffer dropped on overflow
+    uint64_t latePackets;     // Packets the simulator sent behind schedule
+
+    RunResult() : requestedMsps(0.0), deliveredMsps(0.0), consumedMsps(0.0), packets(0),
+                  p50Us(0.0), p99Us(0.0), p999Us(0.0), maxUs(0.0), cpuPercent(0.0),
+                  cpuPercentPerMsps(0.0), droppedSamples(0), latePackets(0) {}
+
+    bool overflowed() const { return droppedSamples > 0; }
+};
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// CPU time of the calling thread, or -1 where unavailable
+double threadCpuSeconds() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+    return -1.0;
+#endif
+}
+
+// Stand-in for per-sample processing in the consumer
+void simulateDsp(size_t samples, double nsPerSample) {
+    if (nsPerSample <= 0.0) {
+        return;
+    }
+    uint64_t until = nowNs() + static_cast<uint64_t>(samples * nsPerSample);
+    while (nowNs() < until) {
+    }
+}
+
+RunResult runRate(Device& device, const Options& options, double rateMsps, bool realTime) {
+    SimulatorConfig config = Simulator::getConfig();
+    config.realTime = realTime;
+    config.packetSamples = options.packetSamples;
+    Simulator::configure(config);
+    device.setSampleRate(rateMsps * 1e6);
+
+    StreamingParams params;
+    params.bufferSize = options.bufferSize;
+    params.waitStrategy = options.waitStrategy;
+    if (!device.startStreaming(params)) {
+        throw std::runtime_error("failed to start streaming at " + std::to_string(rateMsps) + " MSPS");
+    }
+
+    std::vector<std::complex<short>> samples(options.bufferSize);
+    LatencyHistogram histogram;
+    uint64_t consumed = 0;
+    double dspSeconds = 0.0;
+    const double cpuStart = threadCpuSeconds();
+    const uint64_t wallStart = nowNs();
+    const uint64_t wallEnd = wallStart + static_cast<uint64_t>(options.seconds * 1e9);
+
+    while (nowNs() < wallEnd) {
+        if (!device.waitForSamples(options.packetSamples, 10)) {
+            continue;
+        }
+        uint64_t start = device.getReadIndex();
+        size_t count = device.readSamples(samples.data(), samples.size());
+        uint64_t returnNs = nowNs();
+        uint64_t end = start + count;
+        for (const StreamTag& tag : device.getStreamTags(start, count)) {
+            if (tag.sampleIndex + tag.numSamples <= end && returnNs > tag.timestampNs) {
+                histogram.record(returnNs - tag.timestampNs);
+            }
+        }
+        consumed += count;
+
+        uint64_t dspStart = nowNs();
+        simulateDsp(count, options.dspNsPerSample);
+        dspSeconds += (nowNs() - dspStart) / 1e9;
+    }
+
+    const double wallSeconds = (nowNs() - wallStart) / 1e9;
+    const double consumerCpu = threadCpuSeconds() - cpuStart - dspSeconds;
+    SimulatorStats stats = Simulator::getStats();
+    device.stopStreaming();
+
+    RunResult result;
+    result.mode = realTime ? "paced" : "unpaced";
+    result.requestedMsps = realTime ? rateMsps : 0.0;
+    result.deliveredMsps = stats.samples / wallSeconds / 1e6;
+    result.consumedMsps = consumed / wallSeconds / 1e6;
+    result.packets = histogram.count();
+    result.p50Us = histogram.percentile(50.0) / 1e3;
+    result.p99Us = histogram.percentile(99.0) / 1e3;
+    result.p999Us = histogram.percentile(99.9) / 1e3;
+    result.maxUs = histogram.max() / 1e3;
+    result.cpuPercent = (stats.totalCallbackNs / 1e9 + std::max(consumerCpu, 0.0)) / wallSeconds * 100.0;
+    result.cpuPercentPerMsps = result.deliveredMsps > 0.0 ? result.cpuPercent / result.deliveredMsps : 0.0;
+    // startStreaming() reallocates the buffer, which clears its counters
+    result.droppedSamples = device.getDroppedSampleCount();
+    result.latePackets = stats.latePackets;
+    return result;
+}
+
+// Highest paced rate at or below which no run dropped samples
+double sustainedMsps(const std::vector<RunResult>& results) {
+    double sustained = 0.0;
+    for (const RunResult& result : results) {
+        if (result.mode != "paced") {
+            continue;
+        }
+        if (result.overflowed()) {
+            break;
+        }
+        sustained = result.requestedMsps;
+    }
+    return sustained;
+}
+
+// Lowest paced rate that dropped samples, or -1 if none did
+double overflowOnsetMsps(const std::vector<RunResult>& results) {
+    for (const RunResult& result : results) {
+        if (result.mode == "paced" && result.overflowed()) {
+            return result.requestedMsps;
+        }
+    }
+    return -1.0;
+}
+
+std::vector<std::string> checkGates(const std::vector<RunResult>& results, const Options& options) {
+    std::vector<std::string> failures;
+    for (const RunResult& result : results) {
+        if (result.mode != "paced") {
+            continue;
+        }
+        std::ostringstream failure;
+        failure << std::fixed << std::setprecision(2);
+        if (options.maxP99Us >= 0 && result.p99Us > options.maxP99Us) {
+            failure << "p99 " << result.p99Us << " us at " << result.requestedMsps << " MSPS";
+            failures.push_back(failure.str());
+            failure.str("");
+        }
+        if (options.maxP999Us >= 0 && result.p999Us > options.maxP999Us) {
+            failure << "p99.9 " << result.p999Us << " us at " << result.requestedMsps << " MSPS";
+            failures.push_back(failure.str());
+        }
+    }
+    if (options.minSustainedMsps >= 0 && sustainedMsps(results) < options.minSustainedMsps) {
+        std::ostringstream failure;
+        failure << "sustained rate " << sustainedMsps(results) << " MSPS";
+        failures.push_back(failure.str());
+    }
+    return failures;
+}
+
+void printTable(std::ostream& out, const std::vector<RunResult>& results) {
+    out << std::left << std::setw(9) << "mode" << std::right << std::setw(9) << "MSPS"
+        << std::setw(11) << "delivered" << std::setw(10) << "consumed" << std::setw(10) << "p50 us"
+        << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us" << std::setw(10) << "max us"
+        << std::setw(8) << "CPU %" << std::setw(11) << "%/MSPS" << std::setw(12) << "dropped"
+        << std::endl;
+    for (const RunResult& result : results) {
+        out << std::left << std::setw(9) << result.mode << std::right << std::fixed << std::setprecision(2)
+            << std::setw(9);
+        if (result.mode == "paced") {
+            out << result.requestedMsps;
+        } else {
+            out << "-";
+        }
+        out << std::setw(11) << result.deliveredMsps << std::setw(10) << result.consumedMsps
+            << std::setprecision(1) << std::setw(10) << result.p50Us << std::setw(10) << result.p99Us
+            << std::setw(10) << result.p999Us << std::setw(10) << result.maxUs
+            << std::setw(8) << result.cpuPercent << std::setprecision(2) << std::setw(11)
+            << result.cpuPercentPerMsps << std::setw(12) << result.droppedSamples << std::endl;
+    }
+
+    double onset = overflowOnsetMsps(results);
+    out << std::endl << "Sustained without drops: " << sustainedMsps(results) << " MSPS" << std::endl;
+    out << "Overflow onset: ";
+    if (onset < 0) {
+        out << "none in sweep" << std::endl;
+    } else {
+        out << onset << " MSPS" << std::endl;
+    }
+}
+
+std::string timestamp() {
+    std::time_t now = std::time(nullptr);
+    char text[32];
+    std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return text;
+}
+
+void writeJson(std::ostream& out, const std::vector<RunResult>& results, const Options& options,
+               const std::vector<std::string>& failures) {
+    double onset = overflowOnsetMsps(results);
+    out << std::fixed << std::setprecision(2)
+        << "{\n"
+        << "  \"timestamp\": \"" << timestamp() << "\",\n"
+        << "  \"seconds_per_rate\": " << options.seconds << ",\n"
+        << "  \"buffer_size\": " << options.bufferSize << ",\n"
+        << "  \"packet_samples\": " << options.packetSamples << ",\n"
+        << "  \"wait_strategy\": \"" << waitStrategyName(options.waitStrategy) << "\",\n"
+        << "  \"dsp_ns_per_sample\": " << options.dspNsPerSample << ",\n"
+        << "  \"sustained_msps\": " << sustainedMsps(results) << ",\n"
+        << "  \"overflow_onset_msps\": ";
+    if (onset < 0) {
+        out << "null";
+    } else {
+        out << onset;
+    }
+    out << ",\n  \"gates_passed\": " << (failures.empty() ? "true" : "false") << ",\n"
+        << "  \"gate_failures\": [";
+    for (size_t i = 0; i < failures.size(); ++i) {
+        out << (i ? ", " : "") << "\"" << failures[i] << "\"";
+    }
+    out << "],\n  \"runs\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const RunResult& result = results[i];
+        out << "    {\"mode\": \"" << result.mode << "\", \"requested_msps\": " << result.requestedMsps
+            << ", \"delivered_msps\": " << result.deliveredMsps
+            << ", \"consumed_msps\": " << result.consumedMsps << ", \"packets\": " << result.packets
+            << ", \"p50_us\": " << result.p50Us << ", \"p99_us\": " << result.p99Us
+            << ", \"p999_us\": " << result.p999Us << ", \"max_us\": " << result.maxUs
+            << ", \"cpu_percent\": " << result.cpuPercent
+            << ", \"cpu_percent_per_msps\": " << result.cpuPercentPerMsps
+            << ", \"dropped_samples\": " << result.droppedSamples
+            << ", \"late_packets\": " << result.latePackets << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void writeCsv(std::ostream& out, const std::vector<RunResult>& results) {
+    out << "mode,requested_msps,delivered_msps,consumed_msps,packets,p50_us,p99_us,p999_us,max_us,"
+           "cpu_percent,cpu_percent_per_msps,dropped_samples,late_packets\n";
+    out << std::fixed << std::setprecision(2);
+    for (const RunResult& result : results) {
+        out << result.mode << "," << result.requestedMsps << "," << result.deliveredMsps << ","
+            << result.consumedMsps << "," << result.packets << "," << result.p50Us << ","
+            << result.p99Us << "," << result.p999Us << "," << result.maxUs << ","
+            << result.cpuPercent << "," << result.cpuPercentPerMsps << ","
+            << result.droppedSamples << "," << result.latePackets << "\n";
+    }
+}
+
+std::vector<double> parseRates(const std::string& text) {
+    std::vector<double> rates;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        double rate = std::atof(item.c_str());
+        if (rate <= 0.0 || rate > MAX_RATE_MSPS) {
+            std::ostringstream message;
+            message << "rate out of range (0, " << MAX_RATE_MSPS << "] MSPS: " << item;
+            throw std::invalid_argument(message.str());
+        }
+        rates.push_back(rate);
+    }
+    std::sort(rates.begin(), rates.end());
+    return rates;
+}
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --rates LIST              Paced rates in MSPS, comma separated (default 2,4,6,8,10,10.66)\n"
+              << "  --seconds S               Streaming time per rate (default 2)\n"
+              << "  --no-unpaced              Skip the run at the simulator's maximum speed\n"
+              << "  --buffer N                Sample buffer size (default 262144)\n"
+              << "  --packet N                Samples per simulated packet (default 1008)\n"
+              << "  --wait block|spin|poll    Consumer wait strategy (default block)\n"
+              << "  --dsp-ns-per-sample X     Simulated consumer processing cost\n"
+              << "  --format table|json|csv   Output format (default table)\n"
+              << "  --output FILE             Write json/csv output to FILE\n"
+              << "  --max-p99-us X            Fail if any paced rate's p99 latency exceeds X\n"
+              << "  --max-p999-us X           Fail if any paced rate's p99.9 latency exceeds X\n"
+              << "  --min-sustained-msps X    Fail if samples drop at or below X MSPS\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--no-unpaced") {
+            options.unpaced = false;
+        } else if (!hasValue) {
+            return false;
+        } else if (arg == "--rates") {
+            options.ratesMsps = parseRates(argv[++i]);
+        } else if (arg == "--seconds") {
+            options.seconds = std::atof(argv[++i]);
+        } else if (arg == "--buffer") {
+            options.bufferSize = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--packet") {
+            options.packetSamples = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--wait") {
+            std::string wait = argv[++i];
+            if (wait == "block") {
+                options.waitStrategy = WaitStrategy::Block;
+            } else if (wait == "spin") {
+                options.waitStrategy = WaitStrategy::SpinThenBlock;
+            } else if (wait == "poll") {
+                options.waitStrategy = WaitStrategy::BusyPoll;
+            } else {
+                return false;
+            }
+        } else if (arg == "--dsp-ns-per-sample") {
+            options.dspNsPerSample = std::atof(argv[++i]);
+        } else if (arg == "--format") {
+            options.format = argv[++i];
+        } else if (arg == "--output") {
+            options.output = argv[++i];
+        } else if (arg == "--max-p99-us") {
+            options.maxP99Us = std::atof(argv[++i]);
+        } else if (arg == "--max-p999-us") {
+            options.maxP999Us = std::atof(argv[++i]);
+        } else if (arg == "--min-sustained-msps") {
+            options.minSustainedMsps = std::atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return (options.format == "table" || options.format == "json" || options.format == "csv") &&
+           options.seconds > 0.0 && options.bufferSize > 0 && options.packetSamples > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            usage(argv[0]);
+            return 2;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    DeviceRegistry::registerFactory(RSP1A_HWVER, []() { return std::make_unique<RSP1AControl>(); });
+    SimulatorConfig config;
+    config.hwVer = RSP1A_HWVER;
+    Simulator::configure(config);
+
+    // The device layer logs to stdout; keep machine-readable output clean
+    std::streambuf* stdoutBuffer = std::cout.rdbuf();
+    if (options.format != "table") {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    std::vector<RunResult> results;
+    try {
+        Device device;
+        std::vector<DeviceInfo> devices = device.getAvailableDevices();
+        if (devices.empty() || !device.selectDevice(devices[0])) {
+            throw std::runtime_error("no simulated device available");
+        }
+        device.setFrequency(100e6);
+
+        for (double rate : options.ratesMsps) {
+            results.push_back(runRate(device, options, rate, true));
+        }
+        if (options.unpaced) {
+            results.push_back(runRate(device, options, MAX_RATE_MSPS, false));
+        }
+        device.releaseDevice();
+    } catch (const std::exception& e) {
+        std::cout.rdbuf(stdoutBuffer);
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout.rdbuf(stdoutBuffer);
+
+    std::vector<std::string> failures = checkGates(results, options);
+    if (options.format == "table") {
+        printTable(std::cout, results);
+    } else {
+        std::ofstream file;
+        if (!options.output.empty()) {
+            file.open(options.output);
+            if (!file) {
+                std::cerr << "Cannot write " << options.output << std::endl;
+                return 1;
+            }
+        }
+        std::ostream& out = options.output.empty() ? std::cout : file;
+        if (options.format == "json") {
+            writeJson(out, results, options, failures);
+        } else {
+            writeCsv(out, results);
+        }
+    }
+
+    for (const std::string& failure : failures) {
+        std::cerr << "GATE FAILED: " << failure << std::endl;
+    }
+    return failures.empty() ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+#pragma once
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "ring_allocator.h"
+#include "ring_storage.h"
+
+namespace sdrplay {
+
+class BlockPool;
+
+/**
+ * @brief Fixed-capacity block of IQ samples owned by a BlockPool
+ *
+ * Blocks are filled through the SampleBlockWriter that BlockPool::acquire()
+ * returns, and are read-only once published.
+ */
+class SampleBlock {
+public:
+    const std::complex<short>* data() const { return samples; }
+    std::complex<short>* data() { return samples; }
+
+    /**
+     * @brief Get the number of valid samples
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Get the most samples the block can hold
+     */
+    size_t capacity() const { return blockCapacity; }
+
+    /**
+     * @brief Set the number of valid samples
+     *
+     * @param n Sample count, clamped to capacity()
+     */
+    void resize(size_t n) { count = n < blockCapacity ? n : blockCapacity; }
+
+    uint64_t sequence{0};        // Block number in the stream; gaps mean dropped blocks
+    uint32_t firstSampleNum{0};  // API sample number of the first sample
+    uint64_t timestampNs{0};     // Host arrival time of the packet (steady clock)
+
+private:
+    friend class BlockPool;
+    friend class SampleBlockRef;
+    friend class SampleBlockWriter;
+
+    std::atomic<uint32_t> refs{0};
+    std::atomic<uint32_t> next{0};     // Free-list link
+    BlockPool* pool{nullptr};
+    std::shared_ptr<BlockPool> owner;  // Keeps the pool alive while the block is out
+    std::complex<short>* samples{nullptr};
+    size_t blockCapacity{0};
+    size_t count{0};
+};
+
+/**
+ * @brief Shared handle to a pooled SampleBlock
+ *
+ * Copying a handle bumps the block's intrusive reference count; no memory
+ * is allocated. The block returns to its pool when the last handle goes
+ * away, from whichever thread that happens on.
+ */
+class SampleBlockRef {
+public:
+    SampleBlockRef() noexcept : block(nullptr) {}
+    SampleBlockRef(const SampleBlockRef& other) noexcept;
+    SampleBlockRef(SampleBlockRef&& other) noexcept : block(other.block) { other.block = nullptr; }
+    SampleBlockRef& operator=(const SampleBlockRef& other) noexcept;
+    SampleBlockRef& operator=(SampleBlockRef&& other) noexcept;
+    ~SampleBlockRef() { reset(); }
+
+    /**
+     * @brief Drop this handle's reference
+     */
+    void reset() noexcept;
+
+    explicit operator bool() const { return block != nullptr; }
+    const SampleBlock& operator*() const { return *block; }
+    const SampleBlock* operator->() const { return block; }
+
+    /**
+     * @brief Get the number of handles sharing the block
+     */
+    uint32_t useCount() const;
+
+private:
+    friend class BlockPool;
+    friend class SampleBlockWriter;
+    explicit SampleBlockRef(SampleBlock* adopted) noexcept : block(adopted) {}
+
+    SampleBlock* block;
+};
+
+/**
+ * @brief Sole, writable handle to a block fresh from BlockPool::acquire()
+ *
+ * The producer fills the block through this handle and then publishes it
+ * as a read-only SampleBlockRef. Writers cannot be copied and a published
+ * block cannot be written again, so consumers never see a block change.
+ */
+class SampleBlockWriter {
+public:
+    SampleBlockWriter() noexcept = default;
+    SampleBlockWriter(SampleBlockWriter&&) noexcept = default;
+    SampleBlockWriter& operator=(SampleBlockWriter&&) noexcept = default;
+    SampleBlockWriter(const SampleBlockWriter&) = delete;
+    SampleBlockWriter& operator=(const SampleBlockWriter&) = delete;
+
+    explicit operator bool() const { return static_cast<bool>(ref); }
+    SampleBlock& operator*() const { return *ref.block; }
+    SampleBlock* operator->() const { return ref.block; }
+
+    /**
+     * @brief Hand the filled block over for sharing
+     *
+     * Leaves this writer empty.
+     *
+     * @return SampleBlockRef Read-only handle to the block
+     */
+    SampleBlockRef publish() { return std::move(ref); }
+
+private:
+    friend class BlockPool;
+    explicit SampleBlockWriter(SampleBlock* adopted) noexcept : ref(adopted) {}
+
+    SampleBlockRef ref;
+};
+
+/**
+ * @brief Usage counters of a BlockPool
+ */
+struct BlockPoolStats {
+    size_t blockCount;        // Blocks in the pool
+    size_t blockSamples;      // Capacity of each block
+    size_t freeBlocks;        // Blocks not held by anyone right now
+    size_t minFreeBlocks;     // Fewest free blocks seen; 0 means the pool ran dry
+    uint64_t acquiredBlocks;  // Successful acquire() calls
+    uint64_t exhaustedCount;  // acquire() calls that found no free block
+    uint64_t droppedSamples;  // Samples not published because the pool was empty
+
+    BlockPoolStats() : blockCount(0), blockSamples(0), freeBlocks(0), minFreeBlocks(0),
+                       acquiredBlocks(0), exhaustedCount(0), droppedSamples(0) {}
+};
+
+/**
+ * @brief Fixed set of sample blocks recycled through a lock-free free-list
+ *
+ * All block memory is allocated up front, so once the pool exists,
+ * acquiring, sharing and releasing blocks never allocates. The free-list is
+ * a Treiber stack whose head carries a version tag against ABA, so any
+ * thread may release while the producer acquires.
+ *
+ * Pools are always owned by a std::shared_ptr (see create()); outstanding
+ * blocks keep their pool alive.
+ */
+class BlockPool : public std::enable_shared_from_this<BlockPool> {
+    struct Key {};
+
+public:
+    /**
+     * @brief Create a pool
+     *
+     * @param blockCount Number of blocks
+     * @param blockSamples Capacity of each block in samples
+     * @param allocator Memory for the sample storage (nullptr = heap)
+     * @return std::shared_ptr<BlockPool> The pool
+     */
+    static std::shared_ptr<BlockPool> create(size_t blockCount, size_t blockSamples,
+                                             std::shared_ptr<RingAllocator> allocator = nullptr);
+
+    BlockPool(Key, size_t blockCount, size_t blockSamples, std::shared_ptr<RingAllocator> allocator);
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    /**
+     * @brief Take a free block
+     *
+     * @return SampleBlockWriter Writable handle to an empty block, or an empty handle if none is free
+     */
+    SampleBlockWriter acquire();
+
+    /**
+     * @brief Get the number of blocks in the pool
+     */
+    size_t blockCount() const { return count; }
+
+    /**
+     * @brief Get the capacity of each block in samples
+     */
+    size_t blockSamples() const { return samplesPerBlock; }
+
+    /**
+     * @brief Get the number of free blocks
+     */
+    size_t freeBlocks() const { return freeCount.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get usage counters
+     *
+     * @return BlockPoolStats Counters; droppedSamples is left to the producer
+     */
+    BlockPoolStats getStats() const;
+
+    /**
+     * @brief Lock the sample storage into RAM, or unlock it
+     *
+     * @param lock true to lock, false to unlock
+     * @return true on success; on failure errno describes the reason
+     */
+    bool lockMemory(bool lock = true);
+
+    /**
+     * @brief Populate the sample storage pages without changing their contents
+     *
+     * @return true on success; on failure errno describes the reason
+     */
+    bool prefaultMemory();
+
+private:
+    friend class SampleBlockRef;
+
+    static constexpr uint32_t NO_BLOCK = UINT32_MAX;
+
+    /**
+     * @brief Return a block whose last reference was dropped
+     */
+    void release(SampleBlock* block);
+
+    void push(uint32_t index);
+    SampleBlock* pop();
+
+    size_t count;
+    size_t samplesPerBlock;
+    RingStorage storage;
+    std::unique_ptr<SampleBlock[]> blocks;
+
+    alignas(64) std::atomic<uint64_t> freeHead;  // Version tag << 32 | block index
+    std::atomic<size_t> freeCount;
+    std::atomic<size_t> minFree;
+    std::atomic<uint64_t> acquired;
+    std::atomic<uint64_t> exhausted;
+};
+
+} // namespace sdrplay
@@ -0,0 +1,258 @@
+#pragma once
+#include <atomic>
+#include <complex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "ring_storage.h"
+#include "sample_buffer.h"
+
+namespace sdrplay {
+
+/**
+ * @brief What a broadcast reader does when the producer laps it
+ *
+ * The producer never waits for broadcast readers, so there is no blocking
+ * policy: a reader that falls a full buffer behind always loses samples.
+ */
+enum class ReaderOverflowPolicy {
+    DropOldest,     // Skip to the oldest sample still buffered (keep as much history as possible)
+    SkipToNewest    // Skip to the newest sample (lowest latency, e.g. for displays)
+};
+
+class BroadcastReader;
+
+/**
+ * @brief Single-producer ring shared by any number of readers
+ *
+ * Every sample is written once and each registered reader consumes it
+ * through its own cursor. The producer never looks at the readers, so a
+ * slow reader cannot stall the producer or any other reader; it is lapped
+ * instead and handles that according to its own ReaderOverflowPolicy.
+ *
+ * Readers detect being overwritten mid-read with a sequence check on the
+ * producer's claimed write position, in the same way as a seqlock.
+ *
+ * The storage is only allocated when the first reader registers, so a
+ * stream nobody fans out from costs no second ring.
+ */
+class BroadcastBuffer : public std::enable_shared_from_this<BroadcastBuffer> {
+public:
+    /**
+     * @brief Construct a broadcast buffer
+     *
+     * Nothing is allocated until the first reader registers.
+     *
+     * @param size Buffer capacity in samples (rounded up to a power of two)
+     * @param layout Storage layout; Mirrored makes every peek a single span
+     * @param allocator Memory for standard layout (nullptr = heap)
+     */
+    explicit BroadcastBuffer(size_t size, RingLayout layout = RingLayout::Standard,
+                             std::shared_ptr<RingAllocator> allocator = nullptr);
+
+    BroadcastBuffer(const BroadcastBuffer&) = delete;
+    BroadcastBuffer& operator=(const BroadcastBuffer&) = delete;
+
+    /**
+     * @brief Register a new reader
+     *
+     * The reader starts at the current write position, so it only sees
+     * samples written after it was added. It stays registered until the
+     * last reference to it is released. The first reader allocates the
+     * storage; must not be called while the producer is writing unless
+     * a reader already exists.
+     *
+     * @param policy What the reader does when it is lapped
+     * @return std::shared_ptr<BroadcastReader> Reader handle
+     */
+    std::shared_ptr<BroadcastReader> addReader(
+        ReaderOverflowPolicy policy = ReaderOverflowPolicy::DropOldest);
+
+    /**
+     * @brief Write samples for all readers
+     *
+     * Must only be called from the producer thread. Never blocks; packets
+     * larger than the capacity keep only their newest samples.
+     *
+     * @param data Pointer to samples
+     * @param count Number of samples
+     */
+    void write(const std::complex<short>* data, size_t count);
+
+    /**
+     * @brief Change the capacity and memory of the buffer
+     *
+     * Frees the storage; the next reader to register allocates it with the
+     * new settings. Refused while any reader is registered, since readers
+     * may be copying out of the current storage. Must not be called while
+     * the producer is writing.
+     *
+     * @param size Buffer capacity in samples
+     * @param layout Storage layout
+     * @param allocator Memory for standard layout (nullptr = heap)
+     * @return true if applied, false if readers kept the current storage
+     */
+    bool reconfigure(size_t size, RingLayout layout = RingLayout::Standard,
+                     std::shared_ptr<RingAllocator> allocator = nullptr);
+
+    /**
+     * @brief Get the number of registered readers
+     */
+    size_t readerCount() const;
+
+    /**
+     * @brief Get the stream index of the next sample to be written
+     */
+    uint64_t writeIndex() const;
+
+    /**
+     * @brief Get the buffer capacity in samples
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Lock the storage into RAM, or unlock it
+     *
+     * Storage allocated later by the first reader is locked as it is
+     * allocated. Reallocating the storage drops the lock.
+     *
+     * @param lock true to lock, false to unlock
+     * @return true on success; on failure errno describes the reason
+     */
+    bool lockMemory(bool lock = true);
+
+    /**
+     * @brief Populate the storage pages without changing their contents
+     *
+     * Does nothing while no storage is allocated.
+     *
+     * @return true on success; on failure errno describes the reason
+     */
+    bool prefaultMemory();
+
+private:
+    friend class BroadcastReader;
+
+    std::complex<short>* samples() const;
+    void copyIn(uint64_t pos, const std::complex<short>* src, size_t count);
+    void copyOut(uint64_t pos, std::complex<short>* dest, size_t count) const;
+    SampleSpans spansAt(uint64_t pos, size_t count) const;
+    uint64_t oldestValid(uint64_t end) const;
+    void notifyWaiters();
+
+    // Allocated by the first reader; only replaced while there are none
+    mutable std::mutex storageMutex;
+    std::unique_ptr<RingStorage> storage;
+    RingLayout storageLayout;
+    std::shared_ptr<RingAllocator> storageAllocator;
+    bool lockRequested;
+    size_t bufferSize;
+    size_t mask;
+
+    alignas(64) std::atomic<uint64_t> tail;   // Published write position
+    std::atomic<uint64_t> claim;              // Write position including the copy in progress
+    std::atomic<uint64_t> start;              // First position backed by the current storage
+
+    alignas(64) std::atomic<size_t> readers;
+    std::atomic<int> waiters;
+    std::mutex waitMutex;
+    std::condition_variable dataAvailable;
+};
+
+/**
+ * @brief One reader's cursor into a BroadcastBuffer
+ *
+ * Each reader must only be used from one thread at a time. Different
+ * readers can be used from different threads concurrently.
+ */
+class BroadcastReader {
+public:
+    ~BroadcastReader();
+
+    BroadcastReader(const BroadcastReader&) = delete;
+    BroadcastReader& operator=(const BroadcastReader&) = delete;
+
+    /**
+     * @brief Copy samples out and advance the cursor
+     *
+     * @param dest Destination buffer
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Number of samples read
+     */
+    size_t read(std::complex<short>* dest, size_t maxCount);
+
+    /**
+     * @brief Access buffered samples in place without copying
+     *
+     * The producer does not wait for the reader, so the spans can be
+     * overwritten if the reader holds them for close to a full buffer's
+     * worth of time; consume() reports when that happened.
+     *
+     * @param maxCount Maximum number of samples to expose
+     * @return SampleSpans Up to two spans into the buffer, valid until consume()
+     */
+    SampleSpans peek(size_t maxCount);
+
+    /**
+     * @brief Release samples returned by peek()
+     *
+     * @param count Number of samples to release
+     * @return size_t Number of samples released, or 0 if the peeked samples
+     *         were overwritten while in use (they are counted as dropped)
+     */
+    size_t consume(size_t count);
+
+    /**
+     * @brief Wait until samples are available to this reader
+     *
+     * @param count Number of samples to wait for
+     * @param timeoutMs Timeout in milliseconds (0 = no timeout)
+     * @return true if samples are available, false on timeout
+     */
+    bool waitForSamples(size_t count, unsigned int timeoutMs = 0);
+
+    /**
+     * @brief Get the number of samples available to this reader
+     */
+    size_t available() const;
+
+    /**
+     * @brief Get the stream index of the next sample this reader returns
+     */
+    uint64_t readIndex() const;
+
+    /**
+     * @brief Get the number of samples this reader lost to being lapped
+     */
+    uint64_t droppedSamples() const;
+
+    /**
+     * @brief Get the number of times this reader was lapped
+     */
+    uint64_t overflowEvents() const;
+
+    /**
+     * @brief Get the reader's overflow policy
+     */
+    ReaderOverflowPolicy policy() const;
+
+private:
+    friend class BroadcastBuffer;
+
+    BroadcastReader(std::shared_ptr<BroadcastBuffer> ring, ReaderOverflowPolicy policy);
+
+    uint64_t catchUp(uint64_t end);
+    void recordLoss(uint64_t count);
+
+    std::shared_ptr<BroadcastBuffer> ring;
+    ReaderOverflowPolicy overflowPolicy;
+    std::atomic<uint64_t> cursor;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> overflowEpisodes;
+    uint64_t peekPos;
+    size_t peekCount;
+};
+
+} // namespace sdrplay
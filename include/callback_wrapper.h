@@ -2,11 +2,24 @@
 #include <functional>
 #include <memory>
 #include <vector>
+#include <utility>
 #include <complex>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <atomic>
-#include <condition_variable>
+#include <thread>
 #include "sdrplay_api.h"
+#include "sample_buffer.h"
+#include "planar_buffer.h"
+#include "broadcast_buffer.h"
+#include "block_pool.h"
+#include "stream_tags.h"
+#include "stream_stats.h"
+#include "rcu_holder.h"
+#include "sample_convert.h"
+#include "sample_notifier.h"
+#include "thread_policy.h"
 
 namespace sdrplay {
 
@@ -37,104 +50,106 @@ struct EventParams {
 };
 
 /**
- * @brief Buffer for streaming samples
+ * @brief Thread the user sample callback runs on
+ */
+enum class CallbackMode {
+    Inline,     // On the API stream thread; a slow callback stalls the USB pipeline
+    Dispatcher  // On a wrapper-owned worker thread fed from a broadcast reader
+};
+
+/**
+ * @brief Lag and throughput metrics of the callback dispatcher
+ */
+struct DispatcherStats {
+    uint64_t dispatchedSamples;   // Samples delivered to the callback
+    uint64_t droppedSamples;      // Samples lost because the dispatcher fell a full buffer behind
+    uint64_t callbackCount;       // Number of callback invocations
+    size_t backlogSamples;        // Samples waiting to be dispatched right now
+    size_t peakBacklogSamples;    // Largest backlog seen when the dispatcher woke up
+    uint64_t maxCallbackNs;       // Longest single callback invocation in nanoseconds
+
+    DispatcherStats() : dispatchedSamples(0), droppedSamples(0), callbackCount(0),
+                        backlogSamples(0), peakBacklogSamples(0), maxCallbackNs(0) {}
+};
+
+/**
+ * @brief Wrapper for SDRPlay API callbacks
  * 
- * Thread-safe circular buffer to store IQ samples
+ * This class manages streaming data and event callbacks from the SDRplay API.
  */
-class SampleBuffer {
+class CallbackWrapper {
 public:
     /**
-     * @brief Construct a new Sample Buffer object
-     * 
-     * @param size Buffer size in number of complex samples
+     * @brief User callback type for IQ samples
      */
-    SampleBuffer(size_t size);
+    using SampleCallback = std::function<void(const std::complex<short>*, size_t)>;
     
     /**
-     * @brief Write samples to buffer
-     * 
-     * @param data Complex sample data to write
-     * @param count Number of samples to write
-     * @return true if successful, false if buffer overflow
+     * @brief User callback type for CF32 samples
      */
-    bool write(const std::complex<short>* data, size_t count);
+    using SampleCallbackCF32 = std::function<void(const std::complex<float>*, size_t)>;
     
     /**
-     * @brief Read samples from buffer
-     * 
-     * @param dest Destination buffer
-     * @param maxCount Maximum number of samples to read
-     * @return size_t Actual number of samples read
+     * @brief User callback type for CS8 samples (count I/Q pairs)
      */
-    size_t read(std::complex<short>* dest, size_t maxCount);
+    using SampleCallbackCS8 = std::function<void(const int8_t*, size_t)>;
     
     /**
-     * @brief Wait for samples to be available
-     * 
-     * @param count Number of samples to wait for
-     * @param timeoutMs Timeout in milliseconds (0 = no timeout)
-     * @return true if samples are available, false on timeout
+     * @brief User callback type for CU8 samples (count I/Q pairs)
      */
-    bool waitForSamples(size_t count, unsigned int timeoutMs = 0);
+    using SampleCallbackCU8 = std::function<void(const uint8_t*, size_t)>;
     
     /**
-     * @brief Get number of samples available for reading
-     * 
-     * @return size_t Number of samples available
+     * @brief User callback type for device events
      */
-    size_t available() const;
+    using EventCallback = std::function<void(EventType, const EventParams&)>;
     
     /**
-     * @brief Check if buffer overflow occurred
-     * 
-     * @return true if overflow occurred
+     * @brief Consumer of pooled sample blocks
+     *
+     * Runs on the API stream thread. Copy the handle to keep the block
+     * (e.g. onto a queue for a worker thread); copying never allocates.
      */
-    bool overflow() const;
+    using BlockCallback = std::function<void(const SampleBlockRef&)>;
     
     /**
-     * @brief Reset buffer state
+     * @brief Default capacity of the conversion scratch arena in samples
+     *
+     * Comfortably larger than any single packet the API delivers.
      */
-    void reset();
+    static constexpr size_t DEFAULT_MAX_PACKET_SAMPLES = 8192;
     
     /**
-     * @brief Get buffer capacity
-     * 
-     * @return size_t Buffer capacity in samples
+     * @brief Minimum number of packet tags kept alongside the sample buffer
      */
-    size_t capacity() const;
-
-private:
-    std::vector<std::complex<short>> buffer;
-    size_t readPos;
-    size_t writePos;
-    std::atomic<bool> overflowed;
-    mutable std::mutex bufferMutex;
-    std::condition_variable dataAvailable;
-};
-
-/**
- * @brief Wrapper for SDRPlay API callbacks
- * 
- * This class manages streaming data and event callbacks from the SDRplay API.
- */
-class CallbackWrapper {
-public:
+    static constexpr size_t DEFAULT_TAG_CAPACITY = 16384;
+    
     /**
-     * @brief User callback type for IQ samples
+     * @brief Default limit on zeros inserted for a single gap
+     *
+     * A larger jump in firstSampleNum is more likely a counter glitch than
+     * real loss, so only this many zeros are inserted for it.
      */
-    using SampleCallback = std::function<void(const std::complex<short>*, size_t)>;
+    static constexpr size_t DEFAULT_MAX_GAP_FILL = 1048576;
     
     /**
-     * @brief User callback type for device events
+     * @brief Most samples the dispatcher hands to one callback invocation
      */
-    using EventCallback = std::function<void(EventType, const EventParams&)>;
-    
+    static constexpr size_t DISPATCH_CHUNK_SAMPLES = 16384;
+
+    /**
+     * @brief Number of EventType values, None included
+     */
+    static constexpr size_t EVENT_TYPES = static_cast<size_t>(EventType::None) + 1;
+
     /**
      * @brief Construct a new CallbackWrapper
      * 
      * @param bufferSize Size of the internal sample buffer
+     * @param layout Storage layout of the internal sample buffer
      */
-    CallbackWrapper(size_t bufferSize = 262144); // Default to 256K samples
+    CallbackWrapper(size_t bufferSize = 262144, // Default to 256K samples
+                    RingLayout layout = RingLayout::Standard);
     
     /**
      * @brief Destructor
@@ -144,21 +159,207 @@ public:
     /**
      * @brief Set the sample callback function
      * 
-     * This function will be called when new samples are available
+     * This function will be called when new samples are available. Safe to
+     * call while streaming; returns once the previous callback is no longer
+     * running, so it must not be called from inside a callback.
      * 
      * @param callback Function to call with new samples
      */
     void setSampleCallback(SampleCallback callback);
     
+    /**
+     * @brief Set a sample callback that receives CF32 samples
+     * 
+     * Replaces any sample callback. Typed callbacks are only called while
+     * the sample format matches their type.
+     * 
+     * @param callback Function to call with new samples
+     */
+    void setSampleCallback(SampleCallbackCF32 callback);
+    
+    /**
+     * @brief Set a sample callback that receives CS8 samples
+     * 
+     * @param callback Function to call with new samples
+     */
+    void setSampleCallback(SampleCallbackCS8 callback);
+    
+    /**
+     * @brief Set a sample callback that receives CU8 samples
+     * 
+     * @param callback Function to call with new samples
+     */
+    void setSampleCallback(SampleCallbackCU8 callback);
+    
+    /**
+     * @brief Remove the sample callback
+     */
+    void setSampleCallback(std::nullptr_t);
+    
+    /**
+     * @brief Check whether the sample callback can be used with a sample format
+     * 
+     * @param format Sample format to check
+     * @return false if a sample callback of another type is set
+     */
+    bool sampleCallbackMatches(SampleFormat format) const;
+    
     /**
      * @brief Set the event callback function
      * 
-     * This function will be called when device events occur
+     * This function will be called when device events occur. Like
+     * setSampleCallback(), it must not be called from inside a callback.
      * 
      * @param callback Function to call with events
      */
     void setEventCallback(EventCallback callback);
     
+    /**
+     * @brief Deliver samples to the sample callback in fixed-size blocks
+     * 
+     * API packets hold a few hundred to about 1.3k samples; coalescing
+     * them cuts per-call overhead, especially through Python. A partial
+     * block is delivered once its oldest sample has waited maxLatencyMs
+     * (checked as packets arrive, or by the dispatcher's timer), and on
+     * flushSampleBlock(). Must not be called while the API is delivering
+     * packets, and is refused while the dispatcher runs: switch to
+     * CallbackMode::Inline first.
+     * 
+     * @param blockSamples Samples per callback (0 = deliver packets as they arrive)
+     * @param maxLatencyMs Longest a sample may wait for its block to fill (0 = no limit)
+     * @return true if applied, false if the dispatcher is running
+     */
+    bool setCallbackBlockSize(size_t blockSamples, unsigned int maxLatencyMs = 0);
+    
+    /**
+     * @brief Get the number of samples per sample callback
+     * 
+     * @return size_t Block size, or 0 if packets are delivered as they arrive
+     */
+    size_t getCallbackBlockSize() const;
+    
+    /**
+     * @brief Deliver a partially filled inline block now
+     * 
+     * Must only be called when the API is not delivering packets, e.g.
+     * after streaming was stopped.
+     */
+    void flushSampleBlock();
+    
+    /**
+     * @brief Select the format samples are delivered to the callback in
+     * 
+     * The sample buffer and readers keep CS16; samples are converted once,
+     * with the SIMD kernels, on their way to the callback, using arenas
+     * sized here and in prepareStream(). Must not be called while the API
+     * is delivering packets, and is refused while the dispatcher runs:
+     * switch to CallbackMode::Inline first.
+     * 
+     * @param format Sample format
+     * @return true if applied, false if the dispatcher is running
+     */
+    bool setSampleFormat(SampleFormat format);
+    
+    /**
+     * @brief Get the format samples are delivered to the callback in
+     * 
+     * @return SampleFormat Current sample format
+     */
+    SampleFormat getSampleFormat() const;
+    
+    /**
+     * @brief Choose the thread the sample callback runs on
+     * 
+     * In Dispatcher mode the API thread only converts and enqueues; a
+     * worker thread drains a broadcast reader and calls the callback, so a
+     * slow callback costs it samples (counted in getDispatcherStats())
+     * instead of back-pressuring the stream. Switching to Inline stops the
+     * worker after delivering what it has queued; while streaming, its
+     * last call may overlap the first inline one.
+     * 
+     * @param mode Callback mode
+     */
+    void setCallbackMode(CallbackMode mode);
+    
+    /**
+     * @brief Get the thread the sample callback runs on
+     * 
+     * @return CallbackMode Current callback mode
+     */
+    CallbackMode getCallbackMode() const;
+    
+    /**
+     * @brief Get lag and throughput metrics of the callback dispatcher
+     * 
+     * @return DispatcherStats Metrics since the dispatcher was started
+     */
+    DispatcherStats getDispatcherStats() const;
+    
+    /**
+     * @brief Apply scheduling and memory settings to wrapper-owned resources
+     * 
+     * Affinity and realtime priority go to the dispatcher thread; memory
+     * locking covers the sample, planar and broadcast buffers. The policy
+     * is applied now and again whenever the dispatcher starts or the
+     * buffers are reallocated. Settings that cannot be applied are skipped
+     * and reported; a failed lock falls back to prefaulting the buffers.
+     * 
+     * @param policy Settings to apply
+     * @return ThreadPolicyStatus What was applied and what failed
+     */
+    ThreadPolicyStatus setThreadPolicy(const ThreadPolicy& policy);
+    
+    /**
+     * @brief Get the current thread policy
+     * 
+     * @return ThreadPolicy Settings from the last setThreadPolicy()
+     */
+    ThreadPolicy getThreadPolicy() const;
+    
+    /**
+     * @brief Get what the current thread policy achieved
+     * 
+     * Thread settings are only reported while the dispatcher runs.
+     * 
+     * @return ThreadPolicyStatus Applied settings and failures
+     */
+    ThreadPolicyStatus getThreadPolicyStatus() const;
+    
+    /**
+     * @brief Prepare per-stream resources before streaming starts
+     *
+     * Sizes the scratch arena used to interleave I/Q packets so that the
+     * stream callback never allocates. Packets larger than the arena are
+     * converted and delivered in arena-sized pieces. Must not be called
+     * while streaming.
+     *
+     * @param maxPacketSamples Largest packet expected from the API
+     */
+    void prepareStream(size_t maxPacketSamples = DEFAULT_MAX_PACKET_SAMPLES);
+    
+    /**
+     * @brief Reallocate the sample buffer
+     * 
+     * Discards buffered samples. Must only be called while not streaming.
+     * With planar storage the API's xi/xq arrays are stored as they are,
+     * and packets are only interleaved when a sample callback or reader
+     * needs them.
+     * 
+     * @param bufferSize Buffer capacity in samples
+     * @param layout Storage layout
+     * @param planar Keep I and Q in separate arrays, read with readPlanar()/peekPlanar()
+     * @param allocator Memory for the full-size buffers (nullptr = heap)
+     */
+    void configureBuffer(size_t bufferSize, RingLayout layout, bool planar = false,
+                         std::shared_ptr<RingAllocator> allocator = nullptr);
+    
+    /**
+     * @brief Check whether the sample buffer stores I and Q separately
+     * 
+     * @return true if configured with planar storage
+     */
+    bool isPlanarStorage() const;
+    
     /**
      * @brief Get SDRplay API stream callback function
      * 
@@ -182,6 +383,41 @@ public:
      */
     bool waitForSamples(size_t count, unsigned int timeoutMs = 0);
     
+    /**
+     * @brief Get a pollable descriptor signalled at a sample low-watermark
+     * 
+     * The descriptor becomes readable once at least lowWatermark samples are
+     * buffered for readSamples()/readPlanar(), and stays readable until
+     * acknowledgeSampleEvent() is called. Add it to poll/epoll/select to
+     * service several devices from one thread. Calling again changes the
+     * watermark and returns the same descriptor.
+     * 
+     * @param lowWatermark Samples that must be buffered to signal
+     * @return int Descriptor owned by the wrapper, or -1 if unsupported
+     */
+    int enableSampleEvent(size_t lowWatermark);
+    
+    /**
+     * @brief Stop signalling the sample descriptor
+     */
+    void disableSampleEvent();
+    
+    /**
+     * @brief Drain the sample descriptor and re-arm it
+     * 
+     * Call after reading the samples that made the descriptor readable. If
+     * the watermark is still met, it is signalled again straight away, so
+     * samples that arrived during the read are not missed.
+     */
+    void acknowledgeSampleEvent();
+    
+    /**
+     * @brief Get the number of times the sample descriptor was signalled
+     * 
+     * @return uint64_t Watermark crossings since construction
+     */
+    uint64_t getSampleEventCount() const;
+    
     /**
      * @brief Read samples from the buffer
      * 
@@ -191,6 +427,164 @@ public:
      */
     size_t readSamples(std::complex<short>* dest, size_t maxCount);
     
+    /**
+     * @brief Read samples converted to CF32
+     * 
+     * Converts straight out of the sample buffer into dest, whatever the
+     * sample format is.
+     * 
+     * @param dest Destination buffer
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t readSamples(std::complex<float>* dest, size_t maxCount);
+    
+    /**
+     * @brief Read samples converted to CS8
+     * 
+     * @param dest Destination for 2 * maxCount bytes
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t readSamples(int8_t* dest, size_t maxCount);
+    
+    /**
+     * @brief Read samples converted to CU8
+     * 
+     * @param dest Destination for 2 * maxCount bytes
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t readSamples(uint8_t* dest, size_t maxCount);
+    
+    /**
+     * @brief Read samples as separate I and Q arrays
+     * 
+     * Only available with planar storage.
+     * 
+     * @param xi Destination for I values
+     * @param xq Destination for Q values
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read, 0 without planar storage
+     */
+    size_t readPlanar(short* xi, short* xq, size_t maxCount);
+    
+    /**
+     * @brief Access buffered samples in place without copying
+     * 
+     * Returns nothing with planar storage; use peekPlanar() instead.
+     * 
+     * @param maxCount Maximum number of samples to expose
+     * @return SampleSpans Up to two spans into the sample buffer, valid until consumeSamples()
+     */
+    SampleSpans peekSamples(size_t maxCount);
+    
+    /**
+     * @brief Access planar buffered samples in place without copying
+     * 
+     * @param maxCount Maximum number of samples to expose
+     * @return PlanarSpans Up to two spans into the planar buffer, valid until consumeSamples()
+     */
+    PlanarSpans peekPlanar(size_t maxCount);
+    
+    /**
+     * @brief Release samples returned by peekSamples() or peekPlanar()
+     * 
+     * @param count Number of samples to release
+     * @return size_t Number of samples released
+     */
+    size_t consumeSamples(size_t count);
+    
+    /**
+     * @brief Get the stream index of the next sample readSamples()/peekSamples() returns
+     * 
+     * @return uint64_t Stream index, comparable with StreamTag::sampleIndex
+     */
+    uint64_t getReadIndex() const;
+    
+    /**
+     * @brief Get the packet tags overlapping a range of read samples
+     * 
+     * @param startIndex Stream index of the first sample in the range
+     * @param count Number of samples in the range
+     * @return std::vector<StreamTag> Tags in stream order
+     */
+    std::vector<StreamTag> getStreamTags(uint64_t startIndex, size_t count) const;
+    
+    /**
+     * @brief Register an additional independent reader of the sample stream
+     * 
+     * Every reader sees every sample written after it was added, through
+     * its own cursor and overflow policy, without copying in user code.
+     * Readers never stall the stream or each other, and are independent
+     * of readSamples()/peekSamples(). The reader unregisters itself when
+     * the last reference is released.
+     * 
+     * @param policy What the reader does when it falls a full buffer behind
+     * @return std::shared_ptr<BroadcastReader> Reader handle
+     */
+    std::shared_ptr<BroadcastReader> addSampleReader(
+        ReaderOverflowPolicy policy = ReaderOverflowPolicy::DropOldest);
+    
+    /**
+     * @brief Publish the stream as pooled, reference-counted sample blocks
+     * 
+     * Each packet is copied once into blocks taken from a fixed pool, and
+     * every block consumer receives a shared handle to them, so any number
+     * of pipeline stages see the same samples without copying them. Blocks
+     * return to the pool when the last handle is dropped. Streaming
+     * allocates nothing once the pool exists; when consumers hold every
+     * block, samples are dropped and counted in getBlockPoolStats().
+     * 
+     * Replaces any previous pool; blocks still held keep the old pool alive.
+     * 
+     * @param blockCount Blocks in the pool
+     * @param blockSamples Samples per block; longer packets span several blocks
+     * @param allocator Memory for the blocks (nullptr = heap)
+     */
+    void enableSampleBlocks(size_t blockCount, size_t blockSamples = DEFAULT_MAX_PACKET_SAMPLES,
+                            std::shared_ptr<RingAllocator> allocator = nullptr);
+    
+    /**
+     * @brief Stop publishing sample blocks and drop the pool
+     */
+    void disableSampleBlocks();
+    
+    /**
+     * @brief Add a consumer of the blocks published by enableSampleBlocks()
+     * 
+     * Like setSampleCallback(), returns once the stream thread has seen the
+     * change and must not be called from inside a callback.
+     * 
+     * @param consumer Function called with each block
+     * @return size_t Id for removeBlockConsumer()
+     */
+    size_t addBlockConsumer(BlockCallback consumer);
+    
+    /**
+     * @brief Remove a block consumer
+     * 
+     * @param id Id returned by addBlockConsumer()
+     */
+    void removeBlockConsumer(size_t id);
+    
+    /**
+     * @brief Get usage counters of the block pool
+     * 
+     * @return BlockPoolStats Counters, all zero if blocks are not enabled
+     */
+    BlockPoolStats getBlockPoolStats() const;
+    
+    /**
+     * @brief Get a snapshot of the stream's rate, timing, fill and loss counters
+     * 
+     * The stream thread keeps the counters with relaxed atomic stores, so
+     * this can be called from any thread at any rate without disturbing it.
+     * 
+     * @return StreamStats Counters of the current stream
+     */
+    StreamStats getStreamStats() const;
+    
     /**
      * @brief Get number of available samples
      * 
@@ -205,11 +599,115 @@ public:
      */
     bool hasOverflow() const;
     
+    /**
+     * @brief Set how waitForSamples() waits for the API thread
+     * 
+     * @param strategy Block, SpinThenBlock or BusyPoll
+     * @param spinUs Spin budget before sleeping, for SpinThenBlock
+     */
+    void setWaitStrategy(WaitStrategy strategy, unsigned int spinUs = 50);
+    
+    /**
+     * @brief Get the wait strategy used by waitForSamples()
+     * 
+     * @return WaitStrategy Current wait strategy
+     */
+    WaitStrategy getWaitStrategy() const;
+    
+    /**
+     * @brief Set the policy applied when the sample buffer is full
+     * 
+     * @param policy Overflow policy
+     * @param blockTimeoutMs Maximum wait on the API thread for BlockWithTimeout
+     */
+    void setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs = 10);
+    
+    /**
+     * @brief Get the policy applied when the sample buffer is full
+     * 
+     * @return OverflowPolicy Current overflow policy
+     */
+    OverflowPolicy getOverflowPolicy() const;
+    
+    /**
+     * @brief Get the number of samples lost to buffer overflows
+     * 
+     * @return uint64_t Dropped samples since streaming started
+     */
+    uint64_t getDroppedSampleCount() const;
+    
+    /**
+     * @brief Get the number of buffer overflow episodes
+     * 
+     * @return uint64_t Runs of consecutive packets that lost samples
+     */
+    uint64_t getOverflowEventCount() const;
+    
+    /**
+     * @brief Enable or disable zero filling of lost samples
+     * 
+     * When enabled, a jump in the API's firstSampleNum is filled with
+     * zero-valued samples so that stream indices stay aligned with time.
+     * Lost samples are counted whether or not filling is enabled.
+     * 
+     * @param enable Insert zeros for lost samples
+     * @param maxFillSamples Most zeros inserted for a single gap
+     */
+    void setGapFill(bool enable, size_t maxFillSamples = DEFAULT_MAX_GAP_FILL);
+    
+    /**
+     * @brief Check whether lost samples are zero filled
+     * 
+     * @return true if zero filling is enabled
+     */
+    bool getGapFill() const;
+    
+    /**
+     * @brief Get the number of samples the API failed to deliver
+     * 
+     * Detected from discontinuities in firstSampleNum, e.g. USB drops.
+     * 
+     * @return uint64_t Missing samples since streaming started
+     */
+    uint64_t getMissingSampleCount() const;
+    
+    /**
+     * @brief Get the number of discontinuities in firstSampleNum
+     * 
+     * @return uint64_t Gaps detected since streaming started
+     */
+    uint64_t getGapEventCount() const;
+    
+    /**
+     * @brief Get the number of device events received of one type
+     * 
+     * Counted whether or not an event callback is set; unrecognised
+     * events count as EventType::None.
+     * 
+     * @param type Event type
+     * @return uint64_t Events received over the wrapper's lifetime
+     */
+    uint64_t getEventCount(EventType type) const;
+    
     /**
      * @brief Reset buffer state
      */
     void resetBuffer();
     
+    /**
+     * @brief Get the sample buffer
+     * 
+     * @return const SampleBuffer& Buffer backing readSamples()/peekSamples()
+     */
+    const SampleBuffer& getSampleBuffer() const;
+    
+    /**
+     * @brief Get the planar sample buffer
+     * 
+     * @return const PlanarBuffer& Buffer backing readPlanar()/peekPlanar()
+     */
+    const PlanarBuffer& getPlanarBuffer() const;
+    
     /**
      * @brief Get a pointer to the internal context
      * 
@@ -276,11 +774,189 @@ private:
                               sdrplay_api_TunerSelectT tuner,
                               sdrplay_api_EventParamsT *params);
     
-    SampleCallback m_sampleCallback;
-    EventCallback m_eventCallback;
+    /**
+     * @brief Check a packet's firstSampleNum against the expected value
+     * 
+     * @param params Stream callback parameters
+     * @param numSamples Number of samples in the packet
+     * @param restart The stream was restarted or resampled at this packet
+     * @return uint32_t Number of samples missing before the packet
+     */
+    uint32_t checkContinuity(const sdrplay_api_StreamCbParamsT *params,
+                             unsigned int numSamples, bool restart);
+    
+    /**
+     * @brief Callbacks published to the API and dispatcher threads
+     */
+    struct ActiveCallbacks {
+        SampleCallback sample;
+        SampleCallbackCF32 sampleCF32;
+        SampleCallbackCS8 sampleCS8;
+        SampleCallbackCU8 sampleCU8;
+        EventCallback event;
+        bool dispatch;  // Sample callback runs on the dispatcher thread
+        std::shared_ptr<BlockPool> blockPool;
+        std::vector<std::pair<size_t, BlockCallback>> blockConsumers;
+        
+        ActiveCallbacks() : dispatch(false) {}
+        
+        bool hasSample(SampleFormat format) const;
+        void clearSample();
+    };
+    
+    /**
+     * @brief Write zeros in place of lost samples
+     * 
+     * @param active Callbacks of the current packet
+     * @param tag Tag of the packet following the gap
+     * @param count Number of zeros to write
+     */
+    void fillGap(const ActiveCallbacks& active, const StreamTag& tag, size_t count);
+    
+    /**
+     * @brief Record the broadcast index where a callback mode switch took effect
+     * 
+     * @param dispatch Mode seen by the current packet
+     */
+    void claimSwitchIndex(bool dispatch);
+    
+    /**
+     * @brief Start the dispatcher worker thread
+     */
+    void startDispatcher();
+    
+    /**
+     * @brief Deliver queued samples and join the dispatcher worker thread
+     */
+    void stopDispatcher();
+    
+    /**
+     * @brief Lock or prefault the buffers as the thread policy asks
+     * 
+     * Must be called with dispatcherMutex held.
+     */
+    void applyMemoryPolicy();
+    
+    /**
+     * @brief Dispatcher worker thread body
+     */
+    void dispatchLoop();
+    
+    /**
+     * @brief Deliver everything currently queued for the dispatcher
+     * 
+     * @param flushPartial Also deliver a trailing partial block
+     */
+    void dispatchAvailable(bool flushPartial);
+    
+    /**
+     * @brief Hand samples to the inline sample callback, coalescing into blocks
+     * 
+     * @param active Callbacks of the current packet
+     * @param samples Converted samples
+     * @param count Number of samples
+     * @param arrivalNs Arrival time of the packet
+     */
+    void deliverSamples(const ActiveCallbacks& active, const std::complex<short>* samples,
+                        size_t count, uint64_t arrivalNs);
+    
+    /**
+     * @brief Deliver the pending partial block, if any
+     * 
+     * @param active Callbacks to deliver to
+     */
+    void flushBlock(const ActiveCallbacks& active);
+    
+    /**
+     * @brief Convert samples to the sample format and call the sample callback
+     * 
+     * @param active Callbacks to deliver to
+     * @param samples Samples to deliver
+     * @param count Number of samples
+     * @param arena Conversion arena of the calling thread
+     */
+    void invokeSampleCallback(const ActiveCallbacks& active, const std::complex<short>* samples,
+                              size_t count, std::vector<std::complex<float>>& arena);
+    
+    /**
+     * @brief Copy samples into pooled blocks and hand them to the block consumers
+     *
+     * @param active Callbacks of the current packet
+     * @param samples Interleaved samples
+     * @param count Number of samples
+     * @param tag Tag of the packet the samples belong to
+     */
+    void publishBlocks(const ActiveCallbacks& active, const std::complex<short>* samples,
+                       size_t count, const StreamTag& tag);
+    
+    /**
+     * @brief Size the conversion arenas for the largest possible callback
+     *
+     * Must be called with dispatcherMutex held while the dispatcher is stopped.
+     */
+    void sizeFormatArenas();
+    
+    /**
+     * @brief Get the stream index of the next sample stored for readSamples()
+     */
+    uint64_t storedWriteIndex() const;
+    
+    static constexpr uint64_t NO_INDEX = UINT64_MAX;
+    
+    RcuHolder<ActiveCallbacks> callbacks;
     SampleBuffer sampleBuffer;
-    std::mutex callbackMutex;
+    PlanarBuffer planarBuffer;                     // Replaces sampleBuffer with planar storage
+    std::atomic<bool> planarStorage;              // Read by stats scrapers on other threads
+    std::vector<std::complex<short>> planarReadScratch;  // Consumer-side interleave for converting reads
+    SampleNotifier sampleEvent;                    // Low-watermark descriptor for poll/epoll
+    std::shared_ptr<BroadcastBuffer> broadcast;  // Fan-out to readers from addSampleReader()
+    StreamTagBuffer streamTags;
+    StreamStatsCollector streamStats;              // Written only by the stream thread and prepareStream()
+    std::vector<std::complex<short>> scratch;  // Interleave arena, sized by prepareStream()
     std::atomic<bool> streamActive;
+    
+    // Continuity tracking, touched only by the stream thread and prepareStream()
+    uint32_t expectedSampleNum;
+    bool haveExpectedSampleNum;
+    std::atomic<bool> gapFillEnabled;
+    std::atomic<size_t> maxGapFill;
+    std::atomic<uint64_t> missingSamples;
+    std::atomic<uint64_t> gapEvents;
+    std::atomic<uint64_t> eventCounts[EVENT_TYPES];  // Per EventType, bumped on the API event thread
+    
+    // Callback dispatcher
+    mutable std::mutex dispatcherMutex;             // Serialises start/stop, thread policy and dispatch settings changes
+    std::thread dispatcherThread;
+    ThreadPolicy threadPolicy;
+    ThreadPolicyStatus threadStatus;                // Dispatcher thread settings
+    ThreadPolicyStatus memoryStatus;                // Buffer locking
+    std::shared_ptr<BroadcastReader> dispatchReader;
+    std::vector<std::complex<short>> dispatchBuffer;
+    std::atomic<bool> dispatcherRunning;            // Worker keeps waiting for samples
+    std::atomic<uint64_t> dispatchStartIndex;       // Broadcast index where dispatching started
+    std::atomic<uint64_t> dispatchStopIndex;        // Broadcast index where inline delivery resumed
+    std::atomic<uint64_t> dispatchedSamples;
+    std::atomic<uint64_t> dispatchDropped;
+    std::atomic<uint64_t> dispatchCalls;
+    std::atomic<size_t> peakBacklog;
+    std::atomic<uint64_t> maxCallbackNs;
+    
+    // Block coalescing; the pending block is touched only by the stream thread
+    size_t blockSize;                               // 0 delivers packets as they arrive
+    uint64_t blockLatencyNs;                        // 0 waits for full blocks
+    std::vector<std::complex<short>> blockBuffer;
+    size_t blockFill;
+    uint64_t blockStartNs;                          // Arrival time of the oldest pending sample
+    
+    // Pooled blocks; the sequence is touched only by the stream thread
+    std::atomic<size_t> nextBlockConsumerId;
+    uint64_t blockSequence;
+    std::atomic<uint64_t> blockDroppedSamples;
+    
+    // Callback sample format; each delivering thread converts into its own arena
+    SampleFormat sampleFormat;
+    std::vector<std::complex<float>> inlineFormatArena;
+    std::vector<std::complex<float>> dispatchFormatArena;
 };
 
 } // namespace sdrplay
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+#include "latency_histogram.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace sdrplay {
+
+/**
+ * @brief sdrplay_api calls on the control path that are timed
+ */
+enum class ControlOperation {
+    Init,    // sdrplay_api_Init, which starts the stream
+    Uninit,  // sdrplay_api_Uninit, which stops it
+    Update   // sdrplay_api_Update, for any reason
+};
+
+/**
+ * @brief Latency summary of one kind of control call
+ */
+struct ControlLatencyStats {
+    uint64_t count;   // Calls timed
+    uint64_t sumNs;   // Total time spent in the calls
+    uint64_t minNs;   // Fastest call
+    uint64_t maxNs;   // Slowest call
+    uint64_t p50Ns;   // Median, within the histogram's 12.5% resolution
+    uint64_t p90Ns;
+    uint64_t p99Ns;
+
+    ControlLatencyStats() : count(0), sumNs(0), minNs(0), maxNs(0), p50Ns(0), p90Ns(0), p99Ns(0) {}
+};
+
+/**
+ * @brief Latency histograms of the control calls made for one device
+ *
+ * Control calls are rare and already take milliseconds, so recording one
+ * is never on the sample path. Snapshots may be taken from any thread.
+ */
+class ControlLatency {
+public:
+    static constexpr size_t OPERATIONS = 3;
+
+    ControlLatency() = default;
+
+    ControlLatency(const ControlLatency&) = delete;
+    ControlLatency& operator=(const ControlLatency&) = delete;
+
+    /**
+     * @brief Record how long a control call took
+     *
+     * @param op Operation that was timed
+     * @param ns Duration in nanoseconds
+     */
+    void record(ControlOperation op, uint64_t ns);
+
+    /**
+     * @brief Summarise the calls of one operation
+     *
+     * @param op Operation to summarise
+     */
+    ControlLatencyStats snapshot(ControlOperation op) const;
+
+private:
+    LatencyHistogram histograms[OPERATIONS];
+};
+
+} // namespace sdrplay
@@ -2,26 +2,14 @@
 #include "device_types.h"
 #include "sdrplay_api.h"
 #include "callback_wrapper.h"
+#include "streaming_params.h"
+#include "control_latency.h"
 #include <memory>
 #include <vector>
 #include <functional>
 
 namespace sdrplay {
 
-/**
- * @brief Streaming configuration parameters
- */
-struct StreamingParams {
-    bool enableIQCorrection{true};  // Enable automatic IQ imbalance correction
-    bool enableDCCorrection{true};  // Enable automatic DC offset correction
-    bool decimate{false};          // Enable decimation
-    int decimationFactor{1};       // Decimation factor (1, 2, 4, 8, 16, 32)
-    bool wideBandSignal{false};    // Process signal as wideband
-    
-    // Default constructor
-    StreamingParams() = default;
-};
-
 class DeviceControl {
 public:
     DeviceControl();
@@ -40,6 +28,18 @@ public:
     virtual sdrplay_api_DeviceParamsT* getDeviceParams() const;
     virtual std::string getLastError() const;
 
+    /**
+     * @brief Apply changed device parameters with sdrplay_api_Update
+     * 
+     * Times the call for getControlLatency().
+     * 
+     * @param reason Parameters that changed
+     * @param reasonExt Extended parameters that changed
+     * @return sdrplay_api_ErrT API result; sdrplay_api_NotInitialised without a selected device
+     */
+    virtual sdrplay_api_ErrT updateDevice(sdrplay_api_ReasonForUpdateT reason,
+                                          sdrplay_api_ReasonForUpdateExtension1T reasonExt = sdrplay_api_Update_Ext1_None);
+
     // Common control methods
     virtual void setFrequency(double freq) = 0;
     virtual double getFrequency() const = 0;
@@ -84,6 +84,34 @@ public:
      */
     virtual void setSampleCallback(CallbackWrapper::SampleCallback callback);
     
+    /**
+     * @brief Set a sample callback that receives CF32 samples
+     * 
+     * Called while streaming with SampleFormat::CF32.
+     * 
+     * @param callback Function to call with new samples
+     */
+    virtual void setSampleCallback(CallbackWrapper::SampleCallbackCF32 callback);
+    
+    /**
+     * @brief Set a sample callback that receives CS8 samples
+     * 
+     * @param callback Function to call with new samples
+     */
+    virtual void setSampleCallback(CallbackWrapper::SampleCallbackCS8 callback);
+    
+    /**
+     * @brief Set a sample callback that receives CU8 samples
+     * 
+     * @param callback Function to call with new samples
+     */
+    virtual void setSampleCallback(CallbackWrapper::SampleCallbackCU8 callback);
+    
+    /**
+     * @brief Remove the sample callback
+     */
+    virtual void setSampleCallback(std::nullptr_t);
+    
     /**
      * @brief Set the event callback function
      * 
@@ -100,6 +128,28 @@ public:
      */
     virtual bool waitForSamples(size_t count, unsigned int timeoutMs = 0);
     
+    /**
+     * @brief Get a pollable descriptor signalled at a sample low-watermark
+     * 
+     * Becomes readable once at least lowWatermark samples are buffered and
+     * stays readable until acknowledgeSampleEvent(). Lets one poll/epoll
+     * loop service several devices. May be called before streaming starts.
+     * 
+     * @param lowWatermark Samples that must be buffered to signal
+     * @return int Descriptor owned by the device, or -1 if unsupported
+     */
+    virtual int enableSampleEvent(size_t lowWatermark);
+    
+    /**
+     * @brief Stop signalling the sample descriptor
+     */
+    virtual void disableSampleEvent();
+    
+    /**
+     * @brief Drain and re-arm the sample descriptor after reading samples
+     */
+    virtual void acknowledgeSampleEvent();
+    
     /**
      * @brief Read samples from the buffer
      * 
@@ -109,6 +159,135 @@ public:
      */
     virtual size_t readSamples(std::complex<short>* dest, size_t maxCount);
     
+    /**
+     * @brief Read samples converted to CF32 (scaled to [-1.0, 1.0))
+     * 
+     * @param dest Destination buffer
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    virtual size_t readSamples(std::complex<float>* dest, size_t maxCount);
+    
+    /**
+     * @brief Read samples converted to CS8 I/Q pairs
+     * 
+     * @param dest Destination for 2 * maxCount bytes
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    virtual size_t readSamples(int8_t* dest, size_t maxCount);
+    
+    /**
+     * @brief Read samples converted to CU8 I/Q pairs
+     * 
+     * @param dest Destination for 2 * maxCount bytes
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    virtual size_t readSamples(uint8_t* dest, size_t maxCount);
+    
+    /**
+     * @brief Access buffered samples in place without copying
+     * 
+     * @param maxCount Maximum number of samples to expose
+     * @return SampleSpans Up to two spans into the sample buffer, valid until consumeSamples()
+     */
+    virtual SampleSpans peekSamples(size_t maxCount);
+    
+    /**
+     * @brief Read samples as separate I and Q arrays
+     * 
+     * Only available when streaming with planarStorage.
+     * 
+     * @param xi Destination for I values
+     * @param xq Destination for Q values
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    virtual size_t readPlanar(short* xi, short* xq, size_t maxCount);
+    
+    /**
+     * @brief Access planar buffered samples in place without copying
+     * 
+     * @param maxCount Maximum number of samples to expose
+     * @return PlanarSpans Up to two spans into the planar buffer, valid until consumeSamples()
+     */
+    virtual PlanarSpans peekPlanar(size_t maxCount);
+    
+    /**
+     * @brief Release samples returned by peekSamples()
+     * 
+     * @param count Number of samples to release
+     * @return size_t Number of samples released; 0 when not streaming
+     */
+    virtual size_t consumeSamples(size_t count);
+    
+    /**
+     * @brief Register an additional independent reader of the sample stream
+     * 
+     * Lets several consumers (e.g. a recorder, a display and a demodulator)
+     * share one stream, each with its own cursor and overflow policy.
+     * 
+     * @param policy What the reader does when it falls a full buffer behind
+     * @return std::shared_ptr<BroadcastReader> Reader handle, or nullptr if unavailable
+     */
+    virtual std::shared_ptr<BroadcastReader> addSampleReader(
+        ReaderOverflowPolicy policy = ReaderOverflowPolicy::DropOldest);
+    
+    /**
+     * @brief Publish the stream as pooled, reference-counted sample blocks
+     * 
+     * Every block consumer shares the same blocks instead of copying the
+     * samples; see CallbackWrapper::enableSampleBlocks().
+     * 
+     * @param blockCount Blocks in the pool
+     * @param blockSamples Samples per block
+     * @param allocator Memory for the blocks (nullptr = heap)
+     */
+    virtual void enableSampleBlocks(size_t blockCount,
+                                    size_t blockSamples = CallbackWrapper::DEFAULT_MAX_PACKET_SAMPLES,
+                                    std::shared_ptr<RingAllocator> allocator = nullptr);
+    
+    /**
+     * @brief Stop publishing sample blocks
+     */
+    virtual void disableSampleBlocks();
+    
+    /**
+     * @brief Add a consumer of the pooled sample blocks
+     * 
+     * @param consumer Function called on the stream thread with each block
+     * @return size_t Id for removeBlockConsumer(), 0 if unavailable
+     */
+    virtual size_t addBlockConsumer(CallbackWrapper::BlockCallback consumer);
+    
+    /**
+     * @brief Remove a block consumer
+     * 
+     * @param id Id returned by addBlockConsumer()
+     */
+    virtual void removeBlockConsumer(size_t id);
+    
+    /**
+     * @brief Get the stream index of the next sample readSamples()/peekSamples() returns
+     * 
+     * @return uint64_t Stream index, comparable with StreamTag::sampleIndex
+     */
+    virtual uint64_t getReadIndex() const;
+    
+    /**
+     * @brief Get the packet tags overlapping a range of read samples
+     * 
+     * Each tag carries the packet's API sample number, gain/frequency/rate
+     * change flags and host arrival time, so settling samples after a
+     * retune can be located exactly.
+     * 
+     * @param startIndex Stream index of the first sample in the range
+     * @param count Number of samples in the range
+     * @return std::vector<StreamTag> Tags in stream order
+     */
+    virtual std::vector<StreamTag> getStreamTags(uint64_t startIndex, size_t count) const;
+    
     /**
      * @brief Get number of available samples
      * 
@@ -123,6 +302,134 @@ public:
      */
     virtual bool hasBufferOverflow() const;
     
+    /**
+     * @brief Set how waitForSamples() waits for the API thread
+     * 
+     * @param strategy Block, SpinThenBlock or BusyPoll
+     * @param spinUs Spin budget before sleeping, for SpinThenBlock
+     */
+    virtual void setWaitStrategy(WaitStrategy strategy, unsigned int spinUs = 50);
+    
+    /**
+     * @brief Get the wait strategy used by waitForSamples()
+     * 
+     * @return WaitStrategy Current wait strategy
+     */
+    virtual WaitStrategy getWaitStrategy() const;
+    
+    /**
+     * @brief Set the policy applied when the sample buffer is full
+     * 
+     * @param policy Overflow policy
+     * @param blockTimeoutMs Maximum wait on the API thread for BlockWithTimeout
+     */
+    virtual void setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs = 10);
+    
+    /**
+     * @brief Get the policy applied when the sample buffer is full
+     * 
+     * @return OverflowPolicy Current overflow policy
+     */
+    virtual OverflowPolicy getOverflowPolicy() const;
+    
+    /**
+     * @brief Get the number of samples lost to buffer overflows
+     * 
+     * @return uint64_t Dropped samples since streaming started
+     */
+    virtual uint64_t getDroppedSampleCount() const;
+    
+    /**
+     * @brief Get the number of buffer overflow episodes
+     * 
+     * @return uint64_t Runs of consecutive packets that lost samples
+     */
+    virtual uint64_t getOverflowEventCount() const;
+    
+    /**
+     * @brief Get the number of samples the API failed to deliver
+     * 
+     * Detected from jumps in the packet sample counter (firstSampleNum).
+     * 
+     * @return uint64_t Missing samples since streaming started
+     */
+    virtual uint64_t getMissingSampleCount() const;
+    
+    /**
+     * @brief Get the number of discontinuities in the packet sample counter
+     * 
+     * @return uint64_t Gaps detected since streaming started
+     */
+    virtual uint64_t getGapEventCount() const;
+    
+    /**
+     * @brief Get lag metrics of the callback dispatcher
+     * 
+     * Only meaningful when streaming with CallbackMode::Dispatcher.
+     * 
+     * @return DispatcherStats Dispatcher metrics
+     */
+    virtual DispatcherStats getDispatcherStats() const;
+    
+    /**
+     * @brief Get usage counters of the sample block pool
+     * 
+     * @return BlockPoolStats Pool counters, all zero if blocks are not enabled
+     */
+    virtual BlockPoolStats getBlockPoolStats() const;
+    
+    /**
+     * @brief Get a snapshot of the stream's rate, timing, fill and loss counters
+     * 
+     * Cheap enough to poll from a monitoring thread while streaming.
+     * 
+     * @return StreamStats Counters since streaming last started
+     */
+    virtual StreamStats getStreamStats() const;
+    
+    /**
+     * @brief Get the number of device events received of one type
+     * 
+     * @param type Event type
+     * @return uint64_t Events received since the device control was created
+     */
+    virtual uint64_t getEventCount(EventType type) const;
+    
+    /**
+     * @brief Get how long sdrplay_api_Init, Uninit or Update calls took
+     * 
+     * @param op Control call to summarise
+     * @return ControlLatencyStats Latencies since the device control was created
+     */
+    virtual ControlLatencyStats getControlLatency(ControlOperation op) const;
+    
+    /**
+     * @brief Pin and prioritise wrapper-owned threads and lock the sample buffers
+     * 
+     * Affinity and SCHED_FIFO priority apply to the callback dispatcher;
+     * memory locking applies to the sample buffers. Settings are re-applied
+     * when streaming starts. Missing permissions do not fail the call; the
+     * returned status lists what could not be applied.
+     * 
+     * @param policy Settings to apply
+     * @return ThreadPolicyStatus What was applied and what failed
+     */
+    virtual ThreadPolicyStatus setThreadPolicy(const ThreadPolicy& policy);
+    
+    /**
+     * @brief Get what the current thread policy achieved
+     * 
+     * @return ThreadPolicyStatus Applied settings and failures
+     */
+    virtual ThreadPolicyStatus getThreadPolicyStatus() const;
+    
+    /**
+     * @brief Get the format the sample callback receives
+     * 
+     * @return SampleFormat Format selected by the last startStreaming()
+     */
+    virtual SampleFormat getSampleFormat() const;
+    
     /**
      * @brief Reset buffer state
      */
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sdrplay {
+
+/**
+ * @brief Log-linear histogram of latencies in nanoseconds
+ *
+ * Each power of two is split into 8 buckets, so any recorded value is
+ * reported within 12.5% over the whole 64-bit range in a fixed 4 KiB of
+ * counters. record() is a couple of relaxed atomic increments and never
+ * allocates, so it can run on the stream thread; readers may query while
+ * values are being recorded.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief Record one latency
+     *
+     * @param ns Latency in nanoseconds
+     */
+    void record(uint64_t ns);
+
+    /**
+     * @brief Add every value recorded in another histogram
+     *
+     * @param other Histogram to merge in
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Clear all recorded values
+     */
+    void reset();
+
+    /**
+     * @brief Get the number of recorded values
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief Get the smallest recorded value (0 if empty)
+     */
+    uint64_t min() const;
+
+    /**
+     * @brief Get the largest recorded value (0 if empty)
+     */
+    uint64_t max() const;
+
+    /**
+     * @brief Get the mean of the recorded values (0 if empty)
+     */
+    double mean() const;
+
+    /**
+     * @brief Get a percentile
+     *
+     * @param percent Percentile in [0, 100]
+     * @return uint64_t Upper bound of the bucket holding it, capped at max()
+     */
+    uint64_t percentile(double percent) const;
+
+    /**
+     * @brief Get the number of values in a bucket
+     *
+     * @param index Bucket index below BUCKETS
+     */
+    uint64_t bucketCount(size_t index) const;
+
+    /**
+     * @brief Get the smallest value that falls into a bucket
+     *
+     * @param index Bucket index below BUCKETS
+     */
+    static uint64_t bucketLowerBound(size_t index);
+
+    /**
+     * @brief Get the bucket a value falls into
+     *
+     * @param ns Value in nanoseconds
+     */
+    static size_t bucketIndex(uint64_t ns);
+
+private:
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> minimum;
+    std::atomic<uint64_t> maximum;
+};
+
+} // namespace sdrplay
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace sdrplay {
+
+class Device;
+
+/**
+ * @brief Embedded HTTP endpoint serving device metrics in Prometheus text format
+ *
+ * Serves GET /metrics from its own thread with a non-blocking socket, so a
+ * slow or stalled scraper never holds up the caller. Each scrape reads the
+ * same snapshots as getStreamStats(), getEventCount() and
+ * getControlLatency(): relaxed loads of counters the stream thread already
+ * keeps, so the sample path does no extra work for the server. The state
+ * startStreaming() and stopStreaming() change is atomic too, so a scrape
+ * may run while a device starts or stops. Binds to 127.0.0.1 unless told
+ * otherwise.
+ *
+ * Only available on POSIX systems; elsewhere start() fails.
+ */
+class MetricsServer {
+public:
+    /**
+     * @brief Port used when none is given (the Prometheus exporter range)
+     */
+    static constexpr uint16_t DEFAULT_PORT = 9464;
+
+    MetricsServer();
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Bind the listening socket and start the server thread
+     *
+     * @param port TCP port; 0 picks a free one, see getPort()
+     * @param bindAddress IPv4 address to listen on; "0.0.0.0" exposes the metrics to the network
+     * @return true if the server is running
+     */
+    bool start(uint16_t port = DEFAULT_PORT, const std::string& bindAddress = "127.0.0.1");
+
+    /**
+     * @brief Stop the server thread and close the socket
+     *
+     * Returns within about one poll interval (100 ms).
+     */
+    void stop();
+
+    /**
+     * @brief Check whether the server is running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Get the port the server listens on
+     *
+     * @return uint16_t Bound port, or 0 if not running
+     */
+    uint16_t getPort() const;
+
+    /**
+     * @brief Get the reason the last start() failed
+     */
+    std::string getLastError() const;
+
+    /**
+     * @brief Publish the metrics of a device
+     *
+     * The device must stay alive, and keep its selection, until it is
+     * removed: call removeDevice() before releaseDevice(), selectDevice()
+     * or destroying it. Adding a device again replaces its name.
+     *
+     * @param device Device to publish
+     * @param name Value of the device label on its metrics
+     */
+    void addDevice(Device& device, const std::string& name);
+
+    /**
+     * @brief Stop publishing a device
+     *
+     * Once this returns the server no longer touches the device.
+     *
+     * @param device Device to remove
+     */
+    void removeDevice(Device& device);
+
+    /**
+     * @brief Render the metrics of all published devices
+     *
+     * This is the body served for GET /metrics.
+     *
+     * @return std::string Metrics in Prometheus text exposition format 0.0.4
+     */
+    std::string renderMetrics() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace sdrplay
@@ -0,0 +1,240 @@
+#pragma once
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "ring_index.h"
+#include "ring_storage.h"
+#include "wait_strategy.h"
+#include "sample_buffer.h"
+
+namespace sdrplay {
+
+/**
+ * @brief Contiguous run of planar samples inside ring storage
+ */
+struct PlanarSpan {
+    const short* i;  // First I value, nullptr if empty
+    const short* q;  // First Q value, nullptr if empty
+    size_t size;     // Number of samples
+
+    PlanarSpan() : i(nullptr), q(nullptr), size(0) {}
+    PlanarSpan(const short* iData, const short* qData, size_t n) : i(iData), q(qData), size(n) {}
+};
+
+/**
+ * @brief Readable region of a planar ring buffer
+ *
+ * A region that wraps around the end of storage is split in two; otherwise
+ * second is empty.
+ */
+struct PlanarSpans {
+    PlanarSpan first;
+    PlanarSpan second;
+
+    size_t size() const { return first.size + second.size; }
+    bool empty() const { return size() == 0; }
+};
+
+/**
+ * @brief Buffer for streaming samples with I and Q stored separately
+ *
+ * Same lock-free single-producer/single-consumer ring as SampleBuffer, but
+ * I and Q live in two cache-line-aligned arrays, matching the xi/xq arrays
+ * the API delivers. Packets are stored without interleaving, and kernels
+ * that work on one component at a time (magnitude, dot products, FIR
+ * filters) can run straight on the ring with full-width vector loads.
+ *
+ * Both arrays share one RingIndex, so a sample's I and Q values are always
+ * published and released together.
+ */
+class PlanarBuffer {
+public:
+    /**
+     * @brief Construct a new Planar Buffer object
+     *
+     * @param size Buffer size in number of samples (rounded up to a power of two)
+     * @param layout Storage layout; Mirrored falls back to Standard if unavailable
+     * @param allocator Memory for standard layout (nullptr = heap)
+     */
+    PlanarBuffer(size_t size, RingLayout layout = RingLayout::Standard,
+                 std::shared_ptr<RingAllocator> allocator = nullptr);
+
+    /**
+     * @brief Reallocate storage with a new size and layout
+     *
+     * Discards all buffered samples. Must only be called while neither the
+     * producer nor the consumer is active.
+     *
+     * @param size Buffer size in number of samples
+     * @param layout Storage layout
+     * @param allocator Memory for standard layout (nullptr = heap)
+     */
+    void reconfigure(size_t size, RingLayout layout,
+                     std::shared_ptr<RingAllocator> allocator = nullptr);
+
+    /**
+     * @brief Write samples to buffer
+     *
+     * Must only be called from the producer thread. The overflow policy
+     * applies as in SampleBuffer::write().
+     *
+     * @param xi I values
+     * @param xq Q values
+     * @param count Number of samples
+     * @return true if all samples were stored without dropping any
+     */
+    bool write(const short* xi, const short* xq, size_t count);
+
+    /**
+     * @brief Read samples from buffer
+     *
+     * Must only be called from the consumer thread.
+     *
+     * @param xi Destination for I values
+     * @param xq Destination for Q values
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t read(short* xi, short* xq, size_t maxCount);
+
+    /**
+     * @brief Access readable samples in place without copying
+     *
+     * The returned spans stay valid until they are released with consume()
+     * or the buffer is reset. Must only be called from the consumer thread.
+     *
+     * @param maxCount Maximum number of samples to expose
+     * @return PlanarSpans Up to two spans covering the readable samples
+     */
+    PlanarSpans peek(size_t maxCount);
+
+    /**
+     * @brief Release samples previously returned by peek()
+     *
+     * @param count Number of samples to release (clamped to the last peek)
+     * @return size_t Samples released; 0 if a reset or overwrite discarded the peeked data
+     */
+    size_t consume(size_t count);
+
+    /**
+     * @brief Wait for samples to be available
+     *
+     * @param count Number of samples to wait for (clamped to capacity)
+     * @param timeoutMs Timeout in milliseconds (0 = no timeout)
+     * @return true if samples are available, false on timeout
+     */
+    bool waitForSamples(size_t count, unsigned int timeoutMs = 0);
+
+    /**
+     * @brief Set how waitForSamples() waits
+     *
+     * The producer wakes sleepers of every strategy, so this may be changed
+     * at any time.
+     *
+     * @param strategy Wait strategy
+     * @param spinUs Spin budget before sleeping, for SpinThenBlock
+     */
+    void setWaitStrategy(WaitStrategy strategy, unsigned int spinUs = 50);
+
+    /**
+     * @brief Get the wait strategy
+     */
+    WaitStrategy getWaitStrategy() const;
+
+    /**
+     * @brief Get number of samples available for reading
+     */
+    size_t available() const;
+
+    /**
+     * @brief Get the stream index of the next sample to be read
+     */
+    uint64_t readIndex() const;
+
+    /**
+     * @brief Get the stream index the next written sample will receive
+     */
+    uint64_t writeIndex() const;
+
+    /**
+     * @brief Check if buffer overflow occurred
+     *
+     * @return true if overflow occurred since the last reset
+     */
+    bool overflow() const;
+
+    /**
+     * @brief Set the overflow policy
+     *
+     * @param policy Policy applied by write() when the buffer is full
+     * @param blockTimeoutMs Maximum wait for BlockWithTimeout
+     */
+    void setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs = 10);
+
+    /**
+     * @brief Get the overflow policy
+     */
+    OverflowPolicy getOverflowPolicy() const;
+
+    /**
+     * @brief Get the total number of samples dropped by overflows
+     */
+    uint64_t droppedSamples() const;
+
+    /**
+     * @brief Get the number of overflow episodes
+     */
+    uint64_t overflowEvents() const;
+
+    /**
+     * @brief Reset buffer state
+     *
+     * Discards all unread samples. Safe to call from either side.
+     */
+    void reset();
+
+    /**
+     * @brief Get buffer capacity
+     *
+     * @return size_t Buffer capacity in samples
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Lock the storage into RAM, or unlock it
+     *
+     * Reallocating the storage drops the lock.
+     *
+     * @param lock true to lock, false to unlock
+     * @return true on success; on failure errno describes the reason
+     */
+    bool lockMemory(bool lock = true);
+
+    /**
+     * @brief Populate the storage pages without changing their contents
+     *
+     * @return true on success; on failure errno describes the reason
+     */
+    bool prefaultMemory();
+
+    /**
+     * @brief Get the storage layout actually in use
+     *
+     * @return RingLayout Mirrored only if both double mappings succeeded
+     */
+    RingLayout layout() const;
+
+private:
+    short* iValues() const;
+    short* qValues() const;
+    bool mirrored() const;
+    void copyIn(size_t pos, const short* xi, const short* xq, size_t count);
+    void copyOut(size_t pos, short* xi, short* xq, size_t count) const;
+    PlanarSpans spansAt(size_t pos, size_t count) const;
+
+    RingStorage iStorage;
+    RingStorage qStorage;
+    RingIndex index;  // One set of positions for both components
+};
+
+} // namespace sdrplay
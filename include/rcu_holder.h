@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace sdrplay {
+
+/**
+ * @brief Read-mostly value published through an atomically swapped pointer
+ *
+ * Readers take a ReadGuard, which costs two atomic increments and a pointer
+ * load and never blocks. Writers copy the current value, modify the copy,
+ * swap it in, and then wait until every reader that might still see the old
+ * value has released its guard before deleting it (read-copy-update).
+ *
+ * Readers are counted per epoch. A writer advances the epoch after the swap
+ * and waits for the previous epoch's count to drain; a reader that raced
+ * with the epoch change retries, so it never uses a value it was not counted
+ * for. Writers are serialised by a mutex that readers never touch.
+ *
+ * @tparam T Value type; must be copy-constructible
+ */
+template <typename T>
+class RcuHolder {
+public:
+    /**
+     * @brief Guard keeping the value it was taken on alive
+     */
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept : counter(other.counter), value(other.value) {
+            other.counter = nullptr;
+        }
+        ~ReadGuard() {
+            if (counter) {
+                counter->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+        const T& operator*() const { return *value; }
+        const T* operator->() const { return value; }
+
+    private:
+        friend class RcuHolder;
+        ReadGuard(std::atomic<uint64_t>* readerCount, const T* current)
+            : counter(readerCount), value(current) {}
+
+        std::atomic<uint64_t>* counter;
+        const T* value;
+    };
+
+    RcuHolder() : current(new T()), epoch(0) {
+        readers[0].store(0, std::memory_order_relaxed);
+        readers[1].store(0, std::memory_order_relaxed);
+    }
+
+    ~RcuHolder() {
+        delete current.load(std::memory_order_relaxed);
+    }
+
+    RcuHolder(const RcuHolder&) = delete;
+    RcuHolder& operator=(const RcuHolder&) = delete;
+
+    /**
+     * @brief Access the current value without blocking
+     *
+     * Must not be held while calling update() on the same holder from the
+     * same thread, which would wait for itself.
+     *
+     * @return ReadGuard Guard valid until destroyed
+     */
+    ReadGuard read() const {
+        for (;;) {
+            uint64_t e = epoch.load(std::memory_order_seq_cst);
+            std::atomic<uint64_t>& counter = readers[e & 1];
+            counter.fetch_add(1, std::memory_order_seq_cst);
+            if (epoch.load(std::memory_order_seq_cst) == e) {
+                return ReadGuard(&counter, current.load(std::memory_order_seq_cst));
+            }
+            // A writer advanced the epoch in between and may not wait for us
+            counter.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Replace the value with a modified copy
+     *
+     * Returns once no reader can still observe the old value.
+     *
+     * @param modify Called with the copy to modify before it is published
+     */
+    template <typename Modify>
+    void update(Modify modify) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        std::unique_ptr<T> next(new T(*current.load(std::memory_order_relaxed)));
+        modify(*next);
+        std::unique_ptr<T> previous(current.exchange(next.release(), std::memory_order_seq_cst));
+        waitForReaders();
+    }
+
+    /**
+     * @brief Wait until every reader that started before this call has finished
+     */
+    void synchronize() {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        waitForReaders();
+    }
+
+private:
+    void waitForReaders() {
+        uint64_t e = epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic<uint64_t>& counter = readers[e & 1];
+        while (counter.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    std::atomic<T*> current;
+    std::atomic<uint64_t> epoch;
+    mutable std::atomic<uint64_t> readers[2];
+    std::mutex writerMutex;
+};
+
+} // namespace sdrplay
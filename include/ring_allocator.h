@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace sdrplay {
+
+/**
+ * @brief Source of memory for standard-layout ring storage
+ *
+ * Lets applications control where sample buffers live, for example in huge
+ * pages or on a particular NUMA node. Mirrored storage is mapped from a
+ * memfd and does not go through the allocator.
+ *
+ * Implementations must be thread-safe; one allocator may back several
+ * buffers.
+ */
+class RingAllocator {
+public:
+    virtual ~RingAllocator() = default;
+
+    /**
+     * @brief Allocate zero-filled memory
+     *
+     * @param bytes Size in bytes
+     * @return void* Block aligned to at least RingStorage::ALIGNMENT, or nullptr on failure
+     */
+    virtual void* allocate(size_t bytes) = 0;
+
+    /**
+     * @brief Release a block returned by allocate()
+     *
+     * @param block Block to release
+     * @param bytes Size passed to allocate()
+     */
+    virtual void deallocate(void* block, size_t bytes) = 0;
+
+    /**
+     * @brief Get a short name for diagnostics
+     */
+    virtual const char* name() const = 0;
+};
+
+/**
+ * @brief Default allocator: cache-line-aligned blocks from the C heap
+ */
+class HeapRingAllocator : public RingAllocator {
+public:
+    void* allocate(size_t bytes) override;
+    void deallocate(void* block, size_t bytes) override;
+    const char* name() const override { return "heap"; }
+
+    /**
+     * @brief Get the shared default instance
+     */
+    static std::shared_ptr<RingAllocator> instance();
+};
+
+/**
+ * @brief What kind of huge pages HugePageRingAllocator asks for
+ */
+enum class HugePageMode {
+    Transparent,  // 2 MB-aligned mapping with MADV_HUGEPAGE; the kernel backs it when it can
+    Explicit      // MAP_HUGETLB from the reserved hugetlbfs pool, falling back to Transparent
+};
+
+/**
+ * @brief Where a HugePageRingAllocator block ended up
+ */
+struct HugePageAllocation {
+    bool explicitHugePages{false};  // Came from the hugetlbfs pool
+    bool transparent{false};        // Advised for transparent huge pages
+    int numaNode{-1};               // Node the memory is bound to, -1 if unbound
+
+    HugePageAllocation() = default;
+};
+
+/**
+ * @brief Allocator that backs buffers with 2 MB pages on a chosen NUMA node
+ *
+ * A 64M-sample buffer spans 65536 4 KB pages but only 128 huge pages,
+ * which takes TLB misses off the consumer's hot loop. Sizes are rounded up
+ * to whole huge pages. Memory can be bound to a NUMA node, by default the
+ * node of the thread that allocates it (the one starting the stream, which
+ * is normally the consumer), so reads never cross the interconnect.
+ *
+ * Linux only; elsewhere it behaves like HeapRingAllocator.
+ */
+class HugePageRingAllocator : public RingAllocator {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+    static constexpr int NO_NODE = -1;       // Leave placement to the kernel
+    static constexpr int CURRENT_NODE = -2;  // Node of the allocating thread
+
+    /**
+     * @brief Construct a huge page allocator
+     *
+     * @param mode Transparent or explicit huge pages
+     * @param numaNode Node to bind to, NO_NODE or CURRENT_NODE
+     */
+    explicit HugePageRingAllocator(HugePageMode mode = HugePageMode::Transparent,
+                                   int numaNode = CURRENT_NODE);
+
+    void* allocate(size_t bytes) override;
+    void deallocate(void* block, size_t bytes) override;
+    const char* name() const override { return "huge-page"; }
+
+    /**
+     * @brief Get how the most recent allocation was satisfied
+     */
+    HugePageAllocation lastAllocation() const;
+
+    /**
+     * @brief Get the NUMA node the calling thread is running on
+     *
+     * @return int Node number, or -1 if unknown
+     */
+    static int currentNode();
+
+private:
+    static size_t roundUp(size_t bytes);
+
+    HugePageMode mode;
+    int numaNode;
+    mutable std::mutex statusMutex;
+    HugePageAllocation last;
+};
+
+} // namespace sdrplay
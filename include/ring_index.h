@@ -0,0 +1,277 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include "ring_storage.h"
+#include "wait_strategy.h"
+
+namespace sdrplay {
+
+/**
+ * @brief What a full buffer does with samples that do not fit
+ */
+enum class OverflowPolicy {
+    DropNewest,        // Keep buffered data, discard the part of the packet that does not fit
+    DropOldest,        // Overwrite the oldest unread samples (including peeked ones) to make room
+    BlockWithTimeout   // Wait for the consumer to make room, then drop newest on timeout
+};
+
+/**
+ * @brief Positions, overflow handling and waiting for a single-producer/single-consumer ring
+ *
+ * Everything a ring buffer does apart from moving the data: SampleBuffer
+ * and PlanarBuffer own their storage and copy in and out of it, and leave
+ * deciding where, how much and when to this class. Positions increase
+ * monotonically and are masked on access, so tail - head is always the
+ * fill level and the full capacity is usable.
+ *
+ * Producer side: beginWrite(), copy, endWrite(). Consumer side:
+ * beginRead(), copy, endRead(), or peek() and consume().
+ */
+class RingIndex {
+public:
+    /**
+     * @brief Slots the producer may fill, as decided by the overflow policy
+     */
+    struct WriteRange {
+        size_t pos;    // Stream position of the first slot
+        size_t skip;   // Leading samples of the packet to skip (dropped)
+        size_t count;  // Samples to copy after skipping
+        size_t lost;   // Samples dropped in total, including skipped ones
+    };
+
+    /**
+     * @brief Round up to the next power of two
+     *
+     * @param size Value to round (0 gives 1)
+     * @return size_t Smallest power of two not below size
+     */
+    static size_t roundUpToPowerOfTwo(size_t size);
+
+    /**
+     * @brief Get the capacity a ring of the given size and layout needs
+     *
+     * Rounds up to a power of two, and for mirrored storage to at least one
+     * mirroring granule of elements.
+     *
+     * @param size Requested number of elements
+     * @param layout Storage layout
+     * @param elementSize Size of one element in bytes
+     * @return size_t Capacity in elements
+     */
+    static size_t capacityFor(size_t size, RingLayout layout, size_t elementSize);
+
+    /**
+     * @brief Construct an empty index
+     *
+     * @param capacity Capacity in elements; must be a power of two
+     */
+    explicit RingIndex(size_t capacity);
+
+    RingIndex(const RingIndex&) = delete;
+    RingIndex& operator=(const RingIndex&) = delete;
+
+    /**
+     * @brief Change the capacity and clear positions and overflow counters
+     *
+     * Must not be called while a producer or consumer is active.
+     *
+     * @param capacity Capacity in elements; must be a power of two
+     */
+    void resize(size_t capacity);
+
+    /**
+     * @brief Claim slots for a packet, applying the overflow policy
+     *
+     * May discard unread samples (DropOldest) or wait for the consumer
+     * (BlockWithTimeout). Producer only.
+     *
+     * @param count Number of samples in the packet
+     * @return WriteRange Where to copy which part of the packet
+     */
+    WriteRange beginWrite(size_t count);
+
+    /**
+     * @brief Publish the slots filled after beginWrite() and count drops
+     *
+     * @param range Range returned by beginWrite()
+     * @return true if no samples were dropped
+     */
+    bool endWrite(const WriteRange& range);
+
+    /**
+     * @brief Find the samples a copying read can take
+     *
+     * Invalidates any outstanding peek. Consumer only.
+     *
+     * @param maxCount Maximum number of samples
+     * @param pos Set to the stream position of the first sample
+     * @return size_t Number of samples readable from pos
+     */
+    size_t beginRead(size_t maxCount, size_t& pos);
+
+    /**
+     * @brief Release samples copied after beginRead()
+     *
+     * @param pos Position returned by beginRead()
+     * @param count Number of samples copied
+     * @return true if the copy is valid; false if a reset or DropOldest
+     *         overwrite discarded the samples while they were copied
+     */
+    bool endRead(size_t pos, size_t count);
+
+    /**
+     * @brief Find readable samples for in-place access and remember them for consume()
+     *
+     * @param maxCount Maximum number of samples
+     * @param pos Set to the stream position of the first sample
+     * @return size_t Number of samples readable from pos
+     */
+    size_t peek(size_t maxCount, size_t& pos);
+
+    /**
+     * @brief Release samples found by the last peek()
+     *
+     * @param count Number of samples to release (clamped to the last peek)
+     * @return size_t Samples released; 0 if a reset or overwrite discarded the peeked data
+     */
+    size_t consume(size_t count);
+
+    /**
+     * @brief Get the offset of a stream position inside storage
+     */
+    size_t offset(size_t pos) const { return pos & mask; }
+
+    /**
+     * @brief Get how many of count samples from pos lie before the end of storage
+     *
+     * @param pos Stream position
+     * @param count Number of samples
+     * @param mirrored Whether the storage is mirrored (then all of them do)
+     * @return size_t Length of the first contiguous segment
+     */
+    size_t firstSegment(size_t pos, size_t count, bool mirrored) const {
+        return mirrored ? count : std::min(count, bufferSize - offset(pos));
+    }
+
+    /**
+     * @brief Wait for samples to be available
+     *
+     * @param count Number of samples to wait for (clamped to capacity)
+     * @param timeoutMs Timeout in milliseconds (0 = no timeout)
+     * @return true if samples are available, false on timeout
+     */
+    bool waitForSamples(size_t count, unsigned int timeoutMs = 0);
+
+    /**
+     * @brief Set how waitForSamples() waits
+     *
+     * @param strategy Wait strategy
+     * @param spinUs Spin budget before sleeping, for SpinThenBlock
+     */
+    void setWaitStrategy(WaitStrategy strategy, unsigned int spinUs = 50);
+
+    /**
+     * @brief Get the wait strategy
+     */
+    WaitStrategy getWaitStrategy() const;
+
+    /**
+     * @brief Get number of samples available for reading
+     */
+    size_t available() const;
+
+    /**
+     * @brief Get the stream position of the next sample to be read
+     */
+    uint64_t readIndex() const;
+
+    /**
+     * @brief Get the stream position the next written sample will receive
+     */
+    uint64_t writeIndex() const;
+
+    /**
+     * @brief Check if an overflow occurred since the last reset
+     */
+    bool overflow() const;
+
+    /**
+     * @brief Set the overflow policy
+     *
+     * @param policy Policy applied by beginWrite() when the ring is full
+     * @param blockTimeoutMs Maximum wait for BlockWithTimeout
+     */
+    void setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs = 10);
+
+    /**
+     * @brief Get the overflow policy
+     */
+    OverflowPolicy getOverflowPolicy() const;
+
+    /**
+     * @brief Get the total number of samples dropped by overflows
+     */
+    uint64_t droppedSamples() const;
+
+    /**
+     * @brief Get the number of overflow episodes
+     */
+    uint64_t overflowEvents() const;
+
+    /**
+     * @brief Discard all unread samples; safe to call from either side
+     */
+    void reset();
+
+    /**
+     * @brief Get the capacity in elements
+     *
+     * Safe to call from any thread, also while resize() runs.
+     */
+    size_t capacity() const { return publishedCapacity.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    void notifyWaiters();
+    void notifySpace();
+    bool waitForSpace(size_t count, unsigned int timeoutMs);
+    size_t discardOldest(size_t t, size_t count);
+    void recordOverflow(size_t dropped);
+
+    size_t bufferSize;
+    size_t mask;
+    std::atomic<size_t> publishedCapacity;  // bufferSize for threads outside the data path
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;   // Next sample to read
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;   // Next slot to write
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> overflowed;
+    std::atomic<unsigned int> waiters;
+    std::atomic<unsigned int> spaceWaiters;
+    WaitEvent dataEvent;                      // Sleep/wake for SpinThenBlock
+    std::atomic<WaitStrategy> waitStrategy;
+    std::atomic<unsigned int> spinBudgetUs;
+
+    // Overflow handling and accounting
+    std::atomic<OverflowPolicy> overflowPolicy;
+    std::atomic<unsigned int> blockTimeoutMs;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> overflowEpisodes;
+    bool inOverflow;  // Producer-only: previous write also dropped samples
+
+    // Consumer-side record of the last peek(), checked by consume()
+    size_t peekPos;
+    size_t peekCount;
+
+    // Only used to park threads in waitForSamples/waitForSpace; never taken
+    // on the data path unless the other side has registered a waiter.
+    std::mutex waitMutex;
+    std::condition_variable dataAvailable;
+    std::condition_variable spaceAvailable;
+};
+
+} // namespace sdrplay
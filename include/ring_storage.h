@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include "ring_allocator.h"
+
+namespace sdrplay {
+
+/**
+ * @brief Memory layout of ring buffer storage
+ */
+enum class RingLayout {
+    Standard,   // Single allocation; wrapped regions are split in two
+    Mirrored    // Same pages mapped twice back to back; every region is contiguous
+};
+
+/**
+ * @brief Raw backing memory for a ring buffer
+ *
+ * In mirrored layout the storage is mapped a second time directly after
+ * itself, so data()[i] and data()[i + size()] alias the same byte and any
+ * run of up to size() bytes starting inside the first copy is contiguous.
+ * Mirroring needs a page-multiple size and OS support (memfd on Linux); if
+ * either is missing the storage silently falls back to Standard, which
+ * callers can detect with mirrored(). Standard storage comes from a
+ * RingAllocator, the C heap unless another is given.
+ */
+class RingStorage {
+public:
+    /**
+     * @brief Alignment of data() in bytes (mirrored storage is page aligned)
+     *
+     * A whole cache line, so SIMD loads from the start of the storage never
+     * split a line.
+     */
+    static constexpr size_t ALIGNMENT = 64;
+
+    /**
+     * @brief Allocate ring storage
+     *
+     * @param bytes Requested size in bytes
+     * @param layout Requested layout
+     * @param allocator Memory source for standard layout (nullptr = heap)
+     */
+    RingStorage(size_t bytes, RingLayout layout = RingLayout::Standard,
+                std::shared_ptr<RingAllocator> allocator = nullptr);
+    ~RingStorage();
+
+    RingStorage(const RingStorage&) = delete;
+    RingStorage& operator=(const RingStorage&) = delete;
+    RingStorage(RingStorage&& other) noexcept;
+    RingStorage& operator=(RingStorage&& other) noexcept;
+
+    /**
+     * @brief Get the start of the storage
+     */
+    void* data() const { return base; }
+
+    /**
+     * @brief Get the size of one copy of the storage in bytes
+     */
+    size_t size() const { return bytes; }
+
+    /**
+     * @brief Check whether the storage is mirrored
+     */
+    bool mirrored() const { return isMirrored; }
+
+    /**
+     * @brief Get the granularity mirrored storage sizes must be a multiple of
+     */
+    static size_t mirrorGranularity();
+
+    /**
+     * @brief Lock the storage (both views if mirrored) into RAM
+     *
+     * Locked pages are resident and mapped, so accesses never page-fault.
+     *
+     * @return true on success; on failure errno describes the reason
+     */
+    bool lock();
+
+    /**
+     * @brief Undo lock()
+     */
+    void unlock();
+
+    /**
+     * @brief Check whether the storage is locked into RAM
+     */
+    bool locked() const { return isLocked; }
+
+    /**
+     * @brief Populate every page for writing without changing its contents
+     *
+     * Avoids first-touch faults when locking is not permitted; the pages
+     * can still be reclaimed under memory pressure. Safe while the ring is
+     * in use. Needs Linux 5.14 or later.
+     *
+     * @return true on success; on failure errno describes the reason
+     */
+    bool prefault();
+
+private:
+    bool mapMirrored(size_t size);
+    void release();
+    size_t mappedBytes() const;
+
+    void* base;
+    std::shared_ptr<RingAllocator> allocator;  // Owner of base in standard layout
+    size_t bytes;
+    bool isMirrored;
+    bool isLocked;
+};
+
+} // namespace sdrplay
@@ -0,0 +1,252 @@
+#pragma once
+#include <complex>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "ring_index.h"
+#include "ring_storage.h"
+#include "wait_strategy.h"
+
+namespace sdrplay {
+
+/**
+ * @brief Contiguous run of samples inside ring storage
+ */
+struct SampleSpan {
+    const std::complex<short>* data;  // First sample, nullptr if empty
+    size_t size;                      // Number of samples
+
+    SampleSpan() : data(nullptr), size(0) {}
+    SampleSpan(const std::complex<short>* d, size_t n) : data(d), size(n) {}
+};
+
+/**
+ * @brief Readable region of a ring buffer
+ *
+ * A region that wraps around the end of storage is split in two; otherwise
+ * second is empty.
+ */
+struct SampleSpans {
+    SampleSpan first;
+    SampleSpan second;
+
+    size_t size() const { return first.size + second.size; }
+    bool empty() const { return size() == 0; }
+};
+
+/**
+ * @brief Buffer for streaming samples
+ *
+ * Lock-free single-producer/single-consumer circular buffer for IQ samples.
+ * The SDRplay API stream thread is the only writer and a single consumer
+ * thread reads; neither side takes a lock on the data path. Capacity is
+ * rounded up to a power of two so positions wrap with a mask, and wrapped
+ * transfers are done as at most two memcpy segments. Positions and overflow
+ * handling live in RingIndex; this class owns the storage and the copies.
+ *
+ * With RingLayout::Mirrored the storage is mapped twice back to back, so
+ * every transfer and every peek() is a single contiguous region.
+ */
+class SampleBuffer {
+public:
+    /**
+     * @brief Construct a new Sample Buffer object
+     *
+     * @param size Buffer size in number of complex samples (rounded up to a power of two)
+     * @param layout Storage layout; Mirrored falls back to Standard if unavailable
+     * @param allocator Memory for standard layout (nullptr = heap)
+     */
+    SampleBuffer(size_t size, RingLayout layout = RingLayout::Standard,
+                 std::shared_ptr<RingAllocator> allocator = nullptr);
+
+    /**
+     * @brief Reallocate storage with a new size and layout
+     *
+     * Discards all buffered samples. Must not be called while a producer or
+     * consumer is active.
+     *
+     * @param size Buffer size in number of complex samples
+     * @param layout Storage layout
+     * @param allocator Memory for standard layout (nullptr = heap)
+     */
+    void reconfigure(size_t size, RingLayout layout,
+                     std::shared_ptr<RingAllocator> allocator = nullptr);
+
+    /**
+     * @brief Write samples to buffer
+     *
+     * Must only be called from the producer thread. When the samples do not
+     * fit, the overflow policy decides which ones are dropped; every dropped
+     * sample is counted.
+     *
+     * @param data Complex sample data to write
+     * @param count Number of samples to write
+     * @return true if all samples were stored, false if any were dropped
+     */
+    bool write(const std::complex<short>* data, size_t count);
+
+    /**
+     * @brief Read samples from buffer
+     *
+     * Must only be called from the consumer thread.
+     *
+     * @param dest Destination buffer
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t read(std::complex<short>* dest, size_t maxCount);
+
+    /**
+     * @brief Access readable samples in place without copying
+     *
+     * The returned spans point straight into ring storage and stay valid
+     * until they are released with consume() or the buffer is reset. Must
+     * only be called from the consumer thread.
+     *
+     * @param maxCount Maximum number of samples to expose
+     * @return SampleSpans Up to two spans covering the readable samples
+     */
+    SampleSpans peek(size_t maxCount);
+
+    /**
+     * @brief Release samples previously returned by peek()
+     *
+     * @param count Number of samples to release (clamped to the last peek)
+     * @return size_t Samples released; 0 if a reset discarded the peeked data
+     */
+    size_t consume(size_t count);
+
+    /**
+     * @brief Wait for samples to be available
+     *
+     * @param count Number of samples to wait for (clamped to capacity)
+     * @param timeoutMs Timeout in milliseconds (0 = no timeout)
+     * @return true if samples are available, false on timeout
+     */
+    bool waitForSamples(size_t count, unsigned int timeoutMs = 0);
+
+    /**
+     * @brief Set how waitForSamples() waits
+     *
+     * The producer wakes sleepers of every strategy, so this may be changed
+     * at any time.
+     *
+     * @param strategy Wait strategy
+     * @param spinUs Spin budget before sleeping, for SpinThenBlock
+     */
+    void setWaitStrategy(WaitStrategy strategy, unsigned int spinUs = 50);
+
+    /**
+     * @brief Get the wait strategy
+     */
+    WaitStrategy getWaitStrategy() const;
+
+    /**
+     * @brief Get number of samples available for reading
+     *
+     * @return size_t Number of samples available
+     */
+    size_t available() const;
+
+    /**
+     * @brief Get the stream index of the next sample to be read
+     *
+     * Stream indices count every sample ever stored in the buffer and never
+     * go backwards, so they can be matched against StreamTag::sampleIndex.
+     *
+     * @return uint64_t Index of the first sample read() or peek() returns next
+     */
+    uint64_t readIndex() const;
+
+    /**
+     * @brief Get the stream index the next written sample will receive
+     *
+     * @return uint64_t Total number of samples stored so far
+     */
+    uint64_t writeIndex() const;
+
+    /**
+     * @brief Check if buffer overflow occurred
+     *
+     * @return true if overflow occurred since the last reset
+     */
+    bool overflow() const;
+
+    /**
+     * @brief Set the overflow policy
+     *
+     * @param policy Policy applied by write() when the buffer is full
+     * @param blockTimeoutMs Maximum wait for BlockWithTimeout
+     */
+    void setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs = 10);
+
+    /**
+     * @brief Get the overflow policy
+     */
+    OverflowPolicy getOverflowPolicy() const;
+
+    /**
+     * @brief Get the total number of samples dropped by overflows
+     *
+     * @return uint64_t Dropped samples since construction or reconfigure()
+     */
+    uint64_t droppedSamples() const;
+
+    /**
+     * @brief Get the number of overflow episodes
+     *
+     * An episode is a run of consecutive writes that each dropped samples.
+     *
+     * @return uint64_t Overflow episodes since construction or reconfigure()
+     */
+    uint64_t overflowEvents() const;
+
+    /**
+     * @brief Reset buffer state
+     *
+     * Discards all unread samples. Safe to call from either side.
+     */
+    void reset();
+
+    /**
+     * @brief Get buffer capacity
+     *
+     * @return size_t Buffer capacity in samples
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Lock the storage into RAM, or unlock it
+     *
+     * Reallocating the storage drops the lock.
+     *
+     * @param lock true to lock, false to unlock
+     * @return true on success; on failure errno describes the reason
+     */
+    bool lockMemory(bool lock = true);
+
+    /**
+     * @brief Populate the storage pages without changing their contents
+     *
+     * @return true on success; on failure errno describes the reason
+     */
+    bool prefaultMemory();
+
+    /**
+     * @brief Get the storage layout actually in use
+     *
+     * @return RingLayout Mirrored only if the double mapping succeeded
+     */
+    RingLayout layout() const;
+
+private:
+    std::complex<short>* samples() const;
+    void copyIn(size_t pos, const std::complex<short>* src, size_t count);
+    void copyOut(size_t pos, std::complex<short>* dest, size_t count) const;
+    SampleSpans spansAt(size_t pos, size_t count) const;
+
+    RingStorage storage;
+    RingIndex index;  // Positions, overflow policy and waiting
+};
+
+} // namespace sdrplay
@@ -0,0 +1,161 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+namespace sdrplay {
+
+/**
+ * @brief Instruction set used by the sample conversion kernels
+ */
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+/**
+ * @brief Sample format delivered to readers and callbacks
+ *
+ * The API delivers 16-bit I/Q; every other format is converted from it.
+ * The 8-bit formats keep the top byte of each component and are laid out
+ * as interleaved I/Q pairs, two bytes per sample.
+ */
+enum class SampleFormat {
+    CS16,  // std::complex<short>, as delivered by the API
+    CF32,  // std::complex<float>, scaled to [-1.0, 1.0)
+    CS8,   // Signed 8-bit I/Q pairs
+    CU8    // Unsigned 8-bit I/Q pairs offset by 128 (RTL-SDR layout)
+};
+
+/**
+ * @brief Scale that maps full-scale 16-bit samples to [-1.0, 1.0)
+ */
+constexpr float CF32_SCALE = 1.0f / 32768.0f;
+
+/**
+ * @brief Get the size of one complex sample in a format
+ *
+ * @param format Sample format
+ * @return size_t Bytes per I/Q sample
+ */
+size_t sampleFormatSize(SampleFormat format);
+
+/**
+ * @brief Get a printable name for a sample format
+ */
+const char* sampleFormatName(SampleFormat format);
+
+/**
+ * @brief Get the best instruction set supported by this CPU
+ *
+ * Detected once at runtime and cached.
+ *
+ * @return SimdLevel Level used by the dispatching kernels
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * @brief Check whether a kernel for the given level is available
+ *
+ * @param level Instruction set to check
+ * @return true if the kernel is compiled in and the CPU supports it
+ */
+bool isSimdLevelSupported(SimdLevel level);
+
+/**
+ * @brief Get a printable name for a SIMD level
+ */
+const char* simdLevelName(SimdLevel level);
+
+/**
+ * @brief Interleave separate I and Q arrays into complex samples
+ *
+ * Uses the kernel selected by detectSimdLevel(). All kernels produce
+ * bit-identical output.
+ *
+ * @param xi I samples
+ * @param xq Q samples
+ * @param dest Destination for count complex samples
+ * @param count Number of samples
+ */
+void interleaveIQ(const short* xi, const short* xq, std::complex<short>* dest, size_t count);
+
+/**
+ * @brief Interleave using a specific kernel
+ *
+ * Falls back to the scalar kernel if the level is not supported.
+ *
+ * @param level Kernel to use
+ * @param xi I samples
+ * @param xq Q samples
+ * @param dest Destination for count complex samples
+ * @param count Number of samples
+ */
+void interleaveIQ(SimdLevel level, const short* xi, const short* xq,
+                  std::complex<short>* dest, size_t count);
+
+/**
+ * @brief Convert 16-bit samples to scaled floats
+ *
+ * Uses the kernel selected by detectSimdLevel(). All kernels produce
+ * bit-identical output.
+ *
+ * @param src Source samples
+ * @param dest Destination for count samples
+ * @param count Number of samples
+ * @param scale Factor applied to each component
+ */
+void convertToCF32(const std::complex<short>* src, std::complex<float>* dest, size_t count,
+                   float scale = CF32_SCALE);
+
+/**
+ * @brief Convert 16-bit samples to signed 8-bit I/Q pairs
+ *
+ * @param src Source samples
+ * @param dest Destination for 2 * count bytes
+ * @param count Number of samples
+ */
+void convertToCS8(const std::complex<short>* src, int8_t* dest, size_t count);
+
+/**
+ * @brief Convert 16-bit samples to unsigned 8-bit I/Q pairs
+ *
+ * @param src Source samples
+ * @param dest Destination for 2 * count bytes
+ * @param count Number of samples
+ */
+void convertToCU8(const std::complex<short>* src, uint8_t* dest, size_t count);
+
+/**
+ * @brief Convert 16-bit samples to any sample format
+ *
+ * CF32 uses CF32_SCALE; CS16 is a plain copy.
+ *
+ * @param format Destination format
+ * @param src Source samples
+ * @param dest Destination for count * sampleFormatSize(format) bytes
+ * @param count Number of samples
+ */
+void convertSamples(SampleFormat format, const std::complex<short>* src, void* dest, size_t count);
+
+/**
+ * @brief Convert to floats using a specific kernel
+ *
+ * Falls back to the scalar kernel if the level is not supported.
+ */
+void convertToCF32(SimdLevel level, const std::complex<short>* src, std::complex<float>* dest,
+                   size_t count, float scale = CF32_SCALE);
+
+/**
+ * @brief Convert to signed 8-bit using a specific kernel
+ */
+void convertToCS8(SimdLevel level, const std::complex<short>* src, int8_t* dest, size_t count);
+
+/**
+ * @brief Convert to unsigned 8-bit using a specific kernel
+ */
+void convertToCU8(SimdLevel level, const std::complex<short>* src, uint8_t* dest, size_t count);
+
+} // namespace sdrplay
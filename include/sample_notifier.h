@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace sdrplay {
+
+/**
+ * @brief Pollable file descriptor signalled when samples reach a low-watermark
+ *
+ * Lets one thread wait on several devices, sockets and timers with
+ * poll/epoll/select instead of one waitForSamples() call per buffer. On
+ * Linux the descriptor is an eventfd; other POSIX systems use a pipe.
+ * Where neither exists, enable() returns -1.
+ *
+ * Wakeups are coalesced: the descriptor is signalled once when the buffered
+ * sample count reaches the watermark and stays readable until clear() is
+ * called, however many packets arrive in between. The consumer clears it
+ * and then re-checks the fill level, which re-signals if the watermark is
+ * still met, so no crossing is lost.
+ */
+class SampleNotifier {
+public:
+    SampleNotifier();
+    ~SampleNotifier();
+
+    SampleNotifier(const SampleNotifier&) = delete;
+    SampleNotifier& operator=(const SampleNotifier&) = delete;
+
+    /**
+     * @brief Create the descriptor if needed and set the watermark
+     *
+     * Safe to call while the producer is running. The descriptor stays
+     * the same for the lifetime of the notifier.
+     *
+     * @param lowWatermark Samples that must be buffered to signal (at least 1)
+     * @return int Readable descriptor, or -1 if unsupported or creation failed
+     */
+    int enable(size_t lowWatermark);
+
+    /**
+     * @brief Stop signalling; the descriptor stays open
+     */
+    void disable();
+
+    /**
+     * @brief Check whether the producer should report its fill level
+     */
+    bool enabled() const {
+        return watermark.load(std::memory_order_relaxed) != 0;
+    }
+
+    /**
+     * @brief Get the pollable descriptor
+     *
+     * @return int Descriptor, or -1 if never enabled
+     */
+    int fd() const;
+
+    /**
+     * @brief Get the current watermark
+     *
+     * @return size_t Samples needed to signal, 0 if disabled
+     */
+    size_t lowWatermark() const;
+
+    /**
+     * @brief Report the fill level after new samples were stored
+     *
+     * Signals the descriptor if the watermark is met and it is not already
+     * signalled. Called by the producer; never blocks.
+     *
+     * @param available Samples currently buffered
+     */
+    void update(size_t available);
+
+    /**
+     * @brief Drain the descriptor and re-arm it
+     *
+     * Call update() with a fresh fill level afterwards to catch samples
+     * that arrived while the descriptor was signalled.
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of times the descriptor was signalled
+     *
+     * @return uint64_t Threshold crossings since construction
+     */
+    uint64_t signalCount() const;
+
+private:
+    void signal();
+    void drain();
+
+    int readFd;
+    int writeFd;
+    std::atomic<size_t> watermark;   // 0 while disabled
+    std::atomic<bool> signalled;     // Descriptor is readable and not yet cleared
+    std::atomic<uint64_t> signals;
+    std::mutex enableMutex;          // Serialises descriptor creation
+};
+
+} // namespace sdrplay
@@ -0,0 +1,135 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace sdrplay {
+
+/**
+ * @brief Synthetic signal the simulated device streams
+ */
+enum class SimulatedSignal {
+    Tone,   // Complex tone at frequencyOffsetHz from the tuned frequency
+    Noise,  // Complex Gaussian noise with RMS amplitude per component
+    FM,     // Tone frequency-modulated by a sine at fmRateHz
+    Burst   // Tone switched on for burstDuty of every burstPeriodMs
+};
+
+/**
+ * @brief Configuration of the simulated sdrplay_api backend
+ *
+ * The device list is read by sdrplay_api_GetDevices; waveform and packet
+ * settings are read when a stream starts, so running streams keep theirs.
+ */
+struct SimulatorConfig {
+    unsigned int deviceCount;     // Devices reported by sdrplay_api_GetDevices (1-SDRPLAY_MAX_DEVICES)
+    unsigned char hwVer;          // Hardware version reported for every device
+    std::string serialPrefix;     // Serial numbers are the prefix plus the device index
+    unsigned int packetSamples;   // Samples per stream callback
+    bool realTime;                // Pace packets at the sample rate; false = as fast as possible
+    SimulatedSignal signal;       // Waveform to generate
+    double frequencyOffsetHz;     // Tone/carrier offset from the tuned frequency
+    double amplitude;             // Signal amplitude as a fraction of full scale
+    double noiseAmplitude;        // RMS noise added to every waveform, fraction of full scale
+    double fmDeviationHz;         // Peak deviation for SimulatedSignal::FM
+    double fmRateHz;              // Modulating frequency for SimulatedSignal::FM
+    double burstPeriodMs;         // Burst repetition period for SimulatedSignal::Burst
+    double burstDuty;             // Fraction of the period a burst is on
+    uint64_t seed;                // Noise generator seed; equal seeds give equal streams
+
+    SimulatorConfig() : deviceCount(1), hwVer(255), serialPrefix("SIM"), packetSamples(1008),
+                        realTime(true), signal(SimulatedSignal::Tone), frequencyOffsetHz(100e3),
+                        amplitude(0.5), noiseAmplitude(0.01), fmDeviationHz(75e3), fmRateHz(1e3),
+                        burstPeriodMs(10.0), burstDuty(0.1), seed(1) {}
+};
+
+/**
+ * @brief Counters of one simulated device
+ */
+struct SimulatorStats {
+    bool streaming;              // Between sdrplay_api_Init and sdrplay_api_Uninit
+    double sampleRate;           // Effective output rate (fsHz over decimation)
+    uint64_t packets;            // Stream callbacks made
+    uint64_t samples;            // Samples delivered through stream callbacks
+    uint64_t droppedPackets;     // Packets skipped by injectDrop()
+    uint64_t droppedSamples;     // Samples in the skipped packets
+    uint64_t latePackets;        // Packets sent behind schedule because a callback ran long
+    uint64_t maxCallbackNs;      // Longest time spent inside a stream callback
+    uint64_t totalCallbackNs;    // Total time spent inside stream callbacks
+
+    SimulatorStats() : streaming(false), sampleRate(0.0), packets(0), samples(0), droppedPackets(0),
+                       droppedSamples(0), latePackets(0), maxCallbackNs(0), totalCallbackNs(0) {}
+};
+
+/**
+ * @brief Controls for the simulated sdrplay_api backend
+ *
+ * Only available when the library is built with SDRPLAY_SIMULATOR=ON, in
+ * which case the sdrplay_api_* functions are served by a simulator instead
+ * of the SDRplay service. Each selected device runs its own stream thread
+ * that calls StreamACbFn with synthetic samples at the configured rate, so
+ * Device can be exercised end to end without hardware.
+ *
+ * Injections are delivered with the next packet of a streaming device.
+ */
+class Simulator {
+public:
+    /**
+     * @brief Replace the simulator configuration
+     *
+     * @param config New configuration
+     */
+    static void configure(const SimulatorConfig& config);
+
+    /**
+     * @brief Get the simulator configuration
+     */
+    static SimulatorConfig getConfig();
+
+    /**
+     * @brief Skip packets as if the USB transfer lost them
+     *
+     * The sample counter keeps running, so the next packet's firstSampleNum jumps.
+     *
+     * @param packets Number of packets to drop
+     * @param device Index of the simulated device (its serial number suffix)
+     */
+    static void injectDrop(unsigned int packets = 1, unsigned int device = 0);
+
+    /**
+     * @brief Set the reset flag on the next packet
+     *
+     * @param device Index of the device
+     */
+    static void injectReset(unsigned int device = 0);
+
+    /**
+     * @brief Set change flags on the next packet
+     *
+     * @param grChanged Gain reduction changed
+     * @param rfChanged RF frequency changed
+     * @param fsChanged Sample rate changed
+     * @param device Index of the device
+     */
+    static void injectChange(bool grChanged, bool rfChanged, bool fsChanged, unsigned int device = 0);
+
+    /**
+     * @brief Raise a power overload event
+     *
+     * @param detected true for Overload_Detected, false for Overload_Corrected
+     * @param device Index of the device
+     */
+    static void injectPowerOverload(bool detected = true, unsigned int device = 0);
+
+    /**
+     * @brief Get the counters of a device
+     *
+     * @param device Index of the device
+     * @return SimulatorStats Counters since the device's stream was last started
+     */
+    static SimulatorStats getStats(unsigned int device = 0);
+
+private:
+    Simulator() = delete;
+};
+
+} // namespace sdrplay
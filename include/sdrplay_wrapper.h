@@ -5,6 +5,8 @@
 #include <complex>
 #include "device_types.h"
 #include "callback_wrapper.h"
+#include "streaming_params.h"
+#include "control_latency.h"
 
 namespace sdrplay {
 
@@ -113,6 +115,14 @@ public:
                        bool enableIqCorrection = true,
                        int decimationFactor = 1);
     
+    /**
+     * @brief Start streaming with full streaming configuration
+     * 
+     * @param params Streaming configuration parameters
+     * @return true if streaming started successfully
+     */
+    bool startStreaming(const StreamingParams& params);
+    
     /**
      * @brief Stop streaming from the device
      * 
@@ -134,6 +144,34 @@ public:
      */
     void setSampleCallback(std::function<void(const std::complex<short>*, size_t)> callback);
     
+    /**
+     * @brief Set callback for CF32 samples
+     * 
+     * Called while streaming with SampleFormat::CF32.
+     * 
+     * @param callback Function to call when samples are received
+     */
+    void setSampleCallback(std::function<void(const std::complex<float>*, size_t)> callback);
+    
+    /**
+     * @brief Set callback for CS8 samples (count I/Q pairs)
+     * 
+     * @param callback Function to call when samples are received
+     */
+    void setSampleCallback(std::function<void(const int8_t*, size_t)> callback);
+    
+    /**
+     * @brief Set callback for CU8 samples (count I/Q pairs)
+     * 
+     * @param callback Function to call when samples are received
+     */
+    void setSampleCallback(std::function<void(const uint8_t*, size_t)> callback);
+    
+    /**
+     * @brief Remove the sample callback
+     */
+    void setSampleCallback(std::nullptr_t);
+    
     /**
      * @brief Set callback for events
      * 
@@ -150,6 +188,28 @@ public:
      */
     bool waitForSamples(size_t count, unsigned int timeoutMs = 0);
     
+    /**
+     * @brief Get a pollable descriptor signalled at a sample low-watermark
+     * 
+     * Becomes readable once at least lowWatermark samples are buffered and
+     * stays readable until acknowledgeSampleEvent(). Lets one poll/epoll
+     * loop service several devices. May be called before streaming starts.
+     * 
+     * @param lowWatermark Samples that must be buffered to signal
+     * @return int Descriptor owned by the device, or -1 if unsupported
+     */
+    int enableSampleEvent(size_t lowWatermark);
+    
+    /**
+     * @brief Stop signalling the sample descriptor
+     */
+    void disableSampleEvent();
+    
+    /**
+     * @brief Drain and re-arm the sample descriptor after reading samples
+     */
+    void acknowledgeSampleEvent();
+    
     /**
      * @brief Read samples from the buffer
      * 
@@ -159,6 +219,140 @@ public:
      */
     size_t readSamples(std::complex<short>* buffer, size_t maxCount);
     
+    /**
+     * @brief Read samples converted to CF32 (scaled to [-1.0, 1.0))
+     * 
+     * @param buffer Destination buffer
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t readSamples(std::complex<float>* buffer, size_t maxCount);
+    
+    /**
+     * @brief Read samples converted to CS8 I/Q pairs
+     * 
+     * @param buffer Destination for 2 * maxCount bytes
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t readSamples(int8_t* buffer, size_t maxCount);
+    
+    /**
+     * @brief Read samples converted to CU8 I/Q pairs
+     * 
+     * @param buffer Destination for 2 * maxCount bytes
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t readSamples(uint8_t* buffer, size_t maxCount);
+    
+    /**
+     * @brief Access buffered samples in place without copying
+     * 
+     * The spans point straight into the sample buffer and remain valid
+     * until consumeSamples() is called. This avoids every copy between the
+     * API thread and the caller for large block sizes.
+     * 
+     * @param maxCount Maximum number of samples to expose
+     * @return SampleSpans Up to two contiguous spans (two when the data wraps)
+     */
+    SampleSpans peekSamples(size_t maxCount);
+    
+    /**
+     * @brief Read samples as separate I and Q arrays
+     * 
+     * Only available when streaming with planarStorage, which keeps I and
+     * Q in separate aligned arrays for kernels that work on one component.
+     * 
+     * @param xi Destination for I values
+     * @param xq Destination for Q values
+     * @param maxCount Maximum number of samples to read
+     * @return size_t Actual number of samples read
+     */
+    size_t readPlanar(short* xi, short* xq, size_t maxCount);
+    
+    /**
+     * @brief Access planar buffered samples in place without copying
+     * 
+     * @param maxCount Maximum number of samples to expose
+     * @return PlanarSpans Up to two spans (two when the data wraps), valid until consumeSamples()
+     */
+    PlanarSpans peekPlanar(size_t maxCount);
+    
+    /**
+     * @brief Release samples returned by peekSamples()
+     * 
+     * @param count Number of samples to release
+     * @return size_t Number of samples released
+     */
+    size_t consumeSamples(size_t count);
+    
+    /**
+     * @brief Register an additional independent reader of the sample stream
+     * 
+     * Lets several consumers (e.g. a recorder, a display and a demodulator)
+     * share one stream, each with its own cursor and overflow policy.
+     * 
+     * @param policy What the reader does when it falls a full buffer behind
+     * @return std::shared_ptr<BroadcastReader> Reader handle, or nullptr if unavailable
+     */
+    std::shared_ptr<BroadcastReader> addSampleReader(
+        ReaderOverflowPolicy policy = ReaderOverflowPolicy::DropOldest);
+    
+    /**
+     * @brief Publish the stream as pooled, reference-counted sample blocks
+     * 
+     * Every block consumer shares the same blocks instead of copying the
+     * samples; see CallbackWrapper::enableSampleBlocks().
+     * 
+     * @param blockCount Blocks in the pool
+     * @param blockSamples Samples per block
+     * @param allocator Memory for the blocks (nullptr = heap)
+     */
+    void enableSampleBlocks(size_t blockCount,
+                            size_t blockSamples = CallbackWrapper::DEFAULT_MAX_PACKET_SAMPLES,
+                            std::shared_ptr<RingAllocator> allocator = nullptr);
+    
+    /**
+     * @brief Stop publishing sample blocks
+     */
+    void disableSampleBlocks();
+    
+    /**
+     * @brief Add a consumer of the pooled sample blocks
+     * 
+     * @param consumer Function called on the stream thread with each block
+     * @return size_t Id for removeBlockConsumer(), 0 if unavailable
+     */
+    size_t addBlockConsumer(CallbackWrapper::BlockCallback consumer);
+    
+    /**
+     * @brief Remove a block consumer
+     * 
+     * @param id Id returned by addBlockConsumer()
+     */
+    void removeBlockConsumer(size_t id);
+    
+    /**
+     * @brief Get the stream index of the next sample readSamples()/peekSamples() returns
+     * 
+     * @return uint64_t Stream index, comparable with StreamTag::sampleIndex
+     */
+    uint64_t getReadIndex() const;
+    
+    /**
+     * @brief Get the packet tags overlapping a range of read samples
+     * 
+     * Each tag carries the packet's API sample number, gain/frequency/rate
+     * change flags and host arrival time, so settling samples after a
+     * retune can be located exactly.
+     * 
+     * @param startIndex Stream index of the first sample in the range
+     * @param count Number of samples in the range
+     * @return std::vector<StreamTag> Tags in stream order
+     */
+    std::vector<StreamTag> getStreamTags(uint64_t startIndex, size_t count) const;
+    
     /**
      * @brief Get number of samples available in buffer
      * 
@@ -173,6 +367,134 @@ public:
      */
     bool hasBufferOverflow() const;
     
+    /**
+     * @brief Set how waitForSamples() waits for the API thread
+     * 
+     * @param strategy Block, SpinThenBlock or BusyPoll
+     * @param spinUs Spin budget before sleeping, for SpinThenBlock
+     */
+    void setWaitStrategy(WaitStrategy strategy, unsigned int spinUs = 50);
+    
+    /**
+     * @brief Get the wait strategy used by waitForSamples()
+     * 
+     * @return WaitStrategy Current wait strategy
+     */
+    WaitStrategy getWaitStrategy() const;
+    
+    /**
+     * @brief Set the policy applied when the sample buffer is full
+     * 
+     * @param policy Overflow policy
+     * @param blockTimeoutMs Maximum wait on the API thread for BlockWithTimeout
+     */
+    void setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs = 10);
+    
+    /**
+     * @brief Get the policy applied when the sample buffer is full
+     * 
+     * @return OverflowPolicy Current overflow policy
+     */
+    OverflowPolicy getOverflowPolicy() const;
+    
+    /**
+     * @brief Get the number of samples lost to buffer overflows
+     * 
+     * @return uint64_t Dropped samples since streaming started
+     */
+    uint64_t getDroppedSampleCount() const;
+    
+    /**
+     * @brief Get the number of buffer overflow episodes
+     * 
+     * @return uint64_t Runs of consecutive packets that lost samples
+     */
+    uint64_t getOverflowEventCount() const;
+    
+    /**
+     * @brief Get the number of samples the API failed to deliver
+     * 
+     * Detected from jumps in the packet sample counter (firstSampleNum).
+     * 
+     * @return uint64_t Missing samples since streaming started
+     */
+    uint64_t getMissingSampleCount() const;
+    
+    /**
+     * @brief Get the number of discontinuities in the packet sample counter
+     * 
+     * @return uint64_t Gaps detected since streaming started
+     */
+    uint64_t getGapEventCount() const;
+    
+    /**
+     * @brief Get lag metrics of the callback dispatcher
+     * 
+     * Only meaningful when streaming with CallbackMode::Dispatcher.
+     * 
+     * @return DispatcherStats Dispatcher metrics
+     */
+    DispatcherStats getDispatcherStats() const;
+    
+    /**
+     * @brief Get usage counters of the sample block pool
+     * 
+     * @return BlockPoolStats Pool counters, all zero if blocks are not enabled
+     */
+    BlockPoolStats getBlockPoolStats() const;
+    
+    /**
+     * @brief Get a snapshot of the stream's rate, timing, fill and loss counters
+     * 
+     * Cheap enough to poll from a monitoring thread while streaming.
+     * 
+     * @return StreamStats Counters since streaming last started
+     */
+    StreamStats getStreamStats() const;
+    
+    /**
+     * @brief Get the number of device events received of one type
+     * 
+     * @param type Event type
+     * @return uint64_t Events received since the device was selected
+     */
+    uint64_t getEventCount(EventType type) const;
+    
+    /**
+     * @brief Get how long sdrplay_api_Init, Uninit or Update calls took
+     * 
+     * @param op Control call to summarise
+     * @return ControlLatencyStats Latencies since the device was selected
+     */
+    ControlLatencyStats getControlLatency(ControlOperation op) const;
+    
+    /**
+     * @brief Pin and prioritise wrapper-owned threads and lock the sample buffers
+     * 
+     * Affinity and SCHED_FIFO priority apply to the callback dispatcher;
+     * memory locking applies to the sample buffers. Settings are re-applied
+     * when streaming starts. Missing permissions do not fail the call; the
+     * returned status lists what could not be applied.
+     * 
+     * @param policy Settings to apply
+     * @return ThreadPolicyStatus What was applied and what failed
+     */
+    ThreadPolicyStatus setThreadPolicy(const ThreadPolicy& policy);
+    
+    /**
+     * @brief Get what the current thread policy achieved
+     * 
+     * @return ThreadPolicyStatus Applied settings and failures
+     */
+    ThreadPolicyStatus getThreadPolicyStatus() const;
+    
+    /**
+     * @brief Get the format the sample callback receives
+     * 
+     * @return SampleFormat Format selected by the last startStreaming()
+     */
+    SampleFormat getSampleFormat() const;
+    
     /**
      * @brief Reset buffer state
      */
@@ -0,0 +1,150 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sdrplay {
+
+/**
+ * @brief Snapshot of the health of a sample stream
+ *
+ * Packet, timing and fill counters restart with the stream and whenever
+ * the API flags a reset; loss counters cover the stream since it was
+ * started. The measured rate covers the most recent rate window.
+ */
+struct StreamStats {
+    static constexpr size_t PACKET_SIZE_BUCKETS = 16;
+
+    double sampleRate;             // Measured input rate in samples per second (0 until two packets arrived)
+    uint64_t callbackCount;        // Stream callbacks (API packets) received
+    uint64_t samplesReceived;      // Samples delivered by the API
+    uint64_t meanIntervalNs;       // Mean time between stream callbacks
+    uint64_t intervalJitterNs;     // Standard deviation of the time between stream callbacks
+    uint64_t minIntervalNs;        // Shortest time between stream callbacks
+    uint64_t maxIntervalNs;        // Longest time between stream callbacks
+    uint32_t minPacketSamples;     // Smallest packet received
+    uint32_t maxPacketSamples;     // Largest packet received
+    std::array<uint64_t, PACKET_SIZE_BUCKETS> packetSizeCounts;  // Packets per size bucket, see packetSizeBucket()
+    size_t bufferCapacity;         // Capacity of the sample buffer
+    size_t bufferHighWatermark;    // Most samples buffered after any packet was written
+    size_t consumerLagSamples;     // Samples waiting for readSamples() right now
+    uint64_t consumerLagNs;        // consumerLagSamples at the measured rate
+    uint64_t droppedSamples;       // Samples lost to sample buffer overflows
+    uint64_t overflowEvents;       // Runs of consecutive packets that lost samples to overflows
+    uint64_t missingSamples;       // Samples the API failed to deliver (firstSampleNum jumps, e.g. USB drops)
+    uint64_t gapEvents;            // Discontinuities in firstSampleNum
+    uint64_t nsSinceLastCallback;  // Time since the last stream callback (UINT64_MAX if none)
+
+    StreamStats() : sampleRate(0.0), callbackCount(0), samplesReceived(0), meanIntervalNs(0),
+                    intervalJitterNs(0), minIntervalNs(0), maxIntervalNs(0), minPacketSamples(0),
+                    maxPacketSamples(0), packetSizeCounts(), bufferCapacity(0), bufferHighWatermark(0),
+                    consumerLagSamples(0), consumerLagNs(0), droppedSamples(0), overflowEvents(0),
+                    missingSamples(0), gapEvents(0), nsSinceLastCallback(UINT64_MAX) {}
+
+    /**
+     * @brief Get the number of packets in a size bucket
+     *
+     * @param bucket Bucket index below PACKET_SIZE_BUCKETS
+     */
+    uint64_t packetSizeCount(size_t bucket) const {
+        return bucket < PACKET_SIZE_BUCKETS ? packetSizeCounts[bucket] : 0;
+    }
+
+    /**
+     * @brief Get the size bucket of a packet
+     *
+     * Bucket b holds packets of 2^b to 2^(b+1) - 1 samples; bucket 0 also
+     * holds empty packets and the last bucket everything larger.
+     *
+     * @param samples Samples in the packet
+     */
+    static size_t packetSizeBucket(size_t samples);
+
+    /**
+     * @brief Get the smallest packet size that falls into a bucket
+     *
+     * @param bucket Bucket index below PACKET_SIZE_BUCKETS
+     */
+    static size_t packetSizeBucketMin(size_t bucket);
+};
+
+/**
+ * @brief Stream statistics updated by the API stream thread
+ *
+ * Only the stream thread writes, so every counter is a relaxed load and
+ * store rather than a locked read-modify-write, and recording a packet
+ * costs a handful of plain memory operations. Readers may take a snapshot
+ * at any time; counters are read individually, so a snapshot taken while
+ * a packet is recorded may mix values from adjacent packets.
+ */
+class StreamStatsCollector {
+public:
+    /**
+     * @brief Length of the window the sample rate is measured over
+     */
+    static constexpr uint64_t RATE_WINDOW_NS = 500000000;
+
+    StreamStatsCollector();
+
+    StreamStatsCollector(const StreamStatsCollector&) = delete;
+    StreamStatsCollector& operator=(const StreamStatsCollector&) = delete;
+
+    /**
+     * @brief Clear all counters
+     *
+     * Must be called from the stream thread, or while no packets arrive.
+     */
+    void reset();
+
+    /**
+     * @brief Record the arrival of a packet
+     *
+     * Must only be called from the stream thread.
+     *
+     * @param arrivalNs Steady-clock arrival time in nanoseconds
+     * @param samples Samples in the packet
+     * @param rateChanged The sample rate changed at this packet; restarts the rate window
+     */
+    void recordPacket(uint64_t arrivalNs, size_t samples, bool rateChanged);
+
+    /**
+     * @brief Record the sample buffer fill level after a packet was written
+     *
+     * Must only be called from the stream thread.
+     *
+     * @param bufferedSamples Samples in the buffer
+     */
+    void recordFill(size_t bufferedSamples);
+
+    /**
+     * @brief Fill in the packet, rate and fill counters of a snapshot
+     *
+     * Buffer and loss counters are left to the owner of the buffer.
+     *
+     * @param stats Snapshot to fill in
+     * @param nowNs Current steady-clock time in nanoseconds
+     */
+    void snapshot(StreamStats& stats, uint64_t nowNs) const;
+
+private:
+    std::atomic<uint64_t> packets;
+    std::atomic<uint64_t> samples;
+    std::atomic<uint64_t> lastArrivalNs;
+    std::atomic<uint64_t> intervals;
+    std::atomic<uint64_t> intervalSumNs;
+    std::atomic<double> intervalSquareSum;  // ns^2; a double so it cannot overflow
+    std::atomic<uint64_t> minInterval;
+    std::atomic<uint64_t> maxInterval;
+    std::atomic<uint32_t> minPacket;
+    std::atomic<uint32_t> maxPacket;
+    std::atomic<uint64_t> packetSizes[StreamStats::PACKET_SIZE_BUCKETS];
+    std::atomic<size_t> highWatermark;
+
+    // Rate window: samples arriving after windowStartNs
+    std::atomic<uint64_t> windowStartNs;
+    std::atomic<uint64_t> windowSamples;
+    std::atomic<double> windowRate;  // Rate over the last complete window
+};
+
+} // namespace sdrplay
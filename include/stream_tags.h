@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sdrplay {
+
+/**
+ * @brief Metadata for one packet delivered by the SDRplay API
+ */
+struct StreamTag {
+    uint64_t sampleIndex;     // Stream index of the first sample of the packet in the sample buffer
+    uint32_t numSamples;      // Number of samples stored for the packet
+    uint32_t firstSampleNum;  // API sample counter (params->firstSampleNum)
+    uint64_t timestampNs;     // Host steady-clock time the packet arrived, in nanoseconds
+    bool grChanged;           // Gain reduction changed at this packet
+    bool rfChanged;           // RF frequency changed at this packet
+    bool fsChanged;           // Sample rate changed at this packet
+    bool reset;               // Stream was (re)started at this packet
+    bool gap;                 // Samples were lost immediately before this packet
+    bool zeroFill;            // Samples are zeros inserted in place of lost samples
+
+    StreamTag() : sampleIndex(0), numSamples(0), firstSampleNum(0), timestampNs(0),
+                  grChanged(false), rfChanged(false), fsChanged(false), reset(false),
+                  gap(false), zeroFill(false) {}
+
+    /**
+     * @brief Check whether any change flag is set
+     */
+    bool hasChange() const { return grChanged || rfChanged || fsChanged || reset || gap || zeroFill; }
+};
+
+/**
+ * @brief Ring of packet tags running alongside the sample buffer
+ *
+ * Written only by the API stream thread. Any number of readers can query
+ * the tags overlapping a range of stream indices; tags are kept in
+ * sample-index order and the oldest are overwritten when the ring is full.
+ * Each slot is guarded by a sequence number, so readers never block the
+ * writer and simply skip slots that are overwritten while being read.
+ */
+class StreamTagBuffer {
+public:
+    /**
+     * @brief Construct a tag buffer
+     *
+     * @param capacity Number of tags kept (rounded up to a power of two)
+     */
+    explicit StreamTagBuffer(size_t capacity);
+
+    /**
+     * @brief Record the tag for a packet
+     *
+     * Must only be called from the producer thread. Tags with no samples
+     * and no change flags are ignored.
+     *
+     * @param tag Tag to append; sampleIndex must not decrease between calls
+     */
+    void append(const StreamTag& tag);
+
+    /**
+     * @brief Get the tags overlapping a range of stream indices
+     *
+     * Packets carrying only change flags are reported if their index is
+     * inside the range.
+     *
+     * @param startIndex First stream index of the range
+     * @param count Number of samples in the range
+     * @return std::vector<StreamTag> Overlapping tags in stream order
+     */
+    std::vector<StreamTag> query(uint64_t startIndex, size_t count) const;
+
+    /**
+     * @brief Discard all tags
+     *
+     * Must not be called while the producer is active.
+     */
+    void clear();
+
+    /**
+     * @brief Reallocate with a new capacity, discarding all tags
+     *
+     * Must not be called while the producer or any reader is active.
+     *
+     * @param capacity Number of tags kept (rounded up to a power of two)
+     */
+    void reconfigure(size_t capacity);
+
+    /**
+     * @brief Get the tag capacity
+     */
+    size_t capacity() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;  // 2n+1 while tag n is written, 2n+2 when complete
+        std::atomic<uint64_t> sampleIndex;
+        std::atomic<uint64_t> timestampNs;
+        std::atomic<uint32_t> numSamples;
+        std::atomic<uint32_t> firstSampleNum;
+        std::atomic<uint32_t> flags;
+    };
+
+    bool load(uint64_t n, StreamTag& tag) const;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    std::atomic<uint64_t> written;  // Number of tags appended
+};
+
+} // namespace sdrplay
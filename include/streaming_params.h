@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include "ring_storage.h"
+#include "ring_allocator.h"
+#include "sample_buffer.h"
+#include "callback_wrapper.h"
+
+namespace sdrplay {
+
+/**
+ * @brief Streaming configuration parameters
+ */
+struct StreamingParams {
+    bool enableIQCorrection{true};  // Enable automatic IQ imbalance correction
+    bool enableDCCorrection{true};  // Enable automatic DC offset correction
+    bool decimate{false};          // Enable decimation
+    int decimationFactor{1};       // Decimation factor (1, 2, 4, 8, 16, 32)
+    bool wideBandSignal{false};    // Process signal as wideband
+    
+    // Sample buffer configuration
+    size_t bufferSize{262144};                      // Buffer capacity in samples (rounded up to a power of two)
+    RingLayout bufferLayout{RingLayout::Standard};  // Mirrored gives contiguous reads across the wrap
+    bool planarStorage{false};                      // Store I and Q separately, as the API delivers them
+    std::shared_ptr<RingAllocator> bufferAllocator;  // Memory for the buffers, e.g. huge pages (nullptr = heap)
+    OverflowPolicy overflowPolicy{OverflowPolicy::DropNewest};  // What to drop when the buffer is full
+    unsigned int overflowTimeoutMs{10};             // Maximum API-thread wait for BlockWithTimeout
+    WaitStrategy waitStrategy{WaitStrategy::Block};  // How waitForSamples() waits for new samples
+    unsigned int waitSpinUs{50};                    // Spin budget before sleeping, for SpinThenBlock
+    
+    // Sample loss handling
+    bool fillGaps{false};          // Insert zeros for samples the API dropped (keeps indices aligned with time)
+    size_t maxGapFill{1048576};    // Most zeros inserted for a single gap
+    
+    // Sample callback delivery
+    CallbackMode callbackMode{CallbackMode::Inline};  // Dispatcher keeps slow callbacks off the API thread
+    size_t callbackBlockSize{0};         // Samples per callback (0 = one call per API packet)
+    unsigned int callbackMaxLatencyMs{0};  // Deliver a partial block after this long (0 = wait for full blocks)
+    SampleFormat sampleFormat{SampleFormat::CS16};  // Format the sample callback receives
+    
+    // Default constructor
+    StreamingParams() = default;
+};
+
+} // namespace sdrplay
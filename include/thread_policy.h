@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sdrplay {
+
+/**
+ * @brief Scheduling and memory settings for wrapper-owned threads
+ *
+ * Applied to the callback dispatcher thread and to the sample buffers.
+ * Realtime priority and memory locking usually need privileges
+ * (CAP_SYS_NICE / CAP_IPC_LOCK or matching rlimits); settings that cannot
+ * be applied are skipped and reported in ThreadPolicyStatus.
+ */
+struct ThreadPolicy {
+    std::vector<int> cpus;      // CPUs the threads may run on (empty = leave affinity alone)
+    int realtimePriority{0};    // SCHED_FIFO priority, 1-99 (0 = normal scheduling)
+    bool lockMemory{false};     // mlock the sample buffers, prefaulting them if that fails
+
+    ThreadPolicy() = default;
+};
+
+/**
+ * @brief What applying a ThreadPolicy achieved
+ */
+struct ThreadPolicyStatus {
+    bool affinityApplied{false};
+    bool priorityApplied{false};
+    bool memoryLocked{false};
+    bool memoryPrefaulted{false};       // Pages populated without locking them
+    std::vector<std::string> failures;  // One message per setting that could not be applied
+
+    ThreadPolicyStatus() = default;
+
+    /**
+     * @brief Check whether every requested setting was applied
+     */
+    bool ok() const { return failures.empty(); }
+};
+
+/**
+ * @brief Apply affinity and priority to a running thread
+ *
+ * The memory setting is ignored; it applies to buffers, not threads.
+ *
+ * @param thread Thread to configure
+ * @param policy Settings to apply
+ * @return ThreadPolicyStatus Applied settings and failures
+ */
+ThreadPolicyStatus applyThreadPolicy(std::thread& thread, const ThreadPolicy& policy);
+
+/**
+ * @brief Apply affinity and priority to the calling thread
+ *
+ * Useful for pinning consumer threads next to the dispatcher.
+ *
+ * @param policy Settings to apply
+ * @return ThreadPolicyStatus Applied settings and failures
+ */
+ThreadPolicyStatus applyThreadPolicy(const ThreadPolicy& policy);
+
+} // namespace sdrplay
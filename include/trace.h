@@ -0,0 +1,144 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sdrplay {
+
+/**
+ * @brief Per-stage timing events exportable as a Chrome trace
+ *
+ * Built with SDRPLAY_TRACING, the wrapper times the stream callback, ring
+ * writes and reads, sample and event callbacks, the dispatcher and every
+ * sdrplay_api_Init/Uninit/Update call. Each thread appends to its own
+ * fixed ring of events without locks, so when drops happen the trace
+ * shows which stage was slow. Load the JSON in chrome://tracing or
+ * https://ui.perfetto.dev.
+ *
+ * Without SDRPLAY_TRACING the trace points compile to nothing and this
+ * class only reports an empty trace. With it, recording still costs a
+ * single relaxed load until enable() is called.
+ */
+class Trace {
+public:
+    /**
+     * @brief Events kept per thread; older events are overwritten
+     */
+    static constexpr size_t EVENTS_PER_THREAD = 65536;
+
+    /**
+     * @brief Check whether the library was built with SDRPLAY_TRACING
+     */
+    static bool isCompiledIn();
+
+    /**
+     * @brief Start or stop recording events
+     *
+     * Has no effect unless the library was built with SDRPLAY_TRACING.
+     *
+     * @param enabled Record events from now on
+     */
+    static void enable(bool enabled = true);
+
+    /**
+     * @brief Check whether events are being recorded
+     */
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Discard all recorded events
+     *
+     * Safe while events are recorded; threads that have exited are forgotten.
+     */
+    static void clear();
+
+    /**
+     * @brief Name the calling thread in the trace
+     *
+     * @param name Thread name shown by the trace viewer
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * @brief Get the recorded events as Chrome trace JSON
+     *
+     * Threads keep recording while the trace is taken; events overwritten
+     * during the copy are left out.
+     *
+     * @return std::string Trace in the Chrome trace event format
+     */
+    static std::string toChromeJson();
+
+    /**
+     * @brief Write the recorded events to a Chrome trace JSON file
+     *
+     * @param path File to write
+     * @return true if the file was written
+     */
+    static bool writeChromeJson(const std::string& path);
+
+    /**
+     * @brief Get the trace clock in nanoseconds (steady clock)
+     */
+    static uint64_t nowNs();
+
+    /**
+     * @brief Record a completed event on the calling thread
+     *
+     * @param name Event name; must outlive the trace (use a string literal)
+     * @param startNs Start time from nowNs()
+     * @param endNs End time from nowNs()
+     */
+    static void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+    /**
+     * @brief Name the calling thread unless it already has a name
+     *
+     * @param name Thread name; must outlive the trace (use a string literal)
+     */
+    static void nameThreadOnce(const char* name);
+
+private:
+    Trace() = delete;
+
+    static std::atomic<bool> enabledFlag;
+};
+
+/**
+ * @brief Records one event spanning its own lifetime
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : name(Trace::isEnabled() ? name : nullptr), startNs(this->name ? Trace::nowNs() : 0) {}
+
+    ~TraceScope() {
+        if (name) {
+            Trace::record(name, startNs, Trace::nowNs());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t startNs;
+};
+
+} // namespace sdrplay
+
+#if defined(SDRPLAY_TRACING) && SDRPLAY_TRACING
+    #define SDRPLAY_TRACE_CONCAT_(a, b) a##b
+    #define SDRPLAY_TRACE_CONCAT(a, b) SDRPLAY_TRACE_CONCAT_(a, b)
+    // Time the rest of the enclosing block as an event called name
+    #define SDRPLAY_TRACE_SCOPE(name) \
+        ::sdrplay::TraceScope SDRPLAY_TRACE_CONCAT(sdrplayTraceScope, __LINE__)(name)
+    // Name the calling thread in the trace the first time it gets here
+    #define SDRPLAY_TRACE_THREAD_NAME(name) \
+        do { if (::sdrplay::Trace::isEnabled()) ::sdrplay::Trace::nameThreadOnce(name); } while (0)
+#else
+    #define SDRPLAY_TRACE_SCOPE(name) do {} while (0)
+    #define SDRPLAY_TRACE_THREAD_NAME(name) do {} while (0)
+#endif
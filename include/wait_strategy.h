@@ -0,0 +1,153 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #include <immintrin.h>
+#endif
+
+namespace sdrplay {
+
+/**
+ * @brief How a consumer waits for samples
+ *
+ * The trade-off is wakeup latency against CPU time; bench_wait_strategy
+ * prints latency histograms for each.
+ */
+enum class WaitStrategy {
+    Block,          // Sleep on a condition variable (lowest CPU use)
+    SpinThenBlock,  // Spin for a bounded time, then sleep on a futex
+    BusyPoll        // Spin until the samples arrive (for a dedicated core)
+};
+
+/**
+ * @brief Get the name of a wait strategy
+ */
+const char* waitStrategyName(WaitStrategy strategy);
+
+/**
+ * @brief Tell the CPU we are in a spin loop
+ */
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief Sleeping half of SpinThenBlock
+ *
+ * A 32-bit sequence word the consumer sleeps on and the producer bumps. On
+ * Linux this is a raw futex, so a wakeup is one syscall with no mutex hand
+ * over; elsewhere it falls back to a condition variable.
+ *
+ * Usage mirrors the buffers' condition-variable handshake: the waiter calls
+ * prepare(), re-checks its predicate, then wait(); the producer issues a
+ * seq_cst fence after publishing and calls notify(). Either the waiter sees
+ * the new data or the producer sees it registered.
+ */
+class WaitEvent {
+public:
+    WaitEvent();
+
+    WaitEvent(const WaitEvent&) = delete;
+    WaitEvent& operator=(const WaitEvent&) = delete;
+
+    /**
+     * @brief Register as a sleeper and snapshot the sequence
+     *
+     * @return uint32_t Sequence to pass to wait()
+     */
+    uint32_t prepare();
+
+    /**
+     * @brief Sleep until notify() moves the sequence past seq or the timeout
+     *
+     * May return early; callers re-check their predicate.
+     *
+     * @param seq Value from prepare()
+     * @param timeout Longest sleep
+     */
+    void wait(uint32_t seq, std::chrono::nanoseconds timeout);
+
+    /**
+     * @brief Deregister after prepare()
+     */
+    void finish();
+
+    /**
+     * @brief Wake all sleepers; a single relaxed load when there are none
+     */
+    void notify();
+
+private:
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> sleepers;
+#if !defined(__linux__)
+    std::mutex mutex;
+    std::condition_variable condition;
+#endif
+};
+
+/**
+ * @brief Wait for a predicate with SpinThenBlock or BusyPoll
+ *
+ * Block is handled by the buffers' own condition variables and must not be
+ * passed here.
+ *
+ * @param event Event the producer notifies
+ * @param strategy SpinThenBlock or BusyPoll
+ * @param spinUs Spin budget before sleeping (SpinThenBlock only)
+ * @param timeoutMs Timeout in milliseconds (0 = no timeout)
+ * @param ready Predicate checked while spinning and after each wakeup
+ * @return true if ready() became true, false on timeout
+ */
+template <typename Ready>
+bool spinWait(WaitEvent& event, WaitStrategy strategy, unsigned int spinUs,
+              unsigned int timeoutMs, Ready ready) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto deadline = timeoutMs == 0 ? Clock::time_point::max()
+                                         : start + std::chrono::milliseconds(timeoutMs);
+    const auto spinEnd = strategy == WaitStrategy::BusyPoll
+        ? deadline : std::min(deadline, start + std::chrono::microseconds(spinUs));
+
+    // Reading the clock costs more than a pause, so only every few rounds
+    for (unsigned int round = 1;; ++round) {
+        if (ready()) {
+            return true;
+        }
+        cpuRelax();
+        if ((round & 15) == 0 && Clock::now() >= spinEnd) {
+            break;
+        }
+    }
+    if (strategy == WaitStrategy::BusyPoll) {
+        return ready();
+    }
+
+    for (;;) {
+        uint32_t seq = event.prepare();
+        if (ready()) {
+            event.finish();
+            return true;
+        }
+        auto now = Clock::now();
+        if (now >= deadline) {
+            event.finish();
+            return false;
+        }
+        event.wait(seq, deadline == Clock::time_point::max()
+                            ? std::chrono::nanoseconds(std::chrono::seconds(1))
+                            : std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now));
+        event.finish();
+    }
+}
+
+} // namespace sdrplay
@@ -0,0 +1,174 @@
+#include "block_pool.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace sdrplay {
+
+namespace {
+
+// Blocks start on a cache line: 16 CS16 samples
+constexpr size_t BLOCK_ALIGN_SAMPLES = RingStorage::ALIGNMENT / sizeof(std::complex<short>);
+
+size_t strideFor(size_t blockSamples) {
+    return (std::max<size_t>(blockSamples, 1) + BLOCK_ALIGN_SAMPLES - 1) & ~(BLOCK_ALIGN_SAMPLES - 1);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// SampleBlockRef implementation
+//------------------------------------------------------------------------------
+
+SampleBlockRef::SampleBlockRef(const SampleBlockRef& other) noexcept : block(other.block) {
+    if (block) {
+        block->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+SampleBlockRef& SampleBlockRef::operator=(const SampleBlockRef& other) noexcept {
+    if (other.block) {
+        other.block->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    reset();
+    block = other.block;
+    return *this;
+}
+
+SampleBlockRef& SampleBlockRef::operator=(SampleBlockRef&& other) noexcept {
+    if (this != &other) {
+        reset();
+        block = other.block;
+        other.block = nullptr;
+    }
+    return *this;
+}
+
+void SampleBlockRef::reset() noexcept {
+    if (!block) {
+        return;
+    }
+    // acq_rel so every holder's reads finish before the block is reused
+    if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        block->pool->release(block);
+    }
+    block = nullptr;
+}
+
+uint32_t SampleBlockRef::useCount() const {
+    return block ? block->refs.load(std::memory_order_relaxed) : 0;
+}
+
+//------------------------------------------------------------------------------
+// BlockPool implementation
+//------------------------------------------------------------------------------
+
+std::shared_ptr<BlockPool> BlockPool::create(size_t blockCount, size_t blockSamples,
+                                             std::shared_ptr<RingAllocator> allocator) {
+    return std::make_shared<BlockPool>(Key(), blockCount, blockSamples, std::move(allocator));
+}
+
+BlockPool::BlockPool(Key, size_t blockCount, size_t blockSamples, std::shared_ptr<RingAllocator> allocator)
+    : count(blockCount), samplesPerBlock(std::max<size_t>(blockSamples, 1)),
+      storage(std::max<size_t>(blockCount, 1) * strideFor(blockSamples) * sizeof(std::complex<short>),
+              RingLayout::Standard, std::move(allocator)),
+      blocks(new SampleBlock[std::max<size_t>(blockCount, 1)]),
+      freeHead(NO_BLOCK), freeCount(0), minFree(blockCount), acquired(0), exhausted(0) {
+    if (blockCount == 0 || blockCount >= NO_BLOCK) {
+        throw std::invalid_argument("BlockPool: block count out of range");
+    }
+
+    std::complex<short>* base = static_cast<std::complex<short>*>(storage.data());
+    size_t stride = strideFor(blockSamples);
+    for (size_t i = count; i-- > 0;) {
+        blocks[i].pool = this;
+        blocks[i].samples = base + i * stride;
+        blocks[i].blockCapacity = samplesPerBlock;
+        push(static_cast<uint32_t>(i));
+    }
+}
+
+void BlockPool::push(uint32_t index) {
+    // Counted before the block becomes visible, so a racing acquire()
+    // never takes the count below zero
+    freeCount.fetch_add(1, std::memory_order_relaxed);
+    uint64_t head = freeHead.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        blocks[index].next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | index;
+    } while (!freeHead.compare_exchange_weak(head, next, std::memory_order_release,
+                                             std::memory_order_relaxed));
+}
+
+SampleBlock* BlockPool::pop() {
+    uint64_t head = freeHead.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t index = static_cast<uint32_t>(head);
+        if (index == NO_BLOCK) {
+            return nullptr;
+        }
+        // May read a link a concurrent pop/push just changed; the version
+        // tag then makes the exchange fail and the loop retries
+        uint32_t next = blocks[index].next.load(std::memory_order_relaxed);
+        uint64_t replacement = (((head >> 32) + 1) << 32) | next;
+        if (freeHead.compare_exchange_weak(head, replacement, std::memory_order_acquire,
+                                           std::memory_order_acquire)) {
+            return &blocks[index];
+        }
+    }
+}
+
+SampleBlockWriter BlockPool::acquire() {
+    SampleBlock* block = pop();
+    if (!block) {
+        exhausted.fetch_add(1, std::memory_order_relaxed);
+        return SampleBlockWriter();
+    }
+
+    size_t remaining = freeCount.fetch_sub(1, std::memory_order_relaxed) - 1;
+    size_t low = minFree.load(std::memory_order_relaxed);
+    while (remaining < low && !minFree.compare_exchange_weak(low, remaining, std::memory_order_relaxed)) {
+    }
+    acquired.fetch_add(1, std::memory_order_relaxed);
+
+    block->owner = shared_from_this();
+    block->count = 0;
+    block->sequence = 0;
+    block->firstSampleNum = 0;
+    block->timestampNs = 0;
+    block->refs.store(1, std::memory_order_relaxed);
+    return SampleBlockWriter(block);
+}
+
+void BlockPool::release(SampleBlock* block) {
+    // The last block out may hold the last reference to the pool, so the
+    // pool is only let go once this function no longer touches it
+    std::shared_ptr<BlockPool> self = std::move(block->owner);
+    push(static_cast<uint32_t>(block - blocks.get()));
+}
+
+BlockPoolStats BlockPool::getStats() const {
+    BlockPoolStats stats;
+    stats.blockCount = count;
+    stats.blockSamples = samplesPerBlock;
+    stats.freeBlocks = freeCount.load(std::memory_order_relaxed);
+    stats.minFreeBlocks = minFree.load(std::memory_order_relaxed);
+    stats.acquiredBlocks = acquired.load(std::memory_order_relaxed);
+    stats.exhaustedCount = exhausted.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool BlockPool::lockMemory(bool lock) {
+    if (!lock) {
+        storage.unlock();
+        return true;
+    }
+    return storage.lock();
+}
+
+bool BlockPool::prefaultMemory() {
+    return storage.prefault();
+}
+
+} // namespace sdrplay
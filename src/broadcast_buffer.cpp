@@ -0,0 +1,300 @@
+#include "broadcast_buffer.h"
+#include "ring_index.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace sdrplay {
+
+//------------------------------------------------------------------------------
+// BroadcastBuffer implementation
+//------------------------------------------------------------------------------
+
+BroadcastBuffer::BroadcastBuffer(size_t size, RingLayout layout, std::shared_ptr<RingAllocator> allocator)
+    : storageLayout(layout), storageAllocator(std::move(allocator)), lockRequested(false),
+      bufferSize(RingIndex::capacityFor(size, layout, sizeof(std::complex<short>))), mask(bufferSize - 1),
+      tail(0), claim(0), start(0), readers(0), waiters(0) {}
+
+std::shared_ptr<BroadcastReader> BroadcastBuffer::addReader(ReaderOverflowPolicy policy) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    if (!storage) {
+        storage.reset(new RingStorage(bufferSize * sizeof(std::complex<short>), storageLayout,
+                                      storageAllocator));
+        if (lockRequested) {
+            storage->lock();
+        }
+    }
+    // The reader count publishes the storage to the producer
+    return std::shared_ptr<BroadcastReader>(new BroadcastReader(shared_from_this(), policy));
+}
+
+bool BroadcastBuffer::reconfigure(size_t size, RingLayout layout, std::shared_ptr<RingAllocator> allocator) {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    if (readers.load(std::memory_order_acquire) > 0) {
+        return false;
+    }
+
+    storage.reset();
+    storageLayout = layout;
+    storageAllocator = std::move(allocator);
+    bufferSize = RingIndex::capacityFor(size, layout, sizeof(std::complex<short>));
+    mask = bufferSize - 1;
+
+    // Positions keep counting up so reader cursors stay comparable; nothing
+    // before the current write position exists in the new storage
+    start.store(tail.load(std::memory_order_relaxed), std::memory_order_release);
+    return true;
+}
+
+std::complex<short>* BroadcastBuffer::samples() const {
+    return static_cast<std::complex<short>*>(storage->data());
+}
+
+void BroadcastBuffer::copyIn(uint64_t pos, const std::complex<short>* src, size_t count) {
+    size_t offset = static_cast<size_t>(pos) & mask;
+    size_t first = storage->mirrored() ? count : std::min(count, bufferSize - offset);
+    std::memcpy(samples() + offset, src, first * sizeof(std::complex<short>));
+    if (count > first) {
+        std::memcpy(samples(), src + first, (count - first) * sizeof(std::complex<short>));
+    }
+}
+
+void BroadcastBuffer::copyOut(uint64_t pos, std::complex<short>* dest, size_t count) const {
+    size_t offset = static_cast<size_t>(pos) & mask;
+    size_t first = storage->mirrored() ? count : std::min(count, bufferSize - offset);
+    std::memcpy(dest, samples() + offset, first * sizeof(std::complex<short>));
+    if (count > first) {
+        std::memcpy(dest + first, samples(), (count - first) * sizeof(std::complex<short>));
+    }
+}
+
+SampleSpans BroadcastBuffer::spansAt(uint64_t pos, size_t count) const {
+    SampleSpans spans;
+    size_t offset = static_cast<size_t>(pos) & mask;
+    size_t first = storage->mirrored() ? count : std::min(count, bufferSize - offset);
+    spans.first = SampleSpan(samples() + offset, first);
+    if (count > first) {
+        spans.second = SampleSpan(samples(), count - first);
+    }
+    return spans;
+}
+
+uint64_t BroadcastBuffer::oldestValid(uint64_t end) const {
+    uint64_t lowest = start.load(std::memory_order_acquire);
+    return end > lowest + bufferSize ? end - bufferSize : lowest;
+}
+
+void BroadcastBuffer::notifyWaiters() {
+    // Same handshake as SampleBuffer: only lock when a reader is waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        dataAvailable.notify_all();
+    }
+}
+
+void BroadcastBuffer::write(const std::complex<short>* data, size_t count) {
+    if (!data || count == 0 || readers.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+
+    // Older samples of an oversized packet would be overwritten at once
+    if (count > bufferSize) {
+        data += count - bufferSize;
+        count = bufferSize;
+    }
+
+    uint64_t t = tail.load(std::memory_order_relaxed);
+
+    // Announce the overwrite before touching the samples, so a reader that
+    // copied any of them sees the new claim in its validation check
+    claim.store(t + count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    copyIn(t, data, count);
+    tail.store(t + count, std::memory_order_release);
+    notifyWaiters();
+}
+
+size_t BroadcastBuffer::readerCount() const {
+    return readers.load(std::memory_order_relaxed);
+}
+
+uint64_t BroadcastBuffer::writeIndex() const {
+    return tail.load(std::memory_order_acquire);
+}
+
+bool BroadcastBuffer::lockMemory(bool lock) {
+    std::lock_guard<std::mutex> guard(storageMutex);
+    lockRequested = lock;
+    if (!storage) {
+        return true;
+    }
+    if (!lock) {
+        storage->unlock();
+        return true;
+    }
+    return storage->lock();
+}
+
+bool BroadcastBuffer::prefaultMemory() {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    return !storage || storage->prefault();
+}
+
+size_t BroadcastBuffer::capacity() const {
+    return bufferSize;
+}
+
+//------------------------------------------------------------------------------
+// BroadcastReader implementation
+//------------------------------------------------------------------------------
+
+BroadcastReader::BroadcastReader(std::shared_ptr<BroadcastBuffer> buffer,
+                                 ReaderOverflowPolicy policy)
+    : ring(std::move(buffer)), overflowPolicy(policy), cursor(0), dropped(0),
+      overflowEpisodes(0), peekPos(0), peekCount(0) {
+    ring->readers.fetch_add(1, std::memory_order_release);
+    cursor.store(ring->tail.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+BroadcastReader::~BroadcastReader() {
+    ring->readers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void BroadcastReader::recordLoss(uint64_t count) {
+    dropped.fetch_add(count, std::memory_order_relaxed);
+    overflowEpisodes.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t BroadcastReader::catchUp(uint64_t end) {
+    uint64_t r = cursor.load(std::memory_order_relaxed);
+
+    // The storage was reallocated; resume at the next sample without loss
+    uint64_t lowest = ring->start.load(std::memory_order_acquire);
+    if (r < lowest) {
+        r = lowest;
+        cursor.store(r, std::memory_order_relaxed);
+    }
+
+    // Checked against the claim so samples being overwritten right now count as lost
+    uint64_t oldest = ring->oldestValid(ring->claim.load(std::memory_order_acquire));
+    if (r < oldest) {
+        uint64_t next = overflowPolicy == ReaderOverflowPolicy::SkipToNewest
+            ? std::max(end, oldest) : oldest;
+        recordLoss(next - r);
+        r = next;
+        cursor.store(r, std::memory_order_relaxed);
+    }
+    return r;
+}
+
+size_t BroadcastReader::read(std::complex<short>* dest, size_t maxCount) {
+    if (!dest || maxCount == 0) {
+        return 0;
+    }
+
+    peekCount = 0;  // Moving the cursor invalidates any outstanding peek
+
+    for (;;) {
+        uint64_t r = catchUp(ring->tail.load(std::memory_order_acquire));
+        uint64_t end = ring->tail.load(std::memory_order_acquire);
+        size_t count = end > r ? static_cast<size_t>(std::min<uint64_t>(end - r, maxCount)) : 0;
+        if (count == 0) {
+            return 0;
+        }
+
+        ring->copyOut(r, dest, count);
+
+        // If the producer started overwriting what we copied, catch up and retry
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring->oldestValid(ring->claim.load(std::memory_order_relaxed)) <= r) {
+            cursor.store(r + count, std::memory_order_release);
+            return count;
+        }
+    }
+}
+
+SampleSpans BroadcastReader::peek(size_t maxCount) {
+    uint64_t r = catchUp(ring->tail.load(std::memory_order_acquire));
+    uint64_t end = ring->tail.load(std::memory_order_acquire);
+    size_t count = end > r ? static_cast<size_t>(std::min<uint64_t>(end - r, maxCount)) : 0;
+
+    peekPos = r;
+    peekCount = count;
+    if (count == 0) {
+        return SampleSpans();
+    }
+    return ring->spansAt(r, count);
+}
+
+size_t BroadcastReader::consume(size_t count) {
+    count = std::min(count, peekCount);
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t h = peekPos;
+    peekPos += count;
+    peekCount -= count;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool intact = ring->oldestValid(ring->claim.load(std::memory_order_relaxed)) <= h;
+    cursor.store(h + count, std::memory_order_release);
+    if (!intact) {
+        peekCount = 0;
+        recordLoss(count);
+        return 0;
+    }
+    return count;
+}
+
+bool BroadcastReader::waitForSamples(size_t count, unsigned int timeoutMs) {
+    count = std::min(count, ring->capacity());
+
+    // Apply any pending skip first so a lapped SkipToNewest reader waits for new samples
+    catchUp(ring->tail.load(std::memory_order_acquire));
+    if (available() >= count) {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(ring->waitMutex);
+    ring->waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    auto ready = [this, count]() { return available() >= count; };
+    bool result = true;
+    if (timeoutMs == 0) {
+        ring->dataAvailable.wait(lock, ready);
+    } else {
+        result = ring->dataAvailable.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+    }
+
+    ring->waiters.fetch_sub(1, std::memory_order_relaxed);
+    return result;
+}
+
+size_t BroadcastReader::available() const {
+    uint64_t end = ring->tail.load(std::memory_order_acquire);
+    uint64_t r = std::max(cursor.load(std::memory_order_acquire), ring->oldestValid(end));
+    return r < end ? static_cast<size_t>(end - r) : 0;
+}
+
+uint64_t BroadcastReader::readIndex() const {
+    return cursor.load(std::memory_order_acquire);
+}
+
+uint64_t BroadcastReader::droppedSamples() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t BroadcastReader::overflowEvents() const {
+    return overflowEpisodes.load(std::memory_order_relaxed);
+}
+
+ReaderOverflowPolicy BroadcastReader::policy() const {
+    return overflowPolicy;
+}
+
+} // namespace sdrplay
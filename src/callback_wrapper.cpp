@@ -1,154 +1,409 @@
 #include "callback_wrapper.h"
+#include "sample_convert.h"
+#include "trace.h"
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 
 namespace sdrplay {
 
+namespace {
+
+// Samples interleaved at a time for converting reads from planar storage
+constexpr size_t PLANAR_READ_CHUNK = 4096;
+
+} // namespace
+
 //------------------------------------------------------------------------------
-// SampleBuffer implementation
+// CallbackWrapper implementation
 //------------------------------------------------------------------------------
 
-SampleBuffer::SampleBuffer(size_t size)
-    : buffer(size), readPos(0), writePos(0), overflowed(false) {}
+CallbackWrapper::CallbackWrapper(size_t bufferSize, RingLayout layout)
+    : sampleBuffer(bufferSize, layout), planarBuffer(1), planarStorage(false),
+      broadcast(std::make_shared<BroadcastBuffer>(bufferSize, layout)),
+      streamTags(std::max(DEFAULT_TAG_CAPACITY, bufferSize / 256)),
+      scratch(DEFAULT_MAX_PACKET_SAMPLES), streamActive(false),
+      expectedSampleNum(0), haveExpectedSampleNum(false), gapFillEnabled(false),
+      maxGapFill(DEFAULT_MAX_GAP_FILL), missingSamples(0), gapEvents(0),
+      dispatchBuffer(DISPATCH_CHUNK_SAMPLES), dispatcherRunning(false),
+      dispatchStartIndex(NO_INDEX), dispatchStopIndex(NO_INDEX),
+      dispatchedSamples(0), dispatchDropped(0), dispatchCalls(0), peakBacklog(0),
+      maxCallbackNs(0), blockSize(0), blockLatencyNs(0), blockFill(0), blockStartNs(0),
+      nextBlockConsumerId(1), blockSequence(0), blockDroppedSamples(0),
+      sampleFormat(SampleFormat::CS16) {
+    for (auto& count : eventCounts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+CallbackWrapper::~CallbackWrapper() {
+    stopDispatcher();
+}
 
-bool SampleBuffer::write(const std::complex<short>* data, size_t count) {
-    if (!data || count == 0) {
-        return true;
+bool CallbackWrapper::ActiveCallbacks::hasSample(SampleFormat format) const {
+    switch (format) {
+        case SampleFormat::CF32: return static_cast<bool>(sampleCF32);
+        case SampleFormat::CS8: return static_cast<bool>(sampleCS8);
+        case SampleFormat::CU8: return static_cast<bool>(sampleCU8);
+        default: return static_cast<bool>(sample);
     }
+}
 
-    std::lock_guard<std::mutex> lock(bufferMutex);
-    
-    // Check if enough space is available
-    size_t bufferSize = buffer.size();
-    size_t available = (readPos <= writePos) 
-        ? bufferSize - (writePos - readPos)
-        : readPos - writePos;
-    
-    // Reserve one slot to differentiate between empty and full buffer
-    if (count >= available) {
-        overflowed = true;
-        return false;
+void CallbackWrapper::ActiveCallbacks::clearSample() {
+    sample = nullptr;
+    sampleCF32 = nullptr;
+    sampleCS8 = nullptr;
+    sampleCU8 = nullptr;
+}
+
+void CallbackWrapper::setSampleCallback(SampleCallback callback) {
+    callbacks.update([&callback](ActiveCallbacks& active) {
+        active.clearSample();
+        active.sample = std::move(callback);
+    });
+}
+
+void CallbackWrapper::setSampleCallback(SampleCallbackCF32 callback) {
+    callbacks.update([&callback](ActiveCallbacks& active) {
+        active.clearSample();
+        active.sampleCF32 = std::move(callback);
+    });
+}
+
+void CallbackWrapper::setSampleCallback(SampleCallbackCS8 callback) {
+    callbacks.update([&callback](ActiveCallbacks& active) {
+        active.clearSample();
+        active.sampleCS8 = std::move(callback);
+    });
+}
+
+void CallbackWrapper::setSampleCallback(SampleCallbackCU8 callback) {
+    callbacks.update([&callback](ActiveCallbacks& active) {
+        active.clearSample();
+        active.sampleCU8 = std::move(callback);
+    });
+}
+
+void CallbackWrapper::setSampleCallback(std::nullptr_t) {
+    callbacks.update([](ActiveCallbacks& active) { active.clearSample(); });
+}
+
+bool CallbackWrapper::sampleCallbackMatches(SampleFormat format) const {
+    auto active = callbacks.read();
+    bool anySample = active->sample || active->sampleCF32 || active->sampleCS8 || active->sampleCU8;
+    return !anySample || active->hasSample(format);
+}
+
+bool CallbackWrapper::setSampleFormat(SampleFormat format) {
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    if (dispatcherThread.joinable()) {
+        return false;  // The dispatcher converts into its arena in this format
     }
-    
-    // Write data to buffer
-    for (size_t i = 0; i < count; ++i) {
-        buffer[writePos] = data[i];
-        writePos = (writePos + 1) % bufferSize;
+    sampleFormat = format;
+    sizeFormatArenas();
+    return true;
+}
+
+SampleFormat CallbackWrapper::getSampleFormat() const {
+    return sampleFormat;
+}
+
+void CallbackWrapper::sizeFormatArenas() {
+    if (sampleFormat == SampleFormat::CS16) {
+        // CS16 callbacks get the samples as they are
+        std::vector<std::complex<float>>().swap(inlineFormatArena);
+        std::vector<std::complex<float>>().swap(dispatchFormatArena);
+        return;
     }
+    // A float per sample is large enough for every format
+    inlineFormatArena.resize(std::max(scratch.size(), blockSize));
+    dispatchFormatArena.resize(dispatchBuffer.size());
+}
+
+void CallbackWrapper::setCallbackMode(CallbackMode mode) {
+    if (mode == CallbackMode::Dispatcher) {
+        startDispatcher();
+    } else {
+        stopDispatcher();
+    }
+}
+
+CallbackMode CallbackWrapper::getCallbackMode() const {
+    return callbacks.read()->dispatch ? CallbackMode::Dispatcher : CallbackMode::Inline;
+}
+
+DispatcherStats CallbackWrapper::getDispatcherStats() const {
+    DispatcherStats stats;
+    stats.dispatchedSamples = dispatchedSamples.load(std::memory_order_relaxed);
+    stats.callbackCount = dispatchCalls.load(std::memory_order_relaxed);
+    stats.peakBacklogSamples = peakBacklog.load(std::memory_order_relaxed);
+    stats.maxCallbackNs = maxCallbackNs.load(std::memory_order_relaxed);
     
-    // Notify waiting threads
-    dataAvailable.notify_all();
+    stats.droppedSamples = dispatchDropped.load(std::memory_order_relaxed);
     
-    return true;
+    std::shared_ptr<BroadcastReader> reader = std::atomic_load(&dispatchReader);
+    if (reader) {
+        stats.backlogSamples = reader->available();
+    }
+    return stats;
 }
 
-size_t SampleBuffer::read(std::complex<short>* dest, size_t maxCount) {
-    if (!dest || maxCount == 0) {
-        return 0;
+void CallbackWrapper::claimSwitchIndex(bool dispatch) {
+    // The first packet after a mode switch records where it starts in the
+    // broadcast ring, unless the switching thread already did
+    std::atomic<uint64_t>& index = dispatch ? dispatchStartIndex : dispatchStopIndex;
+    uint64_t unset = NO_INDEX;
+    if (index.load(std::memory_order_relaxed) == NO_INDEX) {
+        index.compare_exchange_strong(unset, broadcast->writeIndex(), std::memory_order_relaxed);
     }
+}
 
-    std::lock_guard<std::mutex> lock(bufferMutex);
-    
-    if (readPos == writePos) {
-        return 0;  // Buffer is empty
+void CallbackWrapper::startDispatcher() {
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    if (dispatcherThread.joinable()) {
+        return;
     }
     
-    size_t bufferSize = buffer.size();
-    size_t count = (readPos <= writePos) 
-        ? writePos - readPos 
-        : bufferSize - readPos + writePos;
+    dispatchedSamples.store(0, std::memory_order_relaxed);
+    dispatchCalls.store(0, std::memory_order_relaxed);
+    peakBacklog.store(0, std::memory_order_relaxed);
+    maxCallbackNs.store(0, std::memory_order_relaxed);
+    dispatchDropped.store(0, std::memory_order_relaxed);
+    dispatcherRunning.store(true, std::memory_order_relaxed);
     
-    count = std::min(count, maxCount);
+    // The reader starts at or before the switch; the worker skips anything
+    // before the start index, which was still delivered inline
+    std::atomic_store(&dispatchReader, broadcast->addReader(ReaderOverflowPolicy::DropOldest));
+    dispatchStartIndex.store(NO_INDEX, std::memory_order_relaxed);
     
-    // Read data from buffer
-    for (size_t i = 0; i < count; ++i) {
-        dest[i] = buffer[readPos];
-        readPos = (readPos + 1) % bufferSize;
-    }
+    // Returns once no packet that saw inline mode is still in flight
+    callbacks.update([](ActiveCallbacks& active) { active.dispatch = true; });
+    dispatchStopIndex.store(NO_INDEX, std::memory_order_relaxed);
+    claimSwitchIndex(true);
     
-    return count;
+    dispatcherThread = std::thread(&CallbackWrapper::dispatchLoop, this);
+    threadStatus = applyThreadPolicy(dispatcherThread, threadPolicy);
 }
 
-bool SampleBuffer::waitForSamples(size_t count, unsigned int timeoutMs) {
-    std::unique_lock<std::mutex> lock(bufferMutex);
-    
-    if (readPos == writePos) {
-        // Buffer is empty, wait for data
-        if (timeoutMs == 0) {
-            // Wait indefinitely
-            dataAvailable.wait(lock, [this, count]() {
-                size_t available = (readPos <= writePos) 
-                    ? writePos - readPos 
-                    : buffer.size() - readPos + writePos;
-                return available >= count;
-            });
-            return true;
-        } else {
-            // Wait with timeout
-            auto result = dataAvailable.wait_for(lock, 
-                std::chrono::milliseconds(timeoutMs), [this, count]() {
-                    size_t available = (readPos <= writePos) 
-                        ? writePos - readPos 
-                        : buffer.size() - readPos + writePos;
-                    return available >= count;
-                });
-            return result; // true if condition was met, false on timeout
-        }
+void CallbackWrapper::stopDispatcher() {
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    if (!dispatcherThread.joinable()) {
+        return;
     }
     
-    // Check if enough data is available
-    size_t available = (readPos <= writePos) 
-        ? writePos - readPos 
-        : buffer.size() - readPos + writePos;
+    // Hand delivery back to the API thread; the worker still delivers
+    // everything written before the stop index
+    callbacks.update([](ActiveCallbacks& active) { active.dispatch = false; });
+    claimSwitchIndex(false);
     
-    return available >= count;
+    dispatcherRunning.store(false, std::memory_order_release);
+    dispatcherThread.join();
+    std::atomic_store(&dispatchReader, std::shared_ptr<BroadcastReader>());
+    threadStatus = ThreadPolicyStatus();
 }
 
-size_t SampleBuffer::available() const {
-    std::lock_guard<std::mutex> lock(bufferMutex);
-    
-    if (readPos == writePos) {
-        return 0;  // Buffer is empty
+ThreadPolicyStatus CallbackWrapper::setThreadPolicy(const ThreadPolicy& policy) {
+    {
+        std::lock_guard<std::mutex> lock(dispatcherMutex);
+        threadPolicy = policy;
+        threadStatus = ThreadPolicyStatus();
+        if (dispatcherThread.joinable()) {
+            threadStatus = applyThreadPolicy(dispatcherThread, threadPolicy);
+        }
+        applyMemoryPolicy();
     }
-    
-    size_t bufferSize = buffer.size();
-    return (readPos <= writePos) 
-        ? writePos - readPos 
-        : bufferSize - readPos + writePos;
+    return getThreadPolicyStatus();
 }
 
-bool SampleBuffer::overflow() const {
-    return overflowed;
+ThreadPolicy CallbackWrapper::getThreadPolicy() const {
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    return threadPolicy;
 }
 
-void SampleBuffer::reset() {
-    std::lock_guard<std::mutex> lock(bufferMutex);
-    readPos = 0;
-    writePos = 0;
-    overflowed = false;
+ThreadPolicyStatus CallbackWrapper::getThreadPolicyStatus() const {
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    ThreadPolicyStatus status = threadStatus;
+    status.memoryLocked = memoryStatus.memoryLocked;
+    status.memoryPrefaulted = memoryStatus.memoryPrefaulted;
+    status.failures.insert(status.failures.end(),
+                           memoryStatus.failures.begin(), memoryStatus.failures.end());
+    return status;
 }
 
-size_t SampleBuffer::capacity() const {
-    return buffer.size();
+void CallbackWrapper::applyMemoryPolicy() {
+    memoryStatus = ThreadPolicyStatus();
+    std::shared_ptr<BlockPool> pool = callbacks.read()->blockPool;
+    if (!threadPolicy.lockMemory) {
+        sampleBuffer.lockMemory(false);
+        planarBuffer.lockMemory(false);
+        broadcast->lockMemory(false);
+        if (pool) {
+            pool->lockMemory(false);
+        }
+        return;
+    }
+    
+    if (sampleBuffer.lockMemory() && planarBuffer.lockMemory() && broadcast->lockMemory() &&
+        (!pool || pool->lockMemory())) {
+        memoryStatus.memoryLocked = true;
+        return;
+    }
+    std::string failure = std::string("memory lock: ") + std::strerror(errno);
+    
+    // Not allowed to lock (usually RLIMIT_MEMLOCK): at least avoid first-touch faults
+    if (sampleBuffer.prefaultMemory() && planarBuffer.prefaultMemory() && broadcast->prefaultMemory() &&
+        (!pool || pool->prefaultMemory())) {
+        memoryStatus.memoryPrefaulted = true;
+        failure += " (buffers prefaulted instead)";
+    } else {
+        failure += std::string("; prefault: ") + std::strerror(errno);
+    }
+    memoryStatus.failures.push_back(failure);
 }
 
-//------------------------------------------------------------------------------
-// CallbackWrapper implementation
-//------------------------------------------------------------------------------
+void CallbackWrapper::dispatchLoop() {
+    SDRPLAY_TRACE_THREAD_NAME("dispatcher");
+    bool deadlinePassed = false;
+    for (;;) {
+        bool running = dispatcherRunning.load(std::memory_order_acquire);
+        dispatchAvailable(!running || deadlinePassed);
+        if (!running) {
+            break;  // Everything written before the stop has been delivered
+        }
+        
+        // Wait for a whole block, or until the oldest pending sample is
+        // about to exceed its latency deadline
+        size_t want = blockSize > 0 ? dispatchBuffer.size() : 1;
+        unsigned int timeoutMs = blockLatencyNs > 0
+            ? static_cast<unsigned int>(std::max<uint64_t>(blockLatencyNs / 1000000u, 1)) : 50;
+        bool ready = dispatchReader->waitForSamples(want, timeoutMs);
+        deadlinePassed = !ready && blockLatencyNs > 0;
+    }
+}
 
-CallbackWrapper::CallbackWrapper(size_t bufferSize)
-    : sampleBuffer(bufferSize), streamActive(false) {}
+void CallbackWrapper::dispatchAvailable(bool flushPartial) {
+    SDRPLAY_TRACE_SCOPE("dispatch");
+    size_t backlog = dispatchReader->available();
+    size_t peak = peakBacklog.load(std::memory_order_relaxed);
+    if (backlog > peak) {
+        peakBacklog.store(backlog, std::memory_order_relaxed);
+    }
+    
+    // Only samples in [start index, stop index) are dispatched; the rest
+    // are delivered inline by the API thread
+    uint64_t startIndex = dispatchStartIndex.load(std::memory_order_relaxed);
+    for (;;) {
+        // Partial blocks only go out at a deadline or when stopping
+        if (blockSize > 0 && !flushPartial && dispatchReader->available() < dispatchBuffer.size()) {
+            break;
+        }
+        size_t count = dispatchReader->read(dispatchBuffer.data(), dispatchBuffer.size());
+        if (count == 0) {
+            break;
+        }
+        
+        // Reloaded after the read: a stop that raced with it is visible by
+        // now for any sample written after it
+        uint64_t stopIndex = dispatchStopIndex.load(std::memory_order_relaxed);
+        uint64_t end = dispatchReader->readIndex();
+        uint64_t begin = end - count;
+        size_t skip = begin < startIndex
+            ? static_cast<size_t>(std::min<uint64_t>(startIndex - begin, count)) : 0;
+        if (end > stopIndex) {
+            count -= static_cast<size_t>(std::min<uint64_t>(end - stopIndex, count));
+        }
+        if (count <= skip) {
+            if (end > stopIndex) {
+                break;
+            }
+            continue;
+        }
+        
+        // Hold the callbacks only for the call, so updates wait at most one call
+        auto active = callbacks.read();
+        if (!active->hasSample(sampleFormat)) {
+            continue;  // Keep draining so the reader does not count stale drops
+        }
+        
+        auto started = std::chrono::steady_clock::now();
+        invokeSampleCallback(*active, dispatchBuffer.data() + skip, count - skip, dispatchFormatArena);
+        uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started).count());
+        
+        dispatchedSamples.fetch_add(count - skip, std::memory_order_relaxed);
+        dispatchCalls.fetch_add(1, std::memory_order_relaxed);
+        if (elapsed > maxCallbackNs.load(std::memory_order_relaxed)) {
+            maxCallbackNs.store(elapsed, std::memory_order_relaxed);
+        }
+    }
+    
+    // Kept here so the count survives the reader when the dispatcher stops
+    dispatchDropped.store(dispatchReader->droppedSamples(), std::memory_order_relaxed);
+}
 
-CallbackWrapper::~CallbackWrapper() {}
+bool CallbackWrapper::setCallbackBlockSize(size_t blockSamples, unsigned int maxLatencyMs) {
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    if (dispatcherThread.joinable()) {
+        return false;  // The dispatcher reads into dispatchBuffer and waits on blockSize
+    }
+    blockSize = blockSamples;
+    blockLatencyNs = static_cast<uint64_t>(maxLatencyMs) * 1000000u;
+    blockBuffer.assign(blockSamples, std::complex<short>(0, 0));
+    blockFill = 0;
+    
+    // The dispatcher reads whole blocks out of its broadcast reader
+    dispatchBuffer.resize(blockSamples > 0 ? std::min(blockSamples, broadcast->capacity())
+                                           : DISPATCH_CHUNK_SAMPLES);
+    sizeFormatArenas();
+    return true;
+}
 
-void CallbackWrapper::setSampleCallback(SampleCallback callback) {
-    std::lock_guard<std::mutex> lock(callbackMutex);
-    m_sampleCallback = callback;
+size_t CallbackWrapper::getCallbackBlockSize() const {
+    return blockSize;
 }
 
 void CallbackWrapper::setEventCallback(EventCallback callback) {
-    std::lock_guard<std::mutex> lock(callbackMutex);
-    m_eventCallback = callback;
+    callbacks.update([&callback](ActiveCallbacks& active) { active.event = std::move(callback); });
+}
+
+void CallbackWrapper::prepareStream(size_t maxPacketSamples) {
+    scratch.resize(std::max<size_t>(maxPacketSamples, 1));
+    // Only the inline arena depends on the packet size; the dispatcher's
+    // may be in use
+    if (sampleFormat != SampleFormat::CS16) {
+        inlineFormatArena.resize(std::max(scratch.size(), blockSize));
+    }
+    haveExpectedSampleNum = false;
+    missingSamples.store(0, std::memory_order_relaxed);
+    gapEvents.store(0, std::memory_order_relaxed);
+    streamStats.reset();
+}
+
+void CallbackWrapper::configureBuffer(size_t bufferSize, RingLayout layout, bool planar,
+                                      std::shared_ptr<RingAllocator> allocator) {
+    // Only the buffer behind readSamples() gets the capacity; the other is
+    // shrunk to a single sample on the heap
+    planarStorage.store(planar, std::memory_order_relaxed);
+    if (planar) {
+        sampleBuffer.reconfigure(1, RingLayout::Standard);
+        planarBuffer.reconfigure(bufferSize, layout, allocator);
+    } else {
+        sampleBuffer.reconfigure(bufferSize, layout, allocator);
+        planarBuffer.reconfigure(1, RingLayout::Standard);
+    }
+    planarReadScratch.assign(planar ? PLANAR_READ_CHUNK : 0, std::complex<short>(0, 0));
+    // Readers still holding the broadcast ring keep it as it is; otherwise
+    // it is reallocated when the next reader registers
+    broadcast->reconfigure(bufferSize, layout, allocator);
+    // Enough tags to cover a full buffer of the smallest API packets
+    streamTags.reconfigure(std::max(DEFAULT_TAG_CAPACITY, bufferSize / 256));
+    
+    // New storage starts out unlocked
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    if (threadPolicy.lockMemory) {
+        applyMemoryPolicy();
+    }
 }
 
 sdrplay_api_StreamCallback_t CallbackWrapper::getStreamCallback() {
@@ -159,24 +414,297 @@ sdrplay_api_EventCallback_t CallbackWrapper::getEventCallback() {
     return &CallbackWrapper::eventCallback;
 }
 
+bool CallbackWrapper::isPlanarStorage() const {
+    return planarStorage.load(std::memory_order_relaxed);
+}
+
 bool CallbackWrapper::waitForSamples(size_t count, unsigned int timeoutMs) {
+    if (isPlanarStorage()) {
+        return planarBuffer.waitForSamples(count, timeoutMs);
+    }
     return sampleBuffer.waitForSamples(count, timeoutMs);
 }
 
+int CallbackWrapper::enableSampleEvent(size_t lowWatermark) {
+    int fd = sampleEvent.enable(lowWatermark);
+    if (fd >= 0) {
+        sampleEvent.update(samplesAvailable());  // Samples may already be waiting
+    }
+    return fd;
+}
+
+void CallbackWrapper::disableSampleEvent() {
+    sampleEvent.disable();
+}
+
+void CallbackWrapper::acknowledgeSampleEvent() {
+    sampleEvent.clear();
+    sampleEvent.update(samplesAvailable());
+}
+
+uint64_t CallbackWrapper::getSampleEventCount() const {
+    return sampleEvent.signalCount();
+}
+
+namespace {
+
+// Convert straight out of the ring; like read(), the result is discarded if
+// the samples were overwritten while converting
+template <typename T, typename Convert>
+size_t readConverted(SampleBuffer& buffer, T* dest, size_t maxCount, size_t valuesPerSample,
+                     Convert convert) {
+    if (!dest || maxCount == 0) {
+        return 0;
+    }
+    SampleSpans spans = buffer.peek(maxCount);
+    convert(spans.first.data, dest, spans.first.size);
+    convert(spans.second.data, dest + spans.first.size * valuesPerSample, spans.second.size);
+    return buffer.consume(spans.size());
+}
+
+// Planar storage is interleaved a chunk at a time before converting
+template <typename T, typename Convert>
+size_t readConverted(PlanarBuffer& buffer, std::vector<std::complex<short>>& scratch, T* dest,
+                     size_t maxCount, size_t valuesPerSample, Convert convert) {
+    if (!dest || maxCount == 0) {
+        return 0;
+    }
+    PlanarSpans spans = buffer.peek(maxCount);
+    for (const PlanarSpan& span : { spans.first, spans.second }) {
+        for (size_t done = 0; done < span.size; ) {
+            size_t n = std::min(scratch.size(), span.size - done);
+            interleaveIQ(span.i + done, span.q + done, scratch.data(), n);
+            convert(scratch.data(), dest, n);
+            dest += n * valuesPerSample;
+            done += n;
+        }
+    }
+    return buffer.consume(spans.size());
+}
+
+void toCF32(const std::complex<short>* src, std::complex<float>* out, size_t n) {
+    convertToCF32(src, out, n);
+}
+
+} // namespace
+
 size_t CallbackWrapper::readSamples(std::complex<short>* dest, size_t maxCount) {
+    SDRPLAY_TRACE_SCOPE("ring_read");
+    if (isPlanarStorage()) {
+        // Interleaving is the only pass needed, so it goes straight into dest
+        if (!dest || maxCount == 0) {
+            return 0;
+        }
+        PlanarSpans spans = planarBuffer.peek(maxCount);
+        interleaveIQ(spans.first.i, spans.first.q, dest, spans.first.size);
+        interleaveIQ(spans.second.i, spans.second.q, dest + spans.first.size, spans.second.size);
+        return planarBuffer.consume(spans.size());
+    }
     return sampleBuffer.read(dest, maxCount);
 }
 
+size_t CallbackWrapper::readSamples(std::complex<float>* dest, size_t maxCount) {
+    SDRPLAY_TRACE_SCOPE("ring_read_convert");
+    if (isPlanarStorage()) {
+        return readConverted(planarBuffer, planarReadScratch, dest, maxCount, 1, &toCF32);
+    }
+    return readConverted(sampleBuffer, dest, maxCount, 1, &toCF32);
+}
+
+size_t CallbackWrapper::readSamples(int8_t* dest, size_t maxCount) {
+    SDRPLAY_TRACE_SCOPE("ring_read_convert");
+    void (*convert)(const std::complex<short>*, int8_t*, size_t) = &convertToCS8;
+    if (isPlanarStorage()) {
+        return readConverted(planarBuffer, planarReadScratch, dest, maxCount, 2, convert);
+    }
+    return readConverted(sampleBuffer, dest, maxCount, 2, convert);
+}
+
+size_t CallbackWrapper::readSamples(uint8_t* dest, size_t maxCount) {
+    SDRPLAY_TRACE_SCOPE("ring_read_convert");
+    void (*convert)(const std::complex<short>*, uint8_t*, size_t) = &convertToCU8;
+    if (isPlanarStorage()) {
+        return readConverted(planarBuffer, planarReadScratch, dest, maxCount, 2, convert);
+    }
+    return readConverted(sampleBuffer, dest, maxCount, 2, convert);
+}
+
+size_t CallbackWrapper::readPlanar(short* xi, short* xq, size_t maxCount) {
+    SDRPLAY_TRACE_SCOPE("ring_read");
+    if (!isPlanarStorage()) {
+        return 0;
+    }
+    return planarBuffer.read(xi, xq, maxCount);
+}
+
+SampleSpans CallbackWrapper::peekSamples(size_t maxCount) {
+    if (isPlanarStorage()) {
+        return SampleSpans();
+    }
+    return sampleBuffer.peek(maxCount);
+}
+
+PlanarSpans CallbackWrapper::peekPlanar(size_t maxCount) {
+    if (!isPlanarStorage()) {
+        return PlanarSpans();
+    }
+    return planarBuffer.peek(maxCount);
+}
+
+size_t CallbackWrapper::consumeSamples(size_t count) {
+    SDRPLAY_TRACE_SCOPE("ring_consume");
+    if (isPlanarStorage()) {
+        return planarBuffer.consume(count);
+    }
+    return sampleBuffer.consume(count);
+}
+
+uint64_t CallbackWrapper::getReadIndex() const {
+    return isPlanarStorage() ? planarBuffer.readIndex() : sampleBuffer.readIndex();
+}
+
+uint64_t CallbackWrapper::storedWriteIndex() const {
+    return isPlanarStorage() ? planarBuffer.writeIndex() : sampleBuffer.writeIndex();
+}
+
+std::vector<StreamTag> CallbackWrapper::getStreamTags(uint64_t startIndex, size_t count) const {
+    return streamTags.query(startIndex, count);
+}
+
+std::shared_ptr<BroadcastReader> CallbackWrapper::addSampleReader(ReaderOverflowPolicy policy) {
+    return broadcast->addReader(policy);
+}
+
+void CallbackWrapper::enableSampleBlocks(size_t blockCount, size_t blockSamples,
+                                         std::shared_ptr<RingAllocator> allocator) {
+    std::shared_ptr<BlockPool> pool = BlockPool::create(blockCount, blockSamples, std::move(allocator));
+    callbacks.update([&pool](ActiveCallbacks& active) { active.blockPool = pool; });
+    blockDroppedSamples.store(0, std::memory_order_relaxed);
+    
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    if (threadPolicy.lockMemory) {
+        applyMemoryPolicy();
+    }
+}
+
+void CallbackWrapper::disableSampleBlocks() {
+    callbacks.update([](ActiveCallbacks& active) { active.blockPool.reset(); });
+}
+
+size_t CallbackWrapper::addBlockConsumer(BlockCallback consumer) {
+    size_t id = nextBlockConsumerId.fetch_add(1, std::memory_order_relaxed);
+    callbacks.update([id, &consumer](ActiveCallbacks& active) {
+        active.blockConsumers.emplace_back(id, std::move(consumer));
+    });
+    return id;
+}
+
+void CallbackWrapper::removeBlockConsumer(size_t id) {
+    callbacks.update([id](ActiveCallbacks& active) {
+        auto& consumers = active.blockConsumers;
+        consumers.erase(std::remove_if(consumers.begin(), consumers.end(),
+                                       [id](const std::pair<size_t, BlockCallback>& entry) {
+                                           return entry.first == id;
+                                       }),
+                        consumers.end());
+    });
+}
+
+BlockPoolStats CallbackWrapper::getBlockPoolStats() const {
+    BlockPoolStats stats;
+    auto active = callbacks.read();
+    if (active->blockPool) {
+        stats = active->blockPool->getStats();
+        stats.droppedSamples = blockDroppedSamples.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+StreamStats CallbackWrapper::getStreamStats() const {
+    StreamStats stats;
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    streamStats.snapshot(stats, now);
+    
+    stats.bufferCapacity = isPlanarStorage() ? planarBuffer.capacity() : sampleBuffer.capacity();
+    stats.consumerLagSamples = samplesAvailable();
+    if (stats.sampleRate > 0.0) {
+        stats.consumerLagNs = static_cast<uint64_t>(stats.consumerLagSamples * 1e9 / stats.sampleRate);
+    }
+    stats.droppedSamples = getDroppedSampleCount();
+    stats.overflowEvents = getOverflowEventCount();
+    stats.missingSamples = getMissingSampleCount();
+    stats.gapEvents = getGapEventCount();
+    return stats;
+}
+
 size_t CallbackWrapper::samplesAvailable() const {
-    return sampleBuffer.available();
+    return isPlanarStorage() ? planarBuffer.available() : sampleBuffer.available();
 }
 
 bool CallbackWrapper::hasOverflow() const {
-    return sampleBuffer.overflow();
+    return isPlanarStorage() ? planarBuffer.overflow() : sampleBuffer.overflow();
+}
+
+void CallbackWrapper::setWaitStrategy(WaitStrategy strategy, unsigned int spinUs) {
+    sampleBuffer.setWaitStrategy(strategy, spinUs);
+    planarBuffer.setWaitStrategy(strategy, spinUs);
+}
+
+WaitStrategy CallbackWrapper::getWaitStrategy() const {
+    return sampleBuffer.getWaitStrategy();
+}
+
+void CallbackWrapper::setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs) {
+    sampleBuffer.setOverflowPolicy(policy, blockTimeoutMs);
+    planarBuffer.setOverflowPolicy(policy, blockTimeoutMs);
+}
+
+OverflowPolicy CallbackWrapper::getOverflowPolicy() const {
+    return sampleBuffer.getOverflowPolicy();
+}
+
+uint64_t CallbackWrapper::getDroppedSampleCount() const {
+    return isPlanarStorage() ? planarBuffer.droppedSamples() : sampleBuffer.droppedSamples();
+}
+
+uint64_t CallbackWrapper::getOverflowEventCount() const {
+    return isPlanarStorage() ? planarBuffer.overflowEvents() : sampleBuffer.overflowEvents();
+}
+
+void CallbackWrapper::setGapFill(bool enable, size_t maxFillSamples) {
+    maxGapFill.store(maxFillSamples, std::memory_order_relaxed);
+    gapFillEnabled.store(enable, std::memory_order_relaxed);
+}
+
+bool CallbackWrapper::getGapFill() const {
+    return gapFillEnabled.load(std::memory_order_relaxed);
+}
+
+uint64_t CallbackWrapper::getMissingSampleCount() const {
+    return missingSamples.load(std::memory_order_relaxed);
+}
+
+uint64_t CallbackWrapper::getGapEventCount() const {
+    return gapEvents.load(std::memory_order_relaxed);
+}
+
+uint64_t CallbackWrapper::getEventCount(EventType type) const {
+    size_t index = static_cast<size_t>(type);
+    return index < EVENT_TYPES ? eventCounts[index].load(std::memory_order_relaxed) : 0;
 }
 
 void CallbackWrapper::resetBuffer() {
     sampleBuffer.reset();
+    planarBuffer.reset();
+}
+
+const SampleBuffer& CallbackWrapper::getSampleBuffer() const {
+    return sampleBuffer;
+}
+
+const PlanarBuffer& CallbackWrapper::getPlanarBuffer() const {
+    return planarBuffer;
 }
 
 void* CallbackWrapper::getContext() {
@@ -214,9 +742,14 @@ void CallbackWrapper::processStreamCallback(short *xi, short *xq,
                                           sdrplay_api_StreamCbParamsT *params,
                                           unsigned int numSamples, 
                                           unsigned int reset) {
+    auto arrival = std::chrono::steady_clock::now().time_since_epoch();
+    SDRPLAY_TRACE_THREAD_NAME("sdrplay_api stream");
+    SDRPLAY_TRACE_SCOPE("stream_callback");
+    
     // Handle reset condition
     if (reset) {
         resetBuffer();
+        streamStats.reset();
         streamActive = true;
     }
     
@@ -224,25 +757,255 @@ void CallbackWrapper::processStreamCallback(short *xi, short *xq,
         return;
     }
     
-    // Convert separate I/Q arrays to complex samples
-    std::vector<std::complex<short>> samples(numSamples);
-    for (unsigned int i = 0; i < numSamples; ++i) {
-        samples[i] = std::complex<short>(xi[i], xq[i]);
+    StreamTag tag;
+    tag.timestampNs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(arrival).count());
+    if (params) {
+        tag.firstSampleNum = params->firstSampleNum;
+        tag.grChanged = params->grChanged != 0;
+        tag.rfChanged = params->rfChanged != 0;
+        tag.fsChanged = params->fsChanged != 0;
     }
+    tag.reset = reset != 0;
+    streamStats.recordPacket(tag.timestampNs, numSamples, tag.fsChanged);
     
-    // Write samples to buffer
-    bool success = sampleBuffer.write(samples.data(), numSamples);
+    // Lock-free snapshot of the callbacks, held for the whole packet
+    auto active = callbacks.read();
+    claimSwitchIndex(active->dispatch);
+    if (active->dispatch && blockFill > 0) {
+        flushBlock(*active);  // Inline samples go out before the dispatcher takes over
+    }
     
-    // Call user callback if provided
-    std::lock_guard<std::mutex> lock(callbackMutex);
-    if (m_sampleCallback) {
-        m_sampleCallback(samples.data(), numSamples);
+    // Account for samples the API dropped before this packet
+    uint32_t missing = checkContinuity(params, numSamples, tag.reset || tag.fsChanged);
+    if (missing > 0) {
+        tag.gap = true;
+        if (gapFillEnabled.load(std::memory_order_relaxed)) {
+            fillGap(*active, tag, std::min<size_t>(missing, maxGapFill.load(std::memory_order_relaxed)));
+        }
+    }
+    
+    // Planar storage takes the API arrays as they are; interleaving is only
+    // needed for the interleaved buffer, broadcast readers and callbacks
+    bool publish = active->blockPool && !active->blockConsumers.empty();
+    bool planar = isPlanarStorage();
+    bool interleave = !planar || broadcast->readerCount() > 0 || publish ||
+                      (!active->dispatch && active->hasSample(sampleFormat));
+    
+    // Convert separate I/Q arrays to complex samples in the preallocated
+    // arena, one arena-sized piece at a time
+    size_t offset = 0;
+    while (offset < numSamples) {
+        size_t count = std::min<size_t>(numSamples - offset, scratch.size());
+        if (interleave) {
+            interleaveIQ(xi + offset, xq + offset, scratch.data(), count);
+        }
+        
+        // Write samples to buffer and tag where they landed
+        tag.sampleIndex = storedWriteIndex();
+        {
+            SDRPLAY_TRACE_SCOPE("ring_write");
+            if (planar) {
+                planarBuffer.write(xi + offset, xq + offset, count);
+            } else {
+                sampleBuffer.write(scratch.data(), count);
+            }
+        }
+        if (interleave) {
+            SDRPLAY_TRACE_SCOPE("broadcast_write");
+            broadcast->write(scratch.data(), count);
+        }
+        tag.numSamples = static_cast<uint32_t>(storedWriteIndex() - tag.sampleIndex);
+        streamTags.append(tag);
+        
+        // Call user callback if provided, unless the dispatcher delivers it
+        if (interleave) {
+            deliverSamples(*active, scratch.data(), count, tag.timestampNs);
+        }
+        if (publish) {
+            publishBlocks(*active, scratch.data(), count, tag);
+        }
+        offset += count;
+        
+        // Change flags belong to the start of the packet only
+        tag.firstSampleNum += static_cast<uint32_t>(count);
+        tag.grChanged = tag.rfChanged = tag.fsChanged = tag.reset = tag.gap = false;
+    }
+    
+    // One fill-level check per packet; the notifier coalesces the wakeups
+    size_t buffered = samplesAvailable();
+    streamStats.recordFill(buffered);
+    if (sampleEvent.enabled()) {
+        sampleEvent.update(buffered);
+    }
+    
+    // Don't let a partial block wait past its deadline
+    if (blockFill > 0 && blockLatencyNs > 0 && tag.timestampNs - blockStartNs >= blockLatencyNs) {
+        flushBlock(*active);
+    }
+}
+
+void CallbackWrapper::deliverSamples(const ActiveCallbacks& active, const std::complex<short>* samples,
+                                     size_t count, uint64_t arrivalNs) {
+    if (active.dispatch || !active.hasSample(sampleFormat)) {
+        return;
+    }
+    if (blockSize == 0) {
+        invokeSampleCallback(active, samples, count, inlineFormatArena);
+        return;
+    }
+    
+    while (count > 0) {
+        // Whole blocks straight from the arena when nothing is pending
+        if (blockFill == 0 && count >= blockSize) {
+            invokeSampleCallback(active, samples, blockSize, inlineFormatArena);
+            samples += blockSize;
+            count -= blockSize;
+            continue;
+        }
+        
+        if (blockFill == 0) {
+            blockStartNs = arrivalNs;
+        }
+        size_t n = std::min(count, blockSize - blockFill);
+        std::copy(samples, samples + n, blockBuffer.begin() + blockFill);
+        blockFill += n;
+        samples += n;
+        count -= n;
+        
+        if (blockFill == blockSize) {
+            flushBlock(active);
+        }
+    }
+}
+
+void CallbackWrapper::flushBlock(const ActiveCallbacks& active) {
+    if (blockFill > 0 && active.hasSample(sampleFormat)) {
+        invokeSampleCallback(active, blockBuffer.data(), blockFill, inlineFormatArena);
+    }
+    blockFill = 0;
+}
+
+void CallbackWrapper::invokeSampleCallback(const ActiveCallbacks& active,
+                                           const std::complex<short>* samples, size_t count,
+                                           std::vector<std::complex<float>>& arena) {
+    SDRPLAY_TRACE_SCOPE("sample_callback");
+    switch (sampleFormat) {
+        case SampleFormat::CF32:
+            convertToCF32(samples, arena.data(), count);
+            active.sampleCF32(arena.data(), count);
+            break;
+        case SampleFormat::CS8: {
+            int8_t* out = reinterpret_cast<int8_t*>(arena.data());
+            convertToCS8(samples, out, count);
+            active.sampleCS8(out, count);
+            break;
+        }
+        case SampleFormat::CU8: {
+            uint8_t* out = reinterpret_cast<uint8_t*>(arena.data());
+            convertToCU8(samples, out, count);
+            active.sampleCU8(out, count);
+            break;
+        }
+        default:
+            active.sample(samples, count);
+            break;
+    }
+}
+
+void CallbackWrapper::publishBlocks(const ActiveCallbacks& active, const std::complex<short>* samples,
+                                    size_t count, const StreamTag& tag) {
+    if (!active.blockPool || active.blockConsumers.empty()) {
+        return;
+    }
+    SDRPLAY_TRACE_SCOPE("block_publish");
+    uint32_t firstSampleNum = tag.firstSampleNum;
+    size_t blockSamples = active.blockPool->blockSamples();
+    while (count > 0) {
+        size_t n = std::min(count, blockSamples);
+        SampleBlockWriter block = active.blockPool->acquire();
+        if (block) {
+            std::copy(samples, samples + n, block->data());
+            block->resize(n);
+            block->sequence = blockSequence;
+            block->firstSampleNum = firstSampleNum;
+            block->timestampNs = tag.timestampNs;
+            SampleBlockRef ref = block.publish();
+            for (const auto& consumer : active.blockConsumers) {
+                consumer.second(ref);
+            }
+        } else {
+            // Every block is still held downstream
+            blockDroppedSamples.fetch_add(n, std::memory_order_relaxed);
+        }
+        ++blockSequence;
+        firstSampleNum += static_cast<uint32_t>(n);
+        samples += n;
+        count -= n;
+    }
+}
+
+void CallbackWrapper::flushSampleBlock() {
+    auto active = callbacks.read();
+    flushBlock(*active);
+}
+
+uint32_t CallbackWrapper::checkContinuity(const sdrplay_api_StreamCbParamsT *params,
+                                          unsigned int numSamples, bool restart) {
+    if (!params) {
+        return 0;
+    }
+    
+    uint32_t missing = 0;
+    if (haveExpectedSampleNum && !restart) {
+        // The counter wraps at 32 bits; a step backwards is a counter
+        // restart rather than loss, so only forward jumps are counted
+        uint32_t delta = params->firstSampleNum - expectedSampleNum;
+        if (delta != 0 && delta < 0x80000000u) {
+            missing = delta;
+            missingSamples.fetch_add(delta, std::memory_order_relaxed);
+            gapEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    expectedSampleNum = params->firstSampleNum + numSamples;
+    haveExpectedSampleNum = true;
+    return missing;
+}
+
+void CallbackWrapper::fillGap(const ActiveCallbacks& active, const StreamTag& tag, size_t count) {
+    SDRPLAY_TRACE_SCOPE("gap_fill");
+    StreamTag fillTag;
+    fillTag.timestampNs = tag.timestampNs;
+    fillTag.firstSampleNum = tag.firstSampleNum - static_cast<uint32_t>(count);
+    fillTag.zeroFill = true;
+    
+    std::fill(scratch.begin(), scratch.end(), std::complex<short>(0, 0));
+    const short* zeros = reinterpret_cast<const short*>(scratch.data());
+    while (count > 0) {
+        size_t chunk = std::min(count, scratch.size());
+        
+        fillTag.sampleIndex = storedWriteIndex();
+        if (isPlanarStorage()) {
+            planarBuffer.write(zeros, zeros, chunk);
+        } else {
+            sampleBuffer.write(scratch.data(), chunk);
+        }
+        broadcast->write(scratch.data(), chunk);
+        fillTag.numSamples = static_cast<uint32_t>(storedWriteIndex() - fillTag.sampleIndex);
+        streamTags.append(fillTag);
+        
+        deliverSamples(active, scratch.data(), chunk, tag.timestampNs);
+        publishBlocks(active, scratch.data(), chunk, fillTag);
+        fillTag.firstSampleNum += static_cast<uint32_t>(chunk);
+        count -= chunk;
     }
 }
 
 void CallbackWrapper::processEventCallback(sdrplay_api_EventT eventId,
                                          sdrplay_api_TunerSelectT tuner,
                                          sdrplay_api_EventParamsT *params) {
+    SDRPLAY_TRACE_SCOPE("event_callback");
     EventType type = EventType::None;
     EventParams eventParams;
     
@@ -280,11 +1043,12 @@ void CallbackWrapper::processEventCallback(sdrplay_api_EventT eventId,
             type = EventType::None;
             break;
     }
+    eventCounts[static_cast<size_t>(type)].fetch_add(1, std::memory_order_relaxed);
     
     // Call user callback if provided
-    std::lock_guard<std::mutex> lock(callbackMutex);
-    if (m_eventCallback) {
-        m_eventCallback(type, eventParams);
+    auto active = callbacks.read();
+    if (active->event) {
+        active->event(type, eventParams);
     }
 }
 
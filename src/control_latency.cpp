@@ -0,0 +1,26 @@
+#include "control_latency.h"
+#include <cmath>
+
+namespace sdrplay {
+
+void ControlLatency::record(ControlOperation op, uint64_t ns) {
+    histograms[static_cast<size_t>(op)].record(ns);
+}
+
+ControlLatencyStats ControlLatency::snapshot(ControlOperation op) const {
+    const LatencyHistogram& histogram = histograms[static_cast<size_t>(op)];
+    ControlLatencyStats stats;
+    stats.count = histogram.count();
+    if (stats.count == 0) {
+        return stats;
+    }
+    stats.sumNs = static_cast<uint64_t>(std::llround(histogram.mean() * static_cast<double>(stats.count)));
+    stats.minNs = histogram.min();
+    stats.maxNs = histogram.max();
+    stats.p50Ns = histogram.percentile(50.0);
+    stats.p90Ns = histogram.percentile(90.0);
+    stats.p99Ns = histogram.percentile(99.0);
+    return stats;
+}
+
+} // namespace sdrplay
@@ -2,6 +2,7 @@
 #include "control_params.h"
 #include "device_control.h"
 #include "sdrplay_api.h"
+#include "trace.h"
 #include <stdexcept>
 #include <iostream>
 
@@ -67,9 +68,8 @@ bool ControlParams::update() {
             sdrplay_api_Update_Ctrl_Agc
         );
 
-    sdrplay_api_ErrT err = sdrplay_api_Update(
-        device->dev,
-        device->tuner,
+    SDRPLAY_TRACE_SCOPE("sdrplay_api_Update");
+    sdrplay_api_ErrT err = pimpl->deviceControl->updateDevice(
         reason,
         sdrplay_api_Update_Ext1_None
     );
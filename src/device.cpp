@@ -9,6 +9,7 @@
 #include <string>
 #include <stdexcept>
 #include <iostream>
+#include <utility>
 
 namespace sdrplay {
 
@@ -22,8 +23,8 @@ bool Device::selectDevice(const DeviceInfo& deviceInfo) {
             return false;
         }
 
-        // Initialize the device
-        if (!control->open()) {
+        // Initialize the device and claim it from the API
+        if (!control->open() || !control->selectDevice(deviceInfo)) {
             return false;
         }
 
@@ -117,6 +118,14 @@ bool Device::startStreaming(bool enableDcCorrection,
     return pimpl->deviceControl->startStreaming(params);
 }
 
+bool Device::startStreaming(const StreamingParams& params) {
+    if (!pimpl->deviceControl) {
+        return false;
+    }
+    
+    return pimpl->deviceControl->startStreaming(params);
+}
+
 bool Device::stopStreaming() {
     if (!pimpl->deviceControl) {
         return false;
@@ -139,6 +148,30 @@ void Device::setSampleCallback(std::function<void(const std::complex<short>*, si
     }
 }
 
+void Device::setSampleCallback(std::function<void(const std::complex<float>*, size_t)> callback) {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->setSampleCallback(callback);
+    }
+}
+
+void Device::setSampleCallback(std::function<void(const int8_t*, size_t)> callback) {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->setSampleCallback(callback);
+    }
+}
+
+void Device::setSampleCallback(std::function<void(const uint8_t*, size_t)> callback) {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->setSampleCallback(callback);
+    }
+}
+
+void Device::setSampleCallback(std::nullptr_t) {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->setSampleCallback(nullptr);
+    }
+}
+
 void Device::setEventCallback(std::function<void(EventType, const EventParams&)> callback) {
     if (pimpl->deviceControl) {
         pimpl->deviceControl->setEventCallback(callback);
@@ -153,6 +186,26 @@ bool Device::waitForSamples(size_t count, unsigned int timeoutMs) {
     return pimpl->deviceControl->waitForSamples(count, timeoutMs);
 }
 
+int Device::enableSampleEvent(size_t lowWatermark) {
+    if (!pimpl->deviceControl) {
+        return -1;
+    }
+    
+    return pimpl->deviceControl->enableSampleEvent(lowWatermark);
+}
+
+void Device::disableSampleEvent() {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->disableSampleEvent();
+    }
+}
+
+void Device::acknowledgeSampleEvent() {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->acknowledgeSampleEvent();
+    }
+}
+
 size_t Device::readSamples(std::complex<short>* buffer, size_t maxCount) {
     if (!pimpl->deviceControl) {
         return 0;
@@ -161,6 +214,113 @@ size_t Device::readSamples(std::complex<short>* buffer, size_t maxCount) {
     return pimpl->deviceControl->readSamples(buffer, maxCount);
 }
 
+size_t Device::readSamples(std::complex<float>* buffer, size_t maxCount) {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->readSamples(buffer, maxCount);
+}
+
+size_t Device::readSamples(int8_t* buffer, size_t maxCount) {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->readSamples(buffer, maxCount);
+}
+
+size_t Device::readSamples(uint8_t* buffer, size_t maxCount) {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->readSamples(buffer, maxCount);
+}
+
+SampleSpans Device::peekSamples(size_t maxCount) {
+    if (!pimpl->deviceControl) {
+        return SampleSpans();
+    }
+    
+    return pimpl->deviceControl->peekSamples(maxCount);
+}
+
+size_t Device::readPlanar(short* xi, short* xq, size_t maxCount) {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->readPlanar(xi, xq, maxCount);
+}
+
+PlanarSpans Device::peekPlanar(size_t maxCount) {
+    if (!pimpl->deviceControl) {
+        return PlanarSpans();
+    }
+    
+    return pimpl->deviceControl->peekPlanar(maxCount);
+}
+
+size_t Device::consumeSamples(size_t count) {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->consumeSamples(count);
+}
+
+std::shared_ptr<BroadcastReader> Device::addSampleReader(ReaderOverflowPolicy policy) {
+    if (!pimpl->deviceControl) {
+        return nullptr;
+    }
+    
+    return pimpl->deviceControl->addSampleReader(policy);
+}
+
+void Device::enableSampleBlocks(size_t blockCount, size_t blockSamples,
+                                std::shared_ptr<RingAllocator> allocator) {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->enableSampleBlocks(blockCount, blockSamples, std::move(allocator));
+    }
+}
+
+void Device::disableSampleBlocks() {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->disableSampleBlocks();
+    }
+}
+
+size_t Device::addBlockConsumer(CallbackWrapper::BlockCallback consumer) {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->addBlockConsumer(std::move(consumer));
+}
+
+void Device::removeBlockConsumer(size_t id) {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->removeBlockConsumer(id);
+    }
+}
+
+uint64_t Device::getReadIndex() const {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->getReadIndex();
+}
+
+std::vector<StreamTag> Device::getStreamTags(uint64_t startIndex, size_t count) const {
+    if (!pimpl->deviceControl) {
+        return std::vector<StreamTag>();
+    }
+    
+    return pimpl->deviceControl->getStreamTags(startIndex, count);
+}
+
 size_t Device::samplesAvailable() const {
     if (!pimpl->deviceControl) {
         return 0;
@@ -177,6 +337,132 @@ bool Device::hasBufferOverflow() const {
     return pimpl->deviceControl->hasBufferOverflow();
 }
 
+void Device::setWaitStrategy(WaitStrategy strategy, unsigned int spinUs) {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->setWaitStrategy(strategy, spinUs);
+    }
+}
+
+WaitStrategy Device::getWaitStrategy() const {
+    if (!pimpl->deviceControl) {
+        return WaitStrategy::Block;
+    }
+    
+    return pimpl->deviceControl->getWaitStrategy();
+}
+
+void Device::setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs) {
+    if (pimpl->deviceControl) {
+        pimpl->deviceControl->setOverflowPolicy(policy, blockTimeoutMs);
+    }
+}
+
+OverflowPolicy Device::getOverflowPolicy() const {
+    if (!pimpl->deviceControl) {
+        return OverflowPolicy::DropNewest;
+    }
+    
+    return pimpl->deviceControl->getOverflowPolicy();
+}
+
+uint64_t Device::getDroppedSampleCount() const {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->getDroppedSampleCount();
+}
+
+uint64_t Device::getOverflowEventCount() const {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->getOverflowEventCount();
+}
+
+uint64_t Device::getMissingSampleCount() const {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->getMissingSampleCount();
+}
+
+uint64_t Device::getGapEventCount() const {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->getGapEventCount();
+}
+
+DispatcherStats Device::getDispatcherStats() const {
+    if (!pimpl->deviceControl) {
+        return DispatcherStats();
+    }
+    
+    return pimpl->deviceControl->getDispatcherStats();
+}
+
+BlockPoolStats Device::getBlockPoolStats() const {
+    if (!pimpl->deviceControl) {
+        return BlockPoolStats();
+    }
+    
+    return pimpl->deviceControl->getBlockPoolStats();
+}
+
+StreamStats Device::getStreamStats() const {
+    if (!pimpl->deviceControl) {
+        return StreamStats();
+    }
+    
+    return pimpl->deviceControl->getStreamStats();
+}
+
+uint64_t Device::getEventCount(EventType type) const {
+    if (!pimpl->deviceControl) {
+        return 0;
+    }
+    
+    return pimpl->deviceControl->getEventCount(type);
+}
+
+ControlLatencyStats Device::getControlLatency(ControlOperation op) const {
+    if (!pimpl->deviceControl) {
+        return ControlLatencyStats();
+    }
+    
+    return pimpl->deviceControl->getControlLatency(op);
+}
+
+ThreadPolicyStatus Device::setThreadPolicy(const ThreadPolicy& policy) {
+    if (!pimpl->deviceControl) {
+        ThreadPolicyStatus status;
+        status.failures.push_back("no device selected");
+        return status;
+    }
+    
+    return pimpl->deviceControl->setThreadPolicy(policy);
+}
+
+ThreadPolicyStatus Device::getThreadPolicyStatus() const {
+    if (!pimpl->deviceControl) {
+        return ThreadPolicyStatus();
+    }
+    
+    return pimpl->deviceControl->getThreadPolicyStatus();
+}
+
+SampleFormat Device::getSampleFormat() const {
+    if (!pimpl->deviceControl) {
+        return SampleFormat::CS16;
+    }
+    
+    return pimpl->deviceControl->getSampleFormat();
+}
+
 void Device::resetBuffer() {
     if (pimpl->deviceControl) {
         pimpl->deviceControl->resetBuffer();
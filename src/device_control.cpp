@@ -1,7 +1,11 @@
 #include "device_control.h"
 #include "sdrplay_exception.h"
+#include "trace.h"
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <iostream>
+#include <utility>
 
 namespace sdrplay {
 
@@ -10,10 +14,18 @@ struct DeviceControl::Impl {
     sdrplay_api_DeviceParamsT* deviceParams{nullptr};
     std::string lastError;
     std::unique_ptr<CallbackWrapper> callbackWrapper;
-    bool isStreaming{false};
+    std::atomic<bool> isStreaming{false};  // Also read by metrics scrapers
     sdrplay_api_CallbackFnsT callbackFunctions;
+    ControlLatency controlLatency;
 };
 
+namespace {
+    uint64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+}
+
 DeviceControl::DeviceControl() : impl(std::make_unique<Impl>()) {
     impl->callbackWrapper = std::make_unique<CallbackWrapper>();
 }
@@ -167,6 +179,23 @@ std::string DeviceControl::getLastError() const {
     return impl->lastError;
 }
 
+sdrplay_api_ErrT DeviceControl::updateDevice(sdrplay_api_ReasonForUpdateT reason,
+                                             sdrplay_api_ReasonForUpdateExtension1T reasonExt) {
+    if (!impl->currentDevice) {
+        return sdrplay_api_NotInitialised;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    sdrplay_api_ErrT err = sdrplay_api_Update(
+        impl->currentDevice->dev,
+        impl->currentDevice->tuner,
+        reason,
+        reasonExt
+    );
+    impl->controlLatency.record(ControlOperation::Update, elapsedNs(start));
+    return err;
+}
+
 bool DeviceControl::startStreaming(const StreamingParams& params) {
     if (!impl->currentDevice || !impl->deviceParams) {
         impl->lastError = "No device selected";
@@ -183,21 +212,47 @@ bool DeviceControl::startStreaming(const StreamingParams& params) {
         return false;
     }
     
+    if (!impl->callbackWrapper->sampleCallbackMatches(params.sampleFormat)) {
+        impl->lastError = std::string("Sample callback type does not match sample format ") +
+                          sampleFormatName(params.sampleFormat);
+        return false;
+    }
+    
+    // Size the sample buffer and conversion arena before the API thread
+    // starts calling back; the dispatcher must be idle while they change
+    impl->callbackWrapper->setCallbackMode(CallbackMode::Inline);
+    impl->callbackWrapper->configureBuffer(params.bufferSize, params.bufferLayout, params.planarStorage,
+                                           params.bufferAllocator);
+    impl->callbackWrapper->setOverflowPolicy(params.overflowPolicy, params.overflowTimeoutMs);
+    impl->callbackWrapper->setWaitStrategy(params.waitStrategy, params.waitSpinUs);
+    impl->callbackWrapper->setGapFill(params.fillGaps, params.maxGapFill);
+    impl->callbackWrapper->setCallbackBlockSize(params.callbackBlockSize, params.callbackMaxLatencyMs);
+    impl->callbackWrapper->setSampleFormat(params.sampleFormat);
+    impl->callbackWrapper->prepareStream();
+    impl->callbackWrapper->setCallbackMode(params.callbackMode);
+    
     // Set up callback functions
     impl->callbackFunctions.StreamACbFn = impl->callbackWrapper->getStreamCallback();
     impl->callbackFunctions.StreamBCbFn = nullptr;  // Not using stream B
     impl->callbackFunctions.EventCbFn = impl->callbackWrapper->getEventCallback();
     
     // Initialize streaming
-    sdrplay_api_ErrT err = sdrplay_api_Init(
-        impl->currentDevice->dev, 
-        &impl->callbackFunctions, 
-        impl->callbackWrapper->getContext()
-    );
+    sdrplay_api_ErrT err;
+    {
+        SDRPLAY_TRACE_SCOPE("sdrplay_api_Init");
+        auto start = std::chrono::steady_clock::now();
+        err = sdrplay_api_Init(
+            impl->currentDevice->dev, 
+            &impl->callbackFunctions, 
+            impl->callbackWrapper->getContext()
+        );
+        impl->controlLatency.record(ControlOperation::Init, elapsedNs(start));
+    }
     
     if (err != sdrplay_api_Success) {
         impl->lastError = sdrplay_api_GetErrorString(err);
         std::cerr << "Failed to start streaming: " << impl->lastError << std::endl;
+        impl->callbackWrapper->setCallbackMode(CallbackMode::Inline);
         return false;
     }
     
@@ -211,13 +266,23 @@ bool DeviceControl::stopStreaming() {
     }
     
     // Uninitialize API to stop streaming
-    sdrplay_api_ErrT err = sdrplay_api_Uninit(impl->currentDevice->dev);
+    sdrplay_api_ErrT err;
+    {
+        SDRPLAY_TRACE_SCOPE("sdrplay_api_Uninit");
+        auto start = std::chrono::steady_clock::now();
+        err = sdrplay_api_Uninit(impl->currentDevice->dev);
+        impl->controlLatency.record(ControlOperation::Uninit, elapsedNs(start));
+    }
     if (err != sdrplay_api_Success) {
         impl->lastError = sdrplay_api_GetErrorString(err);
         std::cerr << "Failed to stop streaming: " << impl->lastError << std::endl;
         return false;
     }
     
+    // Deliver whatever the dispatcher still has queued, then any partial block
+    impl->callbackWrapper->setCallbackMode(CallbackMode::Inline);
+    impl->callbackWrapper->flushSampleBlock();
+    
     impl->isStreaming = false;
     return true;
 }
@@ -232,6 +297,30 @@ void DeviceControl::setSampleCallback(CallbackWrapper::SampleCallback callback)
     }
 }
 
+void DeviceControl::setSampleCallback(CallbackWrapper::SampleCallbackCF32 callback) {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->setSampleCallback(callback);
+    }
+}
+
+void DeviceControl::setSampleCallback(CallbackWrapper::SampleCallbackCS8 callback) {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->setSampleCallback(callback);
+    }
+}
+
+void DeviceControl::setSampleCallback(CallbackWrapper::SampleCallbackCU8 callback) {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->setSampleCallback(callback);
+    }
+}
+
+void DeviceControl::setSampleCallback(std::nullptr_t) {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->setSampleCallback(nullptr);
+    }
+}
+
 void DeviceControl::setEventCallback(CallbackWrapper::EventCallback callback) {
     if (impl->callbackWrapper) {
         impl->callbackWrapper->setEventCallback(callback);
@@ -245,6 +334,25 @@ bool DeviceControl::waitForSamples(size_t count, unsigned int timeoutMs) {
     return impl->callbackWrapper->waitForSamples(count, timeoutMs);
 }
 
+int DeviceControl::enableSampleEvent(size_t lowWatermark) {
+    if (!impl->callbackWrapper) {
+        return -1;
+    }
+    return impl->callbackWrapper->enableSampleEvent(lowWatermark);
+}
+
+void DeviceControl::disableSampleEvent() {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->disableSampleEvent();
+    }
+}
+
+void DeviceControl::acknowledgeSampleEvent() {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->acknowledgeSampleEvent();
+    }
+}
+
 size_t DeviceControl::readSamples(std::complex<short>* dest, size_t maxCount) {
     if (!impl->callbackWrapper || !impl->isStreaming) {
         return 0;
@@ -252,6 +360,102 @@ size_t DeviceControl::readSamples(std::complex<short>* dest, size_t maxCount) {
     return impl->callbackWrapper->readSamples(dest, maxCount);
 }
 
+size_t DeviceControl::readSamples(std::complex<float>* dest, size_t maxCount) {
+    if (!impl->callbackWrapper || !impl->isStreaming) {
+        return 0;
+    }
+    return impl->callbackWrapper->readSamples(dest, maxCount);
+}
+
+size_t DeviceControl::readSamples(int8_t* dest, size_t maxCount) {
+    if (!impl->callbackWrapper || !impl->isStreaming) {
+        return 0;
+    }
+    return impl->callbackWrapper->readSamples(dest, maxCount);
+}
+
+size_t DeviceControl::readSamples(uint8_t* dest, size_t maxCount) {
+    if (!impl->callbackWrapper || !impl->isStreaming) {
+        return 0;
+    }
+    return impl->callbackWrapper->readSamples(dest, maxCount);
+}
+
+SampleSpans DeviceControl::peekSamples(size_t maxCount) {
+    if (!impl->callbackWrapper || !impl->isStreaming) {
+        return SampleSpans();
+    }
+    return impl->callbackWrapper->peekSamples(maxCount);
+}
+
+size_t DeviceControl::readPlanar(short* xi, short* xq, size_t maxCount) {
+    if (!impl->callbackWrapper || !impl->isStreaming) {
+        return 0;
+    }
+    return impl->callbackWrapper->readPlanar(xi, xq, maxCount);
+}
+
+PlanarSpans DeviceControl::peekPlanar(size_t maxCount) {
+    if (!impl->callbackWrapper || !impl->isStreaming) {
+        return PlanarSpans();
+    }
+    return impl->callbackWrapper->peekPlanar(maxCount);
+}
+
+size_t DeviceControl::consumeSamples(size_t count) {
+    if (!impl->callbackWrapper || !impl->isStreaming) {
+        return 0;
+    }
+    return impl->callbackWrapper->consumeSamples(count);
+}
+
+std::shared_ptr<BroadcastReader> DeviceControl::addSampleReader(ReaderOverflowPolicy policy) {
+    if (!impl->callbackWrapper) {
+        return nullptr;
+    }
+    return impl->callbackWrapper->addSampleReader(policy);
+}
+
+void DeviceControl::enableSampleBlocks(size_t blockCount, size_t blockSamples,
+                                       std::shared_ptr<RingAllocator> allocator) {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->enableSampleBlocks(blockCount, blockSamples, std::move(allocator));
+    }
+}
+
+void DeviceControl::disableSampleBlocks() {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->disableSampleBlocks();
+    }
+}
+
+size_t DeviceControl::addBlockConsumer(CallbackWrapper::BlockCallback consumer) {
+    if (!impl->callbackWrapper) {
+        return 0;
+    }
+    return impl->callbackWrapper->addBlockConsumer(std::move(consumer));
+}
+
+void DeviceControl::removeBlockConsumer(size_t id) {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->removeBlockConsumer(id);
+    }
+}
+
+uint64_t DeviceControl::getReadIndex() const {
+    if (!impl->callbackWrapper) {
+        return 0;
+    }
+    return impl->callbackWrapper->getReadIndex();
+}
+
+std::vector<StreamTag> DeviceControl::getStreamTags(uint64_t startIndex, size_t count) const {
+    if (!impl->callbackWrapper) {
+        return std::vector<StreamTag>();
+    }
+    return impl->callbackWrapper->getStreamTags(startIndex, count);
+}
+
 size_t DeviceControl::samplesAvailable() const {
     if (!impl->callbackWrapper || !impl->isStreaming) {
         return 0;
@@ -266,6 +470,113 @@ bool DeviceControl::hasBufferOverflow() const {
     return impl->callbackWrapper->hasOverflow();
 }
 
+void DeviceControl::setWaitStrategy(WaitStrategy strategy, unsigned int spinUs) {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->setWaitStrategy(strategy, spinUs);
+    }
+}
+
+WaitStrategy DeviceControl::getWaitStrategy() const {
+    if (!impl->callbackWrapper) {
+        return WaitStrategy::Block;
+    }
+    return impl->callbackWrapper->getWaitStrategy();
+}
+
+void DeviceControl::setOverflowPolicy(OverflowPolicy policy, unsigned int blockTimeoutMs) {
+    if (impl->callbackWrapper) {
+        impl->callbackWrapper->setOverflowPolicy(policy, blockTimeoutMs);
+    }
+}
+
+OverflowPolicy DeviceControl::getOverflowPolicy() const {
+    if (!impl->callbackWrapper) {
+        return OverflowPolicy::DropNewest;
+    }
+    return impl->callbackWrapper->getOverflowPolicy();
+}
+
+uint64_t DeviceControl::getDroppedSampleCount() const {
+    if (!impl->callbackWrapper) {
+        return 0;
+    }
+    return impl->callbackWrapper->getDroppedSampleCount();
+}
+
+uint64_t DeviceControl::getOverflowEventCount() const {
+    if (!impl->callbackWrapper) {
+        return 0;
+    }
+    return impl->callbackWrapper->getOverflowEventCount();
+}
+
+uint64_t DeviceControl::getMissingSampleCount() const {
+    if (!impl->callbackWrapper) {
+        return 0;
+    }
+    return impl->callbackWrapper->getMissingSampleCount();
+}
+
+uint64_t DeviceControl::getGapEventCount() const {
+    if (!impl->callbackWrapper) {
+        return 0;
+    }
+    return impl->callbackWrapper->getGapEventCount();
+}
+
+DispatcherStats DeviceControl::getDispatcherStats() const {
+    if (!impl->callbackWrapper) {
+        return DispatcherStats();
+    }
+    return impl->callbackWrapper->getDispatcherStats();
+}
+
+BlockPoolStats DeviceControl::getBlockPoolStats() const {
+    if (!impl->callbackWrapper) {
+        return BlockPoolStats();
+    }
+    return impl->callbackWrapper->getBlockPoolStats();
+}
+
+StreamStats DeviceControl::getStreamStats() const {
+    if (!impl->callbackWrapper) {
+        return StreamStats();
+    }
+    return impl->callbackWrapper->getStreamStats();
+}
+
+uint64_t DeviceControl::getEventCount(EventType type) const {
+    if (!impl->callbackWrapper) {
+        return 0;
+    }
+    return impl->callbackWrapper->getEventCount(type);
+}
+
+ControlLatencyStats DeviceControl::getControlLatency(ControlOperation op) const {
+    return impl->controlLatency.snapshot(op);
+}
+
+ThreadPolicyStatus DeviceControl::setThreadPolicy(const ThreadPolicy& policy) {
+    if (!impl->callbackWrapper) {
+        return ThreadPolicyStatus();
+    }
+    return impl->callbackWrapper->setThreadPolicy(policy);
+}
+
+ThreadPolicyStatus DeviceControl::getThreadPolicyStatus() const {
+    if (!impl->callbackWrapper) {
+        return ThreadPolicyStatus();
+    }
+    return impl->callbackWrapper->getThreadPolicyStatus();
+}
+
+SampleFormat DeviceControl::getSampleFormat() const {
+    if (!impl->callbackWrapper) {
+        return SampleFormat::CS16;
+    }
+    return impl->callbackWrapper->getSampleFormat();
+}
+
 void DeviceControl::resetBuffer() {
     if (impl->callbackWrapper) {
         impl->callbackWrapper->resetBuffer();
@@ -297,12 +608,11 @@ bool DeviceControl::setupStreamingParameters(const StreamingParams& params) {
         params.wideBandSignal ? 1 : 0;
     
     // Update device with these parameters
-    sdrplay_api_ErrT err = sdrplay_api_Update(
-        impl->currentDevice->dev, 
-        impl->currentDevice->tuner, 
-        sdrplay_api_Update_Ctrl_DCoffsetIQimbalance, 
-        sdrplay_api_Update_Ext1_None
-    );
+    sdrplay_api_ErrT err;
+    {
+        SDRPLAY_TRACE_SCOPE("sdrplay_api_Update Ctrl_DCoffsetIQimbalance");
+        err = updateDevice(sdrplay_api_Update_Ctrl_DCoffsetIQimbalance);
+    }
     
     if (err != sdrplay_api_Success) {
         impl->lastError = sdrplay_api_GetErrorString(err);
@@ -310,12 +620,10 @@ bool DeviceControl::setupStreamingParameters(const StreamingParams& params) {
         return false;
     }
     
-    err = sdrplay_api_Update(
-        impl->currentDevice->dev, 
-        impl->currentDevice->tuner, 
-        sdrplay_api_Update_Ctrl_Decimation, 
-        sdrplay_api_Update_Ext1_None
-    );
+    {
+        SDRPLAY_TRACE_SCOPE("sdrplay_api_Update Ctrl_Decimation");
+        err = updateDevice(sdrplay_api_Update_Ctrl_Decimation);
+    }
     
     if (err != sdrplay_api_Success) {
         impl->lastError = sdrplay_api_GetErrorString(err);
@@ -1,5 +1,6 @@
 #include "device_impl/rsp1a_control.h"
 #include "sdrplay_exception.h"
+#include "trace.h"
 #include <iostream>
 #include <mutex>
 #include <cassert>
@@ -36,9 +37,8 @@ void RSP1AControl::setFrequency(double freq) {
 
         auto* device = getCurrentDevice();
         if (device) {
-            sdrplay_api_Update(device->dev, device->tuner,
-                             sdrplay_api_Update_Tuner_Frf,
-                             sdrplay_api_Update_Ext1_None);
+            SDRPLAY_TRACE_SCOPE("sdrplay_api_Update Tuner_Frf");
+            updateDevice(sdrplay_api_Update_Tuner_Frf, sdrplay_api_Update_Ext1_None);
         }
     }
 }
@@ -62,9 +62,8 @@ void RSP1AControl::setSampleRate(double rate) {
 
         auto* device = getCurrentDevice();
         if (device) {
-            sdrplay_api_Update(device->dev, device->tuner,
-                             sdrplay_api_Update_Dev_Fs,
-                             sdrplay_api_Update_Ext1_None);
+            SDRPLAY_TRACE_SCOPE("sdrplay_api_Update Dev_Fs");
+            updateDevice(sdrplay_api_Update_Dev_Fs, sdrplay_api_Update_Ext1_None);
         }
     }
 }
@@ -88,9 +87,8 @@ void RSP1AControl::setGainReduction(int gain) {
 
         auto* device = getCurrentDevice();
         if (device) {
-            sdrplay_api_Update(device->dev, device->tuner,
-                             sdrplay_api_Update_Tuner_Gr,
-                             sdrplay_api_Update_Ext1_None);
+            SDRPLAY_TRACE_SCOPE("sdrplay_api_Update Tuner_Gr");
+            updateDevice(sdrplay_api_Update_Tuner_Gr, sdrplay_api_Update_Ext1_None);
         }
     }
 }
@@ -105,9 +103,8 @@ void RSP1AControl::setLNAState(int state) {
 
         auto* device = getCurrentDevice();
         if (device) {
-            sdrplay_api_Update(device->dev, device->tuner,
-                             sdrplay_api_Update_Tuner_Gr,
-                             sdrplay_api_Update_Ext1_None);
+            SDRPLAY_TRACE_SCOPE("sdrplay_api_Update Tuner_Gr");
+            updateDevice(sdrplay_api_Update_Tuner_Gr, sdrplay_api_Update_Ext1_None);
         }
     }
 }
@@ -1,4 +1,5 @@
 #include "device_impl/rspdxr2_control.h"
+#include "trace.h"
 #include <stdexcept>
 #include <iostream>
 
@@ -24,9 +25,8 @@ void RSPdxR2Control::setFrequency(double freq) {
         // Update the device parameters
         auto* device = getCurrentDevice();
         if (device) {
-            sdrplay_api_Update(device->dev, device->tuner,
-                             sdrplay_api_Update_Tuner_Frf,
-                             sdrplay_api_Update_Ext1_None);
+            SDRPLAY_TRACE_SCOPE("sdrplay_api_Update Tuner_Frf");
+            updateDevice(sdrplay_api_Update_Tuner_Frf, sdrplay_api_Update_Ext1_None);
         }
     }
 }
@@ -43,9 +43,8 @@ void RSPdxR2Control::setSampleRate(double rate) {
         // Update the device parameters
         auto* device = getCurrentDevice();
         if (device) {
-            sdrplay_api_Update(device->dev, device->tuner,
-                             sdrplay_api_Update_Dev_Fs,
-                             sdrplay_api_Update_Ext1_None);
+            SDRPLAY_TRACE_SCOPE("sdrplay_api_Update Dev_Fs");
+            updateDevice(sdrplay_api_Update_Dev_Fs, sdrplay_api_Update_Ext1_None);
         }
     }
 }
@@ -62,9 +61,8 @@ void RSPdxR2Control::setHDRMode(bool enable) {
         // Update the device parameters
         auto* device = getCurrentDevice();
         if (device) {
-            sdrplay_api_Update(device->dev, device->tuner,
-                             sdrplay_api_Update_None,
-                             sdrplay_api_Update_RspDx_HdrEnable);
+            SDRPLAY_TRACE_SCOPE("sdrplay_api_Update RspDx_HdrEnable");
+            updateDevice(sdrplay_api_Update_None, sdrplay_api_Update_RspDx_HdrEnable);
         }
     }
 }
@@ -77,9 +75,8 @@ void RSPdxR2Control::setBiasTEnabled(bool enable) {
         // Update the device parameters
         auto* device = getCurrentDevice();
         if (device) {
-            sdrplay_api_Update(device->dev, device->tuner,
-                             sdrplay_api_Update_None,
-                             sdrplay_api_Update_RspDx_BiasTControl);
+            SDRPLAY_TRACE_SCOPE("sdrplay_api_Update RspDx_BiasTControl");
+            updateDevice(sdrplay_api_Update_None, sdrplay_api_Update_RspDx_BiasTControl);
         }
     }
 }
@@ -2,6 +2,7 @@
 #include "device_params/rsp1a_params.h"
 #include "device_control.h"
 #include "sdrplay_api.h"
+#include "trace.h"
 #include <stdexcept>
 #include <iostream>
 
@@ -80,9 +81,8 @@ bool Rsp1aParams::update() {
             sdrplay_api_Update_Rsp1a_RfDabNotchControl
         );
 
-    sdrplay_api_ErrT err = sdrplay_api_Update(
-        device->dev,
-        device->tuner,
+    SDRPLAY_TRACE_SCOPE("sdrplay_api_Update");
+    sdrplay_api_ErrT err = pimpl->deviceControl->updateDevice(
         reason,
         sdrplay_api_Update_Ext1_None
     );
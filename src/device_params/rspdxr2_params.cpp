@@ -2,6 +2,7 @@
 #include "device_params/rspdxr2_params.h"
 #include "device_control.h"
 #include "sdrplay_api.h"
+#include "trace.h"
 #include <stdexcept>
 #include <iostream>
 
@@ -48,9 +49,8 @@ bool RspDxR2Params::update() {
     }
 
     // RSPdxR2 uses same parameter updates as RSPdx
-    sdrplay_api_ErrT err = sdrplay_api_Update(
-        device->dev,
-        device->tuner,
+    SDRPLAY_TRACE_SCOPE("sdrplay_api_Update");
+    sdrplay_api_ErrT err = pimpl->deviceControl->updateDevice(
         static_cast<sdrplay_api_ReasonForUpdateT>(0),  // No unique RSPdxR2 parameters to update
         sdrplay_api_Update_Ext1_None
     );
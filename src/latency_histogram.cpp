@@ -0,0 +1,128 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sdrplay {
+
+namespace {
+    unsigned int highestBit(uint64_t value) {
+        unsigned int bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+    : total(0), sum(0), minimum(UINT64_MAX), maximum(0) {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t ns) {
+    // Values below SUB_BUCKETS get a bucket each; above that, the top
+    // SUB_BUCKET_BITS bits after the leading one pick the sub-bucket
+    if (ns < SUB_BUCKETS) {
+        return static_cast<size_t>(ns);
+    }
+    unsigned int msb = highestBit(ns);
+    size_t sub = static_cast<size_t>(ns >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    size_t msb = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t sub = index % SUB_BUCKETS;
+    return (uint64_t(1) << msb) | (sub << (msb - SUB_BUCKET_BITS));
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t low = minimum.load(std::memory_order_relaxed);
+    while (ns < low && !minimum.compare_exchange_weak(low, ns, std::memory_order_relaxed)) {
+    }
+    uint64_t high = maximum.load(std::memory_order_relaxed);
+    while (ns > high && !maximum.compare_exchange_weak(high, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        uint64_t n = other.buckets[i].load(std::memory_order_relaxed);
+        if (n > 0) {
+            buckets[i].fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    total.fetch_add(other.total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    uint64_t otherMin = other.minimum.load(std::memory_order_relaxed);
+    uint64_t low = minimum.load(std::memory_order_relaxed);
+    while (otherMin < low && !minimum.compare_exchange_weak(low, otherMin, std::memory_order_relaxed)) {
+    }
+    uint64_t otherMax = other.maximum.load(std::memory_order_relaxed);
+    uint64_t high = maximum.load(std::memory_order_relaxed);
+    while (otherMax > high && !maximum.compare_exchange_weak(high, otherMax, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    minimum.store(UINT64_MAX, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::min() const {
+    uint64_t low = minimum.load(std::memory_order_relaxed);
+    return low == UINT64_MAX ? 0 : low;
+}
+
+uint64_t LatencyHistogram::max() const {
+    return maximum.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum.load(std::memory_order_relaxed)) / n;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    percent = std::min(std::max(percent, 0.0), 100.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percent / 100.0 * n)));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t upper = i + 1 < BUCKETS ? bucketLowerBound(i + 1) - 1 : UINT64_MAX;
+            return std::min(upper, max());
+        }
+    }
+    return max();
+}
+
+uint64_t LatencyHistogram::bucketCount(size_t index) const {
+    return index < BUCKETS ? buckets[index].load(std::memory_order_relaxed) : 0;
+}
+
+} // namespace sdrplay
@@ -0,0 +1,504 @@
+#include "metrics_server.h"
+#include "sdrplay_wrapper.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #define SDRPLAY_HAVE_METRICS_SOCKETS 1
+#endif
+
+namespace sdrplay {
+
+namespace {
+    constexpr int POLL_INTERVAL_MS = 100;       // How often the server thread checks for stop()
+    constexpr int CLIENT_TIMEOUT_MS = 1000;     // Longest a single scrape may take
+    constexpr size_t MAX_REQUEST_BYTES = 8192;  // Requests larger than this are dropped
+
+    // Everything published for one device, read before any output is written
+    struct DeviceSnapshot {
+        std::string name;
+        bool streaming;
+        StreamStats stream;
+        uint64_t events[CallbackWrapper::EVENT_TYPES];
+        ControlLatencyStats control[ControlLatency::OPERATIONS];
+    };
+
+    const char* eventTypeLabel(size_t type) {
+        switch (static_cast<EventType>(type)) {
+            case EventType::GainChange: return "gain_change";
+            case EventType::PowerOverload: return "power_overload";
+            case EventType::DeviceRemoved: return "device_removed";
+            case EventType::ADCOverflow: return "adc_overflow";
+            case EventType::RspDuoModeChange: return "rspduo_mode_change";
+            default: return "other";
+        }
+    }
+
+    const char* operationLabel(size_t op) {
+        switch (static_cast<ControlOperation>(op)) {
+            case ControlOperation::Init: return "init";
+            case ControlOperation::Uninit: return "uninit";
+            default: return "update";
+        }
+    }
+
+    std::string escapeLabel(const std::string& value) {
+        std::string escaped;
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                escaped += '\\';
+                escaped += c;
+            } else if (c == '\n') {
+                escaped += "\\n";
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    std::string formatDouble(double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.9g", value);
+        return text;
+    }
+
+    std::string seconds(uint64_t ns) {
+        return formatDouble(static_cast<double>(ns) / 1e9);
+    }
+
+    // Writes metric families one at a time: HELP and TYPE once, then a
+    // sample per device
+    class MetricsWriter {
+    public:
+        explicit MetricsWriter(std::ostringstream& out) : out(out) {}
+
+        void family(const char* name, const char* type, const char* help) {
+            out << "# HELP " << name << " " << help << "\n";
+            out << "# TYPE " << name << " " << type << "\n";
+        }
+
+        void sample(const std::string& name, const DeviceSnapshot& device, const std::string& value,
+                    const std::string& extraLabels = std::string()) {
+            out << name << "{device=\"" << escapeLabel(device.name) << "\"";
+            if (!extraLabels.empty()) {
+                out << "," << extraLabels;
+            }
+            out << "} " << value << "\n";
+        }
+
+    private:
+        std::ostringstream& out;
+    };
+}
+
+struct MetricsServer::Impl {
+    mutable std::mutex devicesMutex;  // Held while a scrape reads the devices
+    std::vector<std::pair<Device*, std::string>> devices;
+
+    mutable std::mutex controlMutex;  // Serialises start() and stop()
+    std::thread serverThread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<uint16_t> port{0};
+    std::string lastError;
+    int listenFd{-1};
+
+    std::vector<DeviceSnapshot> snapshotDevices() const;
+    std::string render() const;
+    void serve();
+    void handleClient(int clientFd);
+};
+
+std::vector<DeviceSnapshot> MetricsServer::Impl::snapshotDevices() const {
+    std::lock_guard<std::mutex> lock(devicesMutex);
+    std::vector<DeviceSnapshot> snapshots(devices.size());
+    for (size_t i = 0; i < devices.size(); ++i) {
+        const Device& device = *devices[i].first;
+        DeviceSnapshot& snapshot = snapshots[i];
+        snapshot.name = devices[i].second;
+        snapshot.streaming = device.isStreaming();
+        snapshot.stream = device.getStreamStats();
+        for (size_t type = 0; type < CallbackWrapper::EVENT_TYPES; ++type) {
+            snapshot.events[type] = device.getEventCount(static_cast<EventType>(type));
+        }
+        for (size_t op = 0; op < ControlLatency::OPERATIONS; ++op) {
+            snapshot.control[op] = device.getControlLatency(static_cast<ControlOperation>(op));
+        }
+    }
+    return snapshots;
+}
+
+MetricsServer::MetricsServer() : impl(std::make_unique<Impl>()) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+void MetricsServer::addDevice(Device& device, const std::string& name) {
+    std::lock_guard<std::mutex> lock(impl->devicesMutex);
+    for (auto& entry : impl->devices) {
+        if (entry.first == &device) {
+            entry.second = name;
+            return;
+        }
+    }
+    impl->devices.emplace_back(&device, name);
+}
+
+void MetricsServer::removeDevice(Device& device) {
+    std::lock_guard<std::mutex> lock(impl->devicesMutex);
+    impl->devices.erase(std::remove_if(impl->devices.begin(), impl->devices.end(),
+        [&device](const std::pair<Device*, std::string>& entry) { return entry.first == &device; }),
+        impl->devices.end());
+}
+
+std::string MetricsServer::renderMetrics() const {
+    return impl->render();
+}
+
+std::string MetricsServer::Impl::render() const {
+    std::vector<DeviceSnapshot> snapshots = snapshotDevices();
+    std::ostringstream out;
+    MetricsWriter writer(out);
+
+    // One gauge or counter family per StreamStats field
+    struct StreamMetric {
+        const char* name;
+        const char* type;
+        const char* help;
+        std::string (*value)(const DeviceSnapshot&);
+    };
+    static const StreamMetric streamMetrics[] = {
+        {"sdrplay_streaming", "gauge", "Whether the device is streaming.",
+         [](const DeviceSnapshot& d) { return std::string(d.streaming ? "1" : "0"); }},
+        {"sdrplay_stream_sample_rate_hertz", "gauge", "Measured input sample rate.",
+         [](const DeviceSnapshot& d) { return formatDouble(d.stream.sampleRate); }},
+        {"sdrplay_stream_callbacks_total", "counter", "Stream callbacks (API packets) received since the stream started or reset.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.callbackCount); }},
+        {"sdrplay_stream_samples_received_total", "counter", "Samples delivered by the API since the stream started or reset.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.samplesReceived); }},
+        {"sdrplay_stream_callback_interval_mean_seconds", "gauge", "Mean time between stream callbacks.",
+         [](const DeviceSnapshot& d) { return seconds(d.stream.meanIntervalNs); }},
+        {"sdrplay_stream_callback_interval_jitter_seconds", "gauge", "Standard deviation of the time between stream callbacks.",
+         [](const DeviceSnapshot& d) { return seconds(d.stream.intervalJitterNs); }},
+        {"sdrplay_stream_callback_interval_min_seconds", "gauge", "Shortest time between stream callbacks.",
+         [](const DeviceSnapshot& d) { return seconds(d.stream.minIntervalNs); }},
+        {"sdrplay_stream_callback_interval_max_seconds", "gauge", "Longest time between stream callbacks.",
+         [](const DeviceSnapshot& d) { return seconds(d.stream.maxIntervalNs); }},
+        {"sdrplay_buffer_capacity_samples", "gauge", "Capacity of the sample buffer.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.bufferCapacity); }},
+        {"sdrplay_buffer_high_watermark_samples", "gauge", "Most samples buffered after any packet was written.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.bufferHighWatermark); }},
+        {"sdrplay_consumer_lag_samples", "gauge", "Samples waiting to be read.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.consumerLagSamples); }},
+        {"sdrplay_consumer_lag_seconds", "gauge", "Samples waiting to be read, at the measured rate.",
+         [](const DeviceSnapshot& d) { return seconds(d.stream.consumerLagNs); }},
+        {"sdrplay_dropped_samples_total", "counter", "Samples lost to sample buffer overflows since the stream started.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.droppedSamples); }},
+        {"sdrplay_overflow_events_total", "counter", "Sample buffer overflow episodes since the stream started.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.overflowEvents); }},
+        {"sdrplay_missing_samples_total", "counter", "Samples the API failed to deliver since the stream started.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.missingSamples); }},
+        {"sdrplay_gap_events_total", "counter", "Discontinuities in the API sample counter since the stream started.",
+         [](const DeviceSnapshot& d) { return std::to_string(d.stream.gapEvents); }},
+    };
+
+    for (const StreamMetric& metric : streamMetrics) {
+        writer.family(metric.name, metric.type, metric.help);
+        for (const DeviceSnapshot& device : snapshots) {
+            writer.sample(metric.name, device, metric.value(device));
+        }
+    }
+
+    writer.family("sdrplay_seconds_since_last_callback", "gauge",
+                  "Time since the last stream callback; absent before the first one.");
+    for (const DeviceSnapshot& device : snapshots) {
+        if (device.stream.nsSinceLastCallback != UINT64_MAX) {
+            writer.sample("sdrplay_seconds_since_last_callback", device,
+                          seconds(device.stream.nsSinceLastCallback));
+        }
+    }
+
+    // Packet sizes fall into power-of-two buckets, which map directly
+    // onto cumulative histogram buckets
+    writer.family("sdrplay_stream_packet_samples", "histogram", "Samples per API packet.");
+    for (const DeviceSnapshot& device : snapshots) {
+        uint64_t cumulative = 0;
+        for (size_t bucket = 0; bucket < StreamStats::PACKET_SIZE_BUCKETS; ++bucket) {
+            cumulative += device.stream.packetSizeCount(bucket);
+            std::string le = bucket + 1 < StreamStats::PACKET_SIZE_BUCKETS
+                ? std::to_string(StreamStats::packetSizeBucketMin(bucket + 1) - 1) : "+Inf";
+            writer.sample("sdrplay_stream_packet_samples_bucket", device, std::to_string(cumulative),
+                          "le=\"" + le + "\"");
+        }
+        writer.sample("sdrplay_stream_packet_samples_sum", device, std::to_string(device.stream.samplesReceived));
+        writer.sample("sdrplay_stream_packet_samples_count", device, std::to_string(cumulative));
+    }
+
+    writer.family("sdrplay_events_total", "counter", "Device events received, by type.");
+    for (const DeviceSnapshot& device : snapshots) {
+        for (size_t type = 0; type < CallbackWrapper::EVENT_TYPES; ++type) {
+            writer.sample("sdrplay_events_total", device, std::to_string(device.events[type]),
+                          std::string("type=\"") + eventTypeLabel(type) + "\"");
+        }
+    }
+
+    writer.family("sdrplay_control_latency_seconds", "summary",
+                  "Time spent in sdrplay_api_Init, Uninit and Update calls.");
+    for (const DeviceSnapshot& device : snapshots) {
+        for (size_t op = 0; op < ControlLatency::OPERATIONS; ++op) {
+            const ControlLatencyStats& stats = device.control[op];
+            std::string operation = std::string("operation=\"") + operationLabel(op) + "\"";
+            const std::pair<const char*, uint64_t> quantiles[] = {
+                {"0.5", stats.p50Ns}, {"0.9", stats.p90Ns}, {"0.99", stats.p99Ns}};
+            for (const auto& quantile : quantiles) {
+                writer.sample("sdrplay_control_latency_seconds", device,
+                              stats.count ? seconds(quantile.second) : std::string("NaN"),
+                              operation + ",quantile=\"" + quantile.first + "\"");
+            }
+            writer.sample("sdrplay_control_latency_seconds_sum", device, seconds(stats.sumNs), operation);
+            writer.sample("sdrplay_control_latency_seconds_count", device, std::to_string(stats.count), operation);
+        }
+    }
+
+    writer.family("sdrplay_control_latency_max_seconds", "gauge",
+                  "Slowest sdrplay_api_Init, Uninit and Update call.");
+    for (const DeviceSnapshot& device : snapshots) {
+        for (size_t op = 0; op < ControlLatency::OPERATIONS; ++op) {
+            writer.sample("sdrplay_control_latency_max_seconds", device, seconds(device.control[op].maxNs),
+                          std::string("operation=\"") + operationLabel(op) + "\"");
+        }
+    }
+
+    return out.str();
+}
+
+bool MetricsServer::isRunning() const {
+    return impl->running.load();
+}
+
+uint16_t MetricsServer::getPort() const {
+    return impl->running.load() ? impl->port.load() : 0;
+}
+
+std::string MetricsServer::getLastError() const {
+    std::lock_guard<std::mutex> lock(impl->controlMutex);
+    return impl->lastError;
+}
+
+#if defined(SDRPLAY_HAVE_METRICS_SOCKETS)
+
+namespace {
+    bool setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 &&
+               fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+    }
+
+    int remainingMs(std::chrono::steady_clock::time_point deadline) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        return left > 0 ? static_cast<int>(left) : 0;
+    }
+
+    // Send everything or give up at the deadline; never raises SIGPIPE
+    void sendAll(int fd, const std::string& data, std::chrono::steady_clock::time_point deadline) {
+#if defined(MSG_NOSIGNAL)
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+#endif
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, flags);
+            if (n > 0) {
+                sent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return;
+            }
+            pollfd pfd = {fd, POLLOUT, 0};
+            int timeout = remainingMs(deadline);
+            if (timeout == 0 || ::poll(&pfd, 1, timeout) <= 0) {
+                return;
+            }
+        }
+    }
+
+    std::string httpResponse(const char* status, const std::string& contentType, const std::string& body,
+                             bool includeBody, const char* extraHeaders = "") {
+        std::ostringstream response;
+        response << "HTTP/1.1 " << status << "\r\n"
+                 << "Content-Type: " << contentType << "\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << extraHeaders
+                 << "Connection: close\r\n\r\n";
+        if (includeBody) {
+            response << body;
+        }
+        return response.str();
+    }
+}
+
+bool MetricsServer::start(uint16_t port, const std::string& bindAddress) {
+    std::lock_guard<std::mutex> lock(impl->controlMutex);
+    if (impl->running.load()) {
+        impl->lastError = "Metrics server already running";
+        return false;
+    }
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, bindAddress.c_str(), &address.sin_addr) != 1) {
+        impl->lastError = "Invalid bind address: " + bindAddress;
+        return false;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        impl->lastError = std::string("socket() failed: ") + std::strerror(errno);
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#if defined(SO_NOSIGPIPE)
+    int noSigpipe = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+
+    if (!setNonBlocking(fd) ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, 16) != 0) {
+        impl->lastError = "Cannot listen on " + bindAddress + ":" + std::to_string(port) + ": " +
+                          std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    impl->port.store(ntohs(address.sin_port));
+    impl->listenFd = fd;
+    impl->lastError.clear();
+    impl->stopRequested.store(false);
+    impl->running.store(true);
+    impl->serverThread = std::thread(&Impl::serve, impl.get());
+    return true;
+}
+
+void MetricsServer::stop() {
+    std::lock_guard<std::mutex> lock(impl->controlMutex);
+    if (!impl->running.load()) {
+        return;
+    }
+    impl->stopRequested.store(true);
+    if (impl->serverThread.joinable()) {
+        impl->serverThread.join();
+    }
+    ::close(impl->listenFd);
+    impl->listenFd = -1;
+    impl->running.store(false);
+}
+
+void MetricsServer::Impl::serve() {
+    while (!stopRequested.load()) {
+        pollfd pfd = {listenFd, POLLIN, 0};
+        if (::poll(&pfd, 1, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+        int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+        if (setNonBlocking(clientFd)) {
+            handleClient(clientFd);
+        }
+        ::close(clientFd);
+    }
+}
+
+void MetricsServer::Impl::handleClient(int clientFd) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CLIENT_TIMEOUT_MS);
+
+    // Read up to the end of the request headers; request bodies are ignored
+    std::string request;
+    char chunk[1024];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = ::recv(clientFd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            request.append(chunk, static_cast<size_t>(n));
+            if (request.size() > MAX_REQUEST_BYTES) {
+                return;
+            }
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            return;
+        }
+        // Wake up regularly so stop() is not held up by a stalled client
+        int timeout = remainingMs(deadline);
+        if (timeout == 0 || stopRequested.load()) {
+            return;
+        }
+        pollfd pfd = {clientFd, POLLIN, 0};
+        ::poll(&pfd, 1, std::min(timeout, POLL_INTERVAL_MS));
+    }
+
+    std::istringstream requestLine(request.substr(0, request.find("\r\n")));
+    std::string method, target;
+    requestLine >> method >> target;
+    std::string path = target.substr(0, target.find('?'));
+
+    const std::string textType = "text/plain; charset=utf-8";
+    std::string response;
+    if (method != "GET" && method != "HEAD") {
+        response = httpResponse("405 Method Not Allowed", textType, "Method not allowed\n", true,
+                                "Allow: GET, HEAD\r\n");
+    } else if (path == "/metrics") {
+        response = httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                                render(), method == "GET");
+    } else {
+        response = httpResponse("404 Not Found", textType, "Metrics are served at /metrics\n", method == "GET");
+    }
+    sendAll(clientFd, response, deadline);
+}
+
+#else
+
+bool MetricsServer::start(uint16_t, const std::string&) {
+    std::lock_guard<std::mutex> lock(impl->controlMutex);
+    impl->lastError = "Metrics server is not supported on this platform";
+    return false;
+}
+
+void MetricsServer::stop() {
+}
+
+void MetricsServer::Impl::serve() {
+}
+
+void MetricsServer::Impl::handleClient(int) {
+}
+
+#endif
+
+} // namespace sdrplay
@@ -0,0 +1,175 @@
+#include "planar_buffer.h"
+#include <cstring>
+
+namespace sdrplay {
+
+PlanarBuffer::PlanarBuffer(size_t size, RingLayout layout, std::shared_ptr<RingAllocator> allocator)
+    : iStorage(RingIndex::capacityFor(size, layout, sizeof(short)) * sizeof(short), layout, allocator),
+      qStorage(RingIndex::capacityFor(size, layout, sizeof(short)) * sizeof(short),
+               iStorage.mirrored() ? layout : RingLayout::Standard, allocator),
+      index(RingIndex::capacityFor(size, layout, sizeof(short))) {}
+
+void PlanarBuffer::reconfigure(size_t size, RingLayout layout, std::shared_ptr<RingAllocator> allocator) {
+    size_t newSize = RingIndex::capacityFor(size, layout, sizeof(short));
+    iStorage = RingStorage(newSize * sizeof(short), layout, allocator);
+    qStorage = RingStorage(newSize * sizeof(short),
+                           iStorage.mirrored() ? layout : RingLayout::Standard, allocator);
+    index.resize(newSize);
+}
+
+short* PlanarBuffer::iValues() const {
+    return static_cast<short*>(iStorage.data());
+}
+
+short* PlanarBuffer::qValues() const {
+    return static_cast<short*>(qStorage.data());
+}
+
+bool PlanarBuffer::mirrored() const {
+    // If only one component could be mirrored, both are treated as standard
+    return iStorage.mirrored() && qStorage.mirrored();
+}
+
+void PlanarBuffer::copyIn(size_t pos, const short* xi, const short* xq, size_t count) {
+    size_t offset = index.offset(pos);
+    size_t first = index.firstSegment(pos, count, mirrored());
+    std::memcpy(iValues() + offset, xi, first * sizeof(short));
+    std::memcpy(qValues() + offset, xq, first * sizeof(short));
+    if (count > first) {
+        std::memcpy(iValues(), xi + first, (count - first) * sizeof(short));
+        std::memcpy(qValues(), xq + first, (count - first) * sizeof(short));
+    }
+}
+
+void PlanarBuffer::copyOut(size_t pos, short* xi, short* xq, size_t count) const {
+    size_t offset = index.offset(pos);
+    size_t first = index.firstSegment(pos, count, mirrored());
+    std::memcpy(xi, iValues() + offset, first * sizeof(short));
+    std::memcpy(xq, qValues() + offset, first * sizeof(short));
+    if (count > first) {
+        std::memcpy(xi + first, iValues(), (count - first) * sizeof(short));
+        std::memcpy(xq + first, qValues(), (count - first) * sizeof(short));
+    }
+}
+
+PlanarSpans PlanarBuffer::spansAt(size_t pos, size_t count) const {
+    PlanarSpans spans;
+    size_t offset = index.offset(pos);
+    size_t first = index.firstSegment(pos, count, mirrored());
+    spans.first = PlanarSpan(iValues() + offset, qValues() + offset, first);
+    if (count > first) {
+        spans.second = PlanarSpan(iValues(), qValues(), count - first);
+    }
+    return spans;
+}
+
+bool PlanarBuffer::write(const short* xi, const short* xq, size_t count) {
+    if (!xi || !xq || count == 0) {
+        return true;
+    }
+
+    RingIndex::WriteRange range = index.beginWrite(count);
+    if (range.count > 0) {
+        copyIn(range.pos, xi + range.skip, xq + range.skip, range.count);
+    }
+    return index.endWrite(range);
+}
+
+size_t PlanarBuffer::read(short* xi, short* xq, size_t maxCount) {
+    if (!xi || !xq || maxCount == 0) {
+        return 0;
+    }
+
+    size_t pos;
+    size_t count = index.beginRead(maxCount, pos);
+    if (count == 0) {
+        return 0;
+    }
+
+    copyOut(pos, xi, xq, count);
+    return index.endRead(pos, count) ? count : 0;
+}
+
+PlanarSpans PlanarBuffer::peek(size_t maxCount) {
+    size_t pos;
+    size_t count = index.peek(maxCount, pos);
+    if (count == 0) {
+        return PlanarSpans();
+    }
+    return spansAt(pos, count);
+}
+
+size_t PlanarBuffer::consume(size_t count) {
+    return index.consume(count);
+}
+
+bool PlanarBuffer::waitForSamples(size_t count, unsigned int timeoutMs) {
+    return index.waitForSamples(count, timeoutMs);
+}
+
+void PlanarBuffer::setWaitStrategy(WaitStrategy strategy, unsigned int spinUs) {
+    index.setWaitStrategy(strategy, spinUs);
+}
+
+WaitStrategy PlanarBuffer::getWaitStrategy() const {
+    return index.getWaitStrategy();
+}
+
+size_t PlanarBuffer::available() const {
+    return index.available();
+}
+
+uint64_t PlanarBuffer::readIndex() const {
+    return index.readIndex();
+}
+
+uint64_t PlanarBuffer::writeIndex() const {
+    return index.writeIndex();
+}
+
+bool PlanarBuffer::overflow() const {
+    return index.overflow();
+}
+
+void PlanarBuffer::reset() {
+    index.reset();
+}
+
+void PlanarBuffer::setOverflowPolicy(OverflowPolicy policy, unsigned int timeoutMs) {
+    index.setOverflowPolicy(policy, timeoutMs);
+}
+
+OverflowPolicy PlanarBuffer::getOverflowPolicy() const {
+    return index.getOverflowPolicy();
+}
+
+uint64_t PlanarBuffer::droppedSamples() const {
+    return index.droppedSamples();
+}
+
+uint64_t PlanarBuffer::overflowEvents() const {
+    return index.overflowEvents();
+}
+
+size_t PlanarBuffer::capacity() const {
+    return index.capacity();
+}
+
+bool PlanarBuffer::lockMemory(bool lock) {
+    if (!lock) {
+        iStorage.unlock();
+        qStorage.unlock();
+        return true;
+    }
+    return iStorage.lock() && qStorage.lock();
+}
+
+bool PlanarBuffer::prefaultMemory() {
+    return iStorage.prefault() && qStorage.prefault();
+}
+
+RingLayout PlanarBuffer::layout() const {
+    return mirrored() ? RingLayout::Mirrored : RingLayout::Standard;
+}
+
+} // namespace sdrplay
@@ -0,0 +1,137 @@
+#include "ring_allocator.h"
+#include "ring_storage.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #define SDRPLAY_HAVE_HUGE_PAGES 1
+
+    #ifndef MAP_HUGE_SHIFT
+        #define MAP_HUGE_SHIFT 26
+    #endif
+    #ifndef MPOL_BIND
+        #define MPOL_BIND 2  // From <numaif.h>, which would pull in libnuma
+    #endif
+#endif
+
+namespace sdrplay {
+
+// The original calloc() pointer is kept in the word just before the
+// aligned block so deallocate() can find it
+void* HeapRingAllocator::allocate(size_t bytes) {
+    const size_t alignment = RingStorage::ALIGNMENT;
+    void* raw = std::calloc(bytes + alignment + sizeof(void*), 1);
+    if (!raw) {
+        return nullptr;
+    }
+    uintptr_t address = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+    address = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    void** block = reinterpret_cast<void**>(address);
+    block[-1] = raw;
+    return block;
+}
+
+void HeapRingAllocator::deallocate(void* block, size_t) {
+    if (block) {
+        std::free(static_cast<void**>(block)[-1]);
+    }
+}
+
+std::shared_ptr<RingAllocator> HeapRingAllocator::instance() {
+    static std::shared_ptr<RingAllocator> allocator = std::make_shared<HeapRingAllocator>();
+    return allocator;
+}
+
+HugePageRingAllocator::HugePageRingAllocator(HugePageMode mode, int numaNode)
+    : mode(mode), numaNode(numaNode) {}
+
+size_t HugePageRingAllocator::roundUp(size_t bytes) {
+    return (std::max<size_t>(bytes, 1) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+int HugePageRingAllocator::currentNode() {
+#if defined(SDRPLAY_HAVE_HUGE_PAGES) && defined(SYS_getcpu)
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return -1;
+}
+
+void* HugePageRingAllocator::allocate(size_t bytes) {
+#if defined(SDRPLAY_HAVE_HUGE_PAGES)
+    size_t length = roundUp(bytes);
+    HugePageAllocation status;
+    void* block = nullptr;
+
+    if (mode == HugePageMode::Explicit) {
+        void* mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+        if (mapped != MAP_FAILED) {
+            block = mapped;
+            status.explicitHugePages = true;
+        }
+    }
+
+    if (!block) {
+        // Over-map by one huge page and trim, so the block starts on a
+        // 2 MB boundary and every page of it can be promoted
+        size_t span = length + HUGE_PAGE_SIZE;
+        void* mapped = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            return nullptr;
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+        uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~static_cast<uintptr_t>(HUGE_PAGE_SIZE - 1);
+        if (aligned > start) {
+            munmap(mapped, aligned - start);
+        }
+        size_t tail = (start + span) - (aligned + length);
+        if (tail > 0) {
+            munmap(reinterpret_cast<void*>(aligned + length), tail);
+        }
+        block = reinterpret_cast<void*>(aligned);
+        status.transparent = madvise(block, length, MADV_HUGEPAGE) == 0;
+    }
+
+    // Pages are placed on first touch, so binding before use is enough
+    int node = numaNode == CURRENT_NODE ? currentNode() : numaNode;
+    if (node >= 0 && node < static_cast<int>(8 * sizeof(unsigned long))) {
+        unsigned long nodemask = 1UL << node;
+        if (syscall(SYS_mbind, block, length, MPOL_BIND, &nodemask,
+                    8 * sizeof(nodemask), 0) == 0) {
+            status.numaNode = node;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(statusMutex);
+    last = status;
+    return block;
+#else
+    return HeapRingAllocator::instance()->allocate(bytes);
+#endif
+}
+
+void HugePageRingAllocator::deallocate(void* block, size_t bytes) {
+    if (!block) {
+        return;
+    }
+#if defined(SDRPLAY_HAVE_HUGE_PAGES)
+    munmap(block, roundUp(bytes));
+#else
+    HeapRingAllocator::instance()->deallocate(block, bytes);
+#endif
+}
+
+HugePageAllocation HugePageRingAllocator::lastAllocation() const {
+    std::lock_guard<std::mutex> lock(statusMutex);
+    return last;
+}
+
+} // namespace sdrplay
@@ -0,0 +1,292 @@
+#include "ring_index.h"
+#include <chrono>
+
+namespace sdrplay {
+
+size_t RingIndex::roundUpToPowerOfTwo(size_t size) {
+    size_t result = 1;
+    while (result < size) {
+        result <<= 1;
+    }
+    return result;
+}
+
+size_t RingIndex::capacityFor(size_t size, RingLayout layout, size_t elementSize) {
+    size_t capacity = roundUpToPowerOfTwo(size);
+    if (layout == RingLayout::Mirrored) {
+        // Mirroring maps whole pages, so grow to at least one page of elements
+        size_t minElements = RingStorage::mirrorGranularity() / elementSize;
+        capacity = std::max(capacity, roundUpToPowerOfTwo(minElements));
+    }
+    return capacity;
+}
+
+RingIndex::RingIndex(size_t capacity)
+    : bufferSize(capacity), mask(capacity - 1), publishedCapacity(capacity),
+      head(0), tail(0), overflowed(false), waiters(0), spaceWaiters(0),
+      waitStrategy(WaitStrategy::Block), spinBudgetUs(50),
+      overflowPolicy(OverflowPolicy::DropNewest), blockTimeoutMs(10),
+      dropped(0), overflowEpisodes(0), inOverflow(false), peekPos(0), peekCount(0) {}
+
+void RingIndex::resize(size_t capacity) {
+    bufferSize = capacity;
+    mask = capacity - 1;
+    publishedCapacity.store(capacity, std::memory_order_relaxed);
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_release);
+    overflowed.store(false, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    overflowEpisodes.store(0, std::memory_order_relaxed);
+    inOverflow = false;
+    peekPos = 0;
+    peekCount = 0;
+}
+
+void RingIndex::notifyWaiters() {
+    // Pairs with the fence in waitForSamples: either the waiter sees the new
+    // tail in its predicate, or we see it registered and wake it up.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        dataAvailable.notify_all();
+    }
+    dataEvent.notify();
+}
+
+void RingIndex::notifySpace() {
+    // Mirror of notifyWaiters() for a producer blocked in waitForSpace
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (spaceWaiters.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        spaceAvailable.notify_all();
+    }
+}
+
+bool RingIndex::waitForSpace(size_t count, unsigned int timeoutMs) {
+    if (count > bufferSize || timeoutMs == 0) {
+        return false;
+    }
+
+    size_t t = tail.load(std::memory_order_relaxed);
+    auto ready = [this, t, count]() {
+        return bufferSize - (t - head.load(std::memory_order_acquire)) >= count;
+    };
+
+    std::unique_lock<std::mutex> lock(waitMutex);
+    spaceWaiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool result = spaceAvailable.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+    spaceWaiters.fetch_sub(1, std::memory_order_relaxed);
+    return result;
+}
+
+size_t RingIndex::discardOldest(size_t t, size_t count) {
+    size_t h = head.load(std::memory_order_acquire);
+    while (bufferSize - (t - h) < count) {
+        size_t newHead = t + count - bufferSize;
+        // Racing the consumer: if it advanced head first, retry with less to drop
+        if (head.compare_exchange_weak(h, newHead,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+            return newHead - h;
+        }
+    }
+    return 0;
+}
+
+void RingIndex::recordOverflow(size_t count) {
+    if (count == 0) {
+        inOverflow = false;
+        return;
+    }
+    dropped.fetch_add(count, std::memory_order_relaxed);
+    if (!inOverflow) {
+        overflowEpisodes.fetch_add(1, std::memory_order_relaxed);
+        inOverflow = true;
+    }
+    overflowed.store(true, std::memory_order_relaxed);
+}
+
+RingIndex::WriteRange RingIndex::beginWrite(size_t count) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    size_t space = bufferSize - (t - h);
+    WriteRange range = { t, 0, count, 0 };
+
+    if (count > space) {
+        OverflowPolicy policy = overflowPolicy.load(std::memory_order_relaxed);
+
+        if (policy == OverflowPolicy::BlockWithTimeout &&
+            waitForSpace(count, blockTimeoutMs.load(std::memory_order_relaxed))) {
+            space = count;
+        } else if (policy == OverflowPolicy::DropOldest) {
+            // Only the newest capacity samples of an oversized packet can survive
+            if (range.count > bufferSize) {
+                range.skip = range.count - bufferSize;
+                range.count = bufferSize;
+            }
+            range.lost = range.skip + discardOldest(t, range.count);
+            space = range.count;
+        } else {
+            // Drop newest; also the fallback when blocking timed out
+            h = head.load(std::memory_order_acquire);
+            space = bufferSize - (t - h);
+        }
+
+        if (range.count > space) {
+            range.lost += range.count - space;
+            range.count = space;
+        }
+    }
+    return range;
+}
+
+bool RingIndex::endWrite(const WriteRange& range) {
+    if (range.count > 0) {
+        tail.store(range.pos + range.count, std::memory_order_release);
+        notifyWaiters();
+    }
+    recordOverflow(range.lost);
+    return range.lost == 0;
+}
+
+size_t RingIndex::beginRead(size_t maxCount, size_t& pos) {
+    peekCount = 0;  // Moving head invalidates any outstanding peek
+
+    pos = head.load(std::memory_order_acquire);
+    size_t t = tail.load(std::memory_order_acquire);
+    return std::min(t - pos, maxCount);
+}
+
+bool RingIndex::endRead(size_t pos, size_t count) {
+    // A concurrent reset() or DropOldest overwrite moves head forward and
+    // lets the producer reuse the slots just copied, so the copy is
+    // discarded in that case.
+    if (!head.compare_exchange_strong(pos, pos + count,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+        return false;
+    }
+    notifySpace();
+    return true;
+}
+
+size_t RingIndex::peek(size_t maxCount, size_t& pos) {
+    pos = head.load(std::memory_order_acquire);
+    size_t t = tail.load(std::memory_order_acquire);
+    size_t count = std::min(t - pos, maxCount);
+
+    peekPos = pos;
+    peekCount = count;
+    return count;
+}
+
+size_t RingIndex::consume(size_t count) {
+    count = std::min(count, peekCount);
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t h = peekPos;
+    peekPos += count;
+    peekCount -= count;
+
+    // Fails only if reset() or a DropOldest overwrite discarded the peeked
+    // samples in the meantime
+    if (!head.compare_exchange_strong(h, h + count,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+        peekCount = 0;
+        return 0;
+    }
+    notifySpace();
+    return count;
+}
+
+bool RingIndex::waitForSamples(size_t count, unsigned int timeoutMs) {
+    count = std::min(count, bufferSize);
+    if (available() >= count) {
+        return true;
+    }
+
+    WaitStrategy strategy = waitStrategy.load(std::memory_order_relaxed);
+    if (strategy != WaitStrategy::Block) {
+        return spinWait(dataEvent, strategy, spinBudgetUs.load(std::memory_order_relaxed), timeoutMs,
+                        [this, count]() { return available() >= count; });
+    }
+
+    std::unique_lock<std::mutex> lock(waitMutex);
+    waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    auto ready = [this, count]() { return available() >= count; };
+    bool result = true;
+    if (timeoutMs == 0) {
+        // Wait indefinitely
+        dataAvailable.wait(lock, ready);
+    } else {
+        // Wait with timeout
+        result = dataAvailable.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+    }
+
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+    return result;
+}
+
+void RingIndex::setWaitStrategy(WaitStrategy strategy, unsigned int spinUs) {
+    spinBudgetUs.store(spinUs, std::memory_order_relaxed);
+    waitStrategy.store(strategy, std::memory_order_relaxed);
+}
+
+WaitStrategy RingIndex::getWaitStrategy() const {
+    return waitStrategy.load(std::memory_order_relaxed);
+}
+
+size_t RingIndex::available() const {
+    // Load head first: it never passes the tail, so the difference cannot underflow
+    size_t h = head.load(std::memory_order_acquire);
+    size_t t = tail.load(std::memory_order_acquire);
+    return t - h;
+}
+
+uint64_t RingIndex::readIndex() const {
+    return head.load(std::memory_order_acquire);
+}
+
+uint64_t RingIndex::writeIndex() const {
+    return tail.load(std::memory_order_acquire);
+}
+
+bool RingIndex::overflow() const {
+    return overflowed.load(std::memory_order_relaxed);
+}
+
+void RingIndex::reset() {
+    size_t t = tail.load(std::memory_order_acquire);
+    size_t h = head.load(std::memory_order_relaxed);
+    while (h < t && !head.compare_exchange_weak(h, t,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+    }
+    overflowed.store(false, std::memory_order_relaxed);
+    notifySpace();
+}
+
+void RingIndex::setOverflowPolicy(OverflowPolicy policy, unsigned int timeoutMs) {
+    blockTimeoutMs.store(timeoutMs, std::memory_order_relaxed);
+    overflowPolicy.store(policy, std::memory_order_relaxed);
+}
+
+OverflowPolicy RingIndex::getOverflowPolicy() const {
+    return overflowPolicy.load(std::memory_order_relaxed);
+}
+
+uint64_t RingIndex::droppedSamples() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t RingIndex::overflowEvents() const {
+    return overflowEpisodes.load(std::memory_order_relaxed);
+}
+
+} // namespace sdrplay
@@ -0,0 +1,182 @@
+#include "ring_storage.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define SDRPLAY_HAVE_MIRRORED_RING 1
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define SDRPLAY_HAVE_MLOCK 1
+#endif
+
+#if defined(__linux__) && !defined(MADV_POPULATE_WRITE)
+    #define MADV_POPULATE_WRITE 23  // Linux 5.14; older headers lack it
+#endif
+
+namespace sdrplay {
+
+RingStorage::RingStorage(size_t size, RingLayout layout, std::shared_ptr<RingAllocator> allocator)
+    : base(nullptr), bytes(size), isMirrored(false), isLocked(false) {
+    if (layout == RingLayout::Mirrored && mapMirrored(size)) {
+        return;
+    }
+
+    // Standard layout, also the fallback when mirroring is unavailable
+    this->allocator = allocator ? std::move(allocator) : HeapRingAllocator::instance();
+    base = this->allocator->allocate(size);
+    if (!base) {
+        throw std::bad_alloc();
+    }
+}
+
+RingStorage::~RingStorage() {
+    release();
+}
+
+RingStorage::RingStorage(RingStorage&& other) noexcept
+    : base(other.base), allocator(std::move(other.allocator)), bytes(other.bytes),
+      isMirrored(other.isMirrored), isLocked(other.isLocked) {
+    other.base = nullptr;
+    other.bytes = 0;
+    other.isMirrored = false;
+    other.isLocked = false;
+}
+
+RingStorage& RingStorage::operator=(RingStorage&& other) noexcept {
+    if (this != &other) {
+        release();
+        std::swap(base, other.base);
+        std::swap(allocator, other.allocator);
+        std::swap(bytes, other.bytes);
+        std::swap(isMirrored, other.isMirrored);
+        std::swap(isLocked, other.isLocked);
+    }
+    return *this;
+}
+
+size_t RingStorage::mirrorGranularity() {
+#if defined(SDRPLAY_HAVE_MIRRORED_RING)
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return pageSize;
+#else
+    return 0;
+#endif
+}
+
+bool RingStorage::mapMirrored(size_t size) {
+#if defined(SDRPLAY_HAVE_MIRRORED_RING)
+    size_t granularity = mirrorGranularity();
+    if (size == 0 || granularity == 0 || size % granularity != 0) {
+        return false;
+    }
+
+    int fd = memfd_create("sdrplay_ring", MFD_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Reserve twice the address space, then map the same pages into both halves
+    void* reserved = mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    char* lower = static_cast<char*>(reserved);
+    void* first = mmap(lower, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    void* second = (first == MAP_FAILED) ? MAP_FAILED
+        : mmap(lower + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+
+    // The mappings keep the memory alive; the descriptor is no longer needed
+    ::close(fd);
+
+    if (first == MAP_FAILED || second == MAP_FAILED) {
+        munmap(reserved, 2 * size);
+        return false;
+    }
+
+    base = reserved;
+    bytes = size;
+    isMirrored = true;
+    return true;
+#else
+    (void)size;
+    return false;
+#endif
+}
+
+size_t RingStorage::mappedBytes() const {
+    return isMirrored ? 2 * bytes : bytes;
+}
+
+bool RingStorage::lock() {
+#if defined(SDRPLAY_HAVE_MLOCK)
+    if (!base || isLocked) {
+        return base != nullptr;
+    }
+    if (mlock(base, mappedBytes()) != 0) {
+        return false;
+    }
+    isLocked = true;
+    return true;
+#else
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+void RingStorage::unlock() {
+#if defined(SDRPLAY_HAVE_MLOCK)
+    if (isLocked) {
+        munlock(base, mappedBytes());
+        isLocked = false;
+    }
+#endif
+}
+
+bool RingStorage::prefault() {
+#if defined(__linux__)
+    if (!base) {
+        return false;
+    }
+    // madvise wants a page-aligned start; standard storage comes from the heap
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(base) & ~static_cast<uintptr_t>(page - 1);
+    size_t length = reinterpret_cast<uintptr_t>(base) + mappedBytes() - start;
+    return madvise(reinterpret_cast<void*>(start), length, MADV_POPULATE_WRITE) == 0;
+#else
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+void RingStorage::release() {
+    if (!base) {
+        return;
+    }
+    unlock();
+#if defined(SDRPLAY_HAVE_MIRRORED_RING)
+    if (isMirrored) {
+        munmap(base, 2 * bytes);
+        base = nullptr;
+        return;
+    }
+#endif
+    allocator->deallocate(base, bytes);
+    base = nullptr;
+    allocator.reset();
+}
+
+} // namespace sdrplay
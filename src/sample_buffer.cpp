@@ -0,0 +1,158 @@
+#include "sample_buffer.h"
+#include <cstring>
+#include <utility>
+
+namespace sdrplay {
+
+SampleBuffer::SampleBuffer(size_t size, RingLayout layout, std::shared_ptr<RingAllocator> allocator)
+    : storage(RingIndex::capacityFor(size, layout, sizeof(std::complex<short>)) * sizeof(std::complex<short>),
+              layout, std::move(allocator)),
+      index(RingIndex::capacityFor(size, layout, sizeof(std::complex<short>))) {}
+
+void SampleBuffer::reconfigure(size_t size, RingLayout layout, std::shared_ptr<RingAllocator> allocator) {
+    size_t newSize = RingIndex::capacityFor(size, layout, sizeof(std::complex<short>));
+    storage = RingStorage(newSize * sizeof(std::complex<short>), layout, std::move(allocator));
+    index.resize(newSize);
+}
+
+std::complex<short>* SampleBuffer::samples() const {
+    return static_cast<std::complex<short>*>(storage.data());
+}
+
+void SampleBuffer::copyIn(size_t pos, const std::complex<short>* src, size_t count) {
+    size_t offset = index.offset(pos);
+    size_t first = index.firstSegment(pos, count, storage.mirrored());
+    std::memcpy(samples() + offset, src, first * sizeof(std::complex<short>));
+    if (count > first) {
+        std::memcpy(samples(), src + first, (count - first) * sizeof(std::complex<short>));
+    }
+}
+
+void SampleBuffer::copyOut(size_t pos, std::complex<short>* dest, size_t count) const {
+    size_t offset = index.offset(pos);
+    size_t first = index.firstSegment(pos, count, storage.mirrored());
+    std::memcpy(dest, samples() + offset, first * sizeof(std::complex<short>));
+    if (count > first) {
+        std::memcpy(dest + first, samples(), (count - first) * sizeof(std::complex<short>));
+    }
+}
+
+SampleSpans SampleBuffer::spansAt(size_t pos, size_t count) const {
+    SampleSpans spans;
+    size_t first = index.firstSegment(pos, count, storage.mirrored());
+    spans.first = SampleSpan(samples() + index.offset(pos), first);
+    if (count > first) {
+        spans.second = SampleSpan(samples(), count - first);
+    }
+    return spans;
+}
+
+bool SampleBuffer::write(const std::complex<short>* data, size_t count) {
+    if (!data || count == 0) {
+        return true;
+    }
+
+    RingIndex::WriteRange range = index.beginWrite(count);
+    if (range.count > 0) {
+        copyIn(range.pos, data + range.skip, range.count);
+    }
+    return index.endWrite(range);
+}
+
+size_t SampleBuffer::read(std::complex<short>* dest, size_t maxCount) {
+    if (!dest || maxCount == 0) {
+        return 0;
+    }
+
+    size_t pos;
+    size_t count = index.beginRead(maxCount, pos);
+    if (count == 0) {
+        return 0;  // Buffer is empty
+    }
+
+    copyOut(pos, dest, count);
+    return index.endRead(pos, count) ? count : 0;
+}
+
+SampleSpans SampleBuffer::peek(size_t maxCount) {
+    size_t pos;
+    size_t count = index.peek(maxCount, pos);
+    if (count == 0) {
+        return SampleSpans();
+    }
+    return spansAt(pos, count);
+}
+
+size_t SampleBuffer::consume(size_t count) {
+    return index.consume(count);
+}
+
+bool SampleBuffer::waitForSamples(size_t count, unsigned int timeoutMs) {
+    return index.waitForSamples(count, timeoutMs);
+}
+
+void SampleBuffer::setWaitStrategy(WaitStrategy strategy, unsigned int spinUs) {
+    index.setWaitStrategy(strategy, spinUs);
+}
+
+WaitStrategy SampleBuffer::getWaitStrategy() const {
+    return index.getWaitStrategy();
+}
+
+size_t SampleBuffer::available() const {
+    return index.available();
+}
+
+uint64_t SampleBuffer::readIndex() const {
+    return index.readIndex();
+}
+
+uint64_t SampleBuffer::writeIndex() const {
+    return index.writeIndex();
+}
+
+bool SampleBuffer::overflow() const {
+    return index.overflow();
+}
+
+void SampleBuffer::reset() {
+    index.reset();
+}
+
+void SampleBuffer::setOverflowPolicy(OverflowPolicy policy, unsigned int timeoutMs) {
+    index.setOverflowPolicy(policy, timeoutMs);
+}
+
+OverflowPolicy SampleBuffer::getOverflowPolicy() const {
+    return index.getOverflowPolicy();
+}
+
+uint64_t SampleBuffer::droppedSamples() const {
+    return index.droppedSamples();
+}
+
+uint64_t SampleBuffer::overflowEvents() const {
+    return index.overflowEvents();
+}
+
+size_t SampleBuffer::capacity() const {
+    return index.capacity();
+}
+
+bool SampleBuffer::lockMemory(bool lock) {
+    if (!lock) {
+        storage.unlock();
+        return true;
+    }
+    return storage.lock();
+}
+
+bool SampleBuffer::prefaultMemory() {
+    return storage.prefault();
+}
+
+RingLayout SampleBuffer::layout() const {
+    return storage.mirrored() ? RingLayout::Mirrored : RingLayout::Standard;
+}
+
+} // namespace sdrplay
@@ -0,0 +1,430 @@
+#include "sample_convert.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define SDRPLAY_HAVE_X86_KERNELS 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define SDRPLAY_TARGET_SSE2
+        #define SDRPLAY_TARGET_AVX2
+    #else
+        #define SDRPLAY_TARGET_SSE2 __attribute__((target("sse2")))
+        #define SDRPLAY_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+    #define SDRPLAY_HAVE_NEON_KERNELS 1
+    #include <arm_neon.h>
+#endif
+
+namespace sdrplay {
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Interleave kernels
+//------------------------------------------------------------------------------
+
+void interleaveScalar(const short* xi, const short* xq, std::complex<short>* dest, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = std::complex<short>(xi[i], xq[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Format conversion kernels
+//
+// CS8/CU8 keep the top byte of each component with an arithmetic shift, so
+// every kernel rounds toward negative infinity the same way.
+//------------------------------------------------------------------------------
+
+void toCF32Scalar(const std::complex<short>* src, std::complex<float>* dest, size_t count, float scale) {
+    const short* in = reinterpret_cast<const short*>(src);
+    float* out = reinterpret_cast<float*>(dest);
+    for (size_t i = 0; i < 2 * count; ++i) {
+        out[i] = static_cast<float>(in[i]) * scale;
+    }
+}
+
+void toCS8Scalar(const std::complex<short>* src, int8_t* dest, size_t count) {
+    const short* in = reinterpret_cast<const short*>(src);
+    for (size_t i = 0; i < 2 * count; ++i) {
+        dest[i] = static_cast<int8_t>(in[i] >> 8);
+    }
+}
+
+void toCU8Scalar(const std::complex<short>* src, uint8_t* dest, size_t count) {
+    const short* in = reinterpret_cast<const short*>(src);
+    for (size_t i = 0; i < 2 * count; ++i) {
+        dest[i] = static_cast<uint8_t>((in[i] >> 8) + 128);
+    }
+}
+
+#if defined(SDRPLAY_HAVE_X86_KERNELS)
+
+SDRPLAY_TARGET_SSE2
+void interleaveSSE2(const short* xi, const short* xq, std::complex<short>* dest, size_t count) {
+    short* out = reinterpret_cast<short*>(dest);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xi + i));
+        __m128i vq = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xq + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi16(vi, vq));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 8), _mm_unpackhi_epi16(vi, vq));
+    }
+    interleaveScalar(xi + i, xq + i, dest + i, count - i);
+}
+
+SDRPLAY_TARGET_AVX2
+void interleaveAVX2(const short* xi, const short* xq, std::complex<short>* dest, size_t count) {
+    short* out = reinterpret_cast<short*>(dest);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xi + i));
+        __m256i vq = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xq + i));
+        // unpack works per 128-bit lane, so swap the middle halves back into order
+        __m256i lo = _mm256_unpacklo_epi16(vi, vq);
+        __m256i hi = _mm256_unpackhi_epi16(vi, vq);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i),
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 16),
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    interleaveSSE2(xi + i, xq + i, dest + i, count - i);
+}
+
+SDRPLAY_TARGET_SSE2
+void toCF32SSE2(const std::complex<short>* src, std::complex<float>* dest, size_t count, float scale) {
+    const short* in = reinterpret_cast<const short*>(src);
+    float* out = reinterpret_cast<float*>(dest);
+    const __m128 vscale = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+        // Sign-extend by placing each value in the top half and shifting back
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + 2 * i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+    }
+    toCF32Scalar(src + i, dest + i, count - i, scale);
+}
+
+SDRPLAY_TARGET_SSE2
+void toCS8SSE2(const std::complex<short>* src, int8_t* dest, size_t count) {
+    const short* in = reinterpret_cast<const short*>(src);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i)), 8);
+        __m128i b = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 2 * i), _mm_packs_epi16(a, b));
+    }
+    toCS8Scalar(src + i, dest + 2 * i, count - i);
+}
+
+SDRPLAY_TARGET_SSE2
+void toCU8SSE2(const std::complex<short>* src, uint8_t* dest, size_t count) {
+    const short* in = reinterpret_cast<const short*>(src);
+    const __m128i offset = _mm_set1_epi8(static_cast<char>(0x80));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i)), 8);
+        __m128i b = _mm_srai_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8)), 8);
+        // Adding 128 to a signed byte is flipping its top bit
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 2 * i),
+                         _mm_xor_si128(_mm_packs_epi16(a, b), offset));
+    }
+    toCU8Scalar(src + i, dest + 2 * i, count - i);
+}
+
+SDRPLAY_TARGET_AVX2
+void toCF32AVX2(const std::complex<short>* src, std::complex<float>* dest, size_t count, float scale) {
+    const short* in = reinterpret_cast<const short*>(src);
+    float* out = reinterpret_cast<float*>(dest);
+    const __m256 vscale = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8));
+        _mm256_storeu_ps(out + 2 * i,
+                         _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), vscale));
+        _mm256_storeu_ps(out + 2 * i + 8,
+                         _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), vscale));
+    }
+    toCF32SSE2(src + i, dest + i, count - i, scale);
+}
+
+SDRPLAY_TARGET_AVX2
+__m256i packTopBytesAVX2(const short* in) {
+    __m256i a = _mm256_srai_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)), 8);
+    __m256i b = _mm256_srai_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 16)), 8);
+    // packs works per 128-bit lane; restore the order of the four quarters
+    return _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xD8);
+}
+
+SDRPLAY_TARGET_AVX2
+void toCS8AVX2(const std::complex<short>* src, int8_t* dest, size_t count) {
+    const short* in = reinterpret_cast<const short*>(src);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 2 * i), packTopBytesAVX2(in + 2 * i));
+    }
+    toCS8SSE2(src + i, dest + 2 * i, count - i);
+}
+
+SDRPLAY_TARGET_AVX2
+void toCU8AVX2(const std::complex<short>* src, uint8_t* dest, size_t count) {
+    const short* in = reinterpret_cast<const short*>(src);
+    const __m256i offset = _mm256_set1_epi8(static_cast<char>(0x80));
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 2 * i),
+                            _mm256_xor_si256(packTopBytesAVX2(in + 2 * i), offset));
+    }
+    toCU8SSE2(src + i, dest + 2 * i, count - i);
+}
+
+bool cpuSupports(SimdLevel level) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    bool ymmEnabled = osxsave && avx && ((_xgetbv(0) & 0x6) == 0x6);
+    switch (level) {
+        case SimdLevel::SSE2: return sse2;
+        case SimdLevel::AVX2: return avx2 && ymmEnabled;
+        default: return false;
+    }
+#else
+    __builtin_cpu_init();
+    switch (level) {
+        case SimdLevel::SSE2: return __builtin_cpu_supports("sse2");
+        case SimdLevel::AVX2: return __builtin_cpu_supports("avx2");
+        default: return false;
+    }
+#endif
+}
+
+#elif defined(SDRPLAY_HAVE_NEON_KERNELS)
+
+void interleaveNEON(const short* xi, const short* xq, std::complex<short>* dest, size_t count) {
+    short* out = reinterpret_cast<short*>(dest);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8x2_t iq;
+        iq.val[0] = vld1q_s16(xi + i);
+        iq.val[1] = vld1q_s16(xq + i);
+        vst2q_s16(out + 2 * i, iq);
+    }
+    interleaveScalar(xi + i, xq + i, dest + i, count - i);
+}
+
+void toCF32NEON(const std::complex<short>* src, std::complex<float>* dest, size_t count, float scale) {
+    const short* in = reinterpret_cast<const short*>(src);
+    float* out = reinterpret_cast<float*>(dest);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int16x8_t v = vld1q_s16(in + 2 * i);
+        vst1q_f32(out + 2 * i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(out + 2 * i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    toCF32Scalar(src + i, dest + i, count - i, scale);
+}
+
+void toCS8NEON(const std::complex<short>* src, int8_t* dest, size_t count) {
+    const short* in = reinterpret_cast<const short*>(src);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int8x8_t lo = vshrn_n_s16(vld1q_s16(in + 2 * i), 8);
+        int8x8_t hi = vshrn_n_s16(vld1q_s16(in + 2 * i + 8), 8);
+        vst1q_s8(dest + 2 * i, vcombine_s8(lo, hi));
+    }
+    toCS8Scalar(src + i, dest + 2 * i, count - i);
+}
+
+void toCU8NEON(const std::complex<short>* src, uint8_t* dest, size_t count) {
+    const short* in = reinterpret_cast<const short*>(src);
+    const uint8x16_t offset = vdupq_n_u8(0x80);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int8x8_t lo = vshrn_n_s16(vld1q_s16(in + 2 * i), 8);
+        int8x8_t hi = vshrn_n_s16(vld1q_s16(in + 2 * i + 8), 8);
+        vst1q_u8(dest + 2 * i, veorq_u8(vreinterpretq_u8_s8(vcombine_s8(lo, hi)), offset));
+    }
+    toCU8Scalar(src + i, dest + 2 * i, count - i);
+}
+
+#endif
+
+using InterleaveFn = void (*)(const short*, const short*, std::complex<short>*, size_t);
+
+InterleaveFn interleaveKernel(SimdLevel level) {
+    if (!isSimdLevelSupported(level)) {
+        return &interleaveScalar;
+    }
+    switch (level) {
+#if defined(SDRPLAY_HAVE_X86_KERNELS)
+        case SimdLevel::SSE2: return &interleaveSSE2;
+        case SimdLevel::AVX2: return &interleaveAVX2;
+#elif defined(SDRPLAY_HAVE_NEON_KERNELS)
+        case SimdLevel::NEON: return &interleaveNEON;
+#endif
+        default: return &interleaveScalar;
+    }
+}
+
+/**
+ * @brief Format conversion kernels for one instruction set
+ */
+struct ConvertKernels {
+    void (*toCF32)(const std::complex<short>*, std::complex<float>*, size_t, float);
+    void (*toCS8)(const std::complex<short>*, int8_t*, size_t);
+    void (*toCU8)(const std::complex<short>*, uint8_t*, size_t);
+};
+
+ConvertKernels convertKernels(SimdLevel level) {
+    if (isSimdLevelSupported(level)) {
+        switch (level) {
+#if defined(SDRPLAY_HAVE_X86_KERNELS)
+            case SimdLevel::SSE2: return { &toCF32SSE2, &toCS8SSE2, &toCU8SSE2 };
+            case SimdLevel::AVX2: return { &toCF32AVX2, &toCS8AVX2, &toCU8AVX2 };
+#elif defined(SDRPLAY_HAVE_NEON_KERNELS)
+            case SimdLevel::NEON: return { &toCF32NEON, &toCS8NEON, &toCU8NEON };
+#endif
+            default: break;
+        }
+    }
+    return { &toCF32Scalar, &toCS8Scalar, &toCU8Scalar };
+}
+
+const ConvertKernels& bestConvertKernels() {
+    static const ConvertKernels kernels = convertKernels(detectSimdLevel());
+    return kernels;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Runtime dispatch
+//------------------------------------------------------------------------------
+
+bool isSimdLevelSupported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar:
+            return true;
+#if defined(SDRPLAY_HAVE_X86_KERNELS)
+        case SimdLevel::SSE2:
+        case SimdLevel::AVX2:
+            return cpuSupports(level);
+#elif defined(SDRPLAY_HAVE_NEON_KERNELS)
+        case SimdLevel::NEON:
+            return true;  // NEON is mandatory wherever these kernels are compiled
+#endif
+        default:
+            return false;
+    }
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = []() {
+        const SimdLevel preferred[] = { SimdLevel::AVX2, SimdLevel::SSE2, SimdLevel::NEON };
+        for (SimdLevel candidate : preferred) {
+            if (isSimdLevelSupported(candidate)) {
+                return candidate;
+            }
+        }
+        return SimdLevel::Scalar;
+    }();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE2: return "SSE2";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::NEON: return "NEON";
+        default: return "Scalar";
+    }
+}
+
+void interleaveIQ(const short* xi, const short* xq, std::complex<short>* dest, size_t count) {
+    static const InterleaveFn kernel = interleaveKernel(detectSimdLevel());
+    kernel(xi, xq, dest, count);
+}
+
+void interleaveIQ(SimdLevel level, const short* xi, const short* xq,
+                  std::complex<short>* dest, size_t count) {
+    interleaveKernel(level)(xi, xq, dest, count);
+}
+
+//------------------------------------------------------------------------------
+// Format conversion
+//------------------------------------------------------------------------------
+
+size_t sampleFormatSize(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::CF32: return sizeof(std::complex<float>);
+        case SampleFormat::CS8:
+        case SampleFormat::CU8: return 2;
+        default: return sizeof(std::complex<short>);
+    }
+}
+
+const char* sampleFormatName(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::CF32: return "CF32";
+        case SampleFormat::CS8: return "CS8";
+        case SampleFormat::CU8: return "CU8";
+        default: return "CS16";
+    }
+}
+
+void convertToCF32(const std::complex<short>* src, std::complex<float>* dest, size_t count, float scale) {
+    bestConvertKernels().toCF32(src, dest, count, scale);
+}
+
+void convertToCS8(const std::complex<short>* src, int8_t* dest, size_t count) {
+    bestConvertKernels().toCS8(src, dest, count);
+}
+
+void convertToCU8(const std::complex<short>* src, uint8_t* dest, size_t count) {
+    bestConvertKernels().toCU8(src, dest, count);
+}
+
+void convertSamples(SampleFormat format, const std::complex<short>* src, void* dest, size_t count) {
+    switch (format) {
+        case SampleFormat::CF32:
+            convertToCF32(src, static_cast<std::complex<float>*>(dest), count);
+            break;
+        case SampleFormat::CS8:
+            convertToCS8(src, static_cast<int8_t*>(dest), count);
+            break;
+        case SampleFormat::CU8:
+            convertToCU8(src, static_cast<uint8_t*>(dest), count);
+            break;
+        default:
+            if (count > 0) {
+                std::memcpy(dest, src, count * sizeof(std::complex<short>));
+            }
+            break;
+    }
+}
+
+void convertToCF32(SimdLevel level, const std::complex<short>* src, std::complex<float>* dest,
+                   size_t count, float scale) {
+    convertKernels(level).toCF32(src, dest, count, scale);
+}
+
+void convertToCS8(SimdLevel level, const std::complex<short>* src, int8_t* dest, size_t count) {
+    convertKernels(level).toCS8(src, dest, count);
+}
+
+void convertToCU8(SimdLevel level, const std::complex<short>* src, uint8_t* dest, size_t count) {
+    convertKernels(level).toCU8(src, dest, count);
+}
+
+} // namespace sdrplay
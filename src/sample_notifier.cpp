@@ -0,0 +1,124 @@
+#include "sample_notifier.h"
+#include <algorithm>
+
+#if defined(__linux__)
+    #include <sys/eventfd.h>
+    #include <unistd.h>
+    #define SDRPLAY_HAVE_EVENTFD 1
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #define SDRPLAY_HAVE_PIPE_NOTIFIER 1
+#endif
+
+namespace sdrplay {
+
+SampleNotifier::SampleNotifier()
+    : readFd(-1), writeFd(-1), watermark(0), signalled(false), signals(0) {}
+
+SampleNotifier::~SampleNotifier() {
+#if defined(SDRPLAY_HAVE_EVENTFD) || defined(SDRPLAY_HAVE_PIPE_NOTIFIER)
+    if (writeFd >= 0 && writeFd != readFd) {
+        ::close(writeFd);
+    }
+    if (readFd >= 0) {
+        ::close(readFd);
+    }
+#endif
+}
+
+int SampleNotifier::enable(size_t lowWatermark) {
+    std::lock_guard<std::mutex> lock(enableMutex);
+    if (readFd < 0) {
+#if defined(SDRPLAY_HAVE_EVENTFD)
+        int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (efd < 0) {
+            return -1;
+        }
+        readFd = writeFd = efd;
+#elif defined(SDRPLAY_HAVE_PIPE_NOTIFIER)
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return -1;
+        }
+        for (int pipeFd : fds) {
+            fcntl(pipeFd, F_SETFL, fcntl(pipeFd, F_GETFL) | O_NONBLOCK);
+            fcntl(pipeFd, F_SETFD, FD_CLOEXEC);
+        }
+        readFd = fds[0];
+        writeFd = fds[1];
+#else
+        return -1;
+#endif
+    }
+
+    // The descriptor is published before the watermark that makes the
+    // producer use it
+    watermark.store(std::max<size_t>(lowWatermark, 1), std::memory_order_release);
+    return readFd;
+}
+
+void SampleNotifier::disable() {
+    watermark.store(0, std::memory_order_relaxed);
+}
+
+int SampleNotifier::fd() const {
+    return readFd;
+}
+
+size_t SampleNotifier::lowWatermark() const {
+    return watermark.load(std::memory_order_relaxed);
+}
+
+void SampleNotifier::update(size_t available) {
+    size_t threshold = watermark.load(std::memory_order_acquire);
+    if (threshold == 0 || available < threshold) {
+        return;
+    }
+    // Only the first crossing since the last clear() touches the descriptor
+    if (!signalled.exchange(true, std::memory_order_seq_cst)) {
+        signal();
+    }
+}
+
+void SampleNotifier::clear() {
+    drain();
+    signalled.store(false, std::memory_order_seq_cst);
+    // Pairs with the producer storing its tail before update(): the fill
+    // level the caller reads next includes any packet that saw the flag set
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+uint64_t SampleNotifier::signalCount() const {
+    return signals.load(std::memory_order_relaxed);
+}
+
+void SampleNotifier::signal() {
+    signals.fetch_add(1, std::memory_order_relaxed);
+#if defined(SDRPLAY_HAVE_EVENTFD)
+    uint64_t one = 1;
+    ssize_t written = ::write(writeFd, &one, sizeof(one));
+    (void)written;  // Only fails if the counter is saturated, which still leaves it readable
+#elif defined(SDRPLAY_HAVE_PIPE_NOTIFIER)
+    char byte = 1;
+    ssize_t written = ::write(writeFd, &byte, 1);
+    (void)written;
+#endif
+}
+
+void SampleNotifier::drain() {
+    if (readFd < 0) {
+        return;
+    }
+#if defined(SDRPLAY_HAVE_EVENTFD)
+    uint64_t value;
+    ssize_t result = ::read(readFd, &value, sizeof(value));
+    (void)result;  // EAGAIN when nothing was signalled
+#elif defined(SDRPLAY_HAVE_PIPE_NOTIFIER)
+    char bytes[64];
+    while (::read(readFd, bytes, sizeof(bytes)) > 0) {
+    }
+#endif
+}
+
+} // namespace sdrplay
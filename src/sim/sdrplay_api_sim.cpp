@@ -0,0 +1,672 @@
+// Simulated sdrplay_api backend: implements the SDK entry points the wrapper
+// uses, streaming synthetic signals from a thread per device.
+#include "sdrplay_simulator.h"
+#include "sdrplay_api.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sdrplay {
+
+namespace {
+
+constexpr double TWO_PI = 6.283185307179586;
+constexpr double MAX_SAMPLE_RATE = 10.66e6;
+constexpr double DEFAULT_SAMPLE_RATE = 2e6;
+constexpr double DEFAULT_RF_HZ = 200e6;
+constexpr float FULL_SCALE = 32767.0f;
+constexpr double LNA_STEP_DB = 6.0;  // Gain model: flat reduction per LNA state
+
+// Work the stream thread picks up with its next packet
+enum PendingFlag : unsigned int {
+    PENDING_GR = 1u << 0,
+    PENDING_RF = 1u << 1,
+    PENDING_FS = 1u << 2,
+    PENDING_RESET = 1u << 3,
+    PENDING_GAIN_EVENT = 1u << 4,
+    PENDING_OVERLOAD_DETECTED = 1u << 5,
+    PENDING_OVERLOAD_CORRECTED = 1u << 6
+};
+
+/**
+ * @brief Renders the configured waveform into 16-bit I/Q
+ *
+ * Phases are 32-bit accumulators looked up in a cosine table, and noise is
+ * an Irwin-Hall approximation from a xorshift generator, so a packet costs a
+ * few table reads per sample even at 10 MSPS. Nothing allocates after
+ * construction.
+ */
+class SignalGenerator {
+public:
+    explicit SignalGenerator(const SimulatorConfig& config)
+        : config(config), cosine(TABLE_SIZE), carrierPhase(0), modulatorPhase(0),
+          sampleCount(0), rng(config.seed ? config.seed : 1) {
+        for (size_t i = 0; i < TABLE_SIZE; ++i) {
+            cosine[i] = static_cast<float>(std::cos(TWO_PI * static_cast<double>(i) / TABLE_SIZE));
+        }
+    }
+
+    void generate(short* xi, short* xq, unsigned int count, double sampleRate) {
+        const uint32_t carrierStep = phaseStep(config.frequencyOffsetHz, sampleRate);
+        const uint32_t modulatorStep = phaseStep(config.fmRateHz, sampleRate);
+        const double deviationSteps = config.fmDeviationHz / sampleRate * PHASE_SCALE;
+        const uint64_t burstPeriod = std::max<uint64_t>(
+            static_cast<uint64_t>(config.burstPeriodMs * 1e-3 * sampleRate), 1);
+        const uint64_t burstOn = static_cast<uint64_t>(config.burstDuty * static_cast<double>(burstPeriod));
+        const float amplitude = static_cast<float>(config.amplitude);
+        const float noise = static_cast<float>(config.noiseAmplitude);
+
+        for (unsigned int n = 0; n < count; ++n, ++sampleCount) {
+            float i = 0.0f;
+            float q = 0.0f;
+            switch (config.signal) {
+            case SimulatedSignal::Tone:
+                i = amplitude * cosOf(carrierPhase);
+                q = amplitude * sinOf(carrierPhase);
+                carrierPhase += carrierStep;
+                break;
+            case SimulatedSignal::Noise:
+                i = amplitude * gaussian();
+                q = amplitude * gaussian();
+                break;
+            case SimulatedSignal::FM:
+                i = amplitude * cosOf(carrierPhase);
+                q = amplitude * sinOf(carrierPhase);
+                carrierPhase += carrierStep +
+                    static_cast<uint32_t>(static_cast<int64_t>(deviationSteps * sinOf(modulatorPhase)));
+                modulatorPhase += modulatorStep;
+                break;
+            case SimulatedSignal::Burst:
+                if (sampleCount % burstPeriod < burstOn) {
+                    i = amplitude * cosOf(carrierPhase);
+                    q = amplitude * sinOf(carrierPhase);
+                }
+                carrierPhase += carrierStep;
+                break;
+            }
+            if (noise > 0.0f) {
+                i += noise * gaussian();
+                q += noise * gaussian();
+            }
+            xi[n] = toShort(i);
+            xq[n] = toShort(q);
+        }
+    }
+
+    /**
+     * @brief Advance the waveform over samples that are never delivered
+     */
+    void skip(uint64_t count, double sampleRate) {
+        carrierPhase += static_cast<uint32_t>(phaseStep(config.frequencyOffsetHz, sampleRate) * count);
+        modulatorPhase += static_cast<uint32_t>(phaseStep(config.fmRateHz, sampleRate) * count);
+        sampleCount += count;
+    }
+
+private:
+    static constexpr size_t TABLE_BITS = 12;
+    static constexpr size_t TABLE_SIZE = size_t(1) << TABLE_BITS;
+    static constexpr double PHASE_SCALE = 4294967296.0;  // 2^32 phase steps per cycle
+
+    static uint32_t phaseStep(double hz, double sampleRate) {
+        double cycles = std::max(-0.5, std::min(0.5, hz / sampleRate));
+        return static_cast<uint32_t>(static_cast<int64_t>(std::llround(cycles * PHASE_SCALE)));
+    }
+
+    float cosOf(uint32_t phase) const { return cosine[phase >> (32 - TABLE_BITS)]; }
+    float sinOf(uint32_t phase) const { return cosOf(phase - 0x40000000u); }
+
+    // Standard normal approximated by the sum of four uniform 16-bit draws
+    float gaussian() {
+        rng ^= rng >> 12;
+        rng ^= rng << 25;
+        rng ^= rng >> 27;
+        uint64_t bits = rng * 0x2545F4914F6CDD1DULL;
+        uint32_t sum = static_cast<uint32_t>(bits & 0xffff) + static_cast<uint32_t>((bits >> 16) & 0xffff) +
+                       static_cast<uint32_t>((bits >> 32) & 0xffff) + static_cast<uint32_t>(bits >> 48);
+        return (static_cast<float>(sum) - 131070.0f) * (1.0f / 37837.2f);
+    }
+
+    static short toShort(float value) {
+        float scaled = std::max(-FULL_SCALE, std::min(FULL_SCALE, value * FULL_SCALE));
+        return static_cast<short>(std::lrint(scaled));
+    }
+
+    SimulatorConfig config;
+    std::vector<float> cosine;
+    uint32_t carrierPhase;
+    uint32_t modulatorPhase;
+    uint64_t sampleCount;
+    uint64_t rng;
+};
+
+struct SimDevice {
+    sdrplay_api_DevParamsT devParams;
+    sdrplay_api_RxChannelParamsT rxChannelA;
+    sdrplay_api_DeviceParamsT deviceParams;
+    bool selected{false};
+
+    sdrplay_api_CallbackFnsT callbacks;
+    void* context{nullptr};
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<double> sampleRate{0.0};
+
+    std::atomic<unsigned int> pending{0};
+    std::atomic<unsigned int> pendingDrops{0};
+    std::atomic<int> gainRdB{0};
+    std::atomic<int> lnaState{0};
+
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> droppedPackets{0};
+    std::atomic<uint64_t> droppedSamples{0};
+    std::atomic<uint64_t> latePackets{0};
+    std::atomic<uint64_t> maxCallbackNs{0};
+    std::atomic<uint64_t> totalCallbackNs{0};
+};
+
+struct SimState {
+    std::mutex mutex;         // Guards everything but the per-device atomics
+    std::mutex deviceApiLock;  // sdrplay_api_LockDeviceApi/UnlockDeviceApi
+    SimulatorConfig config;
+    bool opened{false};
+    SimDevice devices[SDRPLAY_MAX_DEVICES];
+
+    ~SimState() {
+        // Streams left running at exit must not outlive the threads' state
+        for (SimDevice& device : devices) {
+            if (device.thread.joinable()) {
+                device.running.store(false, std::memory_order_release);
+                device.thread.join();
+            }
+        }
+    }
+};
+
+SimState& state() {
+    static SimState simState;
+    return simState;
+}
+
+SimDevice* findDevice(HANDLE dev) {
+    for (SimDevice& device : state().devices) {
+        if (static_cast<HANDLE>(&device) == dev) {
+            return &device;
+        }
+    }
+    return nullptr;
+}
+
+SimDevice* deviceAt(unsigned int index) {
+    return index < SDRPLAY_MAX_DEVICES ? &state().devices[index] : nullptr;
+}
+
+unsigned int deviceCount(const SimulatorConfig& config) {
+    return std::max(1u, std::min<unsigned int>(config.deviceCount, SDRPLAY_MAX_DEVICES));
+}
+
+void formatSerial(const SimulatorConfig& config, unsigned int index, char* serial) {
+    std::snprintf(serial, SDRPLAY_MAX_SER_NO_LEN, "%s%04u", config.serialPrefix.c_str(), index);
+}
+
+void setDefaultParams(SimDevice& device) {
+    std::memset(&device.devParams, 0, sizeof(device.devParams));
+    std::memset(&device.rxChannelA, 0, sizeof(device.rxChannelA));
+
+    device.devParams.fsFreq.fsHz = DEFAULT_SAMPLE_RATE;
+    device.rxChannelA.tunerParams.rfFreq.rfHz = DEFAULT_RF_HZ;
+    device.rxChannelA.tunerParams.bwType = sdrplay_api_BW_0_200;
+    device.rxChannelA.tunerParams.ifType = sdrplay_api_IF_Zero;
+    device.rxChannelA.tunerParams.gain.gRdB = 50;
+    device.rxChannelA.tunerParams.gain.LNAstate = 0;
+    device.rxChannelA.ctrlParams.dcOffset.DCenable = 1;
+    device.rxChannelA.ctrlParams.dcOffset.IQenable = 1;
+    device.rxChannelA.ctrlParams.decimation.decimationFactor = 1;
+    device.rxChannelA.ctrlParams.agc.enable = sdrplay_api_AGC_DISABLE;
+
+    device.deviceParams.devParams = &device.devParams;
+    device.deviceParams.rxChannelA = &device.rxChannelA;
+    device.deviceParams.rxChannelB = nullptr;
+}
+
+// Output rate after decimation, or 0 if the parameters are out of range
+double effectiveRate(const SimDevice& device) {
+    double fs = device.devParams.fsFreq.fsHz;
+    if (!(fs > 0.0) || fs > MAX_SAMPLE_RATE) {
+        return 0.0;
+    }
+    const sdrplay_api_DecimationT& decimation = device.rxChannelA.ctrlParams.decimation;
+    if (decimation.enable && decimation.decimationFactor > 1) {
+        fs /= decimation.decimationFactor;
+    }
+    return fs;
+}
+
+void deliverEvents(SimDevice& device, unsigned int pending) {
+    sdrplay_api_EventCallback_t eventCallback = device.callbacks.EventCbFn;
+    if (!eventCallback) {
+        return;
+    }
+    sdrplay_api_EventParamsT params;
+    if (pending & PENDING_GAIN_EVENT) {
+        std::memset(&params, 0, sizeof(params));
+        int gRdB = device.gainRdB.load(std::memory_order_relaxed);
+        int lnaGRdB = static_cast<int>(device.lnaState.load(std::memory_order_relaxed) * LNA_STEP_DB);
+        params.gainParams.gRdB = static_cast<unsigned int>(gRdB);
+        params.gainParams.lnaGRdB = static_cast<unsigned int>(lnaGRdB);
+        params.gainParams.currGain = -static_cast<double>(gRdB + lnaGRdB);
+        eventCallback(sdrplay_api_GainChange, sdrplay_api_Tuner_A, &params, device.context);
+    }
+    if (pending & PENDING_OVERLOAD_DETECTED) {
+        std::memset(&params, 0, sizeof(params));
+        params.powerOverloadParams.powerOverloadChangeType = sdrplay_api_Overload_Detected;
+        eventCallback(sdrplay_api_PowerOverloadChange, sdrplay_api_Tuner_A, &params, device.context);
+    }
+    if (pending & PENDING_OVERLOAD_CORRECTED) {
+        std::memset(&params, 0, sizeof(params));
+        params.powerOverloadParams.powerOverloadChangeType = sdrplay_api_Overload_Corrected;
+        eventCallback(sdrplay_api_PowerOverloadChange, sdrplay_api_Tuner_A, &params, device.context);
+    }
+}
+
+void streamLoop(SimDevice* device, SimulatorConfig config) {
+    using Clock = std::chrono::steady_clock;
+
+    const unsigned int packetSamples = std::max(config.packetSamples, 1u);
+    std::vector<short> xi(packetSamples), xq(packetSamples);
+    SignalGenerator generator(config);
+    unsigned int sampleNum = 0;
+    bool first = true;
+    Clock::time_point deadline = Clock::now();
+
+    while (device->running.load(std::memory_order_acquire)) {
+        const double rate = device->sampleRate.load(std::memory_order_relaxed);
+        const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(packetSamples / rate));
+
+        unsigned int pending = device->pending.exchange(0, std::memory_order_acq_rel);
+        deliverEvents(*device, pending);
+
+        unsigned int drops = device->pendingDrops.exchange(0, std::memory_order_relaxed);
+        if (drops > 0) {
+            uint64_t lost = static_cast<uint64_t>(drops) * packetSamples;
+            sampleNum += static_cast<unsigned int>(lost);
+            generator.skip(lost, rate);
+            deadline += period * drops;
+            device->droppedPackets.fetch_add(drops, std::memory_order_relaxed);
+            device->droppedSamples.fetch_add(lost, std::memory_order_relaxed);
+        }
+
+        generator.generate(xi.data(), xq.data(), packetSamples, rate);
+
+        sdrplay_api_StreamCbParamsT params;
+        std::memset(&params, 0, sizeof(params));
+        params.firstSampleNum = sampleNum;
+        params.grChanged = (pending & PENDING_GR) ? 1 : 0;
+        params.rfChanged = (pending & PENDING_RF) ? 1 : 0;
+        params.fsChanged = (pending & PENDING_FS) ? 1 : 0;
+        params.numSamples = packetSamples;
+        unsigned int reset = (first || (pending & PENDING_RESET)) ? 1 : 0;
+        first = false;
+
+        Clock::time_point start = Clock::now();
+        device->callbacks.StreamACbFn(xi.data(), xq.data(), &params, packetSamples, reset, device->context);
+        uint64_t elapsedNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+        sampleNum += packetSamples;
+        device->packets.fetch_add(1, std::memory_order_relaxed);
+        device->samples.fetch_add(packetSamples, std::memory_order_relaxed);
+        device->totalCallbackNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+        if (elapsedNs > device->maxCallbackNs.load(std::memory_order_relaxed)) {
+            device->maxCallbackNs.store(elapsedNs, std::memory_order_relaxed);
+        }
+
+        if (!config.realTime) {
+            continue;
+        }
+        deadline += period;
+        Clock::time_point now = Clock::now();
+        if (now < deadline) {
+            std::this_thread::sleep_until(deadline);
+        } else if (now - deadline > period) {
+            device->latePackets.fetch_add(1, std::memory_order_relaxed);
+            // Like the hardware, don't burst to catch up after a long stall
+            if (now - deadline > std::chrono::milliseconds(100)) {
+                deadline = now;
+            }
+        }
+    }
+}
+
+// Caller holds state().mutex
+sdrplay_api_ErrT stopStream(SimDevice& device) {
+    if (!device.running.load(std::memory_order_relaxed)) {
+        return sdrplay_api_NotInitialised;
+    }
+    if (device.thread.get_id() == std::this_thread::get_id()) {
+        return sdrplay_api_Fail;  // Called from inside a callback
+    }
+    device.running.store(false, std::memory_order_release);
+    device.thread.join();
+    return sdrplay_api_Success;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Simulator controls
+//------------------------------------------------------------------------------
+
+void Simulator::configure(const SimulatorConfig& config) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().config = config;
+}
+
+SimulatorConfig Simulator::getConfig() {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    return state().config;
+}
+
+void Simulator::injectDrop(unsigned int packets, unsigned int device) {
+    if (SimDevice* sim = deviceAt(device)) {
+        sim->pendingDrops.fetch_add(packets, std::memory_order_relaxed);
+    }
+}
+
+void Simulator::injectReset(unsigned int device) {
+    if (SimDevice* sim = deviceAt(device)) {
+        sim->pending.fetch_or(PENDING_RESET, std::memory_order_release);
+    }
+}
+
+void Simulator::injectChange(bool grChanged, bool rfChanged, bool fsChanged, unsigned int device) {
+    if (SimDevice* sim = deviceAt(device)) {
+        unsigned int flags = (grChanged ? PENDING_GR : 0u) | (rfChanged ? PENDING_RF : 0u) |
+                             (fsChanged ? PENDING_FS : 0u);
+        sim->pending.fetch_or(flags, std::memory_order_release);
+    }
+}
+
+void Simulator::injectPowerOverload(bool detected, unsigned int device) {
+    if (SimDevice* sim = deviceAt(device)) {
+        sim->pending.fetch_or(detected ? PENDING_OVERLOAD_DETECTED : PENDING_OVERLOAD_CORRECTED,
+                              std::memory_order_release);
+    }
+}
+
+SimulatorStats Simulator::getStats(unsigned int device) {
+    SimulatorStats stats;
+    SimDevice* sim = deviceAt(device);
+    if (!sim) {
+        return stats;
+    }
+    stats.streaming = sim->running.load(std::memory_order_relaxed);
+    stats.sampleRate = sim->sampleRate.load(std::memory_order_relaxed);
+    stats.packets = sim->packets.load(std::memory_order_relaxed);
+    stats.samples = sim->samples.load(std::memory_order_relaxed);
+    stats.droppedPackets = sim->droppedPackets.load(std::memory_order_relaxed);
+    stats.droppedSamples = sim->droppedSamples.load(std::memory_order_relaxed);
+    stats.latePackets = sim->latePackets.load(std::memory_order_relaxed);
+    stats.maxCallbackNs = sim->maxCallbackNs.load(std::memory_order_relaxed);
+    stats.totalCallbackNs = sim->totalCallbackNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace sdrplay
+
+//------------------------------------------------------------------------------
+// sdrplay_api entry points
+//------------------------------------------------------------------------------
+
+using sdrplay::SimDevice;
+using sdrplay::state;
+
+sdrplay_api_ErrT sdrplay_api_Open(void) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().opened = true;
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_Close(void) {
+    // Streams of devices still selected keep running, as with the service
+    std::lock_guard<std::mutex> lock(state().mutex);
+    state().opened = false;
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_ApiVersion(float* apiVer) {
+    if (!apiVer) {
+        return sdrplay_api_InvalidParam;
+    }
+    *apiVer = SDRPLAY_API_VERSION;
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_LockDeviceApi(void) {
+    state().deviceApiLock.lock();
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_UnlockDeviceApi(void) {
+    state().deviceApiLock.unlock();
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_DisableHeartbeat(void) {
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_DebugEnable(HANDLE dev, sdrplay_api_DbgLvl_t enable) {
+    (void)enable;
+    return sdrplay::findDevice(dev) ? sdrplay_api_Success : sdrplay_api_InvalidParam;
+}
+
+sdrplay_api_ErrT sdrplay_api_GetDevices(sdrplay_api_DeviceT* devices, unsigned int* numDevs,
+                                        unsigned int maxDevs) {
+    if (!devices || !numDevs) {
+        return sdrplay_api_InvalidParam;
+    }
+    std::lock_guard<std::mutex> lock(state().mutex);
+    *numDevs = 0;
+    if (!state().opened) {
+        return sdrplay_api_ServiceNotResponding;
+    }
+
+    // Selected devices belong to their owner and are not listed
+    const sdrplay::SimulatorConfig& config = state().config;
+    for (unsigned int i = 0; i < sdrplay::deviceCount(config) && *numDevs < maxDevs; ++i) {
+        if (state().devices[i].selected) {
+            continue;
+        }
+        sdrplay_api_DeviceT& entry = devices[(*numDevs)++];
+        std::memset(&entry, 0, sizeof(entry));
+        sdrplay::formatSerial(config, i, entry.SerNo);
+        entry.hwVer = config.hwVer;
+        entry.tuner = sdrplay_api_Tuner_A;
+        entry.rspDuoMode = sdrplay_api_RspDuoMode_Unknown;
+        entry.valid = 1;
+        entry.dev = &state().devices[i];
+    }
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_SelectDevice(sdrplay_api_DeviceT* device) {
+    if (!device) {
+        return sdrplay_api_InvalidParam;
+    }
+    std::lock_guard<std::mutex> lock(state().mutex);
+    if (!state().opened) {
+        return sdrplay_api_ServiceNotResponding;
+    }
+
+    // Match the handle, or the serial number if the handle was not kept
+    SimDevice* sim = sdrplay::findDevice(device->dev);
+    for (unsigned int i = 0; !sim && i < sdrplay::deviceCount(state().config); ++i) {
+        char serial[SDRPLAY_MAX_SER_NO_LEN];
+        sdrplay::formatSerial(state().config, i, serial);
+        if (std::strncmp(serial, device->SerNo, SDRPLAY_MAX_SER_NO_LEN) == 0) {
+            sim = &state().devices[i];
+        }
+    }
+    if (!sim) {
+        return sdrplay_api_InvalidParam;
+    }
+    if (sim->selected) {
+        return sdrplay_api_Fail;
+    }
+
+    sdrplay::setDefaultParams(*sim);
+    sim->selected = true;
+    device->dev = sim;
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_ReleaseDevice(sdrplay_api_DeviceT* device) {
+    if (!device) {
+        return sdrplay_api_InvalidParam;
+    }
+    std::lock_guard<std::mutex> lock(state().mutex);
+    SimDevice* sim = sdrplay::findDevice(device->dev);
+    if (!sim || !sim->selected) {
+        return sdrplay_api_InvalidParam;
+    }
+    sdrplay::stopStream(*sim);
+    sim->selected = false;
+    return sdrplay_api_Success;
+}
+
+const char* sdrplay_api_GetErrorString(sdrplay_api_ErrT err) {
+    switch (err) {
+    case sdrplay_api_Success: return "sdrplay_api_Success";
+    case sdrplay_api_Fail: return "sdrplay_api_Fail";
+    case sdrplay_api_InvalidParam: return "sdrplay_api_InvalidParam";
+    case sdrplay_api_OutOfRange: return "sdrplay_api_OutOfRange";
+    case sdrplay_api_GainUpdateError: return "sdrplay_api_GainUpdateError";
+    case sdrplay_api_RfUpdateError: return "sdrplay_api_RfUpdateError";
+    case sdrplay_api_FsUpdateError: return "sdrplay_api_FsUpdateError";
+    case sdrplay_api_HwError: return "sdrplay_api_HwError";
+    case sdrplay_api_AliasingError: return "sdrplay_api_AliasingError";
+    case sdrplay_api_AlreadyInitialised: return "sdrplay_api_AlreadyInitialised";
+    case sdrplay_api_NotInitialised: return "sdrplay_api_NotInitialised";
+    case sdrplay_api_NotEnabled: return "sdrplay_api_NotEnabled";
+    case sdrplay_api_HwVerError: return "sdrplay_api_HwVerError";
+    case sdrplay_api_OutOfMemError: return "sdrplay_api_OutOfMemError";
+    case sdrplay_api_ServiceNotResponding: return "sdrplay_api_ServiceNotResponding";
+    case sdrplay_api_StartPending: return "sdrplay_api_StartPending";
+    case sdrplay_api_StopPending: return "sdrplay_api_StopPending";
+    case sdrplay_api_InvalidMode: return "sdrplay_api_InvalidMode";
+    default: return "sdrplay_api_Unknown";
+    }
+}
+
+sdrplay_api_ErrorInfoT* sdrplay_api_GetLastError(sdrplay_api_DeviceT* device) {
+    (void)device;
+    static sdrplay_api_ErrorInfoT none;
+    return &none;
+}
+
+sdrplay_api_ErrT sdrplay_api_GetDeviceParams(HANDLE dev, sdrplay_api_DeviceParamsT** deviceParams) {
+    if (!deviceParams) {
+        return sdrplay_api_InvalidParam;
+    }
+    std::lock_guard<std::mutex> lock(state().mutex);
+    SimDevice* sim = sdrplay::findDevice(dev);
+    if (!sim || !sim->selected) {
+        return sdrplay_api_InvalidParam;
+    }
+    *deviceParams = &sim->deviceParams;
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_Init(HANDLE dev, sdrplay_api_CallbackFnsT* callbackFns, void* cbContext) {
+    if (!callbackFns || !callbackFns->StreamACbFn) {
+        return sdrplay_api_InvalidParam;
+    }
+    std::lock_guard<std::mutex> lock(state().mutex);
+    SimDevice* sim = sdrplay::findDevice(dev);
+    if (!sim || !sim->selected) {
+        return sdrplay_api_InvalidParam;
+    }
+    if (sim->running.load(std::memory_order_relaxed)) {
+        return sdrplay_api_AlreadyInitialised;
+    }
+    double rate = sdrplay::effectiveRate(*sim);
+    if (rate <= 0.0) {
+        return sdrplay_api_OutOfRange;
+    }
+
+    sdrplay::SimulatorConfig config = state().config;
+    sim->devParams.samplesPerPkt = std::max(config.packetSamples, 1u);
+    sim->callbacks = *callbackFns;
+    sim->context = cbContext;
+    sim->sampleRate.store(rate, std::memory_order_relaxed);
+    sim->pending.store(0, std::memory_order_relaxed);
+    sim->pendingDrops.store(0, std::memory_order_relaxed);
+    sim->packets.store(0, std::memory_order_relaxed);
+    sim->samples.store(0, std::memory_order_relaxed);
+    sim->droppedPackets.store(0, std::memory_order_relaxed);
+    sim->droppedSamples.store(0, std::memory_order_relaxed);
+    sim->latePackets.store(0, std::memory_order_relaxed);
+    sim->maxCallbackNs.store(0, std::memory_order_relaxed);
+    sim->totalCallbackNs.store(0, std::memory_order_relaxed);
+
+    sim->running.store(true, std::memory_order_release);
+    sim->thread = std::thread(sdrplay::streamLoop, sim, config);
+    return sdrplay_api_Success;
+}
+
+sdrplay_api_ErrT sdrplay_api_Uninit(HANDLE dev) {
+    std::lock_guard<std::mutex> lock(state().mutex);
+    SimDevice* sim = sdrplay::findDevice(dev);
+    if (!sim || !sim->selected) {
+        return sdrplay_api_InvalidParam;
+    }
+    return sdrplay::stopStream(*sim);
+}
+
+sdrplay_api_ErrT sdrplay_api_Update(HANDLE dev, sdrplay_api_TunerSelectT tuner,
+                                    sdrplay_api_ReasonForUpdateT reasonForUpdate,
+                                    sdrplay_api_ReasonForUpdateExtension1T reasonForUpdateExt1) {
+    (void)tuner;
+    (void)reasonForUpdateExt1;
+    std::lock_guard<std::mutex> lock(state().mutex);
+    SimDevice* sim = sdrplay::findDevice(dev);
+    if (!sim || !sim->selected) {
+        return sdrplay_api_InvalidParam;
+    }
+
+    unsigned int reason = static_cast<unsigned int>(reasonForUpdate);
+    if (reason & (sdrplay_api_Update_Dev_Fs | sdrplay_api_Update_Ctrl_Decimation)) {
+        double rate = sdrplay::effectiveRate(*sim);
+        if (rate <= 0.0) {
+            return sdrplay_api_OutOfRange;
+        }
+        sim->sampleRate.store(rate, std::memory_order_relaxed);
+    }
+
+    // Before sdrplay_api_Init there is no stream to flag; Init picks the values up
+    if (!sim->running.load(std::memory_order_relaxed)) {
+        return sdrplay_api_Success;
+    }
+    unsigned int flags = 0;
+    if (reason & sdrplay_api_Update_Dev_Fs) {
+        flags |= sdrplay::PENDING_FS;
+    }
+    if (reason & sdrplay_api_Update_Tuner_Frf) {
+        flags |= sdrplay::PENDING_RF;
+    }
+    if (reason & sdrplay_api_Update_Tuner_Gr) {
+        sim->gainRdB.store(sim->rxChannelA.tunerParams.gain.gRdB, std::memory_order_relaxed);
+        sim->lnaState.store(sim->rxChannelA.tunerParams.gain.LNAstate, std::memory_order_relaxed);
+        flags |= sdrplay::PENDING_GR | sdrplay::PENDING_GAIN_EVENT;
+    }
+    sim->pending.fetch_or(flags, std::memory_order_release);
+    return sdrplay_api_Success;
+}
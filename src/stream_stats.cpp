@@ -0,0 +1,144 @@
+#include "stream_stats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sdrplay {
+
+namespace {
+    unsigned int highestBit(uint64_t value) {
+        unsigned int bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+    }
+
+    // Single-writer update: no read-modify-write needed
+    template <typename T, typename U>
+    void add(std::atomic<T>& counter, U value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+size_t StreamStats::packetSizeBucket(size_t samples) {
+    return std::min<size_t>(highestBit(samples), PACKET_SIZE_BUCKETS - 1);
+}
+
+size_t StreamStats::packetSizeBucketMin(size_t bucket) {
+    return bucket == 0 ? 0 : size_t(1) << bucket;
+}
+
+StreamStatsCollector::StreamStatsCollector() {
+    reset();
+}
+
+void StreamStatsCollector::reset() {
+    packets.store(0, std::memory_order_relaxed);
+    samples.store(0, std::memory_order_relaxed);
+    lastArrivalNs.store(0, std::memory_order_relaxed);
+    intervals.store(0, std::memory_order_relaxed);
+    intervalSumNs.store(0, std::memory_order_relaxed);
+    intervalSquareSum.store(0.0, std::memory_order_relaxed);
+    minInterval.store(UINT64_MAX, std::memory_order_relaxed);
+    maxInterval.store(0, std::memory_order_relaxed);
+    minPacket.store(UINT32_MAX, std::memory_order_relaxed);
+    maxPacket.store(0, std::memory_order_relaxed);
+    for (auto& bucket : packetSizes) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    highWatermark.store(0, std::memory_order_relaxed);
+    windowStartNs.store(0, std::memory_order_relaxed);
+    windowSamples.store(0, std::memory_order_relaxed);
+    windowRate.store(0.0, std::memory_order_relaxed);
+}
+
+void StreamStatsCollector::recordPacket(uint64_t arrivalNs, size_t count, bool rateChanged) {
+    uint64_t last = lastArrivalNs.load(std::memory_order_relaxed);
+    if (last != 0 && arrivalNs >= last) {
+        uint64_t interval = arrivalNs - last;
+        add(intervals, 1);
+        add(intervalSumNs, interval);
+        add(intervalSquareSum, static_cast<double>(interval) * static_cast<double>(interval));
+        if (interval < minInterval.load(std::memory_order_relaxed)) {
+            minInterval.store(interval, std::memory_order_relaxed);
+        }
+        if (interval > maxInterval.load(std::memory_order_relaxed)) {
+            maxInterval.store(interval, std::memory_order_relaxed);
+        }
+    }
+    lastArrivalNs.store(arrivalNs, std::memory_order_relaxed);
+
+    add(packets, 1);
+    add(samples, count);
+    uint32_t size = static_cast<uint32_t>(std::min<size_t>(count, UINT32_MAX));
+    if (size < minPacket.load(std::memory_order_relaxed)) {
+        minPacket.store(size, std::memory_order_relaxed);
+    }
+    if (size > maxPacket.load(std::memory_order_relaxed)) {
+        maxPacket.store(size, std::memory_order_relaxed);
+    }
+    add(packetSizes[StreamStats::packetSizeBucket(count)], 1);
+
+    // A packet's samples were produced before it arrived, so the packet
+    // that opens a window is not counted in it
+    uint64_t start = windowStartNs.load(std::memory_order_relaxed);
+    if (start == 0 || rateChanged) {
+        windowStartNs.store(arrivalNs, std::memory_order_relaxed);
+        windowSamples.store(0, std::memory_order_relaxed);
+        if (rateChanged) {
+            windowRate.store(0.0, std::memory_order_relaxed);
+        }
+        return;
+    }
+    uint64_t windowed = windowSamples.load(std::memory_order_relaxed) + count;
+    if (arrivalNs - start >= RATE_WINDOW_NS) {
+        windowRate.store(windowed * 1e9 / static_cast<double>(arrivalNs - start), std::memory_order_relaxed);
+        windowStartNs.store(arrivalNs, std::memory_order_relaxed);
+        windowed = 0;
+    }
+    windowSamples.store(windowed, std::memory_order_relaxed);
+}
+
+void StreamStatsCollector::recordFill(size_t bufferedSamples) {
+    if (bufferedSamples > highWatermark.load(std::memory_order_relaxed)) {
+        highWatermark.store(bufferedSamples, std::memory_order_relaxed);
+    }
+}
+
+void StreamStatsCollector::snapshot(StreamStats& stats, uint64_t nowNs) const {
+    stats.callbackCount = packets.load(std::memory_order_relaxed);
+    stats.samplesReceived = samples.load(std::memory_order_relaxed);
+
+    uint64_t n = intervals.load(std::memory_order_relaxed);
+    if (n > 0) {
+        double mean = static_cast<double>(intervalSumNs.load(std::memory_order_relaxed)) / n;
+        double variance = intervalSquareSum.load(std::memory_order_relaxed) / n - mean * mean;
+        stats.meanIntervalNs = static_cast<uint64_t>(mean);
+        stats.intervalJitterNs = static_cast<uint64_t>(std::sqrt(std::max(variance, 0.0)));
+        stats.minIntervalNs = minInterval.load(std::memory_order_relaxed);
+        stats.maxIntervalNs = maxInterval.load(std::memory_order_relaxed);
+    }
+
+    if (stats.callbackCount > 0) {
+        stats.minPacketSamples = minPacket.load(std::memory_order_relaxed);
+        stats.maxPacketSamples = maxPacket.load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < StreamStats::PACKET_SIZE_BUCKETS; ++i) {
+        stats.packetSizeCounts[i] = packetSizes[i].load(std::memory_order_relaxed);
+    }
+    stats.bufferHighWatermark = highWatermark.load(std::memory_order_relaxed);
+
+    // Until the first window completes, estimate from the partial one
+    uint64_t last = lastArrivalNs.load(std::memory_order_relaxed);
+    stats.sampleRate = windowRate.load(std::memory_order_relaxed);
+    if (stats.sampleRate == 0.0) {
+        uint64_t start = windowStartNs.load(std::memory_order_relaxed);
+        uint64_t windowed = windowSamples.load(std::memory_order_relaxed);
+        if (start != 0 && last > start && windowed > 0) {
+            stats.sampleRate = windowed * 1e9 / static_cast<double>(last - start);
+        }
+    }
+    stats.nsSinceLastCallback = last != 0 && nowNs >= last ? nowNs - last : UINT64_MAX;
+}
+
+} // namespace sdrplay
@@ -0,0 +1,136 @@
+#include "stream_tags.h"
+#include "ring_index.h"
+
+namespace sdrplay {
+
+namespace {
+    constexpr uint32_t FLAG_GR_CHANGED = 1u << 0;
+    constexpr uint32_t FLAG_RF_CHANGED = 1u << 1;
+    constexpr uint32_t FLAG_FS_CHANGED = 1u << 2;
+    constexpr uint32_t FLAG_RESET      = 1u << 3;
+    constexpr uint32_t FLAG_GAP        = 1u << 4;
+    constexpr uint32_t FLAG_ZERO_FILL  = 1u << 5;
+}
+
+StreamTagBuffer::StreamTagBuffer(size_t capacity)
+    : slots(new Slot[RingIndex::roundUpToPowerOfTwo(capacity)]),
+      mask(RingIndex::roundUpToPowerOfTwo(capacity) - 1), written(0) {
+    clear();
+}
+
+void StreamTagBuffer::append(const StreamTag& tag) {
+    if (tag.numSamples == 0 && !tag.hasChange()) {
+        return;
+    }
+
+    uint32_t flags = (tag.grChanged ? FLAG_GR_CHANGED : 0) |
+                     (tag.rfChanged ? FLAG_RF_CHANGED : 0) |
+                     (tag.fsChanged ? FLAG_FS_CHANGED : 0) |
+                     (tag.reset ? FLAG_RESET : 0) |
+                     (tag.gap ? FLAG_GAP : 0) |
+                     (tag.zeroFill ? FLAG_ZERO_FILL : 0);
+
+    uint64_t n = written.load(std::memory_order_relaxed);
+    Slot& slot = slots[n & mask];
+
+    slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sampleIndex.store(tag.sampleIndex, std::memory_order_relaxed);
+    slot.timestampNs.store(tag.timestampNs, std::memory_order_relaxed);
+    slot.numSamples.store(tag.numSamples, std::memory_order_relaxed);
+    slot.firstSampleNum.store(tag.firstSampleNum, std::memory_order_relaxed);
+    slot.flags.store(flags, std::memory_order_relaxed);
+    slot.sequence.store(2 * n + 2, std::memory_order_release);
+
+    written.store(n + 1, std::memory_order_release);
+}
+
+bool StreamTagBuffer::load(uint64_t n, StreamTag& tag) const {
+    const Slot& slot = slots[n & mask];
+
+    uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != 2 * n + 2) {
+        return false;  // Overwritten by a newer tag, or still being written
+    }
+
+    tag.sampleIndex = slot.sampleIndex.load(std::memory_order_relaxed);
+    tag.timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+    tag.numSamples = slot.numSamples.load(std::memory_order_relaxed);
+    tag.firstSampleNum = slot.firstSampleNum.load(std::memory_order_relaxed);
+    uint32_t flags = slot.flags.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != before) {
+        return false;
+    }
+
+    tag.grChanged = (flags & FLAG_GR_CHANGED) != 0;
+    tag.rfChanged = (flags & FLAG_RF_CHANGED) != 0;
+    tag.fsChanged = (flags & FLAG_FS_CHANGED) != 0;
+    tag.reset = (flags & FLAG_RESET) != 0;
+    tag.gap = (flags & FLAG_GAP) != 0;
+    tag.zeroFill = (flags & FLAG_ZERO_FILL) != 0;
+    return true;
+}
+
+std::vector<StreamTag> StreamTagBuffer::query(uint64_t startIndex, size_t count) const {
+    std::vector<StreamTag> result;
+    uint64_t endIndex = startIndex + count;
+
+    uint64_t hi = written.load(std::memory_order_acquire);
+    uint64_t capacity = mask + 1;
+    uint64_t lo = hi > capacity ? hi - capacity : 0;
+
+    // A tag is at or past the range start if it ends after it; zero-length
+    // tags (flags only) count if they sit at or after the start
+    auto reachesStart = [startIndex](const StreamTag& tag) {
+        return tag.numSamples == 0 ? tag.sampleIndex >= startIndex
+                                   : tag.sampleIndex + tag.numSamples > startIndex;
+    };
+
+    // Binary search for the first tag reaching the range; slots overwritten
+    // during the search are older than anything we want
+    StreamTag tag;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (!load(mid, tag) || !reachesStart(tag)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    uint64_t end = written.load(std::memory_order_acquire);
+    for (uint64_t n = lo; n < end; ++n) {
+        if (!load(n, tag)) {
+            continue;
+        }
+        if (tag.sampleIndex >= endIndex) {
+            break;
+        }
+        if (reachesStart(tag)) {
+            result.push_back(tag);
+        }
+    }
+    return result;
+}
+
+void StreamTagBuffer::clear() {
+    for (size_t i = 0; i <= mask; ++i) {
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    written.store(0, std::memory_order_release);
+}
+
+void StreamTagBuffer::reconfigure(size_t capacity) {
+    size_t newCapacity = RingIndex::roundUpToPowerOfTwo(capacity);
+    slots.reset(new Slot[newCapacity]);
+    mask = newCapacity - 1;
+    clear();
+}
+
+size_t StreamTagBuffer::capacity() const {
+    return mask + 1;
+}
+
+} // namespace sdrplay
@@ -0,0 +1,104 @@
+#include "thread_policy.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <pthread.h>
+    #include <sched.h>
+    #define SDRPLAY_HAVE_PTHREAD 1
+#endif
+
+namespace sdrplay {
+
+namespace {
+
+#if defined(SDRPLAY_HAVE_PTHREAD)
+
+void applyAffinity(pthread_t handle, const std::vector<int>& cpus, ThreadPolicyStatus& status) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            status.failures.push_back("affinity: CPU " + std::to_string(cpu) + " out of range");
+            return;
+        }
+        CPU_SET(cpu, &set);
+    }
+    int err = pthread_setaffinity_np(handle, sizeof(set), &set);
+    if (err != 0) {
+        status.failures.push_back(std::string("affinity: ") + std::strerror(err));
+        return;
+    }
+    status.affinityApplied = true;
+#else
+    (void)handle;
+    (void)cpus;
+    status.failures.push_back("affinity: not supported on this platform");
+#endif
+}
+
+void applyPriority(pthread_t handle, int priority, ThreadPolicyStatus& status) {
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = std::min(std::max(priority, sched_get_priority_min(SCHED_FIFO)),
+                                    sched_get_priority_max(SCHED_FIFO));
+    int err = pthread_setschedparam(handle, SCHED_FIFO, &param);
+    if (err != 0) {
+        status.failures.push_back(std::string("realtime priority: ") + std::strerror(err));
+        return;
+    }
+    status.priorityApplied = true;
+}
+
+ThreadPolicyStatus applyTo(pthread_t handle, const ThreadPolicy& policy) {
+    ThreadPolicyStatus status;
+    if (!policy.cpus.empty()) {
+        applyAffinity(handle, policy.cpus, status);
+    }
+    if (policy.realtimePriority > 0) {
+        applyPriority(handle, policy.realtimePriority, status);
+    }
+    return status;
+}
+
+#else
+
+ThreadPolicyStatus unsupported(const ThreadPolicy& policy) {
+    ThreadPolicyStatus status;
+    if (!policy.cpus.empty()) {
+        status.failures.push_back("affinity: not supported on this platform");
+    }
+    if (policy.realtimePriority > 0) {
+        status.failures.push_back("realtime priority: not supported on this platform");
+    }
+    return status;
+}
+
+#endif
+
+} // namespace
+
+ThreadPolicyStatus applyThreadPolicy(std::thread& thread, const ThreadPolicy& policy) {
+#if defined(SDRPLAY_HAVE_PTHREAD)
+    if (!thread.joinable()) {
+        ThreadPolicyStatus status;
+        status.failures.push_back("thread is not running");
+        return status;
+    }
+    return applyTo(thread.native_handle(), policy);
+#else
+    (void)thread;
+    return unsupported(policy);
+#endif
+}
+
+ThreadPolicyStatus applyThreadPolicy(const ThreadPolicy& policy) {
+#if defined(SDRPLAY_HAVE_PTHREAD)
+    return applyTo(pthread_self(), policy);
+#else
+    return unsupported(policy);
+#endif
+}
+
+} // namespace sdrplay
@@ -0,0 +1,274 @@
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace sdrplay {
+
+std::atomic<bool> Trace::enabledFlag(false);
+
+uint64_t Trace::nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#if defined(SDRPLAY_TRACING) && SDRPLAY_TRACING
+
+namespace {
+    constexpr size_t EVENT_MASK = Trace::EVENTS_PER_THREAD - 1;
+    static_assert((Trace::EVENTS_PER_THREAD & EVENT_MASK) == 0, "EVENTS_PER_THREAD must be a power of two");
+
+    // Buffers of exited threads kept for the next trace
+    constexpr size_t MAX_RETIRED_THREADS = 16;
+
+    struct TraceEvent {
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> startNs;
+        std::atomic<uint64_t> durationNs;
+    };
+
+    // Written only by its thread. Event n lives in slot n & EVENT_MASK;
+    // started is bumped before a slot is overwritten and written after,
+    // so readers can tell which slots they may have caught mid-update.
+    struct ThreadBuffer {
+        explicit ThreadBuffer(uint32_t id)
+            : id(id), events(new TraceEvent[Trace::EVENTS_PER_THREAD]), started(0), written(0),
+              floor(0), retired(false) {}
+
+        uint32_t id;
+        std::string name;               // Guarded by the registry mutex
+        std::unique_ptr<TraceEvent[]> events;
+        std::atomic<uint64_t> started;
+        std::atomic<uint64_t> written;
+        std::atomic<uint64_t> floor;    // Events below this index were cleared
+        std::atomic<bool> retired;      // The thread has exited
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        uint32_t nextId = 1;
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    std::shared_ptr<ThreadBuffer> registerThread() {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+
+        // Forget the oldest exited threads once too many have piled up
+        size_t retired = std::count_if(reg.buffers.begin(), reg.buffers.end(),
+            [](const std::shared_ptr<ThreadBuffer>& buffer) { return buffer->retired.load(); });
+        for (auto it = reg.buffers.begin(); it != reg.buffers.end() && retired > MAX_RETIRED_THREADS;) {
+            if ((*it)->retired.load()) {
+                it = reg.buffers.erase(it);
+                --retired;
+            } else {
+                ++it;
+            }
+        }
+
+        auto buffer = std::make_shared<ThreadBuffer>(reg.nextId++);
+        buffer->name = "thread " + std::to_string(buffer->id);
+        reg.buffers.push_back(buffer);
+        return buffer;
+    }
+
+    struct ThreadHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+        bool named = false;
+
+        ~ThreadHandle() {
+            if (buffer) {
+                buffer->retired.store(true);
+            }
+        }
+    };
+
+    thread_local ThreadHandle threadHandle;
+
+    ThreadBuffer& threadBuffer() {
+        if (!threadHandle.buffer) {
+            threadHandle.buffer = registerThread();
+        }
+        return *threadHandle.buffer;
+    }
+
+    struct CopiedEvent {
+        const char* name;
+        uint64_t startNs;
+        uint64_t durationNs;
+    };
+
+    // Copy the events of one thread that were not overwritten meanwhile
+    std::vector<CopiedEvent> copyEvents(const ThreadBuffer& buffer) {
+        uint64_t end = buffer.written.load(std::memory_order_acquire);
+        uint64_t begin = end > Trace::EVENTS_PER_THREAD ? end - Trace::EVENTS_PER_THREAD : 0;
+        begin = std::max(begin, buffer.floor.load(std::memory_order_relaxed));
+
+        std::vector<CopiedEvent> copied;
+        copied.reserve(end - std::min(begin, end));
+        for (uint64_t n = begin; n < end; ++n) {
+            const TraceEvent& event = buffer.events[n & EVENT_MASK];
+            copied.push_back({event.name.load(std::memory_order_relaxed),
+                              event.startNs.load(std::memory_order_relaxed),
+                              event.durationNs.load(std::memory_order_relaxed)});
+        }
+
+        // Drop the slots the writer started overwriting during the copy
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t started = buffer.started.load(std::memory_order_relaxed);
+        uint64_t firstValid = started > Trace::EVENTS_PER_THREAD ? started - Trace::EVENTS_PER_THREAD : 0;
+        if (firstValid > begin) {
+            copied.erase(copied.begin(), copied.begin() + std::min<uint64_t>(firstValid - begin, copied.size()));
+        }
+        return copied;
+    }
+
+    std::string escapeJson(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", c);
+                escaped += code;
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    void writeMicros(std::ostream& out, uint64_t ns) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%llu.%03u", static_cast<unsigned long long>(ns / 1000),
+                      static_cast<unsigned int>(ns % 1000));
+        out << text;
+    }
+}
+
+bool Trace::isCompiledIn() {
+    return true;
+}
+
+void Trace::enable(bool enabled) {
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+void Trace::clear() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.buffers.erase(std::remove_if(reg.buffers.begin(), reg.buffers.end(),
+        [](const std::shared_ptr<ThreadBuffer>& buffer) { return buffer->retired.load(); }),
+        reg.buffers.end());
+    for (auto& buffer : reg.buffers) {
+        buffer->floor.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+void Trace::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = name;
+    threadHandle.named = true;
+}
+
+void Trace::nameThreadOnce(const char* name) {
+    if (!threadHandle.named) {
+        setThreadName(name);
+    }
+}
+
+void Trace::record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadBuffer& buffer = threadBuffer();
+    uint64_t n = buffer.written.load(std::memory_order_relaxed);
+    buffer.started.store(n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceEvent& event = buffer.events[n & EVENT_MASK];
+    event.name.store(name, std::memory_order_relaxed);
+    event.startNs.store(startNs, std::memory_order_relaxed);
+    event.durationNs.store(endNs > startNs ? endNs - startNs : 0, std::memory_order_relaxed);
+    buffer.written.store(n + 1, std::memory_order_release);
+}
+
+std::string Trace::toChromeJson() {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::vector<std::string> names;
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        buffers = reg.buffers;
+        for (const auto& buffer : buffers) {
+            names.push_back(buffer->name);
+        }
+    }
+
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffers[i]->id << ",\"args\":{\"name\":\"" << escapeJson(names[i]) << "\"}}";
+        first = false;
+
+        for (const CopiedEvent& event : copyEvents(*buffers[i])) {
+            out << ",\n{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"sdrplay\",\"ph\":\"X\",\"ts\":";
+            writeMicros(out, event.startNs);
+            out << ",\"dur\":";
+            writeMicros(out, event.durationNs);
+            out << ",\"pid\":1,\"tid\":" << buffers[i]->id << "}";
+        }
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+#else
+
+bool Trace::isCompiledIn() {
+    return false;
+}
+
+void Trace::enable(bool) {
+}
+
+void Trace::clear() {
+}
+
+void Trace::setThreadName(const std::string&) {
+}
+
+void Trace::nameThreadOnce(const char*) {
+}
+
+void Trace::record(const char*, uint64_t, uint64_t) {
+}
+
+std::string Trace::toChromeJson() {
+    return "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}\n";
+}
+
+#endif
+
+bool Trace::writeChromeJson(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << toChromeJson();
+    return static_cast<bool>(file);
+}
+
+} // namespace sdrplay
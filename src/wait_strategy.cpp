@@ -0,0 +1,80 @@
+#include "wait_strategy.h"
+
+#if defined(__linux__)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+namespace sdrplay {
+
+const char* waitStrategyName(WaitStrategy strategy) {
+    switch (strategy) {
+        case WaitStrategy::SpinThenBlock: return "spin-then-block";
+        case WaitStrategy::BusyPoll: return "busy-poll";
+        default: return "block";
+    }
+}
+
+WaitEvent::WaitEvent() : sequence(0), sleepers(0) {}
+
+#if defined(__linux__)
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex word must be a plain 32-bit integer");
+#endif
+
+uint32_t WaitEvent::prepare() {
+    sleepers.fetch_add(1, std::memory_order_relaxed);
+    // Pairs with the producer's fence before notify(), as in waitForSamples
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return sequence.load(std::memory_order_relaxed);
+}
+
+void WaitEvent::finish() {
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+#if defined(__linux__)
+
+void WaitEvent::wait(uint32_t seq, std::chrono::nanoseconds timeout) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    // Returns at once if notify() already moved the sequence on
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence), FUTEX_WAIT_PRIVATE,
+            seq, &ts, nullptr, 0);
+}
+
+void WaitEvent::notify() {
+    if (sleepers.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    sequence.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence), FUTEX_WAKE_PRIVATE,
+            INT32_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+void WaitEvent::wait(uint32_t seq, std::chrono::nanoseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait_for(lock, timeout, [this, seq]() {
+        return sequence.load(std::memory_order_relaxed) != seq;
+    });
+}
+
+void WaitEvent::notify() {
+    if (sleepers.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sequence.fetch_add(1, std::memory_order_release);
+    }
+    condition.notify_all();
+}
+
+#endif
+
+} // namespace sdrplay
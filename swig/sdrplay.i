@@ -8,6 +8,22 @@
 #include "device_params/rspdxr2_params.h"
 #include "sdrplay_wrapper.h"
 #include "device_registry.h"
+#include "ring_allocator.h"
+#include "ring_storage.h"
+#include "ring_index.h"
+#include "sample_buffer.h"
+#include "planar_buffer.h"
+#include "broadcast_buffer.h"
+#include "block_pool.h"
+#include "stream_tags.h"
+#include "stream_stats.h"
+#include "trace.h"
+#include "control_latency.h"
+#include "metrics_server.h"
+#include "sample_convert.h"
+#include "wait_strategy.h"
+#include "thread_policy.h"
+#include "streaming_params.h"
 #include "callback_wrapper.h"
 #include "device_impl/rsp1a_control.h"
 #include "device_impl/rspdxr2_control.h"
@@ -19,11 +35,23 @@
 %include <std_vector.i>
 %include <std_map.i>
 %include <std_complex.i>
+%include <std_shared_ptr.i>
 %include "numpy.i"
 
 // Template instantiations for STL containers
 %template(DeviceInfoVector) std::vector<sdrplay::DeviceInfo>;
 %template(ComplexShortVector) std::vector<std::complex<short>>;
+%template(StreamTagVector) std::vector<sdrplay::StreamTag>;
+%template(IntVector) std::vector<int>;
+%template(StringVector) std::vector<std::string>;
+
+// Broadcast readers are handed out as shared_ptr
+%shared_ptr(sdrplay::BroadcastReader)
+
+// Buffer allocators are shared between buffers
+%shared_ptr(sdrplay::RingAllocator)
+%shared_ptr(sdrplay::HeapRingAllocator)
+%shared_ptr(sdrplay::HugePageRingAllocator)
 
 // Enable exceptions
 %catches(std::runtime_error);
@@ -42,15 +70,21 @@ namespace sdrplay {
             []() { return std::make_unique<RSPdxR2Control>(); });
     }
     
+    // Convert complex<short> samples into a complex64 destination
+    void samples_to_complex64(const std::complex<short>* samples, size_t count,
+                              std::complex<float>* dest) {
+        convertToCF32(samples, dest, count, 1.0f);
+    }
+    
     // Helper function to create a NumPy array from buffer
     PyObject* samples_to_numpy(const std::complex<short>* samples, size_t count) {
         npy_intp dims[1] = { static_cast<npy_intp>(count) };
-        PyObject* array = PyArray_SimpleNewFromData(1, dims, NPY_COMPLEX64, 
-                                             (void*)samples);
-        // Make the data copy so we can return it safely
-        PyObject* result = PyArray_Copy((PyArrayObject*)array);
-        Py_DECREF(array);
-        return result;
+        PyObject* array = PyArray_SimpleNew(1, dims, NPY_COMPLEX64);
+        if (array && count > 0) {
+            samples_to_complex64(samples, count,
+                static_cast<std::complex<float>*>(PyArray_DATA((PyArrayObject*)array)));
+        }
+        return array;
     }
     
     // Simple buffer class for Python to allocate and hold sample data
@@ -107,9 +141,54 @@ namespace sdrplay {
 %ignore sdrplay::CallbackWrapper::getStreamCallback;
 %ignore sdrplay::CallbackWrapper::getEventCallback;
 %ignore sdrplay::CallbackWrapper::getContext;
+%ignore sdrplay::CallbackWrapper::setSampleCallback;
+%ignore sdrplay::Device::setSampleCallback;
+%ignore sdrplay::RingStorage;
+%ignore sdrplay::RingIndex;
+%ignore sdrplay::BroadcastBuffer;
+%ignore sdrplay::interleaveIQ;
+%ignore sdrplay::convertToCF32;
+%ignore sdrplay::convertToCS8;
+%ignore sdrplay::convertToCU8;
+%ignore sdrplay::convertSamples;
+%ignore sdrplay::cpuRelax;
+%ignore sdrplay::WaitEvent;
+%ignore sdrplay::spinWait;
+%ignore sdrplay::applyThreadPolicy(std::thread&, const sdrplay::ThreadPolicy&);
+%ignore sdrplay::SampleNotifier;
+%ignore sdrplay::StreamStatsCollector;
+%ignore sdrplay::StreamStats::packetSizeCounts;
+%ignore sdrplay::TraceScope;
+%ignore sdrplay::Trace::record;
+%ignore sdrplay::Trace::nameThreadOnce;
+%ignore sdrplay::ControlLatency;
+// Block consumers run on the stream thread, which cannot call into Python
+%ignore sdrplay::BlockPool;
+%ignore sdrplay::SampleBlock;
+%ignore sdrplay::SampleBlockRef;
+%ignore sdrplay::SampleBlockWriter;
+%ignore sdrplay::CallbackWrapper::addBlockConsumer;
+%ignore sdrplay::CallbackWrapper::removeBlockConsumer;
+%ignore sdrplay::Device::addBlockConsumer;
+%ignore sdrplay::Device::removeBlockConsumer;
 
 // Include headers
 %include "device_types.h"
+%include "ring_allocator.h"
+%include "ring_storage.h"
+%include "wait_strategy.h"
+%include "thread_policy.h"
+%include "ring_index.h"
+%include "sample_buffer.h"
+%include "planar_buffer.h"
+%include "broadcast_buffer.h"
+%include "block_pool.h"
+%include "stream_tags.h"
+%include "stream_stats.h"
+%include "trace.h"
+%include "control_latency.h"
+%include "sample_convert.h"
+%include "streaming_params.h"
 %include "callback_wrapper.h"
 %include "basic_params.h"
 %include "control_params.h"
@@ -141,24 +220,98 @@ namespace sdrplay {
         }
     }
     
-    // Convenience method for Python to read samples directly to a NumPy array
+    // Convenience method for Python to read samples directly to a NumPy array.
+    // Samples are converted straight out of the ring into the array, so the
+    // only pass over the data is the conversion NumPy needs anyway. CS16
+    // gives unscaled complex64, CF32 complex64 scaled to +-1.0, and CS8/CU8
+    // int8/uint8 arrays of interleaved I/Q pairs. With planarStorage use
+    // readPlanarToNumpy() instead.
     PyObject* readSamplesToNumpy(size_t maxCount) {
-        // Create a buffer to hold the samples
-        std::vector<std::complex<short>> buffer(maxCount);
+        sdrplay::SampleFormat format = $self->getSampleFormat();
+        sdrplay::SampleSpans spans = $self->peekSamples(maxCount);
         
-        // Read the samples
-        size_t count = $self->readSamples(buffer.data(), maxCount);
+        bool bytes = format == sdrplay::SampleFormat::CS8 || format == sdrplay::SampleFormat::CU8;
+        int type = bytes ? (format == sdrplay::SampleFormat::CS8 ? NPY_INT8 : NPY_UINT8) : NPY_COMPLEX64;
+        npy_intp dims[1] = { static_cast<npy_intp>(bytes ? 2 * spans.size() : spans.size()) };
+        PyObject* array = PyArray_SimpleNew(1, dims, type);
+        if (!array || spans.empty()) {
+            return array;
+        }
         
-        // If no samples were read, return an empty NumPy array
-        if (count == 0) {
-            npy_intp dims[1] = { 0 };
-            return PyArray_SimpleNew(1, dims, NPY_COMPLEX64);
+        char* dest = static_cast<char*>(PyArray_DATA((PyArrayObject*)array));
+        size_t split = spans.first.size * (bytes ? 2 : sizeof(std::complex<float>));
+        if (format == sdrplay::SampleFormat::CS16) {
+            std::complex<float>* out = reinterpret_cast<std::complex<float>*>(dest);
+            sdrplay::samples_to_complex64(spans.first.data, spans.first.size, out);
+            sdrplay::samples_to_complex64(spans.second.data, spans.second.size,
+                                          out + spans.first.size);
+        } else {
+            sdrplay::convertSamples(format, spans.first.data, dest, spans.first.size);
+            sdrplay::convertSamples(format, spans.second.data, dest + split, spans.second.size);
+        }
+        if ($self->consumeSamples(spans.size()) == 0) {
+            // Overwritten while converting; the samples are counted as dropped
+            Py_DECREF(array);
+            dims[0] = 0;
+            return PyArray_SimpleNew(1, dims, type);
+        }
+        return array;
+    }
+}
+
+// Read planar samples into a (2, n) int16 NumPy array: row 0 is I, row 1 is Q
+%extend sdrplay::Device {
+    PyObject* readPlanarToNumpy(size_t maxCount) {
+        sdrplay::PlanarSpans spans = $self->peekPlanar(maxCount);
+        
+        npy_intp dims[2] = { 2, static_cast<npy_intp>(spans.size()) };
+        PyObject* array = PyArray_SimpleNew(2, dims, NPY_INT16);
+        if (!array || spans.empty()) {
+            return array;
+        }
+        
+        short* iRow = static_cast<short*>(PyArray_DATA((PyArrayObject*)array));
+        short* qRow = iRow + spans.size();
+        std::copy(spans.first.i, spans.first.i + spans.first.size, iRow);
+        std::copy(spans.first.q, spans.first.q + spans.first.size, qRow);
+        std::copy(spans.second.i, spans.second.i + spans.second.size, iRow + spans.first.size);
+        std::copy(spans.second.q, spans.second.q + spans.second.size, qRow + spans.first.size);
+        if ($self->consumeSamples(spans.size()) == 0) {
+            // Overwritten while copying; the samples are counted as dropped
+            Py_DECREF(array);
+            dims[1] = 0;
+            return PyArray_SimpleNew(2, dims, NPY_INT16);
+        }
+        return array;
+    }
+}
+
+// Read a broadcast reader's samples straight into a NumPy array
+%extend sdrplay::BroadcastReader {
+    PyObject* readToNumpy(size_t maxCount) {
+        sdrplay::SampleSpans spans = $self->peek(maxCount);
+        
+        npy_intp dims[1] = { static_cast<npy_intp>(spans.size()) };
+        PyObject* array = PyArray_SimpleNew(1, dims, NPY_COMPLEX64);
+        if (!array || spans.empty()) {
+            return array;
         }
         
-        // Create a NumPy array with the samples
-        return sdrplay::samples_to_numpy(buffer.data(), count);
+        std::complex<float>* dest =
+            static_cast<std::complex<float>*>(PyArray_DATA((PyArrayObject*)array));
+        sdrplay::samples_to_complex64(spans.first.data, spans.first.size, dest);
+        sdrplay::samples_to_complex64(spans.second.data, spans.second.size,
+                                      dest + spans.first.size);
+        if ($self->consume(spans.size()) == 0) {
+            // Overwritten while converting; the samples are counted as dropped
+            Py_DECREF(array);
+            dims[0] = 0;
+            return PyArray_SimpleNew(1, dims, NPY_COMPLEX64);
+        }
+        return array;
     }
 }
 
 // Finally include the main wrapper
-%include "sdrplay_wrapper.h"
\ No newline at end of file
+%include "sdrplay_wrapper.h"
+%include "metrics_server.h"
@@ -0,0 +1,207 @@
+#include "block_pool.h"
+#include "callback_wrapper.h"
+#include <atomic>
+#include <cassert>
+#include <complex>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+    // Deliver one packet through the static API callback, as the stream thread would
+    void deliverPacket(CallbackWrapper& wrapper, unsigned int firstSampleNum,
+                       unsigned int numSamples, bool reset = false, short value = 1) {
+        std::vector<short> xi(numSamples, value);
+        std::vector<short> xq(numSamples, static_cast<short>(-value));
+        sdrplay_api_StreamCbParamsT params = {};
+        params.firstSampleNum = firstSampleNum;
+        params.numSamples = numSamples;
+        CallbackWrapper::streamCallback(xi.data(), xq.data(), &params, numSamples,
+                                        reset ? 1 : 0, wrapper.getContext());
+    }
+}
+
+// Test acquiring, sharing and releasing blocks
+void testAcquireRelease() {
+    std::cout << "Testing block acquire/release..." << std::endl;
+
+    auto pool = BlockPool::create(4, 100);
+    assert(pool->blockCount() == 4 && pool->blockSamples() == 100 && pool->freeBlocks() == 4);
+
+    std::vector<SampleBlockRef> held;
+    for (int i = 0; i < 4; ++i) {
+        SampleBlockRef ref = pool->acquire().publish();
+        assert(ref && ref.useCount() == 1 && ref->size() == 0 && ref->capacity() == 100);
+        assert(reinterpret_cast<uintptr_t>(ref->data()) % RingStorage::ALIGNMENT == 0);
+        held.push_back(std::move(ref));
+    }
+    assert(pool->freeBlocks() == 0);
+    assert(!pool->acquire());
+
+    // Copies share the block; it comes back only with the last handle
+    SampleBlockRef copy = held[0];
+    assert(copy.useCount() == 2 && copy->data() == held[0]->data());
+    held[0].reset();
+    assert(pool->freeBlocks() == 0 && copy.useCount() == 1);
+    copy = SampleBlockRef();
+    assert(pool->freeBlocks() == 1);
+
+    SampleBlockWriter again = pool->acquire();
+    assert(again);
+    again->resize(1000);
+    assert(again->size() == 100);
+    held.clear();
+    SampleBlockRef published = again.publish();
+    assert(!again && published && published->size() == 100);
+    published.reset();
+
+    BlockPoolStats stats = pool->getStats();
+    assert(stats.freeBlocks == 4 && stats.minFreeBlocks == 0);
+    assert(stats.acquiredBlocks == 5 && stats.exhaustedCount == 1);
+
+    // Outstanding blocks keep the pool alive
+    SampleBlockWriter writer = pool->acquire();
+    writer->data()[0] = std::complex<short>(7, -7);
+    SampleBlockRef survivor = writer.publish();
+    pool.reset();
+    assert(survivor->data()[0] == std::complex<short>(7, -7));
+    survivor.reset();
+
+    std::cout << "Block acquire/release test passed" << std::endl;
+}
+
+// Test that blocks released on other threads are recycled intact
+void testConcurrentRelease() {
+    std::cout << "Testing concurrent release..." << std::endl;
+
+    const int consumers = 3;
+    const uint64_t blocks = 20000;
+    auto pool = BlockPool::create(8, 64);
+
+    std::mutex queueMutex;
+    std::vector<std::deque<SampleBlockRef>> queues(consumers);
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> checked(0);
+
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            for (;;) {
+                SampleBlockRef ref;
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex);
+                    if (!queues[c].empty()) {
+                        ref = std::move(queues[c].front());
+                        queues[c].pop_front();
+                    }
+                }
+                if (!ref) {
+                    if (done) {
+                        return;
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+                // Every sample carries the block sequence number
+                for (size_t i = 0; i < ref->size(); ++i) {
+                    assert(ref->data()[i].real() == static_cast<short>(ref->sequence));
+                }
+                checked.fetch_add(1);
+            }
+        });
+    }
+
+    uint64_t published = 0;
+    for (uint64_t sequence = 0; published < blocks; ++sequence) {
+        SampleBlockWriter block = pool->acquire();
+        if (!block) {
+            std::this_thread::yield();
+            continue;
+        }
+        block->sequence = sequence;
+        block->resize(64);
+        for (size_t i = 0; i < block->size(); ++i) {
+            block->data()[i] = std::complex<short>(static_cast<short>(sequence), 0);
+        }
+        SampleBlockRef ref = block.publish();
+        std::lock_guard<std::mutex> lock(queueMutex);
+        for (auto& queue : queues) {
+            queue.push_back(ref);
+        }
+        ++published;
+    }
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    assert(checked == blocks * consumers);
+    assert(pool->freeBlocks() == 8);
+
+    std::cout << "Concurrent release test passed" << std::endl;
+}
+
+// Test the wrapper hands every consumer the same pooled blocks
+void testWrapperBlocks() {
+    std::cout << "Testing wrapper sample blocks..." << std::endl;
+
+    CallbackWrapper wrapper(8192);
+    wrapper.prepareStream();
+    wrapper.enableSampleBlocks(4, 256);
+
+    std::vector<SampleBlockRef> first, second;
+    size_t firstId = wrapper.addBlockConsumer([&first](const SampleBlockRef& ref) { first.push_back(ref); });
+    wrapper.addBlockConsumer([&second](const SampleBlockRef& ref) { second.push_back(ref); });
+
+    // A packet longer than a block spans several blocks
+    deliverPacket(wrapper, 1000, 300, true, 5);
+    assert(first.size() == 2 && second.size() == 2);
+    assert(first[0]->data() == second[0]->data() && first[0].useCount() == 2);
+    assert(first[0]->size() == 256 && first[1]->size() == 44);
+    assert(first[0]->firstSampleNum == 1000 && first[1]->firstSampleNum == 1256);
+    assert(first[1]->sequence == first[0]->sequence + 1);
+    assert(first[1]->data()[43] == std::complex<short>(5, -5));
+
+    // Consumers hold every block: the next packet is dropped and counted
+    deliverPacket(wrapper, 1300, 300);
+    deliverPacket(wrapper, 1600, 100);
+    BlockPoolStats stats = wrapper.getBlockPoolStats();
+    assert(stats.freeBlocks == 0 && stats.droppedSamples == 100);
+    assert(first.size() == 4 && first[3]->sequence == first[0]->sequence + 3);
+
+    // Released blocks are reused
+    first.clear();
+    second.clear();
+    wrapper.removeBlockConsumer(firstId);
+    deliverPacket(wrapper, 1700, 100);
+    assert(first.empty() && second.size() == 1);
+    assert(second[0]->sequence == 5);  // The dropped block left a gap
+    second.clear();
+    assert(wrapper.getBlockPoolStats().freeBlocks == 4);
+
+    wrapper.disableSampleBlocks();
+    deliverPacket(wrapper, 1800, 100);
+    assert(second.empty());
+    assert(wrapper.getBlockPoolStats().blockCount == 0);
+
+    std::cout << "Wrapper sample blocks test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testAcquireRelease();
+        testConcurrentRelease();
+        testWrapperBlocks();
+
+        std::cout << "All block pool tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
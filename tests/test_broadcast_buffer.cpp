@@ -0,0 +1,228 @@
+#include "broadcast_buffer.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <complex>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+    // Samples carry their stream position so readers can check ordering
+    std::vector<std::complex<short>> makeSamples(size_t start, size_t count) {
+        std::vector<std::complex<short>> samples(count);
+        for (size_t i = 0; i < count; ++i) {
+            size_t n = start + i;
+            samples[i] = std::complex<short>(static_cast<short>(n & 0x7FFF),
+                                             static_cast<short>((n >> 15) & 0x7FFF));
+        }
+        return samples;
+    }
+
+    size_t sampleNumber(const std::complex<short>& sample) {
+        return static_cast<size_t>(sample.real()) | (static_cast<size_t>(sample.imag()) << 15);
+    }
+}
+
+// Test that every reader sees every sample
+void testFanOut() {
+    std::cout << "Testing broadcast fan-out..." << std::endl;
+
+    auto ring = std::make_shared<BroadcastBuffer>(1024);
+
+    // Writes with no readers registered are discarded
+    ring->write(makeSamples(0, 10).data(), 10);
+    assert(ring->writeIndex() == 0);
+
+    auto a = ring->addReader();
+    auto b = ring->addReader();
+    assert(ring->readerCount() == 2);
+
+    ring->write(makeSamples(0, 100).data(), 100);
+    auto c = ring->addReader();  // Late reader only sees later samples
+    ring->write(makeSamples(100, 100).data(), 100);
+
+    assert(a->available() == 200);
+    assert(b->available() == 200);
+    assert(c->available() == 100);
+
+    std::vector<std::complex<short>> out(200);
+    assert(a->read(out.data(), 200) == 200);
+    for (size_t i = 0; i < 200; ++i) {
+        assert(sampleNumber(out[i]) == i);
+    }
+
+    // Readers advance independently
+    assert(b->read(out.data(), 50) == 50);
+    assert(sampleNumber(out[0]) == 0);
+    assert(b->available() == 150);
+    assert(a->available() == 0);
+
+    assert(c->read(out.data(), 200) == 100);
+    assert(sampleNumber(out[0]) == 100);
+
+    c.reset();
+    assert(ring->readerCount() == 2);
+
+    std::cout << "Broadcast fan-out test passed" << std::endl;
+}
+
+// Test both lap policies
+void testLapping() {
+    std::cout << "Testing broadcast reader lapping..." << std::endl;
+
+    auto ring = std::make_shared<BroadcastBuffer>(256);
+    auto oldest = ring->addReader(ReaderOverflowPolicy::DropOldest);
+    auto newest = ring->addReader(ReaderOverflowPolicy::SkipToNewest);
+    auto fast = ring->addReader();
+
+    std::vector<std::complex<short>> out(256);
+    for (size_t pos = 0; pos < 1000; pos += 100) {
+        ring->write(makeSamples(pos, 100).data(), 100);
+        assert(fast->read(out.data(), out.size()) == 100);
+    }
+    assert(fast->droppedSamples() == 0);
+
+    // DropOldest keeps the newest full buffer
+    assert(oldest->read(out.data(), out.size()) == 256);
+    assert(sampleNumber(out[0]) == 1000 - 256);
+    assert(oldest->droppedSamples() == 1000 - 256);
+    assert(oldest->overflowEvents() == 1);
+
+    // SkipToNewest discards the backlog and waits for new samples
+    assert(newest->read(out.data(), out.size()) == 0);
+    assert(newest->droppedSamples() == 1000);
+    ring->write(makeSamples(1000, 10).data(), 10);
+    assert(newest->read(out.data(), out.size()) == 10);
+    assert(sampleNumber(out[0]) == 1000);
+
+    // Zero-copy access, with overwrite detection on consume
+    SampleSpans spans = oldest->peek(8);
+    assert(spans.size() == 8);
+    assert(sampleNumber(spans.first.data[0]) == 1000);
+    assert(oldest->consume(8) == 8);
+
+    spans = oldest->peek(2);
+    assert(spans.size() == 2);
+    ring->write(makeSamples(1010, 300).data(), 300);  // Overwrites the peeked samples
+    assert(oldest->consume(2) == 0);
+
+    std::cout << "Broadcast reader lapping test passed" << std::endl;
+}
+
+// Test that storage is only reallocated once no reader holds it
+void testReconfigure() {
+    std::cout << "Testing broadcast reconfigure..." << std::endl;
+
+    // Nothing is allocated before the first reader, so settings apply freely
+    auto ring = std::make_shared<BroadcastBuffer>(64);
+    assert(ring->lockMemory(false) && ring->prefaultMemory());
+    assert(ring->reconfigure(128));
+    assert(ring->capacity() == 128);
+
+    // A registered reader keeps the storage it reads from
+    auto reader = ring->addReader();
+    ring->write(makeSamples(0, 50).data(), 50);
+    assert(!ring->reconfigure(1000, RingLayout::Mirrored));
+    assert(ring->capacity() == 128);
+    std::vector<std::complex<short>> out(1024);
+    assert(reader->read(out.data(), out.size()) == 50);
+    assert(sampleNumber(out[49]) == 49);
+
+    // Once it is gone the next reader gets the new storage
+    reader.reset();
+    assert(ring->reconfigure(1000, RingLayout::Mirrored));
+    assert(ring->capacity() >= 1024);
+    reader = ring->addReader();
+    assert(reader->available() == 0);
+
+    ring->write(makeSamples(50, 500).data(), 500);
+    assert(reader->read(out.data(), out.size()) == 500);
+    assert(sampleNumber(out[0]) == 50);
+    assert(reader->droppedSamples() == 0);
+
+    std::cout << "Broadcast reconfigure test passed" << std::endl;
+}
+
+// Test a fast and a slow reader against a live producer
+void testConcurrentReaders() {
+    std::cout << "Testing concurrent broadcast readers..." << std::endl;
+
+    const size_t total = 2000000;
+    auto ring = std::make_shared<BroadcastBuffer>(16384);
+    auto fast = ring->addReader();
+    auto slow = ring->addReader();
+    std::atomic<bool> done(false);
+    std::atomic<bool> lapped(false);
+
+    // Checks each read is a contiguous run in stream order. The slow reader
+    // only starts once the producer has lapped it, so it always loses samples.
+    auto consumer = [&](std::shared_ptr<BroadcastReader> reader, bool sleepy, size_t& received) {
+        std::vector<std::complex<short>> out(4096);
+        size_t expected = 0;
+        while (sleepy && !lapped.load()) {
+            std::this_thread::yield();
+        }
+        for (;;) {
+            bool finished = done.load();
+            size_t n = reader->read(out.data(), out.size());
+            if (n == 0 && finished) {
+                break;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                size_t number = sampleNumber(out[i]);
+                assert(number >= expected);
+                expected = number + 1;
+            }
+            received += n;
+            if (sleepy) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            } else if (n == 0) {
+                reader->waitForSamples(1, 1);
+            }
+        }
+    };
+
+    size_t fastReceived = 0;
+    size_t slowReceived = 0;
+    std::thread fastThread(consumer, fast, false, std::ref(fastReceived));
+    std::thread slowThread(consumer, slow, true, std::ref(slowReceived));
+
+    for (size_t pos = 0; pos < total; pos += 1000) {
+        ring->write(makeSamples(pos, 1000).data(), 1000);
+        if (pos + 1000 >= 2 * ring->capacity()) {
+            lapped = true;
+        }
+        if ((pos / 1000) % 16 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    fastThread.join();
+    slowThread.join();
+
+    // Every sample is either received or counted as dropped
+    assert(fastReceived + fast->droppedSamples() == total);
+    assert(slowReceived + slow->droppedSamples() == total);
+    assert(slow->droppedSamples() > 0);
+
+    std::cout << "Concurrent broadcast reader test passed (slow reader dropped "
+              << slow->droppedSamples() << " samples)" << std::endl;
+}
+
+int main() {
+    try {
+        testFanOut();
+        testLapping();
+        testReconfigure();
+        testConcurrentReaders();
+
+        std::cout << "All broadcast buffer tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
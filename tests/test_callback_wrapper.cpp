@@ -0,0 +1,562 @@
+#include "callback_wrapper.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+using namespace sdrplay;
+
+namespace {
+    // Deliver one packet through the static API callback, as the stream thread would
+    void deliverPacket(CallbackWrapper& wrapper, unsigned int firstSampleNum,
+                       unsigned int numSamples, bool reset = false, short value = 1) {
+        std::vector<short> xi(numSamples, value);
+        std::vector<short> xq(numSamples, static_cast<short>(-value));
+        sdrplay_api_StreamCbParamsT params = {};
+        params.firstSampleNum = firstSampleNum;
+        params.numSamples = numSamples;
+        CallbackWrapper::streamCallback(xi.data(), xq.data(), &params, numSamples,
+                                        reset ? 1 : 0, wrapper.getContext());
+    }
+}
+
+// Test that contiguous packets are not reported as loss
+void testContinuousStream() {
+    std::cout << "Testing continuous stream..." << std::endl;
+
+    CallbackWrapper wrapper(4096);
+    wrapper.prepareStream();
+    deliverPacket(wrapper, 1000, 100, true);
+    deliverPacket(wrapper, 1100, 100);
+    deliverPacket(wrapper, 1200, 100);
+
+    assert(wrapper.samplesAvailable() == 300);
+    assert(wrapper.getMissingSampleCount() == 0);
+    assert(wrapper.getGapEventCount() == 0);
+
+    // The 32-bit sample counter wrapping around is not a gap
+    deliverPacket(wrapper, 0xFFFFFFC0u, 64, true);
+    deliverPacket(wrapper, 0, 64);
+    assert(wrapper.getMissingSampleCount() == 0);
+
+    std::cout << "Continuous stream test passed" << std::endl;
+}
+
+// Test that jumps in firstSampleNum are counted without filling by default
+void testGapDetection() {
+    std::cout << "Testing gap detection..." << std::endl;
+
+    CallbackWrapper wrapper(4096);
+    wrapper.prepareStream();
+    deliverPacket(wrapper, 0, 100, true);
+    deliverPacket(wrapper, 150, 100);   // 50 samples lost
+    deliverPacket(wrapper, 250, 100);
+    deliverPacket(wrapper, 400, 100);   // 50 more lost
+
+    assert(wrapper.getMissingSampleCount() == 100);
+    assert(wrapper.getGapEventCount() == 2);
+    assert(wrapper.samplesAvailable() == 400);
+
+    // The packet after the gap is tagged
+    std::vector<StreamTag> tags = wrapper.getStreamTags(100, 1);
+    assert(tags.size() == 1);
+    assert(tags[0].gap && !tags[0].zeroFill);
+    assert(tags[0].firstSampleNum == 150);
+
+    // A restart resynchronises instead of counting loss
+    deliverPacket(wrapper, 10, 100, true);
+    assert(wrapper.getMissingSampleCount() == 100);
+
+    // Preparing a new stream clears the counters
+    wrapper.prepareStream();
+    assert(wrapper.getMissingSampleCount() == 0);
+    assert(wrapper.getGapEventCount() == 0);
+
+    std::cout << "Gap detection test passed" << std::endl;
+}
+
+// Test that lost samples are replaced by zeros when filling is enabled
+void testGapFill() {
+    std::cout << "Testing gap zero fill..." << std::endl;
+
+    CallbackWrapper wrapper(4096);
+    wrapper.prepareStream(64);  // Force the fill to span several arena pieces
+    wrapper.setGapFill(true);
+    assert(wrapper.getGapFill());
+
+    deliverPacket(wrapper, 0, 100, true, 5);
+    deliverPacket(wrapper, 300, 100, false, 7);  // 200 samples lost
+
+    assert(wrapper.getMissingSampleCount() == 200);
+    assert(wrapper.samplesAvailable() == 400);
+
+    std::vector<std::complex<short>> out(400);
+    assert(wrapper.readSamples(out.data(), out.size()) == 400);
+    for (size_t i = 0; i < 100; ++i) {
+        assert(out[i] == std::complex<short>(5, -5));
+    }
+    for (size_t i = 100; i < 300; ++i) {
+        assert(out[i] == std::complex<short>(0, 0));
+    }
+    for (size_t i = 300; i < 400; ++i) {
+        assert(out[i] == std::complex<short>(7, -7));
+    }
+
+    // Filled samples are tagged with the sample numbers they stand in for
+    std::vector<StreamTag> tags = wrapper.getStreamTags(100, 200);
+    assert(!tags.empty());
+    assert(tags.front().zeroFill && tags.front().firstSampleNum == 100);
+    for (const StreamTag& tag : tags) {
+        assert(tag.zeroFill);
+    }
+
+    // Fill is capped for implausibly large jumps
+    wrapper.setGapFill(true, 10);
+    deliverPacket(wrapper, 1000, 100);
+    assert(wrapper.getMissingSampleCount() == 800);
+    assert(wrapper.samplesAvailable() == 110);
+
+    std::cout << "Gap zero fill test passed" << std::endl;
+}
+
+// Test that registered readers receive the stream alongside readSamples()
+void testSampleReaders() {
+    std::cout << "Testing sample readers..." << std::endl;
+
+    CallbackWrapper wrapper(4096);
+    wrapper.prepareStream();
+    auto first = wrapper.addSampleReader();
+    auto second = wrapper.addSampleReader(ReaderOverflowPolicy::SkipToNewest);
+
+    deliverPacket(wrapper, 0, 100, true, 3);
+    deliverPacket(wrapper, 100, 100, false, 4);
+
+    std::vector<std::complex<short>> out(200);
+    assert(wrapper.readSamples(out.data(), out.size()) == 200);
+    assert(first->read(out.data(), out.size()) == 200);
+    assert(out[0] == std::complex<short>(3, -3));
+    assert(out[199] == std::complex<short>(4, -4));
+    assert(second->available() == 200);
+
+    std::cout << "Sample reader test passed" << std::endl;
+}
+
+// Test that the dispatcher delivers every sample exactly once off the API thread
+void testDispatcher() {
+    std::cout << "Testing callback dispatcher..." << std::endl;
+
+    CallbackWrapper wrapper(65536);
+    wrapper.prepareStream();
+
+    std::thread::id apiThread = std::this_thread::get_id();
+    std::vector<short> delivered;
+    bool onApiThread = false;
+    wrapper.setSampleCallback([&](const std::complex<short>* samples, size_t count) {
+        if (std::this_thread::get_id() == apiThread) {
+            onApiThread = true;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            delivered.push_back(samples[i].real());
+        }
+    });
+
+    // Inline, then dispatched, then inline again; the switches must not
+    // duplicate or lose packets
+    deliverPacket(wrapper, 0, 100, true, 1);
+    assert(onApiThread);
+    onApiThread = false;
+
+    wrapper.setCallbackMode(CallbackMode::Dispatcher);
+    assert(wrapper.getCallbackMode() == CallbackMode::Dispatcher);
+    for (short packet = 2; packet <= 20; ++packet) {
+        deliverPacket(wrapper, packet * 100 - 100, 100, false, packet);
+    }
+    wrapper.setCallbackMode(CallbackMode::Inline);
+    assert(!onApiThread);
+
+    DispatcherStats stats = wrapper.getDispatcherStats();
+    assert(stats.dispatchedSamples == 1900);
+    assert(stats.callbackCount > 0);
+    assert(stats.droppedSamples == 0);
+
+    deliverPacket(wrapper, 2000, 100, false, 21);
+    assert(delivered.size() == 2100);
+    for (size_t i = 0; i < delivered.size(); ++i) {
+        assert(delivered[i] == static_cast<short>(i / 100 + 1));
+    }
+
+    std::cout << "Callback dispatcher test passed" << std::endl;
+}
+
+// Test that a slow dispatched callback costs the dispatcher samples, not the stream
+void testSlowDispatchedCallback() {
+    std::cout << "Testing slow dispatched callback..." << std::endl;
+
+    CallbackWrapper wrapper(1024);
+    wrapper.prepareStream();
+    wrapper.setSampleCallback([](const std::complex<short>*, size_t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+    wrapper.setCallbackMode(CallbackMode::Dispatcher);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (unsigned int packet = 0; packet < 50; ++packet) {
+        deliverPacket(wrapper, packet * 1000, 1000, packet == 0);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    // The API thread never waited for the 20 ms callback
+    assert(elapsed < std::chrono::milliseconds(200));
+    wrapper.setCallbackMode(CallbackMode::Inline);
+
+    DispatcherStats stats = wrapper.getDispatcherStats();
+    assert(stats.droppedSamples > 0);
+    assert(stats.maxCallbackNs >= 20000000u);
+    assert(stats.dispatchedSamples + stats.droppedSamples == 50000);
+
+    std::cout << "Slow dispatched callback test passed" << std::endl;
+}
+
+// Test replacing and clearing the callback while packets are flowing
+void testCallbackSwapWhileStreaming() {
+    std::cout << "Testing callback swap while streaming..." << std::endl;
+
+    CallbackWrapper wrapper(65536);
+    wrapper.prepareStream();
+    std::atomic<bool> stop(false);
+    std::atomic<int> retiredCalls(0);
+    std::atomic<bool> retired(false);
+
+    std::thread api([&]() {
+        unsigned int sampleNum = 0;
+        bool first = true;
+        while (!stop.load()) {
+            deliverPacket(wrapper, sampleNum, 256, first);
+            sampleNum += 256;
+            first = false;
+            wrapper.resetBuffer();
+        }
+    });
+
+    for (int round = 0; round < 200; ++round) {
+        retired = false;
+        wrapper.setSampleCallback([&](const std::complex<short>*, size_t) {
+            if (retired.load()) {
+                ++retiredCalls;  // Called after being replaced
+            }
+        });
+        std::this_thread::yield();
+        wrapper.setSampleCallback(nullptr);
+        retired = true;  // No call to the old callback may start from here on
+    }
+    stop = true;
+    api.join();
+    assert(retiredCalls == 0);
+
+    std::cout << "Callback swap while streaming test passed" << std::endl;
+}
+
+// Test coalescing packets into fixed-size callback blocks
+void testBlockCoalescing() {
+    std::cout << "Testing callback block coalescing..." << std::endl;
+
+    CallbackWrapper wrapper(65536);
+    wrapper.prepareStream();
+    wrapper.setCallbackBlockSize(256);
+    assert(wrapper.getCallbackBlockSize() == 256);
+
+    std::vector<size_t> calls;
+    std::vector<short> delivered;
+    wrapper.setSampleCallback([&](const std::complex<short>* samples, size_t count) {
+        calls.push_back(count);
+        for (size_t i = 0; i < count; ++i) {
+            delivered.push_back(samples[i].real());
+        }
+    });
+
+    // 10 packets of 100 samples make three full blocks and 232 pending
+    for (short packet = 0; packet < 10; ++packet) {
+        deliverPacket(wrapper, packet * 100, 100, packet == 0, packet);
+    }
+    assert(calls.size() == 3);
+    assert(calls[0] == 256 && calls[1] == 256 && calls[2] == 256);
+
+    // Packets of at least a block go straight through
+    deliverPacket(wrapper, 1000, 600, false, 10);
+    assert(calls.size() == 6);
+
+    wrapper.flushSampleBlock();
+    assert(calls.size() == 7);
+    assert(delivered.size() == 1600);
+    for (size_t i = 0; i < delivered.size(); ++i) {
+        assert(delivered[i] == static_cast<short>(i / 100 < 10 ? i / 100 : 10));
+    }
+
+    // A partial block goes out once its oldest sample is past the deadline
+    wrapper.setCallbackBlockSize(4096, 1);
+    calls.clear();
+    deliverPacket(wrapper, 1600, 100);
+    assert(calls.empty());
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    deliverPacket(wrapper, 1700, 100);
+    assert(calls.size() == 1 && calls[0] == 200);
+
+    std::cout << "Callback block coalescing test passed" << std::endl;
+}
+
+// Test block delivery from the dispatcher, including the trailing partial block
+void testDispatcherBlocks() {
+    std::cout << "Testing dispatcher blocks..." << std::endl;
+
+    CallbackWrapper wrapper(65536);
+    wrapper.prepareStream();
+    wrapper.setCallbackBlockSize(500);
+
+    std::vector<size_t> calls;
+    std::atomic<size_t> total(0);
+    wrapper.setSampleCallback([&](const std::complex<short>*, size_t count) {
+        calls.push_back(count);
+        total += count;
+    });
+    wrapper.setCallbackMode(CallbackMode::Dispatcher);
+
+    // The running dispatcher owns the block settings
+    assert(!wrapper.setCallbackBlockSize(100));
+    assert(wrapper.getCallbackBlockSize() == 500);
+
+    for (unsigned int packet = 0; packet < 12; ++packet) {
+        deliverPacket(wrapper, packet * 100, 100, packet == 0);
+    }
+    for (int i = 0; i < 200 && total.load() < 1000; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    assert(total.load() == 1000);
+
+    // Stopping flushes the remaining 200 samples
+    wrapper.setCallbackMode(CallbackMode::Inline);
+    assert(calls.size() == 3);
+    assert(calls[0] == 500 && calls[1] == 500 && calls[2] == 200);
+
+    std::cout << "Dispatcher block test passed" << std::endl;
+}
+
+// Test typed callbacks and reads in each sample format
+void testSampleFormats() {
+    std::cout << "Testing sample formats..." << std::endl;
+
+    CallbackWrapper wrapper(4096);
+    wrapper.prepareStream();
+    wrapper.setCallbackBlockSize(150);
+    wrapper.setSampleFormat(SampleFormat::CF32);
+    assert(wrapper.getSampleFormat() == SampleFormat::CF32);
+
+    std::vector<std::complex<float>> floats;
+    wrapper.setSampleCallback([&](const std::complex<float>* samples, size_t count) {
+        floats.insert(floats.end(), samples, samples + count);
+    });
+    assert(wrapper.sampleCallbackMatches(SampleFormat::CF32));
+    assert(!wrapper.sampleCallbackMatches(SampleFormat::CS16));
+
+    deliverPacket(wrapper, 0, 100, true, 16384);
+    deliverPacket(wrapper, 100, 100, false, 16384);
+    wrapper.flushSampleBlock();
+    assert(floats.size() == 200);
+    for (const auto& sample : floats) {
+        assert(sample == std::complex<float>(0.5f, -0.5f));
+    }
+
+    // Reads convert to the overload's type regardless of the format
+    std::vector<std::complex<float>> readFloats(50);
+    assert(wrapper.readSamples(readFloats.data(), readFloats.size()) == 50);
+    assert(readFloats[49] == std::complex<float>(0.5f, -0.5f));
+    std::vector<int8_t> readS8(2 * 50);
+    assert(wrapper.readSamples(readS8.data(), 50) == 50);
+    assert(readS8[0] == 64 && readS8[1] == -64);
+    std::vector<uint8_t> readU8(2 * 100);
+    assert(wrapper.readSamples(readU8.data(), 100) == 100);
+    assert(readU8[0] == 192 && readU8[1] == 64);
+    assert(wrapper.samplesAvailable() == 0);
+
+    // A callback of another type is not called
+    wrapper.setSampleFormat(SampleFormat::CU8);
+    floats.clear();
+    deliverPacket(wrapper, 200, 200, false, 16384);
+    assert(floats.empty());
+
+    std::vector<uint8_t> bytes;
+    wrapper.setSampleCallback([&](const uint8_t* samples, size_t count) {
+        bytes.insert(bytes.end(), samples, samples + 2 * count);
+    });
+    deliverPacket(wrapper, 400, 200, false, -256);
+    wrapper.flushSampleBlock();
+    assert(bytes.size() == 400);
+    assert(bytes[0] == 127 && bytes[1] == 129);
+
+    // The dispatcher converts into its own arena
+    wrapper.setSampleFormat(SampleFormat::CS8);
+    std::vector<int8_t> signedBytes;
+    std::atomic<size_t> total(0);
+    wrapper.setSampleCallback([&](const int8_t* samples, size_t count) {
+        signedBytes.insert(signedBytes.end(), samples, samples + 2 * count);
+        total += count;
+    });
+    wrapper.setCallbackMode(CallbackMode::Dispatcher);
+    assert(!wrapper.setSampleFormat(SampleFormat::CF32));
+    assert(wrapper.getSampleFormat() == SampleFormat::CS8);
+    deliverPacket(wrapper, 600, 300, false, 1280);
+    wrapper.setCallbackMode(CallbackMode::Inline);
+    assert(total.load() == 300);
+    assert(signedBytes[0] == 5 && signedBytes[1] == -5);
+
+    wrapper.setSampleCallback(nullptr);
+    assert(wrapper.sampleCallbackMatches(SampleFormat::CS16));
+
+    std::cout << "Sample format test passed" << std::endl;
+}
+
+// Test planar storage through the wrapper, with and without interleaved consumers
+void testPlanarStorage() {
+    std::cout << "Testing planar storage..." << std::endl;
+
+    CallbackWrapper wrapper(4096);
+    wrapper.configureBuffer(4096, RingLayout::Standard, true);
+    wrapper.prepareStream();
+    wrapper.setGapFill(true);
+    assert(wrapper.isPlanarStorage());
+
+    deliverPacket(wrapper, 0, 100, true, 7);
+    deliverPacket(wrapper, 150, 100, false, 8);  // 50 zeros filled in between
+    assert(wrapper.samplesAvailable() == 250);
+    assert(wrapper.peekSamples(10).empty());
+
+    uint64_t start = wrapper.getReadIndex();
+    std::vector<StreamTag> tags = wrapper.getStreamTags(start, 250);
+    assert(tags.size() == 3 && tags[1].zeroFill && tags[2].sampleIndex == start + 150);
+
+    std::vector<short> xi(120), xq(120);
+    assert(wrapper.readPlanar(xi.data(), xq.data(), 120) == 120);
+    assert(xi[0] == 7 && xq[99] == -7 && xi[100] == 0 && xq[119] == 0);
+
+    PlanarSpans spans = wrapper.peekPlanar(200);
+    assert(spans.size() == 130 && spans.first.i[30] == 8);
+    assert(wrapper.consumeSamples(30) == 30);
+
+    // Interleaving reads convert out of the planar ring
+    std::vector<std::complex<short>> interleaved(50);
+    assert(wrapper.readSamples(interleaved.data(), 50) == 50);
+    assert(interleaved[0] == std::complex<short>(8, -8));
+    std::vector<std::complex<float>> floats(100);
+    assert(wrapper.readSamples(floats.data(), floats.size()) == 50);
+    assert(floats[49] == std::complex<float>(8 / 32768.0f, -8 / 32768.0f));
+
+    // Callbacks and readers still get interleaved samples
+    auto reader = wrapper.addSampleReader();
+    size_t delivered = 0;
+    wrapper.setSampleCallback([&](const std::complex<short>* samples, size_t count) {
+        assert(samples[0] == std::complex<short>(9, -9));
+        delivered += count;
+    });
+    deliverPacket(wrapper, 250, 64, false, 9);
+    assert(delivered == 64 && reader->available() == 64);
+    assert(wrapper.readPlanar(xi.data(), xq.data(), 120) == 64 && xi[63] == 9);
+
+    // Back to interleaved storage
+    wrapper.setSampleCallback(nullptr);
+    wrapper.configureBuffer(4096, RingLayout::Standard);
+    assert(!wrapper.isPlanarStorage());
+    deliverPacket(wrapper, 0, 10, true, 1);
+    assert(wrapper.readPlanar(xi.data(), xq.data(), 120) == 0);
+    assert(wrapper.peekSamples(10).size() == 10);
+
+    std::cout << "Planar storage test passed" << std::endl;
+}
+
+// Test servicing two wrappers from one epoll loop
+void testSampleEvent() {
+    std::cout << "Testing sample event descriptor..." << std::endl;
+
+#if defined(__linux__)
+    CallbackWrapper first(4096);
+    CallbackWrapper second(4096);
+    first.prepareStream();
+    second.prepareStream();
+    deliverPacket(first, 0, 100, true);
+    deliverPacket(second, 0, 100, true);
+
+    int firstFd = first.enableSampleEvent(250);
+    int secondFd = second.enableSampleEvent(50);  // Already met: signalled at once
+    assert(firstFd >= 0 && secondFd >= 0 && firstFd != secondFd);
+
+    int epfd = epoll_create1(0);
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = &first;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, firstFd, &ev);
+    ev.data.ptr = &second;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, secondFd, &ev);
+
+    epoll_event events[2];
+    assert(epoll_wait(epfd, events, 2, 0) == 1 && events[0].data.ptr == &second);
+
+    // Three packets cross the first watermark once
+    deliverPacket(first, 100, 100);
+    assert(epoll_wait(epfd, events, 2, 0) == 1);
+    deliverPacket(first, 200, 100);
+    deliverPacket(first, 300, 100);
+    assert(first.getSampleEventCount() == 1);
+
+    std::vector<std::complex<short>> dest(4096);
+    int ready = epoll_wait(epfd, events, 2, 0);
+    assert(ready == 2);
+    for (int i = 0; i < ready; ++i) {
+        CallbackWrapper* wrapper = static_cast<CallbackWrapper*>(events[i].data.ptr);
+        wrapper->readSamples(dest.data(), dest.size());
+        wrapper->acknowledgeSampleEvent();
+    }
+    assert(epoll_wait(epfd, events, 2, 0) == 0);
+
+    // Acknowledging while still above the watermark signals again
+    deliverPacket(first, 400, 300);
+    first.acknowledgeSampleEvent();
+    assert(epoll_wait(epfd, events, 2, 0) == 1 && first.getSampleEventCount() == 3);
+
+    first.disableSampleEvent();
+    first.acknowledgeSampleEvent();
+    deliverPacket(first, 700, 300);
+    assert(epoll_wait(epfd, events, 2, 0) == 0);
+    close(epfd);
+#endif
+
+    std::cout << "Sample event descriptor test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testContinuousStream();
+        testGapDetection();
+        testGapFill();
+        testSampleReaders();
+        testDispatcher();
+        testSlowDispatchedCallback();
+        testCallbackSwapWhileStreaming();
+        testBlockCoalescing();
+        testDispatcherBlocks();
+        testSampleFormats();
+        testPlanarStorage();
+        testSampleEvent();
+
+        std::cout << "All callback wrapper tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
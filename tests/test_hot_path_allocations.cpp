@@ -0,0 +1,411 @@
+// Fails if the stream, ring or event paths allocate once warmed up.
+//
+// Replaces the global operator new/delete (and, on glibc builds without a
+// sanitizer, malloc itself) with counting versions, then drives the
+// wrapper through the static callbacks the API calls, using the stream and
+// event parameters of the mock API in test_sdrplay_api.h.
+#include "callback_wrapper.h"
+#include "sample_buffer.h"
+#include "planar_buffer.h"
+#include "broadcast_buffer.h"
+#include <atomic>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__has_feature)
+    #if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+        #define SDRPLAY_SANITIZED 1
+    #endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    #define SDRPLAY_SANITIZED 1
+#endif
+#if defined(__GLIBC__) && !defined(SDRPLAY_SANITIZED)
+    #define SDRPLAY_HOOK_MALLOC 1
+#endif
+
+// The replacement operators hand malloc() blocks to free(), which GCC
+// mistakes for a new/free mismatch once they are inlined
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+    std::atomic<bool> counting(false);
+    std::atomic<uint64_t> allocations(0);
+
+    void noteAllocation() {
+        if (counting.load(std::memory_order_relaxed)) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+#if defined(SDRPLAY_HOOK_MALLOC)
+// Wrap glibc's allocator so C allocations (and std::aligned_alloc) count too
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* block, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* block);
+
+void* malloc(size_t size) {
+    noteAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    noteAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* block, size_t size) {
+    noteAllocation();
+    return __libc_realloc(block, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    noteAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** block, size_t alignment, size_t size) {
+    noteAllocation();
+    *block = __libc_memalign(alignment, size);
+    return *block ? 0 : ENOMEM;
+}
+
+void free(void* block) {
+    __libc_free(block);
+}
+}
+
+namespace {
+    void* rawAllocate(size_t size) { return __libc_malloc(size ? size : 1); }
+    void* rawAllocateAligned(size_t size, size_t alignment) { return __libc_memalign(alignment, size ? size : 1); }
+    void rawFree(void* block) { __libc_free(block); }
+}
+#else
+namespace {
+    void* rawAllocate(size_t size) { return std::malloc(size ? size : 1); }
+    void* rawAllocateAligned(size_t size, size_t alignment) {
+        return std::aligned_alloc(alignment, (std::max<size_t>(size, 1) + alignment - 1) & ~(alignment - 1));
+    }
+    void rawFree(void* block) { std::free(block); }
+}
+#endif
+
+void* operator new(size_t size) {
+    noteAllocation();
+    void* block = rawAllocate(size);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    noteAllocation();
+    return rawAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    noteAllocation();
+    return rawAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    noteAllocation();
+    void* block = rawAllocateAligned(size, static_cast<size_t>(alignment));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* block) noexcept { rawFree(block); }
+void operator delete[](void* block) noexcept { rawFree(block); }
+void operator delete(void* block, size_t) noexcept { rawFree(block); }
+void operator delete[](void* block, size_t) noexcept { rawFree(block); }
+void operator delete(void* block, std::align_val_t) noexcept { rawFree(block); }
+void operator delete[](void* block, std::align_val_t) noexcept { rawFree(block); }
+void operator delete(void* block, size_t, std::align_val_t) noexcept { rawFree(block); }
+void operator delete[](void* block, size_t, std::align_val_t) noexcept { rawFree(block); }
+
+using namespace sdrplay;
+
+namespace {
+    const unsigned int PACKET_SAMPLES = 1008;  // Typical API packet
+    const int WARMUP_PACKETS = 64;
+    const int MEASURED_PACKETS = 2000;
+
+    // Packet source shaped like the API's stream callback arguments
+    struct MockStream {
+        std::vector<short> xi;
+        std::vector<short> xq;
+        sdrplay_api_StreamCbParamsT params;
+        unsigned int nextSampleNum;
+
+        MockStream() : xi(PACKET_SAMPLES), xq(PACKET_SAMPLES), params(), nextSampleNum(0) {
+            for (unsigned int i = 0; i < PACKET_SAMPLES; ++i) {
+                xi[i] = static_cast<short>(i);
+                xq[i] = static_cast<short>(-static_cast<int>(i));
+            }
+        }
+
+        void deliver(CallbackWrapper& wrapper, bool reset = false, unsigned int skip = 0) {
+            nextSampleNum += skip;
+            params = sdrplay_api_StreamCbParamsT();
+            params.firstSampleNum = nextSampleNum;
+            params.numSamples = PACKET_SAMPLES;
+            CallbackWrapper::streamCallback(xi.data(), xq.data(), &params, PACKET_SAMPLES,
+                                            reset ? 1 : 0, wrapper.getContext());
+            nextSampleNum += PACKET_SAMPLES;
+        }
+    };
+
+    int failures = 0;
+
+    // Run step() for the warm-up packets, then count what the measured ones allocate
+    void expectNoAllocations(const std::string& name, const std::function<void(int)>& step) {
+        for (int i = 0; i < WARMUP_PACKETS; ++i) {
+            step(i);
+        }
+        allocations.store(0);
+        counting.store(true);
+        for (int i = 0; i < MEASURED_PACKETS; ++i) {
+            step(WARMUP_PACKETS + i);
+        }
+        counting.store(false);
+
+        uint64_t count = allocations.load();
+        std::cout << "  " << name << ": " << count << " allocations" << std::endl;
+        if (count != 0) {
+            ++failures;
+        }
+    }
+}
+
+// Test the stream callback with the buffer and callback features it feeds
+void testStreamPath() {
+    std::cout << "Testing stream path allocations..." << std::endl;
+
+    {
+        CallbackWrapper wrapper(65536);
+        wrapper.prepareStream(PACKET_SAMPLES);
+        std::vector<std::complex<short>> out(PACKET_SAMPLES);
+        uint64_t seen = 0;
+        wrapper.setSampleCallback([&seen](const std::complex<short>*, size_t count) { seen += count; });
+        MockStream stream;
+        expectNoAllocations("interleaved buffer, inline CS16 callback", [&](int i) {
+            stream.deliver(wrapper, i == 0);
+            wrapper.readSamples(out.data(), out.size());
+        });
+        assert(seen > 0);
+    }
+
+    {
+        CallbackWrapper wrapper(65536);
+        wrapper.prepareStream(PACKET_SAMPLES);
+        wrapper.setSampleFormat(SampleFormat::CF32);
+        wrapper.setCallbackBlockSize(4096, 5);
+        wrapper.setSampleCallback([](const std::complex<float>*, size_t) {});
+        wrapper.setOverflowPolicy(OverflowPolicy::DropOldest);
+        MockStream stream;
+        expectNoAllocations("CF32 callback, block coalescing, drop-oldest overflow", [&](int i) {
+            stream.deliver(wrapper, i == 0);
+        });
+    }
+
+    {
+        CallbackWrapper wrapper(65536);
+        wrapper.prepareStream(PACKET_SAMPLES);
+        wrapper.setGapFill(true);
+        auto reader = wrapper.addSampleReader();
+        std::vector<std::complex<short>> out(PACKET_SAMPLES * 2);
+        int fd = wrapper.enableSampleEvent(PACKET_SAMPLES * 4);
+        MockStream stream;
+        expectNoAllocations("broadcast reader, gap fill, stream tags, sample event", [&](int i) {
+            stream.deliver(wrapper, i == 0, i % 8 == 7 ? 100 : 0);
+            reader->read(out.data(), out.size());
+            if (i % 4 == 3) {
+                wrapper.readSamples(out.data(), out.size());
+                if (fd >= 0) {
+                    wrapper.acknowledgeSampleEvent();
+                }
+            }
+        });
+        assert(wrapper.getMissingSampleCount() > 0);
+    }
+
+    {
+        CallbackWrapper wrapper(65536);
+        wrapper.configureBuffer(65536, RingLayout::Standard, true);
+        wrapper.prepareStream(PACKET_SAMPLES);
+        wrapper.setSampleFormat(SampleFormat::CS8);
+        wrapper.setSampleCallback([](const int8_t*, size_t) {});
+        std::vector<short> xi(PACKET_SAMPLES), xq(PACKET_SAMPLES);
+        MockStream stream;
+        expectNoAllocations("planar storage, CS8 callback", [&](int i) {
+            stream.deliver(wrapper, i == 0);
+            wrapper.readPlanar(xi.data(), xq.data(), xi.size());
+        });
+    }
+
+    {
+        CallbackWrapper wrapper(65536);
+        wrapper.prepareStream(PACKET_SAMPLES);
+        wrapper.enableSampleBlocks(32, PACKET_SAMPLES);
+        // Consumers keep the last few blocks in preallocated slots
+        std::vector<SampleBlockRef> recent(8), display(4);
+        size_t recentSlot = 0, displaySlot = 0;
+        wrapper.addBlockConsumer([&](const SampleBlockRef& block) {
+            recent[recentSlot++ % recent.size()] = block;
+        });
+        wrapper.addBlockConsumer([&](const SampleBlockRef& block) {
+            display[displaySlot++ % display.size()] = block;
+        });
+        MockStream stream;
+        expectNoAllocations("pooled blocks, two consumers", [&](int i) {
+            stream.deliver(wrapper, i == 0);
+        });
+        assert(wrapper.getBlockPoolStats().droppedSamples == 0);
+    }
+
+    {
+        CallbackWrapper wrapper(65536);
+        wrapper.prepareStream(PACKET_SAMPLES);
+        std::atomic<uint64_t> dispatched(0);
+        wrapper.setSampleCallback([&dispatched](const std::complex<short>*, size_t count) {
+            dispatched.fetch_add(count);
+        });
+        wrapper.setCallbackMode(CallbackMode::Dispatcher);
+        std::vector<std::complex<short>> out(PACKET_SAMPLES);
+        MockStream stream;
+        uint64_t delivered = 0;
+        expectNoAllocations("dispatcher thread", [&](int i) {
+            stream.deliver(wrapper, i == 0);
+            delivered += PACKET_SAMPLES;
+            wrapper.readSamples(out.data(), out.size());
+            // Keep the dispatcher inside the measured window
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (dispatched.load() < delivered && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        });
+        wrapper.setCallbackMode(CallbackMode::Inline);
+    }
+
+    std::cout << "Stream path allocations test done" << std::endl;
+}
+
+// Test the ring buffers on their own
+void testRingPath() {
+    std::cout << "Testing ring path allocations..." << std::endl;
+
+    std::vector<std::complex<short>> in(PACKET_SAMPLES, std::complex<short>(1, -1)), out(PACKET_SAMPLES);
+    std::vector<short> xi(PACKET_SAMPLES, 1), xq(PACKET_SAMPLES, -1);
+
+    for (RingLayout layout : {RingLayout::Standard, RingLayout::Mirrored}) {
+        SampleBuffer samples(16384, layout);
+        samples.setOverflowPolicy(OverflowPolicy::DropOldest);
+        PlanarBuffer planar(16384, layout);
+        auto broadcast = std::make_shared<BroadcastBuffer>(16384, layout);
+        auto reader = broadcast->addReader(ReaderOverflowPolicy::SkipToNewest);
+        std::string name = layout == RingLayout::Standard ? "standard" : "mirrored";
+
+        expectNoAllocations(name + " rings", [&](int i) {
+            samples.write(in.data(), in.size());
+            planar.write(xi.data(), xq.data(), xi.size());
+            broadcast->write(in.data(), in.size());
+            if (i % 3 == 0) {
+                samples.read(out.data(), out.size());
+                SampleSpans spans = samples.peek(PACKET_SAMPLES);
+                samples.consume(spans.size());
+                planar.read(xi.data(), xq.data(), xi.size());
+                reader->read(out.data(), out.size());
+            }
+        });
+    }
+
+    std::cout << "Ring path allocations test done" << std::endl;
+}
+
+// Test device events reach the event callback without allocating
+void testEventPath() {
+    std::cout << "Testing event path allocations..." << std::endl;
+
+    CallbackWrapper wrapper(4096);
+    int events = 0;
+    wrapper.setEventCallback([&events](EventType, const EventParams&) { ++events; });
+    sdrplay_api_EventParamsT params = {};
+    params.powerOverloadParams.powerOverloadChangeType = sdrplay_api_Overload_Detected;
+
+    expectNoAllocations("gain and overload events", [&](int i) {
+        sdrplay_api_EventT id = i % 2 ? sdrplay_api_PowerOverloadChange : sdrplay_api_GainChange;
+        CallbackWrapper::eventCallback(id, sdrplay_api_Tuner_A, &params, wrapper.getContext());
+    });
+    assert(events == WARMUP_PACKETS + MEASURED_PACKETS);
+
+    std::cout << "Event path allocations test done" << std::endl;
+}
+
+// Make sure the hooks are live, so a clean run means something
+void testHooks() {
+    std::cout << "Testing allocation hooks..." << std::endl;
+
+    counting.store(true);
+    void* block = ::operator new(64);
+    ::operator delete(block);
+#if defined(SDRPLAY_HOOK_MALLOC)
+    void* (*volatile allocate)(size_t) = &std::malloc;
+    std::free(allocate(64));
+#endif
+    counting.store(false);
+#if defined(SDRPLAY_HOOK_MALLOC)
+    assert(allocations.exchange(0) == 2);
+#else
+    assert(allocations.exchange(0) == 1);
+#endif
+
+    std::cout << "Allocation hooks test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testHooks();
+        testStreamPath();
+        testRingPath();
+        testEventPath();
+
+        if (failures > 0) {
+            std::cerr << failures << " hot path(s) allocated after warm-up" << std::endl;
+            return 1;
+        }
+        std::cout << "All hot path allocation tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
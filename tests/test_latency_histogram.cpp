@@ -0,0 +1,102 @@
+#include "latency_histogram.h"
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+// Test that every value lands in a bucket that brackets it
+void testBuckets() {
+    std::cout << "Testing histogram buckets..." << std::endl;
+
+    assert(LatencyHistogram::bucketIndex(0) == 0);
+    assert(LatencyHistogram::bucketIndex(7) == 7);
+    assert(LatencyHistogram::bucketIndex(UINT64_MAX) == LatencyHistogram::BUCKETS - 1);
+
+    for (uint64_t v = 1; v < (uint64_t(1) << 62); v = v * 3 + 1) {
+        size_t index = LatencyHistogram::bucketIndex(v);
+        uint64_t low = LatencyHistogram::bucketLowerBound(index);
+        uint64_t next = LatencyHistogram::bucketLowerBound(index + 1);
+        assert(low <= v && v < next);
+        assert(next - low <= low / LatencyHistogram::SUB_BUCKETS + 1);  // Within 12.5%
+    }
+
+    std::cout << "Histogram bucket test passed" << std::endl;
+}
+
+// Test summary statistics and percentiles
+void testPercentiles() {
+    std::cout << "Testing histogram percentiles..." << std::endl;
+
+    LatencyHistogram histogram;
+    assert(histogram.count() == 0 && histogram.percentile(50) == 0 && histogram.min() == 0);
+
+    // 1..1000 us, one value each
+    for (uint64_t us = 1; us <= 1000; ++us) {
+        histogram.record(us * 1000);
+    }
+    assert(histogram.count() == 1000);
+    assert(histogram.min() == 1000 && histogram.max() == 1000000);
+    assert(histogram.mean() == 500500.0);
+
+    uint64_t p50 = histogram.percentile(50);
+    uint64_t p99 = histogram.percentile(99);
+    assert(p50 >= 500000 && p50 <= 500000 * 9 / 8);
+    assert(p99 >= 990000 && p99 <= 1000000);
+    assert(histogram.percentile(100) == 1000000);
+    assert(histogram.percentile(0) <= 1000 * 9 / 8);
+
+    LatencyHistogram other;
+    other.record(5);
+    other.record(2000000);
+    histogram.merge(other);
+    assert(histogram.count() == 1002 && histogram.min() == 5 && histogram.max() == 2000000);
+
+    histogram.reset();
+    assert(histogram.count() == 0 && histogram.max() == 0);
+
+    std::cout << "Histogram percentile test passed" << std::endl;
+}
+
+// Test recording from several threads at once
+void testConcurrentRecord() {
+    std::cout << "Testing concurrent recording..." << std::endl;
+
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram, t]() {
+            for (uint64_t i = 0; i < 100000; ++i) {
+                histogram.record(i * (t + 1));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        sum += histogram.bucketCount(i);
+    }
+    assert(sum == 400000 && histogram.count() == 400000);
+    assert(histogram.min() == 0 && histogram.max() == 99999 * 4);
+
+    std::cout << "Concurrent recording test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testBuckets();
+        testPercentiles();
+        testConcurrentRecord();
+
+        std::cout << "All latency histogram tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
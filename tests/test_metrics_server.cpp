@@ -0,0 +1,152 @@
+#include "metrics_server.h"
+#include "sdrplay_wrapper.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #define HAVE_SOCKETS 1
+#endif
+
+using namespace sdrplay;
+
+namespace {
+    bool contains(const std::string& text, const std::string& pattern) {
+        return text.find(pattern) != std::string::npos;
+    }
+
+#if defined(HAVE_SOCKETS)
+    int connectTo(uint16_t port) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        int result = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        assert(result == 0);
+        return fd;
+    }
+
+    // Send a raw request and read the response until the server closes
+    std::string request(uint16_t port, const std::string& text) {
+        int fd = connectTo(port);
+        ssize_t sent = ::send(fd, text.data(), text.size(), 0);
+        assert(sent == static_cast<ssize_t>(text.size()));
+        std::string response;
+        char chunk[4096];
+        ssize_t n;
+        while ((n = ::recv(fd, chunk, sizeof(chunk), 0)) > 0) {
+            response.append(chunk, static_cast<size_t>(n));
+        }
+        ::close(fd);
+        return response;
+    }
+#endif
+}
+
+// Test the exposition format for an idle device
+void testRender() {
+    std::cout << "Testing metrics rendering..." << std::endl;
+
+    MetricsServer server;
+    std::string empty = server.renderMetrics();
+    assert(contains(empty, "# TYPE sdrplay_stream_sample_rate_hertz gauge\n"));
+    assert(contains(empty, "# TYPE sdrplay_events_total counter\n"));
+    assert(!contains(empty, "{device="));
+
+    Device device;
+    server.addDevice(device, "rx \"1\"");
+    std::string text = server.renderMetrics();
+    assert(contains(text, "sdrplay_streaming{device=\"rx \\\"1\\\"\"} 0\n"));
+    assert(contains(text, "sdrplay_dropped_samples_total{device=\"rx \\\"1\\\"\"} 0\n"));
+    assert(contains(text, "sdrplay_events_total{device=\"rx \\\"1\\\"\",type=\"power_overload\"} 0\n"));
+    assert(contains(text, "sdrplay_stream_packet_samples_bucket{device=\"rx \\\"1\\\"\",le=\"1023\"} 0\n"));
+    assert(contains(text, "sdrplay_stream_packet_samples_bucket{device=\"rx \\\"1\\\"\",le=\"+Inf\"} 0\n"));
+    assert(contains(text, "sdrplay_control_latency_seconds{device=\"rx \\\"1\\\"\",operation=\"update\",quantile=\"0.99\"} NaN\n"));
+    assert(!contains(text, "sdrplay_seconds_since_last_callback{"));
+
+    // Adding again renames; removing stops publishing
+    server.addDevice(device, "rx1");
+    text = server.renderMetrics();
+    assert(contains(text, "sdrplay_streaming{device=\"rx1\"} 0\n"));
+    assert(!contains(text, "rx \\\"1\\\""));
+    server.removeDevice(device);
+    assert(server.renderMetrics() == empty);
+
+    std::cout << "Metrics rendering test passed" << std::endl;
+}
+
+// Test serving the metrics over HTTP
+void testServer() {
+    std::cout << "Testing metrics HTTP server..." << std::endl;
+
+    MetricsServer server;
+    assert(!server.isRunning() && server.getPort() == 0);
+    bool started = server.start(0, "not-an-address");
+    assert(!started && !server.getLastError().empty());
+
+#if defined(HAVE_SOCKETS)
+    Device device;
+    server.addDevice(device, "rx1");
+    started = server.start(0);
+    assert(started && server.isRunning());
+    uint16_t port = server.getPort();
+    assert(port != 0);
+    assert(!server.start(0));
+
+    std::string response = request(port, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    assert(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+    assert(contains(response, "Content-Type: text/plain; version=0.0.4"));
+    assert(contains(response, "sdrplay_streaming{device=\"rx1\"} 0\n"));
+
+    response = request(port, "GET /metrics?x=1 HTTP/1.0\r\n\r\n");
+    assert(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+
+    response = request(port, "HEAD /metrics HTTP/1.1\r\n\r\n");
+    assert(response.compare(0, 15, "HTTP/1.1 200 OK") == 0 && !contains(response, "sdrplay_"));
+
+    response = request(port, "GET / HTTP/1.1\r\n\r\n");
+    assert(response.compare(0, 22, "HTTP/1.1 404 Not Found") == 0);
+
+    response = request(port, "POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+    assert(response.compare(0, 31, "HTTP/1.1 405 Method Not Allowed") == 0);
+
+    // A client that never sends its request does not hold up stop()
+    int stalled = connectTo(port);
+    auto start = std::chrono::steady_clock::now();
+    server.stop();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ::close(stalled);
+    assert(elapsed < std::chrono::milliseconds(900));
+    assert(!server.isRunning() && server.getPort() == 0);
+
+    // The server can be restarted
+    started = server.start(0);
+    assert(started);
+    response = request(server.getPort(), "GET /metrics HTTP/1.1\r\n\r\n");
+    assert(contains(response, "sdrplay_streaming{device=\"rx1\"} 0\n"));
+    server.removeDevice(device);
+    server.stop();
+#endif
+
+    std::cout << "Metrics HTTP server test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testRender();
+        testServer();
+
+        std::cout << "All metrics server tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,189 @@
+#include "planar_buffer.h"
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+    // I counts up from start; Q is its negation
+    void makeRamp(size_t count, size_t start, std::vector<short>& xi, std::vector<short>& xq) {
+        xi.resize(count);
+        xq.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            xi[i] = static_cast<short>((start + i) & 0x7fff);
+            xq[i] = static_cast<short>(-xi[i]);
+        }
+    }
+
+    bool isAligned(const short* p) {
+        return reinterpret_cast<uintptr_t>(p) % RingStorage::ALIGNMENT == 0;
+    }
+}
+
+// Test writes and reads across the wrap point
+void testReadWrite() {
+    std::cout << "Testing planar read/write..." << std::endl;
+
+    PlanarBuffer buffer(1000);
+    assert(buffer.capacity() == 1024);
+
+    std::vector<short> xi, xq;
+    std::vector<short> outI(1024), outQ(1024);
+    size_t next = 0;
+    for (int round = 0; round < 5; ++round) {
+        makeRamp(700, next, xi, xq);
+        assert(buffer.write(xi.data(), xq.data(), xi.size()));
+        assert(buffer.available() == 700);
+
+        size_t n = buffer.read(outI.data(), outQ.data(), outI.size());
+        assert(n == 700);
+        for (size_t i = 0; i < n; ++i) {
+            assert(outI[i] == xi[i] && outQ[i] == xq[i]);
+        }
+        next += n;
+    }
+    assert(buffer.readIndex() == next && buffer.writeIndex() == next);
+
+    std::cout << "Planar read/write test passed" << std::endl;
+}
+
+// Test zero-copy access, including a region split by the wrap
+void testPeekConsume() {
+    std::cout << "Testing planar peek/consume..." << std::endl;
+
+    PlanarBuffer buffer(1024);
+    std::vector<short> xi, xq;
+    std::vector<short> sink(1024);
+    makeRamp(900, 0, xi, xq);
+    buffer.write(xi.data(), xq.data(), xi.size());
+    buffer.read(sink.data(), sink.data(), 900);
+
+    makeRamp(300, 900, xi, xq);
+    buffer.write(xi.data(), xq.data(), xi.size());
+
+    PlanarSpans spans = buffer.peek(1024);
+    assert(spans.size() == 300);
+    assert(spans.first.size == 124 && spans.second.size == 176);
+    assert(isAligned(spans.second.i) && isAligned(spans.second.q));
+    assert(spans.first.i[0] == 900 && spans.first.q[0] == -900);
+    assert(spans.second.i[0] == 1024 && spans.second.q[175] == -1199);
+
+    assert(buffer.consume(spans.size()) == 300);
+    assert(buffer.available() == 0);
+
+    std::cout << "Planar peek/consume test passed" << std::endl;
+}
+
+// Test both overflow policies drop and count the right samples
+void testOverflow() {
+    std::cout << "Testing planar overflow..." << std::endl;
+
+    std::vector<short> xi, xq;
+    std::vector<short> outI(256), outQ(256);
+
+    PlanarBuffer newest(256);
+    makeRamp(200, 0, xi, xq);
+    newest.write(xi.data(), xq.data(), xi.size());
+    makeRamp(100, 200, xi, xq);
+    assert(!newest.write(xi.data(), xq.data(), xi.size()));
+    assert(newest.droppedSamples() == 44 && newest.overflowEvents() == 1);
+    assert(newest.read(outI.data(), outQ.data(), 256) == 256);
+    assert(outI[255] == 255 && outQ[255] == -255);
+
+    PlanarBuffer oldest(256);
+    oldest.setOverflowPolicy(OverflowPolicy::DropOldest);
+    makeRamp(200, 0, xi, xq);
+    oldest.write(xi.data(), xq.data(), xi.size());
+    makeRamp(100, 200, xi, xq);
+    assert(!oldest.write(xi.data(), xq.data(), xi.size()));
+    assert(oldest.droppedSamples() == 44);
+    assert(oldest.readIndex() == 44);
+    assert(oldest.read(outI.data(), outQ.data(), 256) == 256);
+    assert(outI[0] == 44 && outQ[255] == -299);
+
+    std::cout << "Planar overflow test passed" << std::endl;
+}
+
+// Test that a mirrored buffer exposes every region as one span
+void testMirroredLayout() {
+    std::cout << "Testing mirrored planar layout..." << std::endl;
+
+    PlanarBuffer buffer(4096, RingLayout::Mirrored);
+    if (buffer.layout() != RingLayout::Mirrored) {
+        std::cout << "Mirrored layout unavailable, skipped" << std::endl;
+        return;
+    }
+
+    size_t capacity = buffer.capacity();
+    std::vector<short> xi, xq;
+    std::vector<short> sink(capacity);
+    makeRamp(capacity - 10, 0, xi, xq);
+    buffer.write(xi.data(), xq.data(), xi.size());
+    buffer.read(sink.data(), sink.data(), capacity - 10);
+
+    makeRamp(100, capacity - 10, xi, xq);
+    buffer.write(xi.data(), xq.data(), xi.size());
+    PlanarSpans spans = buffer.peek(100);
+    assert(spans.first.size == 100 && spans.second.size == 0);
+    for (size_t i = 0; i < 100; ++i) {
+        assert(spans.first.i[i] == xi[i] && spans.first.q[i] == xq[i]);
+    }
+
+    std::cout << "Mirrored planar layout test passed" << std::endl;
+}
+
+// Test a producer and consumer running concurrently
+void testConcurrentTransfer() {
+    std::cout << "Testing concurrent planar transfer..." << std::endl;
+
+    const size_t total = 1 << 20;
+    const size_t packet = 1344;
+    PlanarBuffer buffer(8192);
+    buffer.setOverflowPolicy(OverflowPolicy::BlockWithTimeout, 1000);
+
+    std::thread producer([&buffer, total, packet]() {
+        std::vector<short> xi, xq;
+        size_t sent = 0;
+        while (sent < total) {
+            size_t n = std::min(packet, total - sent);
+            makeRamp(n, sent, xi, xq);
+            buffer.write(xi.data(), xq.data(), n);
+            sent += n;
+        }
+    });
+
+    std::vector<short> outI(4096), outQ(4096);
+    size_t received = 0;
+    while (received < total) {
+        buffer.waitForSamples(1, 100);
+        size_t n = buffer.read(outI.data(), outQ.data(), outI.size());
+        for (size_t i = 0; i < n; ++i) {
+            short v = static_cast<short>((received + i) & 0x7fff);
+            assert(outI[i] == v && outQ[i] == -v);
+        }
+        received += n;
+    }
+    producer.join();
+    assert(buffer.droppedSamples() == 0);
+
+    std::cout << "Concurrent planar transfer test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testReadWrite();
+        testPeekConsume();
+        testOverflow();
+        testMirroredLayout();
+        testConcurrentTransfer();
+
+        std::cout << "All planar buffer tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
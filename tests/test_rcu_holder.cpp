@@ -0,0 +1,111 @@
+#include "rcu_holder.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+    std::atomic<int> liveValues(0);
+
+    // Two fields that writers always keep equal, so torn or freed reads show up
+    struct Value {
+        uint64_t a;
+        uint64_t b;
+        std::atomic<bool> alive;
+
+        Value() : a(0), b(0), alive(true) { ++liveValues; }
+        Value(const Value& other) : a(other.a), b(other.b), alive(true) { ++liveValues; }
+        ~Value() { alive = false; --liveValues; }
+    };
+}
+
+// Test basic publish and reclamation
+void testUpdate() {
+    std::cout << "Testing RCU update..." << std::endl;
+
+    {
+        RcuHolder<Value> holder;
+        assert(holder.read()->a == 0);
+        assert(liveValues == 1);
+
+        holder.update([](Value& value) { value.a = value.b = 7; });
+        assert(holder.read()->a == 7);
+        assert(liveValues == 1);  // The old value was reclaimed
+
+        // A guard keeps seeing the value it was taken on
+        auto guard = holder.read();
+        std::thread writer([&holder]() {
+            holder.update([](Value& value) { value.a = value.b = 8; });
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        assert(guard->a == 7 && guard->alive);
+        assert(holder.read()->a == 8);
+        {
+            auto released = std::move(guard);
+        }
+        writer.join();
+        assert(liveValues == 1);
+    }
+    assert(liveValues == 0);
+
+    std::cout << "RCU update test passed" << std::endl;
+}
+
+// Test readers against a writer replacing the value continuously
+void testConcurrentReaders() {
+    std::cout << "Testing concurrent RCU readers..." << std::endl;
+
+    RcuHolder<Value> holder;
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> reads(0);
+
+    auto reader = [&]() {
+        uint64_t last = 0;
+        while (!done.load()) {
+            auto value = holder.read();
+            assert(value->alive);
+            assert(value->a == value->b);
+            assert(value->a >= last);
+            last = value->a;
+            ++reads;
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back(reader);
+    }
+
+    // Keep writing until the readers have overlapped plenty of updates
+    uint64_t n = 0;
+    while (n < 20000 || reads.load() < 100000) {
+        ++n;
+        holder.update([n](Value& value) { value.a = value.b = n; });
+    }
+    done = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    assert(holder.read()->a == n);
+    assert(liveValues == 1);
+
+    std::cout << "Concurrent RCU reader test passed (" << reads.load() << " reads)" << std::endl;
+}
+
+int main() {
+    try {
+        testUpdate();
+        testConcurrentReaders();
+
+        std::cout << "All RCU holder tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,146 @@
+#include "ring_allocator.h"
+#include "ring_storage.h"
+#include "sample_buffer.h"
+#include "planar_buffer.h"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <complex>
+
+using namespace sdrplay;
+
+namespace {
+    // Heap allocator that counts outstanding blocks
+    class CountingAllocator : public RingAllocator {
+    public:
+        std::atomic<int> live{0};
+        std::atomic<size_t> bytes{0};
+
+        void* allocate(size_t size) override {
+            ++live;
+            bytes += size;
+            return HeapRingAllocator::instance()->allocate(size);
+        }
+
+        void deallocate(void* block, size_t size) override {
+            --live;
+            bytes -= size;
+            HeapRingAllocator::instance()->deallocate(block, size);
+        }
+
+        const char* name() const override { return "counting"; }
+    };
+
+    bool isAligned(const void* p, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+    }
+}
+
+// Test the default heap allocator
+void testHeapAllocator() {
+    std::cout << "Testing heap allocator..." << std::endl;
+
+    auto heap = HeapRingAllocator::instance();
+    assert(heap == HeapRingAllocator::instance());
+    for (size_t size : {1, 63, 64, 4096, 1000000}) {
+        unsigned char* block = static_cast<unsigned char*>(heap->allocate(size));
+        assert(block && isAligned(block, RingStorage::ALIGNMENT));
+        for (size_t i = 0; i < size; ++i) {
+            assert(block[i] == 0);
+        }
+        heap->deallocate(block, size);
+    }
+
+    std::cout << "Heap allocator test passed" << std::endl;
+}
+
+// Test that buffers take their storage from a custom allocator
+void testCustomAllocator() {
+    std::cout << "Testing custom allocator..." << std::endl;
+
+    auto counting = std::make_shared<CountingAllocator>();
+    {
+        SampleBuffer buffer(4096, RingLayout::Standard, counting);
+        assert(counting->live == 1 && counting->bytes == 4096 * sizeof(std::complex<short>));
+
+        std::vector<std::complex<short>> in(1000, std::complex<short>(3, -3)), out(1000);
+        buffer.write(in.data(), in.size());
+        assert(buffer.read(out.data(), out.size()) == 1000 && out[999] == in[999]);
+
+        // Reallocation frees the old block; the heap takes over when none is given
+        buffer.reconfigure(8192, RingLayout::Standard, counting);
+        assert(counting->live == 1 && counting->bytes == 8192 * sizeof(std::complex<short>));
+        buffer.reconfigure(8192, RingLayout::Standard);
+        assert(counting->live == 0);
+
+        PlanarBuffer planar(1024, RingLayout::Standard, counting);
+        assert(counting->live == 2);
+    }
+    assert(counting->live == 0 && counting->bytes == 0);
+
+    // Mirrored storage is mapped directly and skips the allocator
+    RingStorage mirrored(RingStorage::mirrorGranularity() ? RingStorage::mirrorGranularity() : 4096,
+                         RingLayout::Mirrored, counting);
+    assert(counting->live == (mirrored.mirrored() ? 0 : 1));
+
+    std::cout << "Custom allocator test passed" << std::endl;
+}
+
+// Test huge page allocation and NUMA placement
+void testHugePageAllocator() {
+    std::cout << "Testing huge page allocator..." << std::endl;
+
+    for (HugePageMode mode : {HugePageMode::Transparent, HugePageMode::Explicit}) {
+        auto huge = std::make_shared<HugePageRingAllocator>(mode);
+        SampleBuffer buffer(1 << 20, RingLayout::Standard, huge);
+
+        std::vector<std::complex<short>> in(4096), out(4096);
+        for (size_t i = 0; i < in.size(); ++i) {
+            in[i] = std::complex<short>(static_cast<short>(i), static_cast<short>(-static_cast<int>(i)));
+        }
+        for (int round = 0; round < 300; ++round) {
+            buffer.write(in.data(), in.size());
+            assert(buffer.read(out.data(), out.size()) == in.size());
+            assert(std::memcmp(in.data(), out.data(), in.size() * sizeof(in[0])) == 0);
+        }
+
+#if defined(__linux__)
+        HugePageAllocation where = huge->lastAllocation();
+        // Without a reserved hugetlbfs pool, Explicit falls back to transparent pages
+        assert(mode == HugePageMode::Explicit || !where.explicitHugePages);
+        assert(!(where.explicitHugePages && where.transparent));
+        assert(where.numaNode == -1 || where.numaNode == HugePageRingAllocator::currentNode());
+        std::cout << "  " << (where.explicitHugePages ? "explicit" : "transparent")
+                  << " huge pages, NUMA node " << where.numaNode << std::endl;
+#endif
+    }
+
+    // Blocks start on a huge page boundary
+    HugePageRingAllocator unbound(HugePageMode::Transparent, HugePageRingAllocator::NO_NODE);
+    void* block = unbound.allocate(3 << 20);
+    assert(block);
+#if defined(__linux__)
+    assert(isAligned(block, HugePageRingAllocator::HUGE_PAGE_SIZE));
+    assert(unbound.lastAllocation().numaNode == -1);
+#endif
+    unbound.deallocate(block, 3 << 20);
+
+    std::cout << "Huge page allocator test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testHeapAllocator();
+        testCustomAllocator();
+        testHugePageAllocator();
+
+        std::cout << "All ring allocator tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
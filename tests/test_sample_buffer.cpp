@@ -0,0 +1,338 @@
+#include "sample_buffer.h"
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <complex>
+#include <atomic>
+
+using namespace sdrplay;
+
+static std::vector<std::complex<short>> makeRamp(size_t count, size_t start) {
+    std::vector<std::complex<short>> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        short v = static_cast<short>((start + i) & 0x7fff);
+        samples[i] = std::complex<short>(v, static_cast<short>(-v));
+    }
+    return samples;
+}
+
+// Test capacity rounding and basic write/read
+void testBasicReadWrite() {
+    std::cout << "Testing basic read/write..." << std::endl;
+
+    SampleBuffer buffer(1000);
+    assert(buffer.capacity() == 1024);
+    assert(buffer.available() == 0);
+
+    auto in = makeRamp(100, 0);
+    assert(buffer.write(in.data(), in.size()));
+    assert(buffer.available() == 100);
+
+    std::vector<std::complex<short>> out(100);
+    assert(buffer.read(out.data(), out.size()) == 100);
+    assert(out == in);
+    assert(buffer.available() == 0);
+    assert(buffer.read(out.data(), out.size()) == 0);
+
+    std::cout << "Basic read/write test passed" << std::endl;
+}
+
+// Test that data survives the wrap-around boundary
+void testWrapAround() {
+    std::cout << "Testing wrap-around..." << std::endl;
+
+    SampleBuffer buffer(16);
+    std::vector<std::complex<short>> out(16);
+
+    auto first = makeRamp(12, 0);
+    assert(buffer.write(first.data(), first.size()));
+    assert(buffer.read(out.data(), 12) == 12);
+
+    // Straddles the end of storage
+    auto second = makeRamp(10, 12);
+    assert(buffer.write(second.data(), second.size()));
+    assert(buffer.read(out.data(), 10) == 10);
+    out.resize(10);
+    assert(out == second);
+
+    std::cout << "Wrap-around test passed" << std::endl;
+}
+
+// Test that a full buffer rejects writes and flags overflow
+void testOverflow() {
+    std::cout << "Testing overflow..." << std::endl;
+
+    SampleBuffer buffer(16);
+    auto in = makeRamp(16, 0);
+    assert(buffer.write(in.data(), in.size()));
+    assert(buffer.available() == 16);
+    assert(!buffer.overflow());
+
+    assert(!buffer.write(in.data(), 1));
+    assert(buffer.overflow());
+    assert(buffer.available() == 16);
+
+    buffer.reset();
+    assert(!buffer.overflow());
+    assert(buffer.available() == 0);
+
+    std::cout << "Overflow test passed" << std::endl;
+}
+
+// Test each overflow policy and the drop accounting
+void testOverflowPolicies() {
+    std::cout << "Testing overflow policies..." << std::endl;
+
+    std::vector<std::complex<short>> out(16);
+
+    // Drop newest keeps what fits and drops the rest of the packet
+    SampleBuffer newest(16);
+    auto first = makeRamp(12, 0);
+    auto second = makeRamp(8, 12);
+    assert(newest.write(first.data(), first.size()));
+    assert(!newest.write(second.data(), second.size()));
+    assert(newest.available() == 16);
+    assert(newest.droppedSamples() == 4);
+    assert(newest.overflowEvents() == 1);
+    assert(!newest.write(second.data(), 2));
+    assert(newest.droppedSamples() == 6);
+    assert(newest.overflowEvents() == 1);  // Same episode
+    assert(newest.read(out.data(), 16) == 16);
+    assert(out[15] == second[3]);
+    assert(newest.write(second.data(), 1));  // Ends the episode
+    assert(newest.write(first.data(), 12));
+    assert(!newest.write(second.data(), 4));
+    assert(newest.droppedSamples() == 7);
+    assert(newest.overflowEvents() == 2);
+
+    // Drop oldest overwrites unread samples so the newest data survives
+    SampleBuffer oldest(16);
+    oldest.setOverflowPolicy(OverflowPolicy::DropOldest);
+    assert(oldest.getOverflowPolicy() == OverflowPolicy::DropOldest);
+    assert(oldest.write(first.data(), first.size()));
+    assert(!oldest.write(second.data(), second.size()));
+    assert(oldest.available() == 16);
+    assert(oldest.droppedSamples() == 4);
+    assert(oldest.read(out.data(), 16) == 16);
+    assert(out[0] == first[4]);
+    assert(out[15] == second[7]);
+
+    // A packet larger than the buffer keeps only its newest samples
+    auto big = makeRamp(20, 100);
+    assert(!oldest.write(big.data(), big.size()));
+    assert(oldest.droppedSamples() == 8);
+    assert(oldest.overflowEvents() == 1);  // No clean write in between
+    assert(oldest.read(out.data(), 16) == 16);
+    assert(out[0] == big[4]);
+
+    // Block waits for the consumer, then falls back to dropping newest
+    SampleBuffer block(16);
+    block.setOverflowPolicy(OverflowPolicy::BlockWithTimeout, 2000);
+    assert(block.write(first.data(), first.size()));
+    std::thread consumer([&block]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::vector<std::complex<short>> drain(8);
+        block.read(drain.data(), drain.size());
+    });
+    assert(block.write(second.data(), second.size()));
+    consumer.join();
+    assert(block.droppedSamples() == 0);
+    assert(block.available() == 12);
+
+    block.setOverflowPolicy(OverflowPolicy::BlockWithTimeout, 10);
+    assert(!block.write(second.data(), second.size()));
+    assert(block.droppedSamples() == 4);
+
+    std::cout << "Overflow policies test passed" << std::endl;
+}
+
+// Test zero-copy peek/consume, including a region split by the wrap
+void testPeekConsume() {
+    std::cout << "Testing peek/consume..." << std::endl;
+
+    SampleBuffer buffer(16);
+    std::vector<std::complex<short>> out(16);
+
+    auto first = makeRamp(12, 0);
+    assert(buffer.write(first.data(), first.size()));
+    SampleSpans spans = buffer.peek(100);
+    assert(spans.size() == 12 && spans.second.size == 0);
+    assert(spans.first.data[5] == first[5]);
+    assert(buffer.consume(12) == 12);
+    assert(buffer.available() == 0);
+
+    auto second = makeRamp(10, 12);
+    assert(buffer.write(second.data(), second.size()));
+    spans = buffer.peek(10);
+    assert(spans.first.size == 4 && spans.second.size == 6);
+    assert(spans.first.data[0] == second[0]);
+    assert(spans.second.data[0] == second[4]);
+
+    // Partial consume keeps the rest readable
+    assert(buffer.consume(4) == 4);
+    assert(buffer.consume(100) == 6);
+    assert(buffer.available() == 0);
+
+    // A reset between peek and consume discards the peeked data
+    assert(buffer.write(first.data(), 8));
+    spans = buffer.peek(8);
+    assert(spans.size() == 8);
+    buffer.reset();
+    assert(buffer.consume(8) == 0);
+    assert(buffer.available() == 0);
+
+    std::cout << "Peek/consume test passed" << std::endl;
+}
+
+// Test the mirrored layout, which keeps wrapped regions contiguous
+void testMirroredLayout() {
+    std::cout << "Testing mirrored layout..." << std::endl;
+
+    SampleBuffer buffer(1024, RingLayout::Mirrored);
+    if (buffer.layout() != RingLayout::Mirrored) {
+        std::cout << "Mirrored mapping unavailable, fell back to standard layout" << std::endl;
+        assert(buffer.capacity() >= 1024);
+        return;
+    }
+
+    size_t capacity = buffer.capacity();
+    std::vector<std::complex<short>> out(capacity);
+
+    auto first = makeRamp(capacity - 100, 0);
+    assert(buffer.write(first.data(), first.size()));
+    assert(buffer.read(out.data(), first.size()) == first.size());
+
+    // Straddles the end of storage but must come back as one span
+    auto second = makeRamp(300, capacity - 100);
+    assert(buffer.write(second.data(), second.size()));
+    SampleSpans spans = buffer.peek(300);
+    assert(spans.first.size == 300 && spans.second.size == 0);
+    for (size_t i = 0; i < 300; ++i) {
+        assert(spans.first.data[i] == second[i]);
+    }
+    assert(buffer.consume(300) == 300);
+
+    // Reconfiguring back to the standard layout splits wrapped regions again
+    buffer.reconfigure(1024, RingLayout::Standard);
+    assert(buffer.layout() == RingLayout::Standard);
+    assert(buffer.available() == 0);
+
+    std::cout << "Mirrored layout test passed" << std::endl;
+}
+
+// Test waiting with and without data
+void testWaitForSamples() {
+    std::cout << "Testing waitForSamples..." << std::endl;
+
+    SampleBuffer buffer(64);
+    assert(!buffer.waitForSamples(1, 10));
+
+    std::thread producer([&buffer]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto in = makeRamp(32, 0);
+        buffer.write(in.data(), in.size());
+    });
+    assert(buffer.waitForSamples(32, 2000));
+    producer.join();
+
+    std::cout << "waitForSamples test passed" << std::endl;
+}
+
+// Test the spinning strategies wake up, time out and never miss a write
+void testWaitStrategies() {
+    std::cout << "Testing wait strategies..." << std::endl;
+
+    const WaitStrategy strategies[] = {WaitStrategy::SpinThenBlock, WaitStrategy::BusyPoll};
+    for (WaitStrategy strategy : strategies) {
+        for (unsigned int spinUs : {0u, 50u}) {
+            SampleBuffer buffer(64);
+            buffer.setWaitStrategy(strategy, spinUs);
+            assert(buffer.getWaitStrategy() == strategy);
+
+            auto start = std::chrono::steady_clock::now();
+            assert(!buffer.waitForSamples(1, 10));
+            assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(10));
+
+            // Ping-pong: each write must wake the consumer
+            const int rounds = 2000;
+            std::atomic<int> consumed(0);
+            std::thread producer([&buffer, &consumed, rounds]() {
+                auto in = makeRamp(1, 0);
+                for (int i = 0; i < rounds; ++i) {
+                    while (consumed.load() < i) {
+                        std::this_thread::yield();
+                    }
+                    buffer.write(in.data(), 1);
+                }
+            });
+            std::complex<short> out;
+            for (int i = 0; i < rounds; ++i) {
+                assert(buffer.waitForSamples(1, 5000));
+                assert(buffer.read(&out, 1) == 1);
+                consumed.store(i + 1);
+            }
+            producer.join();
+        }
+    }
+
+    std::cout << "Wait strategies test passed" << std::endl;
+}
+
+// Test ordering with a concurrent producer and consumer
+void testConcurrentTransfer() {
+    std::cout << "Testing concurrent transfer..." << std::endl;
+
+    const size_t total = 1 << 20;
+    const size_t packet = 1344;
+    SampleBuffer buffer(8192);
+    buffer.setOverflowPolicy(OverflowPolicy::BlockWithTimeout, 1000);
+
+    std::thread producer([&buffer, total, packet]() {
+        size_t sent = 0;
+        while (sent < total) {
+            size_t n = std::min(packet, total - sent);
+            auto in = makeRamp(n, sent);
+            buffer.write(in.data(), n);
+            sent += n;
+        }
+    });
+
+    std::vector<std::complex<short>> out(4096);
+    size_t received = 0;
+    while (received < total) {
+        buffer.waitForSamples(1, 100);
+        size_t n = buffer.read(out.data(), out.size());
+        for (size_t i = 0; i < n; ++i) {
+            short v = static_cast<short>((received + i) & 0x7fff);
+            assert(out[i] == std::complex<short>(v, static_cast<short>(-v)));
+        }
+        received += n;
+    }
+    producer.join();
+    assert(buffer.droppedSamples() == 0);
+
+    std::cout << "Concurrent transfer test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testBasicReadWrite();
+        testWrapAround();
+        testOverflow();
+        testOverflowPolicies();
+        testPeekConsume();
+        testMirroredLayout();
+        testWaitForSamples();
+        testWaitStrategies();
+        testConcurrentTransfer();
+
+        std::cout << "All sample buffer tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,143 @@
+#include "sample_convert.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+using namespace sdrplay;
+
+// Test every supported interleave kernel against the scalar reference
+void testInterleaveKernels() {
+    std::cout << "Testing interleave kernels (best: "
+              << simdLevelName(detectSimdLevel()) << ")..." << std::endl;
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+
+    const SimdLevel levels[] = { SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+    const size_t sizes[] = { 0, 1, 7, 8, 15, 16, 17, 31, 252, 1008, 1344, 4099 };
+
+    for (size_t size : sizes) {
+        std::vector<short> xi(size), xq(size);
+        for (size_t i = 0; i < size; ++i) {
+            xi[i] = static_cast<short>(dist(rng));
+            xq[i] = static_cast<short>(dist(rng));
+        }
+
+        std::vector<std::complex<short>> reference(size);
+        interleaveIQ(SimdLevel::Scalar, xi.data(), xq.data(), reference.data(), size);
+        for (size_t i = 0; i < size; ++i) {
+            assert(reference[i] == std::complex<short>(xi[i], xq[i]));
+        }
+
+        for (SimdLevel level : levels) {
+            if (!isSimdLevelSupported(level)) {
+                continue;
+            }
+            std::vector<std::complex<short>> out(size);
+            interleaveIQ(level, xi.data(), xq.data(), out.data(), size);
+            assert(out == reference);
+        }
+
+        std::vector<std::complex<short>> dispatched(size);
+        interleaveIQ(xi.data(), xq.data(), dispatched.data(), size);
+        assert(dispatched == reference);
+    }
+
+    std::cout << "Interleave kernel test passed" << std::endl;
+}
+
+// Test every supported format conversion kernel against the scalar reference
+void testFormatKernels() {
+    std::cout << "Testing format conversion kernels..." << std::endl;
+
+    std::mt19937 rng(5678);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+
+    const SimdLevel levels[] = { SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON };
+    const size_t sizes[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 1008, 1344, 4099 };
+
+    for (size_t size : sizes) {
+        std::vector<std::complex<short>> src(size);
+        for (size_t i = 0; i < size; ++i) {
+            src[i] = std::complex<short>(static_cast<short>(dist(rng)), static_cast<short>(dist(rng)));
+        }
+        if (size > 2) {
+            src[0] = std::complex<short>(-32768, 32767);  // Full-scale extremes
+            src[1] = std::complex<short>(-1, 255);        // Rounds down, not toward zero
+        }
+
+        std::vector<std::complex<float>> f32(size);
+        std::vector<int8_t> s8(2 * size);
+        std::vector<uint8_t> u8(2 * size);
+        convertToCF32(SimdLevel::Scalar, src.data(), f32.data(), size);
+        convertToCS8(SimdLevel::Scalar, src.data(), s8.data(), size);
+        convertToCU8(SimdLevel::Scalar, src.data(), u8.data(), size);
+        for (size_t i = 0; i < size; ++i) {
+            assert(f32[i].real() == src[i].real() / 32768.0f);
+            assert(f32[i].imag() == src[i].imag() / 32768.0f);
+            assert(f32[i].real() >= -1.0f && f32[i].real() < 1.0f);
+            assert(s8[2 * i] == (src[i].real() >> 8));
+            assert(s8[2 * i + 1] == (src[i].imag() >> 8));
+            assert(u8[2 * i] == static_cast<uint8_t>(s8[2 * i] + 128));
+            assert(u8[2 * i + 1] == static_cast<uint8_t>(s8[2 * i + 1] + 128));
+        }
+        if (size > 2) {
+            assert(s8[0] == -128 && s8[1] == 127 && u8[0] == 0 && u8[1] == 255);
+            assert(s8[2] == -1 && s8[3] == 0 && u8[2] == 127 && u8[3] == 128);
+        }
+
+        for (SimdLevel level : levels) {
+            if (!isSimdLevelSupported(level)) {
+                continue;
+            }
+            std::vector<std::complex<float>> outF32(size);
+            std::vector<int8_t> outS8(2 * size);
+            std::vector<uint8_t> outU8(2 * size);
+            convertToCF32(level, src.data(), outF32.data(), size);
+            convertToCS8(level, src.data(), outS8.data(), size);
+            convertToCU8(level, src.data(), outU8.data(), size);
+            assert(outF32 == f32);
+            assert(outS8 == s8);
+            assert(outU8 == u8);
+
+            // Unscaled conversion keeps the raw values
+            convertToCF32(level, src.data(), outF32.data(), size, 1.0f);
+            for (size_t i = 0; i < size; ++i) {
+                assert(outF32[i] == std::complex<float>(src[i].real(), src[i].imag()));
+            }
+        }
+
+        // The generic entry point matches the typed kernels
+        std::vector<uint8_t> bytes(size * sampleFormatSize(SampleFormat::CF32));
+        convertSamples(SampleFormat::CF32, src.data(), bytes.data(), size);
+        assert(size == 0 || std::memcmp(bytes.data(), f32.data(), bytes.size()) == 0);
+        convertSamples(SampleFormat::CU8, src.data(), bytes.data(), size);
+        assert(size == 0 || std::memcmp(bytes.data(), u8.data(), u8.size()) == 0);
+        convertSamples(SampleFormat::CS16, src.data(), bytes.data(), size);
+        assert(size == 0 || std::memcmp(bytes.data(), src.data(), size * sizeof(src[0])) == 0);
+    }
+
+    assert(sampleFormatSize(SampleFormat::CS16) == 4);
+    assert(sampleFormatSize(SampleFormat::CF32) == 8);
+    assert(sampleFormatSize(SampleFormat::CS8) == 2);
+    assert(sampleFormatSize(SampleFormat::CU8) == 2);
+
+    std::cout << "Format conversion kernel test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testInterleaveKernels();
+        testFormatKernels();
+
+        std::cout << "All sample conversion tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
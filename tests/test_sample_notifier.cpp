@@ -0,0 +1,107 @@
+#include "sample_notifier.h"
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+#if defined(_WIN32)
+int main() {
+    std::cout << "Sample notifier unsupported on this platform, skipped" << std::endl;
+    return 0;
+}
+#else
+#include <poll.h>
+
+using namespace sdrplay;
+
+namespace {
+    bool readable(int fd, int timeoutMs = 0) {
+        pollfd pfd = {};
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        return poll(&pfd, 1, timeoutMs) == 1 && (pfd.revents & POLLIN);
+    }
+}
+
+// Test that the descriptor follows the watermark and coalesces crossings
+void testWatermark() {
+    std::cout << "Testing watermark signalling..." << std::endl;
+
+    SampleNotifier notifier;
+    assert(!notifier.enabled() && notifier.fd() == -1);
+
+    int fd = notifier.enable(100);
+    assert(fd >= 0 && notifier.enabled() && notifier.lowWatermark() == 100);
+    assert(notifier.enable(200) == fd);
+
+    notifier.update(150);
+    assert(!readable(fd) && notifier.signalCount() == 0);
+
+    notifier.update(200);
+    assert(readable(fd) && notifier.signalCount() == 1);
+
+    // Further packets above the watermark do not signal again
+    notifier.update(300);
+    notifier.update(400);
+    assert(notifier.signalCount() == 1);
+
+    notifier.clear();
+    assert(!readable(fd));
+    notifier.update(250);
+    assert(readable(fd) && notifier.signalCount() == 2);
+
+    notifier.clear();
+    notifier.update(50);
+    assert(!readable(fd));
+
+    notifier.disable();
+    notifier.update(1000);
+    assert(!readable(fd) && notifier.signalCount() == 2);
+
+    std::cout << "Watermark signalling test passed" << std::endl;
+}
+
+// Test that no crossing is lost when the consumer clears while the producer runs
+void testConcurrentCrossings() {
+    std::cout << "Testing concurrent crossings..." << std::endl;
+
+    SampleNotifier notifier;
+    int fd = notifier.enable(1);
+    const size_t total = 200000;
+    std::atomic<size_t> produced(0);
+    std::atomic<size_t> consumed(0);
+
+    std::thread producer([&]() {
+        for (size_t i = 0; i < total; ++i) {
+            produced.fetch_add(1, std::memory_order_release);
+            notifier.update(produced.load() - consumed.load());
+        }
+    });
+
+    // Every produced item must be announced by the descriptor
+    while (consumed.load() < total) {
+        assert(readable(fd, 1000));
+        notifier.clear();
+        consumed.store(produced.load(std::memory_order_acquire));
+        notifier.update(produced.load() - consumed.load());
+    }
+    producer.join();
+    assert(notifier.signalCount() < total);
+
+    std::cout << "Concurrent crossings test passed (" << notifier.signalCount()
+              << " signals)" << std::endl;
+}
+
+int main() {
+    try {
+        testWatermark();
+        testConcurrentCrossings();
+
+        std::cout << "All sample notifier tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
+#endif
@@ -0,0 +1,370 @@
+#include "sdrplay_simulator.h"
+#include "sdrplay_wrapper.h"
+#include "device_registry.h"
+#include "device_impl/rsp1a_control.h"
+#include "metrics_server.h"
+#include "sdrplay_api.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+    // What the raw API callbacks saw; only packets worth checking are kept
+    struct Capture {
+        std::mutex mutex;
+        unsigned int packetSamples{0};
+        unsigned int nextSampleNum{0};
+        std::vector<std::complex<short>> firstPacket;
+        std::vector<unsigned int> resets;       // Packet numbers with reset set
+        std::vector<unsigned int> gaps;         // Samples missing before a packet
+        std::vector<int> changes;               // gr | rf << 1 | fs << 2, for flagged packets
+        std::vector<sdrplay_api_EventT> events;
+        unsigned int lastGainRdB{0};
+        std::atomic<unsigned int> packets{0};
+    };
+
+    void captureStream(short* xi, short* xq, sdrplay_api_StreamCbParamsT* params,
+                       unsigned int numSamples, unsigned int reset, void* context) {
+        Capture* capture = static_cast<Capture*>(context);
+        std::lock_guard<std::mutex> lock(capture->mutex);
+        unsigned int packet = capture->packets.load();
+        if (packet == 0) {
+            for (unsigned int i = 0; i < numSamples; ++i) {
+                capture->firstPacket.emplace_back(xi[i], xq[i]);
+            }
+        } else if (params->firstSampleNum != capture->nextSampleNum) {
+            capture->gaps.push_back(params->firstSampleNum - capture->nextSampleNum);
+        }
+        if (reset) {
+            capture->resets.push_back(packet);
+        }
+        int change = (params->grChanged ? 1 : 0) | (params->rfChanged ? 2 : 0) | (params->fsChanged ? 4 : 0);
+        if (change) {
+            capture->changes.push_back(change);
+        }
+        capture->packetSamples = numSamples;
+        capture->nextSampleNum = params->firstSampleNum + numSamples;
+        capture->packets.fetch_add(1);
+    }
+
+    void captureEvent(sdrplay_api_EventT eventId, sdrplay_api_TunerSelectT tuner,
+                      sdrplay_api_EventParamsT* params, void* context) {
+        (void)tuner;
+        Capture* capture = static_cast<Capture*>(context);
+        std::lock_guard<std::mutex> lock(capture->mutex);
+        capture->events.push_back(eventId);
+        if (eventId == sdrplay_api_GainChange) {
+            capture->lastGainRdB = params->gainParams.gRdB;
+        }
+    }
+
+    // Wait until the stream has moved on by a few packets
+    void waitPackets(Capture& capture, unsigned int count) {
+        unsigned int target = capture.packets.load() + count;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (capture.packets.load() < target) {
+            assert(std::chrono::steady_clock::now() < deadline);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+// Test the raw API: enumeration, packets, flags, injected faults and events
+void testApiStream() {
+    std::cout << "Testing simulated API stream..." << std::endl;
+
+    SimulatorConfig config;
+    config.packetSamples = 500;
+    config.frequencyOffsetHz = 250e3;
+    config.noiseAmplitude = 0.0;
+    Simulator::configure(config);
+
+    sdrplay_api_ErrT err = sdrplay_api_Open();
+    assert(err == sdrplay_api_Success);
+    sdrplay_api_DeviceT devices[SDRPLAY_MAX_DEVICES];
+    unsigned int numDevs = 0;
+    err = sdrplay_api_GetDevices(devices, &numDevs, SDRPLAY_MAX_DEVICES);
+    assert(err == sdrplay_api_Success);
+    assert(numDevs == 1 && devices[0].hwVer == 255 && std::strcmp(devices[0].SerNo, "SIM0000") == 0);
+
+    err = sdrplay_api_SelectDevice(&devices[0]);
+    assert(err == sdrplay_api_Success);
+    assert(sdrplay_api_SelectDevice(&devices[0]) == sdrplay_api_Fail);
+    sdrplay_api_DeviceParamsT* params = nullptr;
+    err = sdrplay_api_GetDeviceParams(devices[0].dev, &params);
+    assert(err == sdrplay_api_Success);
+    params->devParams->fsFreq.fsHz = 2e6;
+
+    Capture capture;
+    sdrplay_api_CallbackFnsT callbacks = {};
+    callbacks.StreamACbFn = captureStream;
+    callbacks.EventCbFn = captureEvent;
+    err = sdrplay_api_Init(devices[0].dev, &callbacks, &capture);
+    assert(err == sdrplay_api_Success);
+    assert(sdrplay_api_Init(devices[0].dev, &callbacks, &capture) == sdrplay_api_AlreadyInitialised);
+    waitPackets(capture, 10);
+
+    // Faults and flags arrive with the following packets
+    Simulator::injectDrop(3);
+    waitPackets(capture, 5);
+    Simulator::injectChange(false, true, false);
+    Simulator::injectReset();
+    waitPackets(capture, 5);
+    params->rxChannelA->tunerParams.gain.gRdB = 30;
+    assert(sdrplay_api_Update(devices[0].dev, sdrplay_api_Tuner_A, sdrplay_api_Update_Tuner_Gr,
+                              sdrplay_api_Update_Ext1_None) == sdrplay_api_Success);
+    params->devParams->fsFreq.fsHz = 4e6;
+    assert(sdrplay_api_Update(devices[0].dev, sdrplay_api_Tuner_A, sdrplay_api_Update_Dev_Fs,
+                              sdrplay_api_Update_Ext1_None) == sdrplay_api_Success);
+    Simulator::injectPowerOverload(true);
+    waitPackets(capture, 5);
+
+    // Out of range rates are refused and leave the stream running
+    params->devParams->fsFreq.fsHz = 20e6;
+    assert(sdrplay_api_Update(devices[0].dev, sdrplay_api_Tuner_A, sdrplay_api_Update_Dev_Fs,
+                              sdrplay_api_Update_Ext1_None) == sdrplay_api_OutOfRange);
+
+    SimulatorStats running = Simulator::getStats();
+    assert(running.streaming && running.sampleRate == 4e6);
+    err = sdrplay_api_Uninit(devices[0].dev);
+    assert(err == sdrplay_api_Success);
+    assert(sdrplay_api_Uninit(devices[0].dev) == sdrplay_api_NotInitialised);
+
+    {
+        std::lock_guard<std::mutex> lock(capture.mutex);
+        assert(capture.packetSamples == 500 && params->devParams->samplesPerPkt == 500);
+        assert(capture.resets.size() == 2 && capture.resets[0] == 0);
+        assert(capture.gaps.size() == 1 && capture.gaps[0] == 3 * 500);
+        // Gain and rate updates land on one packet or two, depending on timing
+        assert(capture.changes.size() >= 2 && capture.changes[0] == 2);
+        int later = 0;
+        for (size_t i = 1; i < capture.changes.size(); ++i) {
+            later |= capture.changes[i];
+        }
+        assert(later == (1 | 4));
+        assert(capture.events.size() == 2);
+        assert(capture.events[0] == sdrplay_api_GainChange && capture.lastGainRdB == 30);
+        assert(capture.events[1] == sdrplay_api_PowerOverloadChange);
+
+        // Tone at fs/8: consecutive samples advance by 45 degrees
+        double phase = 0.0;
+        for (size_t i = 1; i < capture.firstPacket.size(); ++i) {
+            std::complex<double> a(capture.firstPacket[i - 1].real(), capture.firstPacket[i - 1].imag());
+            std::complex<double> b(capture.firstPacket[i].real(), capture.firstPacket[i].imag());
+            phase += std::arg(b * std::conj(a));
+        }
+        phase /= static_cast<double>(capture.firstPacket.size() - 1);
+        assert(std::abs(phase - 0.785398) < 0.01);
+        assert(std::abs(std::abs(std::complex<double>(capture.firstPacket[7].real(),
+                                                      capture.firstPacket[7].imag())) - 0.5 * 32767) < 200);
+    }
+
+    SimulatorStats stats = Simulator::getStats();
+    assert(!stats.streaming && stats.droppedPackets == 3 && stats.droppedSamples == 1500);
+    assert(stats.packets == capture.packets.load() && stats.samples == stats.packets * 500);
+
+    assert(sdrplay_api_ReleaseDevice(&devices[0]) == sdrplay_api_Success);
+    sdrplay_api_Close();
+
+    std::cout << "Simulated API stream test passed" << std::endl;
+}
+
+// Test that packets are paced at the sample rate
+void testRealTimePacing() {
+    std::cout << "Testing real-time pacing..." << std::endl;
+
+    SimulatorConfig config;
+    config.signal = SimulatedSignal::Noise;
+    Simulator::configure(config);
+
+    sdrplay_api_Open();
+    sdrplay_api_DeviceT devices[SDRPLAY_MAX_DEVICES];
+    unsigned int numDevs = 0;
+    sdrplay_api_GetDevices(devices, &numDevs, SDRPLAY_MAX_DEVICES);
+    assert(numDevs == 1);
+    sdrplay_api_SelectDevice(&devices[0]);
+    sdrplay_api_DeviceParamsT* params = nullptr;
+    sdrplay_api_GetDeviceParams(devices[0].dev, &params);
+    params->devParams->fsFreq.fsHz = 10e6;
+
+    Capture capture;
+    sdrplay_api_CallbackFnsT callbacks = {};
+    callbacks.StreamACbFn = captureStream;
+    auto start = std::chrono::steady_clock::now();
+    sdrplay_api_ErrT err = sdrplay_api_Init(devices[0].dev, &callbacks, &capture);
+    assert(err == sdrplay_api_Success);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    SimulatorStats stats = Simulator::getStats();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sdrplay_api_Uninit(devices[0].dev);
+    sdrplay_api_ReleaseDevice(&devices[0]);
+    sdrplay_api_Close();
+
+    // Never ahead of the clock. Falling behind depends on the machine, so a
+    // slow one only gets a warning.
+    double expected = 10e6 * elapsed;
+    std::cout << "  " << stats.samples << " samples in " << elapsed << " s, "
+              << stats.latePackets << " late packets" << std::endl;
+    assert(stats.samples <= expected + 2 * config.packetSamples);
+    if (stats.samples < expected * 0.5) {
+        std::cout << "  Warning: simulator delivered less than half the real-time rate" << std::endl;
+    }
+
+    std::cout << "Real-time pacing test passed" << std::endl;
+}
+
+// Test Device end to end against the simulator
+void testDeviceEndToEnd() {
+    std::cout << "Testing Device end to end..." << std::endl;
+
+    DeviceRegistry::registerFactory(RSP1A_HWVER, []() { return std::make_unique<RSP1AControl>(); });
+    SimulatorConfig config;
+    config.signal = SimulatedSignal::FM;
+    config.packetSamples = 1008;
+    Simulator::configure(config);
+
+    Device device;
+    std::vector<DeviceInfo> devices = device.getAvailableDevices();
+    assert(devices.size() == 1);
+    bool selected = device.selectDevice(devices[0]);
+    assert(selected);
+    device.setSampleRate(8e6);
+    device.setFrequency(100e6);
+
+    std::atomic<int> overloads(0);
+    device.setEventCallback([&overloads](EventType type, const EventParams& params) {
+        if (type == EventType::PowerOverload && params.overloadDetected) {
+            ++overloads;
+        }
+    });
+
+    StreamingParams params;
+    params.bufferSize = 1 << 20;
+    bool started = device.startStreaming(params);
+    assert(started);
+
+    std::vector<std::complex<short>> samples(65536);
+    uint64_t received = 0;
+    bool injected = false;
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(400)) {
+        device.waitForSamples(4096, 10);
+        received += device.readSamples(samples.data(), samples.size());
+        if (!injected && std::chrono::steady_clock::now() - start > std::chrono::milliseconds(100)) {
+            Simulator::injectDrop(2);
+            Simulator::injectPowerOverload(true);
+            injected = true;
+        }
+    }
+    assert(injected);
+    StreamStats health = device.getStreamStats();
+    assert(health.callbackCount > 0 && health.maxPacketSamples == 1008);
+    assert(health.sampleRate > 0.0 && health.sampleRate < 12e6);
+    assert(health.missingSamples == 2 * 1008);
+
+    // Drain while still streaming: reads return nothing once stopped
+    size_t n;
+    while ((n = device.readSamples(samples.data(), samples.size())) > 0) {
+        received += n;
+    }
+
+    // The same counters are published for scraping
+    MetricsServer metrics;
+    metrics.addDevice(device, "sim");
+    std::string text = metrics.renderMetrics();
+    assert(text.find("sdrplay_streaming{device=\"sim\"} 1\n") != std::string::npos);
+    assert(text.find("sdrplay_missing_samples_total{device=\"sim\"} 2016\n") != std::string::npos);
+    assert(text.find("sdrplay_control_latency_seconds_count{device=\"sim\",operation=\"init\"} 1\n") !=
+           std::string::npos);
+    metrics.removeDevice(device);
+    device.stopStreaming();
+    uint64_t unread = device.getStreamStats().consumerLagSamples;
+
+    // Every simulated sample was read, left unread at the stop or counted as
+    // dropped by the buffer
+    SimulatorStats stats = Simulator::getStats();
+    assert(stats.sampleRate == 8e6 && stats.droppedPackets == 2);
+    assert(received + unread + device.getDroppedSampleCount() == stats.samples);
+    assert(device.getMissingSampleCount() == 2 * 1008 && device.getGapEventCount() == 1);
+    assert(overloads == 1);
+    assert(device.getEventCount(EventType::PowerOverload) >= 1);
+    assert(device.getControlLatency(ControlOperation::Init).count == 1);
+    assert(device.getControlLatency(ControlOperation::Uninit).count == 1);
+    assert(device.getControlLatency(ControlOperation::Update).count >= 2);
+    assert(device.getControlLatency(ControlOperation::Update).maxNs > 0);
+    std::cout << "  " << received << " samples at 8 MSPS, "
+              << stats.maxCallbackNs << " ns longest callback" << std::endl;
+
+    device.releaseDevice();
+    std::cout << "Device end to end test passed" << std::endl;
+}
+
+// Test scraping metrics while streaming is started and stopped
+void testMetricsDuringRestart() {
+    std::cout << "Testing metrics scrapes during restarts..." << std::endl;
+
+    SimulatorConfig config;
+    config.signal = SimulatedSignal::Noise;
+    Simulator::configure(config);
+
+    Device device;
+    std::vector<DeviceInfo> devices = device.getAvailableDevices();
+    assert(devices.size() == 1);
+    bool selected = device.selectDevice(devices[0]);
+    assert(selected);
+    device.setSampleRate(2e6);
+
+    MetricsServer metrics;
+    metrics.addDevice(device, "sim");
+    std::atomic<bool> done(false);
+    std::atomic<unsigned int> scrapes(0);
+    std::thread scraper([&]() {
+        while (!done.load()) {
+            std::string text = metrics.renderMetrics();
+            assert(text.find("sdrplay_streaming{device=\"sim\"}") != std::string::npos);
+            ++scrapes;
+        }
+    });
+
+    // Alternate the storage so the buffers are reconfigured on every start
+    for (int i = 0; i < 6; ++i) {
+        StreamingParams params;
+        params.bufferSize = (i % 3 + 1) << 16;
+        params.planarStorage = i % 2 == 1;
+        bool started = device.startStreaming(params);
+        assert(started);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        device.stopStreaming();
+    }
+    done = true;
+    scraper.join();
+    metrics.removeDevice(device);
+    assert(scrapes > 0);
+
+    device.releaseDevice();
+    std::cout << "Metrics scrapes during restarts test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testApiStream();
+        testRealTimePacing();
+        testDeviceEndToEnd();
+        testMetricsDuringRestart();
+
+        std::cout << "All simulator tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
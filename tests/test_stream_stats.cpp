@@ -0,0 +1,129 @@
+#include "stream_stats.h"
+#include "callback_wrapper.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+    // Deliver one packet to the wrapper the way the API does
+    void sendPacket(CallbackWrapper& wrapper, unsigned int firstSampleNum, unsigned int numSamples,
+                    bool reset = false) {
+        std::vector<short> xi(numSamples, 1), xq(numSamples, -1);
+        sdrplay_api_StreamCbParamsT params = {};
+        params.firstSampleNum = firstSampleNum;
+        params.numSamples = numSamples;
+        CallbackWrapper::streamCallback(xi.data(), xq.data(), &params, numSamples, reset ? 1 : 0,
+                                        wrapper.getContext());
+    }
+}
+
+// Test rate, interval and packet size accounting with synthetic arrival times
+void testCollector() {
+    std::cout << "Testing stream stats collector..." << std::endl;
+
+    StreamStatsCollector collector;
+    StreamStats stats;
+    collector.snapshot(stats, 1000);
+    assert(stats.callbackCount == 0 && stats.sampleRate == 0.0);
+    assert(stats.nsSinceLastCallback == UINT64_MAX);
+
+    // 1000 samples every 100 us is 10 MSPS, with alternating +-10 us jitter
+    uint64_t t = 1000000;
+    uint64_t last = 0;
+    for (int i = 0; i < 10000; ++i) {
+        collector.recordPacket(t, 1000, false);
+        last = t;
+        t += (i % 2) ? 90000 : 110000;
+    }
+    collector.recordFill(5000);
+    collector.recordFill(3000);
+
+    collector.snapshot(stats, last + 2000);
+    assert(stats.callbackCount == 10000);
+    assert(stats.samplesReceived == 10000000);
+    assert(stats.sampleRate > 9.9e6 && stats.sampleRate < 10.1e6);
+    assert(stats.meanIntervalNs >= 99990 && stats.meanIntervalNs <= 100010);
+    assert(stats.intervalJitterNs >= 9990 && stats.intervalJitterNs <= 10010);
+    assert(stats.minIntervalNs == 90000 && stats.maxIntervalNs == 110000);
+    assert(stats.minPacketSamples == 1000 && stats.maxPacketSamples == 1000);
+    assert(stats.packetSizeCount(StreamStats::packetSizeBucket(1000)) == 10000);
+    assert(stats.bufferHighWatermark == 5000);
+    assert(stats.nsSinceLastCallback == 2000);
+
+    // Packet size buckets are powers of two
+    assert(StreamStats::packetSizeBucket(0) == 0);
+    assert(StreamStats::packetSizeBucket(1008) == 9);
+    assert(StreamStats::packetSizeBucket(1024) == 10);
+    assert(StreamStats::packetSizeBucket(size_t(1) << 40) == StreamStats::PACKET_SIZE_BUCKETS - 1);
+    assert(StreamStats::packetSizeBucketMin(9) == 512);
+
+    // A rate change discards the window; the new rate shows from the next packets
+    collector.recordPacket(t, 500, true);
+    collector.snapshot(stats, t);
+    assert(stats.sampleRate == 0.0);
+    collector.recordPacket(t + 100000, 500, false);
+    collector.snapshot(stats, t + 100000);
+    assert(stats.sampleRate > 4.9e6 && stats.sampleRate < 5.1e6);
+
+    collector.reset();
+    collector.snapshot(stats, t);
+    assert(stats.callbackCount == 0 && stats.bufferHighWatermark == 0);
+
+    std::cout << "Stream stats collector test passed" << std::endl;
+}
+
+// Test the buffer and loss counters reported by the wrapper
+void testWrapperStats() {
+    std::cout << "Testing wrapper stream stats..." << std::endl;
+
+    CallbackWrapper wrapper(4096);
+    wrapper.prepareStream(2048);
+
+    // Four packets fill the buffer to 4032, the fifth overflows it
+    sendPacket(wrapper, 0, 1008, true);
+    for (unsigned int i = 1; i < 5; ++i) {
+        sendPacket(wrapper, i * 1008, 1008);
+    }
+    StreamStats stats = wrapper.getStreamStats();
+    assert(stats.callbackCount == 5 && stats.samplesReceived == 5040);
+    assert(stats.bufferCapacity == 4096);
+    assert(stats.bufferHighWatermark == 4096);
+    assert(stats.droppedSamples == 944 && stats.overflowEvents == 1);
+    assert(stats.consumerLagSamples == 4096);
+    assert(stats.sampleRate > 0.0 && stats.consumerLagNs > 0);
+    assert(stats.nsSinceLastCallback < 1000000000);
+
+    // The consumer catches up, then the API skips 500 samples
+    std::vector<std::complex<short>> samples(1096);
+    size_t read = wrapper.readSamples(samples.data(), samples.size());
+    assert(read == 1096);
+    sendPacket(wrapper, 5040 + 500, 512);
+    stats = wrapper.getStreamStats();
+    assert(stats.consumerLagSamples == 3512);
+    assert(stats.missingSamples == 500 && stats.gapEvents == 1);
+    assert(stats.minPacketSamples == 512 && stats.maxPacketSamples == 1008);
+    assert(stats.packetSizeCount(9) == 6);
+
+    // An API reset restarts the packet counters; losses are kept until the next stream
+    sendPacket(wrapper, 0, 1008, true);
+    stats = wrapper.getStreamStats();
+    assert(stats.callbackCount == 1 && stats.bufferHighWatermark == 1008);
+    assert(stats.droppedSamples == 944 && stats.missingSamples == 500);
+
+    std::cout << "Wrapper stream stats test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testCollector();
+        testWrapperStats();
+
+        std::cout << "All stream stats tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
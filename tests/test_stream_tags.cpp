@@ -0,0 +1,121 @@
+#include "stream_tags.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+    StreamTag makeTag(uint64_t sampleIndex, uint32_t numSamples, uint32_t firstSampleNum) {
+        StreamTag tag;
+        tag.sampleIndex = sampleIndex;
+        tag.numSamples = numSamples;
+        tag.firstSampleNum = firstSampleNum;
+        tag.timestampNs = sampleIndex * 10;
+        return tag;
+    }
+}
+
+// Test range queries over back-to-back packets
+void testQuery() {
+    std::cout << "Testing tag range queries..." << std::endl;
+
+    StreamTagBuffer tags(16);
+    for (uint32_t i = 0; i < 10; ++i) {
+        tags.append(makeTag(i * 100, 100, 5000 + i * 100));
+    }
+
+    // Range inside a single packet
+    std::vector<StreamTag> result = tags.query(150, 10);
+    assert(result.size() == 1);
+    assert(result[0].sampleIndex == 100);
+    assert(result[0].firstSampleNum == 5100);
+    assert(result[0].timestampNs == 1000);
+
+    // Range straddling three packets
+    result = tags.query(250, 200);
+    assert(result.size() == 3);
+    assert(result[0].sampleIndex == 200);
+    assert(result[2].sampleIndex == 400);
+
+    // Range ending exactly at a packet boundary does not include the next packet
+    result = tags.query(0, 100);
+    assert(result.size() == 1);
+
+    // Range past the newest tag
+    result = tags.query(5000, 100);
+    assert(result.empty());
+
+    std::cout << "Tag range query test passed" << std::endl;
+}
+
+// Test that change flags survive the round trip and flag-only tags are kept
+void testChangeFlags() {
+    std::cout << "Testing tag change flags..." << std::endl;
+
+    StreamTagBuffer tags(8);
+    tags.append(makeTag(0, 100, 0));
+
+    StreamTag retune = makeTag(100, 0, 100);
+    retune.rfChanged = true;
+    tags.append(retune);
+
+    StreamTag gain = makeTag(100, 100, 100);
+    gain.grChanged = true;
+    tags.append(gain);
+
+    // Tags with no samples and no flags are dropped
+    tags.append(makeTag(200, 0, 200));
+
+    std::vector<StreamTag> result = tags.query(100, 50);
+    assert(result.size() == 2);
+    assert(result[0].rfChanged && result[0].numSamples == 0);
+    assert(!result[0].grChanged && !result[0].fsChanged && !result[0].reset);
+    assert(result[1].grChanged && !result[1].rfChanged);
+
+    result = tags.query(200, 100);
+    assert(result.empty());
+
+    std::cout << "Tag change flag test passed" << std::endl;
+}
+
+// Test that the oldest tags are overwritten when the ring wraps
+void testWrap() {
+    std::cout << "Testing tag ring wrap..." << std::endl;
+
+    StreamTagBuffer tags(4);
+    assert(tags.capacity() == 4);
+    for (uint32_t i = 0; i < 10; ++i) {
+        tags.append(makeTag(i * 10, 10, i * 10));
+    }
+
+    // Only the newest four packets remain
+    std::vector<StreamTag> result = tags.query(0, 100);
+    assert(result.size() == 4);
+    assert(result[0].sampleIndex == 60);
+    assert(result[3].sampleIndex == 90);
+
+    tags.clear();
+    assert(tags.query(0, 100).empty());
+
+    tags.reconfigure(5);
+    assert(tags.capacity() == 8);
+    tags.append(makeTag(0, 10, 0));
+    assert(tags.query(0, 10).size() == 1);
+
+    std::cout << "Tag ring wrap test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testQuery();
+        testChangeFlags();
+        testWrap();
+
+        std::cout << "All stream tag tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
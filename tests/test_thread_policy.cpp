@@ -0,0 +1,147 @@
+#include "thread_policy.h"
+#include "ring_storage.h"
+#include "callback_wrapper.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <atomic>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace sdrplay;
+
+namespace {
+    // A setting is either applied or reported as failed, never both
+    void checkConsistent(const ThreadPolicyStatus& status, bool applied, const std::string& prefix) {
+        bool failed = false;
+        for (const std::string& failure : status.failures) {
+            failed = failed || failure.compare(0, prefix.size(), prefix) == 0;
+        }
+        assert(applied != failed);
+    }
+}
+
+// Test affinity and priority on the calling thread and on a std::thread
+void testApplyToThreads() {
+    std::cout << "Testing thread policy on threads..." << std::endl;
+
+    // An empty policy changes nothing and reports nothing
+    ThreadPolicyStatus status = applyThreadPolicy(ThreadPolicy());
+    assert(status.ok() && !status.affinityApplied && !status.priorityApplied);
+
+#if defined(__linux__)
+    ThreadPolicy pin;
+    pin.cpus.push_back(sched_getcpu());
+    std::atomic<bool> stop(false);
+    std::thread worker([&stop]() {
+        while (!stop) {
+            std::this_thread::yield();
+        }
+    });
+    status = applyThreadPolicy(worker, pin);
+    assert(status.ok() && status.affinityApplied);
+    stop = true;
+    worker.join();
+#endif
+
+    ThreadPolicy invalid;
+    invalid.cpus.push_back(-1);
+    status = applyThreadPolicy(invalid);
+    assert(!status.ok() && !status.affinityApplied);
+
+    // Usually needs privileges; either way the outcome must be reported
+    std::thread realtime([]() {
+        ThreadPolicy policy;
+        policy.realtimePriority = 10;
+        ThreadPolicyStatus result = applyThreadPolicy(policy);
+        checkConsistent(result, result.priorityApplied, "realtime priority");
+    });
+    realtime.join();
+
+    std::cout << "Thread policy on threads test passed" << std::endl;
+}
+
+// Test locking and prefaulting ring storage in both layouts
+void testStorageLock() {
+    std::cout << "Testing storage locking..." << std::endl;
+
+    for (RingLayout layout : {RingLayout::Standard, RingLayout::Mirrored}) {
+        RingStorage storage(1 << 16, layout);
+        if (storage.lock()) {
+            assert(storage.locked());
+            storage.unlock();
+        }
+        assert(!storage.locked());
+
+        // Prefaulting must not disturb the contents
+        static_cast<char*>(storage.data())[100] = 42;
+        storage.prefault();
+        assert(static_cast<char*>(storage.data())[100] == 42);
+
+        // Moving the storage carries the lock with it
+        if (storage.lock()) {
+            RingStorage moved(std::move(storage));
+            assert(moved.locked() && !storage.locked());
+        }
+    }
+
+    std::cout << "Storage locking test passed" << std::endl;
+}
+
+// Test the policy follows the dispatcher and the buffers of a wrapper
+void testWrapperPolicy() {
+    std::cout << "Testing wrapper thread policy..." << std::endl;
+
+    CallbackWrapper wrapper(8192);
+    ThreadPolicy policy;
+    policy.lockMemory = true;
+    policy.realtimePriority = 5;
+#if defined(__linux__)
+    policy.cpus.push_back(sched_getcpu());
+#endif
+
+    // No dispatcher yet: only memory settings apply
+    ThreadPolicyStatus status = wrapper.setThreadPolicy(policy);
+    assert(!status.affinityApplied && !status.priorityApplied);
+    checkConsistent(status, status.memoryLocked, "memory lock");
+    assert(wrapper.getThreadPolicy().realtimePriority == 5);
+
+    // Starting the dispatcher applies the thread settings to it
+    wrapper.setSampleCallback([](const std::complex<short>*, size_t) {});
+    wrapper.setCallbackMode(CallbackMode::Dispatcher);
+    status = wrapper.getThreadPolicyStatus();
+#if defined(__linux__)
+    assert(status.affinityApplied);
+#endif
+    checkConsistent(status, status.priorityApplied, "realtime priority");
+
+    // Reallocated buffers are locked again
+    wrapper.setCallbackMode(CallbackMode::Inline);
+    wrapper.configureBuffer(16384, RingLayout::Standard);
+    status = wrapper.getThreadPolicyStatus();
+    assert(!status.affinityApplied);
+    checkConsistent(status, status.memoryLocked, "memory lock");
+
+    wrapper.setThreadPolicy(ThreadPolicy());
+    status = wrapper.getThreadPolicyStatus();
+    assert(status.ok() && !status.memoryLocked);
+
+    std::cout << "Wrapper thread policy test passed" << std::endl;
+}
+
+int main() {
+    try {
+        testApplyToThreads();
+        testStorageLock();
+        testWrapperPolicy();
+
+        std::cout << "All thread policy tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,155 @@
+#include "trace.h"
+#include "callback_wrapper.h"
+#include <cassert>
+#include <complex>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sdrplay;
+
+namespace {
+    // Deliver one packet to the wrapper the way the API does
+    void sendPacket(CallbackWrapper& wrapper, unsigned int firstSampleNum, unsigned int numSamples,
+                    bool reset) {
+        std::vector<short> xi(numSamples, 1), xq(numSamples, -1);
+        sdrplay_api_StreamCbParamsT params = {};
+        params.firstSampleNum = firstSampleNum;
+        params.numSamples = numSamples;
+        CallbackWrapper::streamCallback(xi.data(), xq.data(), &params, numSamples, reset ? 1 : 0,
+                                        wrapper.getContext());
+    }
+
+    // Stream a few packets from a separate thread, as the API would, and read them back;
+    // the first packet carries the reset flag that starts the stream
+    void streamPackets(CallbackWrapper& wrapper, unsigned int packets) {
+        std::thread stream([&wrapper, packets]() {
+            for (unsigned int i = 0; i < packets; ++i) {
+                sendPacket(wrapper, i * 1008, 1008, i == 0);
+            }
+        });
+        stream.join();
+
+        std::vector<std::complex<short>> samples(1008);
+        while (wrapper.readSamples(samples.data(), samples.size()) > 0) {
+        }
+    }
+
+    size_t countOf(const std::string& text, const std::string& pattern) {
+        size_t count = 0;
+        for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            ++count;
+        }
+        return count;
+    }
+}
+
+// Test that the stream stages show up in the trace when tracing is on
+void testStreamTrace() {
+    std::cout << "Testing stream trace events..." << std::endl;
+
+    CallbackWrapper wrapper(16384);
+    wrapper.prepareStream(2048);
+
+    Trace::clear();
+    Trace::enable();
+    assert(Trace::isEnabled());
+    Trace::setThreadName("consumer");
+    streamPackets(wrapper, 4);
+    Trace::enable(false);
+
+    std::string json = Trace::toChromeJson();
+    assert(json.find("\"traceEvents\"") != std::string::npos);
+    assert(countOf(json, "\"name\":\"stream_callback\"") == 4);
+    assert(countOf(json, "\"name\":\"ring_write\"") == 4);
+    assert(countOf(json, "\"name\":\"ring_read\"") >= 4);
+    assert(json.find("\"name\":\"sdrplay_api stream\"") != std::string::npos);
+    assert(json.find("\"name\":\"consumer\"") != std::string::npos);
+    assert(json.find("\"ph\":\"X\"") != std::string::npos);
+
+    // Nothing is recorded while tracing is off
+    streamPackets(wrapper, 2);
+    assert(countOf(Trace::toChromeJson(), "\"name\":\"stream_callback\"") == 4);
+
+    // Clearing forgets the events and the exited stream threads
+    Trace::clear();
+    json = Trace::toChromeJson();
+    assert(json.find("\"ph\":\"X\"") == std::string::npos);
+    assert(json.find("sdrplay_api stream") == std::string::npos);
+
+    std::cout << "Stream trace test passed" << std::endl;
+}
+
+// Test that a thread overwriting its ring keeps only the newest events
+void testRingOverwrite() {
+    std::cout << "Testing trace ring overwrite..." << std::endl;
+
+    Trace::clear();
+    Trace::enable();
+    uint64_t start = Trace::nowNs();
+    for (size_t i = 0; i < Trace::EVENTS_PER_THREAD + 100; ++i) {
+        Trace::record(i < 100 ? "old" : "new", start + i, start + i + 1);
+    }
+    Trace::enable(false);
+
+    std::string json = Trace::toChromeJson();
+    assert(countOf(json, "\"name\":\"old\"") == 0);
+    assert(countOf(json, "\"name\":\"new\"") == Trace::EVENTS_PER_THREAD);
+    Trace::clear();
+
+    std::cout << "Trace ring overwrite test passed" << std::endl;
+}
+
+// Test writing the trace to a file
+void testWriteFile() {
+    std::cout << "Testing trace file output..." << std::endl;
+
+    std::string path = "test_trace_output.json";
+    assert(Trace::writeChromeJson(path));
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    assert(contents.str() == Trace::toChromeJson());
+    std::remove(path.c_str());
+
+    assert(!Trace::writeChromeJson("/nonexistent-directory/trace.json"));
+
+    std::cout << "Trace file output test passed" << std::endl;
+}
+
+// Without SDRPLAY_TRACING the trace stays empty whatever is enabled
+void testCompiledOut() {
+    std::cout << "Testing trace without SDRPLAY_TRACING..." << std::endl;
+
+    CallbackWrapper wrapper(16384);
+    wrapper.prepareStream(2048);
+    Trace::enable();
+    streamPackets(wrapper, 4);
+    Trace::enable(false);
+
+    assert(Trace::toChromeJson().find("\"ph\"") == std::string::npos);
+
+    std::cout << "Compiled-out trace test passed" << std::endl;
+}
+
+int main() {
+    try {
+        if (Trace::isCompiledIn()) {
+            testStreamTrace();
+            testRingOverwrite();
+        } else {
+            testCompiledOut();
+        }
+        testWriteFile();
+
+        std::cout << "All trace tests passed" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}